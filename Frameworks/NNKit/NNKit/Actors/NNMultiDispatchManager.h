@@ -19,6 +19,8 @@
 
 @property (nonatomic, assign, readwrite, getter = isEnabled, setter = setIsEnabled:) BOOL enabled;
 @property (nonatomic, readonly, assign) Protocol *protocol;
+// The number of oneway messages that were not delivered because they were coalesced with a newer message.
+@property (nonatomic, readonly, assign) NSUInteger staleMessageCount;
 
 - (instancetype)initWithProtocol:(Protocol *)protocol;
 
@@ -26,4 +28,7 @@
 - (BOOL)hasObserver:(id)observer;
 - (void)removeObserver:(id)observer;
 
+// Pending oneway messages with this selector are coalesced when their arguments at index are the same object (by identity) or value, so only the most recently sent of them is delivered, in its place in the order. Pass NSNotFound to coalesce all pending messages with the selector. The selector must be oneway and its arguments pointer-sized.
+- (void)coalesceSelector:(SEL)selector byArgumentAtIndex:(NSUInteger)index;
+
 @end
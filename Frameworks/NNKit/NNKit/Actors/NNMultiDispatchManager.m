@@ -14,77 +14,216 @@
 
 #import "NNMultiDispatchManager.h"
 
-#import "NNWeakSet.h"
+#import <pthread.h>
+
 #import "despatch.h"
 #import "nn_autofree.h"
 #import "NSInvocation+NNCopying.h"
 #import "runtime.h"
 
 
-@interface NNMultiDispatchManager ()
+// Selectors that return void and take at most this many pointer-sized arguments are dispatched through trampolines instead of NSInvocation.
+#define NNMultiDispatchMaxArguments 6
+
+
+typedef struct {
+    SEL selector;
+    const char *types;
+    BOOL required;
+    BOOL oneway;
+    // NO if messages with this selector are forwarded through NSInvocation.
+    BOOL trampolined;
+    unsigned argumentCount;
+    // Bit i is set if argument i is an object, which a pending oneway delivery has to keep alive.
+    unsigned objectArguments;
+    // Set by -coalesceSelector:byArgumentAtIndex:. coalescingArgument is NSNotFound if all pending messages with the selector are coalesced.
+    BOOL coalesced;
+    NSUInteger coalescingArgument;
+} NNMultiDispatchSelector;
+
+
+// An observer and the implementations of the protocol's selectors that it responds to.
+@interface _NNMultiDispatchObserver : NSObject {
+@public
+    __weak id _observer;
+    // The class the implementations were looked up in. Observers that change class (KVO does this) get their implementations looked up again before the next delivery. Once the entry has been added, these are only touched on the main thread.
+    Class _class;
+    // One for each of the manager's selectors. NULL where the observer doesn't implement an optional method.
+    IMP *_implementations;
+}
+
+@end
+
+
+@implementation _NNMultiDispatchObserver
+
+- (void)dealloc;
+{
+    free(self->_implementations);
+}
+
+@end
+
+
+// A oneway message waiting to be delivered on the main queue.
+typedef struct {
+    unsigned selectorIndex;
+    // Set when a newer message with the same coalescing key was sent before this one was delivered.
+    BOOL stale;
+    // A retained copy of the invocation for messages that aren't trampolined, NULL otherwise.
+    void *invocation;
+    // Object arguments are retained until the message is delivered.
+    void *arguments[NNMultiDispatchMaxArguments];
+} _NNMultiDispatchDelivery;
+
+// Maps a coalescing key to the newest pending delivery with that key.
+typedef struct {
+    BOOL used;
+    unsigned selectorIndex;
+    void *argument;
+    uint64_t sequence;
+} _NNMultiDispatchCoalescingEntry;
+
+// The number of pending oneway messages the manager has room for before it has to grow its queue.
+#define NNMultiDispatchInitialCapacity 64
+
+
+@interface NNMultiDispatchManager () {
+    pthread_mutex_t _lock;
+    NNMultiDispatchSelector *_selectors;
+    unsigned _selectorCount;
+    // Copy-on-write: the array is replaced instead of mutated, so deliveries iterate it without holding the lock.
+    NSArray *_observers;
+    // Pending oneway messages, in a ring that only grows when it's full. _head and _tail are sequence numbers, and the delivery for sequence number n is at n & (_capacity - 1).
+    _NNMultiDispatchDelivery *_deliveries;
+    NSUInteger _capacity;
+    uint64_t _head;
+    uint64_t _tail;
+    // An open-addressed hash table with twice as many entries as the ring, holding a key for each pending coalesced message that hasn't gone stale.
+    _NNMultiDispatchCoalescingEntry *_coalescing;
+    BOOL _drainScheduled;
+    NSUInteger _staleMessageCount;
+}
 
 @property (nonatomic, readonly, strong) NSMutableDictionary *signatureCache;
-@property (nonatomic, readonly, strong) NNWeakSet *observers;
 
 @end
 
 
+static void _resolveImplementations(__unsafe_unretained NNMultiDispatchManager *self, __unsafe_unretained _NNMultiDispatchObserver *entry, __unsafe_unretained id observer);
+static void _enqueue(__unsafe_unretained NNMultiDispatchManager *self, unsigned selectorIndex, void **arguments, NSInvocation *invocation);
+
+
 @implementation NNMultiDispatchManager
 
 - (instancetype)initWithProtocol:(Protocol *)protocol;
 {
     if (!(self = [super init])) { return nil; }
     
+    pthread_mutex_init(&self->_lock, NULL);
     self->_enabled = YES;
     self->_protocol = protocol;
     self->_signatureCache = [NSMutableDictionary new];
     [self _cacheMethodSignaturesForProcotol:protocol];
-    self->_observers = [NNWeakSet new];
+    self->_observers = @[];
+    self->_capacity = NNMultiDispatchInitialCapacity;
+    self->_deliveries = calloc(self->_capacity, sizeof(_NNMultiDispatchDelivery));
+    self->_coalescing = calloc(self->_capacity * 2, sizeof(_NNMultiDispatchCoalescingEntry));
+    
+    // Instances answer the protocol's messages directly through a class made for the protocol, falling back to -forwardInvocation: for anything the trampolines can't pass along.
+    object_setClass(self, [self _dispatchClass]);
 
     return self;
 }
 
+- (void)dealloc;
+{
+    // Every pending message holds a reference to the manager until its batch is drained, so there's nothing left to release here.
+    free(self->_deliveries);
+    free(self->_coalescing);
+    free(self->_selectors);
+    pthread_mutex_destroy(&self->_lock);
+}
+
 @synthesize enabled = _enabled;
 
 - (BOOL)isEnabled;
 {
-    @synchronized(self) {
-        return self->_enabled;
-    }
+    pthread_mutex_lock(&self->_lock);
+    BOOL enabled = self->_enabled;
+    pthread_mutex_unlock(&self->_lock);
+    return enabled;
 }
 
 - (void)setIsEnabled:(BOOL)enabled;
 {
-    @synchronized(self) {
-        self->_enabled = enabled;
-    }
+    pthread_mutex_lock(&self->_lock);
+    self->_enabled = enabled;
+    pthread_mutex_unlock(&self->_lock);
+}
+
+- (NSUInteger)staleMessageCount;
+{
+    pthread_mutex_lock(&self->_lock);
+    NSUInteger staleMessageCount = self->_staleMessageCount;
+    pthread_mutex_unlock(&self->_lock);
+    return staleMessageCount;
+}
+
+- (void)coalesceSelector:(SEL)aSelector byArgumentAtIndex:(NSUInteger)index;
+{
+    unsigned selectorIndex = [self _indexOfSelector:aSelector];
+    NSParameterAssert(selectorIndex < self->_selectorCount);
+    if (selectorIndex >= self->_selectorCount) { return; }
+    
+    NNMultiDispatchSelector *selector = &self->_selectors[selectorIndex];
+    NSAssert(selector->oneway && selector->trampolined, @"Only oneway messages with pointer-sized arguments can be coalesced");
+    NSAssert(index == NSNotFound || index < selector->argumentCount, @"Selector %@ has no argument at index %lu", NSStringFromSelector(aSelector), (unsigned long)index);
+    
+    pthread_mutex_lock(&self->_lock);
+    selector->coalesced = YES;
+    selector->coalescingArgument = index;
+    pthread_mutex_unlock(&self->_lock);
 }
 
 - (void)addObserver:(id)observer;
 {
     NSParameterAssert([observer conformsToProtocol:self.protocol]);
     
-    @synchronized(self) {
-        [self.observers addObject:observer];
+    _NNMultiDispatchObserver *entry = [_NNMultiDispatchObserver new];
+    entry->_observer = observer;
+    entry->_implementations = calloc(self->_selectorCount + 1, sizeof(IMP));
+    _resolveImplementations(self, entry, observer);
+    
+    pthread_mutex_lock(&self->_lock);
+    if (![self _indexOfObserver:observer]) {
+        self->_observers = [[self _liveObservers] arrayByAddingObject:entry];
     }
+    pthread_mutex_unlock(&self->_lock);
 }
 
 - (BOOL)hasObserver:(id)observer;
 {
     NSAssert([NSThread isMainThread], @"Boundary call was not made on main thread");
     
-    @synchronized(self) {
-        return [self.observers containsObject:observer];
-    }
+    pthread_mutex_lock(&self->_lock);
+    BOOL result = [self _indexOfObserver:observer] != 0;
+    pthread_mutex_unlock(&self->_lock);
+    return result;
 }
 
 - (void)removeObserver:(id)observer;
 {
     NSAssert([NSThread isMainThread], @"Boundary call was not made on main thread");
     
-    @synchronized(self) {
-        [self.observers removeObject:observer];
+    pthread_mutex_lock(&self->_lock);
+    NSUInteger index = [self _indexOfObserver:observer];
+    if (index) {
+        NSMutableArray *observers = [self->_observers mutableCopy];
+        [observers removeObjectAtIndex:index - 1];
+        self->_observers = [observers copy];
     }
+    pthread_mutex_unlock(&self->_lock);
 }
 
 - (NSMethodSignature *)methodSignatureForSelector:(SEL)aSelector;
@@ -96,28 +235,331 @@
 
 - (void)forwardInvocation:(NSInvocation *)anInvocation;
 {
-    @synchronized(self) {
-        if (self.enabled) {
-            if (anInvocation.methodSignature.isOneway) {
-                // If we're going async, copy the invocation to avoid multiple threads calling -invoke or otherwise acting in a thread-unsafe manner.
-                anInvocation = [anInvocation nn_copy];
-                [anInvocation retainArguments];
-            }
+    if (self.enabled) {
+        NSAssert(strstr(anInvocation.methodSignature.methodReturnType, "v"), @"Method return type must be void.");
+        if (anInvocation.methodSignature.isOneway) {
+            // If we're going async, copy the invocation to avoid multiple threads calling -invoke or otherwise acting in a thread-unsafe manner.
+            NSInvocation *invocation = [anInvocation nn_copy];
+            [invocation retainArguments];
             
-            NSAssert(strstr(anInvocation.methodSignature.methodReturnType, "v"), @"Method return type must be void.");
-            dispatch_block_t dispatch = ^{
+            // Forwarded messages wait in the same queue as trampolined ones so that oneway messages are delivered in the order they were sent.
+            unsigned selectorIndex = [self _indexOfSelector:anInvocation.selector];
+            NSAssert(selectorIndex < self->_selectorCount, @"Selector %@ is not actually part of protocol %@?!", NSStringFromSelector(anInvocation.selector), NSStringFromProtocol(self.protocol));
+            _enqueue(self, selectorIndex, NULL, invocation);
+        } else {
+            despatch_sync_main_reentrant(^{
                 [self private_forwardInvocation:anInvocation];
-            };
-            if (anInvocation.methodSignature.isOneway) {
-                dispatch_async(dispatch_get_main_queue(), dispatch);
-            } else {
-                despatch_sync_main_reentrant(dispatch);
+            });
+        }
+    }
+    
+    anInvocation.target = nil;
+    [anInvocation invoke];
+}
+
+#pragma mark Trampolines
+
+static void _dispatch(__unsafe_unretained NNMultiDispatchManager *self, SEL _cmd, void **arguments);
+
+static void _trampoline0(__unsafe_unretained NNMultiDispatchManager *self, SEL _cmd)
+{
+    _dispatch(self, _cmd, NULL);
+}
+
+static void _trampoline1(__unsafe_unretained NNMultiDispatchManager *self, SEL _cmd, void *a0)
+{
+    void *arguments[] = { a0 };
+    _dispatch(self, _cmd, arguments);
+}
+
+static void _trampoline2(__unsafe_unretained NNMultiDispatchManager *self, SEL _cmd, void *a0, void *a1)
+{
+    void *arguments[] = { a0, a1 };
+    _dispatch(self, _cmd, arguments);
+}
+
+static void _trampoline3(__unsafe_unretained NNMultiDispatchManager *self, SEL _cmd, void *a0, void *a1, void *a2)
+{
+    void *arguments[] = { a0, a1, a2 };
+    _dispatch(self, _cmd, arguments);
+}
+
+static void _trampoline4(__unsafe_unretained NNMultiDispatchManager *self, SEL _cmd, void *a0, void *a1, void *a2, void *a3)
+{
+    void *arguments[] = { a0, a1, a2, a3 };
+    _dispatch(self, _cmd, arguments);
+}
+
+static void _trampoline5(__unsafe_unretained NNMultiDispatchManager *self, SEL _cmd, void *a0, void *a1, void *a2, void *a3, void *a4)
+{
+    void *arguments[] = { a0, a1, a2, a3, a4 };
+    _dispatch(self, _cmd, arguments);
+}
+
+static void _trampoline6(__unsafe_unretained NNMultiDispatchManager *self, SEL _cmd, void *a0, void *a1, void *a2, void *a3, void *a4, void *a5)
+{
+    void *arguments[] = { a0, a1, a2, a3, a4, a5 };
+    _dispatch(self, _cmd, arguments);
+}
+
+static const IMP _trampolines[NNMultiDispatchMaxArguments + 1] = {
+    (IMP)_trampoline0, (IMP)_trampoline1, (IMP)_trampoline2, (IMP)_trampoline3, (IMP)_trampoline4, (IMP)_trampoline5, (IMP)_trampoline6,
+};
+
+static void _deliver(__unsafe_unretained NNMultiDispatchManager *self, unsigned selectorIndex, void **arguments)
+{
+    // Observers are looked up at delivery time, so observers removed while a oneway message was pending don't receive it.
+    pthread_mutex_lock(&self->_lock);
+    NSArray *observers = self->_observers;
+    pthread_mutex_unlock(&self->_lock);
+    
+    SEL selector = self->_selectors[selectorIndex].selector;
+    unsigned argumentCount = self->_selectors[selectorIndex].argumentCount;
+    for (_NNMultiDispatchObserver *entry in observers) {
+        id observer = entry->_observer;
+        if (!observer) {
+            continue;
+        }
+        if (object_getClass(observer) != entry->_class) {
+            _resolveImplementations(self, entry, observer);
+        }
+        IMP implementation = entry->_implementations[selectorIndex];
+        if (!implementation) {
+            continue;
+        }
+        
+        void **a = arguments;
+        switch (argumentCount) {
+            case 0:
+                ((void (*)(id, SEL))implementation)(observer, selector);
+                break;
+            case 1:
+                ((void (*)(id, SEL, void *))implementation)(observer, selector, a[0]);
+                break;
+            case 2:
+                ((void (*)(id, SEL, void *, void *))implementation)(observer, selector, a[0], a[1]);
+                break;
+            case 3:
+                ((void (*)(id, SEL, void *, void *, void *))implementation)(observer, selector, a[0], a[1], a[2]);
+                break;
+            case 4:
+                ((void (*)(id, SEL, void *, void *, void *, void *))implementation)(observer, selector, a[0], a[1], a[2], a[3]);
+                break;
+            case 5:
+                ((void (*)(id, SEL, void *, void *, void *, void *, void *))implementation)(observer, selector, a[0], a[1], a[2], a[3], a[4]);
+                break;
+            case 6:
+                ((void (*)(id, SEL, void *, void *, void *, void *, void *, void *))implementation)(observer, selector, a[0], a[1], a[2], a[3], a[4], a[5]);
+                break;
+        }
+    }
+}
+
+typedef struct {
+    __unsafe_unretained NNMultiDispatchManager *manager;
+    unsigned selectorIndex;
+    void **arguments;
+} _NNMultiDispatchContext;
+
+static void _deliverContext(void *context)
+{
+    _NNMultiDispatchContext *dispatch = context;
+    _deliver(dispatch->manager, dispatch->selectorIndex, dispatch->arguments);
+}
+
+static void _dispatch(__unsafe_unretained NNMultiDispatchManager *self, SEL _cmd, void **arguments)
+{
+    unsigned selectorIndex = [self _indexOfSelector:_cmd];
+    NSCAssert(selectorIndex < self->_selectorCount, @"Selector %@ is not actually part of protocol %@?!", NSStringFromSelector(_cmd), NSStringFromProtocol(self.protocol));
+    NNMultiDispatchSelector *selector = &self->_selectors[selectorIndex];
+    
+    if (!selector->oneway) {
+        if (!self.enabled) {
+            return;
+        }
+        if ([NSThread isMainThread]) {
+            _deliver(self, selectorIndex, arguments);
+        } else {
+            _NNMultiDispatchContext context = { self, selectorIndex, arguments };
+            dispatch_sync_f(dispatch_get_main_queue(), &context, _deliverContext);
+        }
+        return;
+    }
+    
+    _enqueue(self, selectorIndex, arguments, nil);
+}
+
+static void _resolveImplementations(__unsafe_unretained NNMultiDispatchManager *self, __unsafe_unretained _NNMultiDispatchObserver *entry, __unsafe_unretained id observer)
+{
+    entry->_class = object_getClass(observer);
+    for (unsigned i = 0; i < self->_selectorCount; ++i) {
+        NNMultiDispatchSelector *selector = &self->_selectors[i];
+        if (selector->required || [observer respondsToSelector:selector->selector]) {
+            entry->_implementations[i] = class_getMethodImplementation(entry->_class, selector->selector);
+        } else {
+            entry->_implementations[i] = NULL;
+        }
+    }
+}
+
+#pragma mark Pending messages
+
+static NSUInteger _coalescingHash(unsigned selectorIndex, void *argument, NSUInteger mask)
+{
+    uintptr_t hash = ((uintptr_t)argument >> 4) ^ ((uintptr_t)argument >> 16) ^ (selectorIndex * 0x9e3779b9U);
+    return hash & mask;
+}
+
+// Must be called with the lock held. Returns the key's entry, or the empty entry where it would go.
+static _NNMultiDispatchCoalescingEntry *_coalescingEntry(__unsafe_unretained NNMultiDispatchManager *self, unsigned selectorIndex, void *argument)
+{
+    NSUInteger mask = self->_capacity * 2 - 1;
+    NSUInteger i = _coalescingHash(selectorIndex, argument, mask);
+    while (self->_coalescing[i].used && (self->_coalescing[i].selectorIndex != selectorIndex || self->_coalescing[i].argument != argument)) {
+        i = (i + 1) & mask;
+    }
+    return &self->_coalescing[i];
+}
+
+// Must be called with the lock held. Removes the entry by shifting the entries that probed past it back, so lookups never need tombstones.
+static void _removeCoalescingEntry(__unsafe_unretained NNMultiDispatchManager *self, _NNMultiDispatchCoalescingEntry *entry)
+{
+    NSUInteger mask = self->_capacity * 2 - 1;
+    NSUInteger hole = (NSUInteger)(entry - self->_coalescing);
+    NSUInteger i = hole;
+    while (YES) {
+        i = (i + 1) & mask;
+        _NNMultiDispatchCoalescingEntry *candidate = &self->_coalescing[i];
+        if (!candidate->used) {
+            break;
+        }
+        NSUInteger home = _coalescingHash(candidate->selectorIndex, candidate->argument, mask);
+        // The candidate can fill the hole unless its home lies cyclically in (hole, i].
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            self->_coalescing[hole] = *candidate;
+            hole = i;
+        }
+    }
+    self->_coalescing[hole].used = NO;
+}
+
+static void *_coalescingArgument(NNMultiDispatchSelector *selector, void **arguments)
+{
+    return selector->coalescingArgument == NSNotFound ? NULL : arguments[selector->coalescingArgument];
+}
+
+// Must be called with the lock held and the ring full. Doubles the ring and the coalescing table, which keep their contents.
+static void _grow(__unsafe_unretained NNMultiDispatchManager *self)
+{
+    NSUInteger oldCapacity = self->_capacity;
+    _NNMultiDispatchDelivery *oldDeliveries = self->_deliveries;
+    _NNMultiDispatchCoalescingEntry *oldCoalescing = self->_coalescing;
+    
+    self->_capacity = oldCapacity * 2;
+    self->_deliveries = calloc(self->_capacity, sizeof(_NNMultiDispatchDelivery));
+    self->_coalescing = calloc(self->_capacity * 2, sizeof(_NNMultiDispatchCoalescingEntry));
+    for (uint64_t sequence = self->_head; sequence < self->_tail; ++sequence) {
+        self->_deliveries[sequence & (self->_capacity - 1)] = oldDeliveries[sequence & (oldCapacity - 1)];
+    }
+    for (NSUInteger i = 0; i < oldCapacity * 2; ++i) {
+        if (oldCoalescing[i].used) {
+            *_coalescingEntry(self, oldCoalescing[i].selectorIndex, oldCoalescing[i].argument) = oldCoalescing[i];
+        }
+    }
+    
+    free(oldDeliveries);
+    free(oldCoalescing);
+}
+
+static void _drainDeliveries(void *context);
+
+// Queues a oneway message for delivery on the main queue. Either arguments are the trampolined message's arguments, or invocation is a copy of the forwarded message with its arguments retained.
+static void _enqueue(__unsafe_unretained NNMultiDispatchManager *self, unsigned selectorIndex, void **arguments, NSInvocation *invocation)
+{
+    NNMultiDispatchSelector *selector = &self->_selectors[selectorIndex];
+    
+    // Oneway messages are queued and delivered in batches, with one trip to the main queue for every message sent before the batch is delivered.
+    BOOL scheduleDrain = NO;
+    pthread_mutex_lock(&self->_lock);
+    if (self->_enabled) {
+        if (self->_tail - self->_head == self->_capacity) {
+            _grow(self);
+        }
+        uint64_t sequence = self->_tail++;
+        _NNMultiDispatchDelivery *delivery = &self->_deliveries[sequence & (self->_capacity - 1)];
+        delivery->selectorIndex = selectorIndex;
+        delivery->stale = NO;
+        delivery->invocation = NULL;
+        if (invocation) {
+            delivery->invocation = (__bridge_retained void *)invocation;
+        } else {
+            for (unsigned i = 0; i < selector->argumentCount; ++i) {
+                delivery->arguments[i] = arguments[i];
+                if ((selector->objectArguments & (1U << i)) && arguments[i]) {
+                    CFRetain(arguments[i]);
+                }
+            }
+            
+            if (selector->coalesced) {
+                // Objects are compared by identity, which is safe because pending deliveries keep their arguments alive.
+                _NNMultiDispatchCoalescingEntry *entry = _coalescingEntry(self, selectorIndex, _coalescingArgument(selector, arguments));
+                if (entry->used) {
+                    self->_deliveries[entry->sequence & (self->_capacity - 1)].stale = YES;
+                    ++self->_staleMessageCount;
+                } else {
+                    *entry = (_NNMultiDispatchCoalescingEntry){ .used = YES, .selectorIndex = selectorIndex, .argument = _coalescingArgument(selector, arguments) };
+                }
+                entry->sequence = sequence;
+            }
+        }
+        scheduleDrain = !self->_drainScheduled;
+        self->_drainScheduled = YES;
+    }
+    pthread_mutex_unlock(&self->_lock);
+    
+    if (scheduleDrain) {
+        // The pending batch holds a reference to the manager until it's drained.
+        dispatch_async_f(dispatch_get_main_queue(), (__bridge_retained void *)self, _drainDeliveries);
+    }
+}
+
+static void _drainDeliveries(void *context)
+{
+    NNMultiDispatchManager *self = (__bridge_transfer NNMultiDispatchManager *)context;
+    
+    pthread_mutex_lock(&self->_lock);
+    uint64_t end = self->_tail;
+    self->_drainScheduled = NO;
+    // Each message is copied out of the ring before it's delivered, so observers can send more messages (and grow the ring) while the batch is drained.
+    while (self->_head < end) {
+        uint64_t sequence = self->_head++;
+        _NNMultiDispatchDelivery delivery = self->_deliveries[sequence & (self->_capacity - 1)];
+        NNMultiDispatchSelector *selector = &self->_selectors[delivery.selectorIndex];
+        if (!delivery.invocation && selector->coalesced && !delivery.stale) {
+            _NNMultiDispatchCoalescingEntry *entry = _coalescingEntry(self, delivery.selectorIndex, _coalescingArgument(selector, delivery.arguments));
+            if (entry->used && entry->sequence == sequence) {
+                _removeCoalescingEntry(self, entry);
+            }
+        }
+        pthread_mutex_unlock(&self->_lock);
+        
+        if (delivery.invocation) {
+            NSInvocation *invocation = (__bridge_transfer NSInvocation *)delivery.invocation;
+            [self private_forwardInvocation:invocation];
+        } else {
+            if (!delivery.stale) {
+                _deliver(self, delivery.selectorIndex, delivery.arguments);
+            }
+            for (unsigned i = 0; i < selector->argumentCount; ++i) {
+                if ((selector->objectArguments & (1U << i)) && delivery.arguments[i]) {
+                    CFRelease(delivery.arguments[i]);
+                }
             }
         }
         
-        anInvocation.target = nil;
-        [anInvocation invoke];
+        pthread_mutex_lock(&self->_lock);
     }
+    pthread_mutex_unlock(&self->_lock);
 }
 
 #pragma mark Private
@@ -125,13 +567,21 @@
 - (void)_cacheMethodSignaturesForProcotol:(Protocol *)protocol;
 {
     @synchronized(self) {
+        // The manager answers <NSObject>'s messages, and anything else it implements, itself. Dispatching them to observers would turn every -release of the manager into a release of each observer.
+        BOOL dispatched = !protocol_isEqual(protocol, @protocol(NSObject));
+        
         unsigned int totalCount;
         for (uint8_t i = 0; i < 1 << 1; ++i) {
-            struct objc_method_description *methodDescriptions = nn_autofree(protocol_copyMethodDescriptionList(protocol, i & 1, YES, &totalCount));
+            BOOL required = i & 1;
+            struct objc_method_description *methodDescriptions = nn_autofree(protocol_copyMethodDescriptionList(protocol, required, YES, &totalCount));
             
             for (unsigned j = 0; j < totalCount; j++) {
                 struct objc_method_description *methodDescription = methodDescriptions + j;
-                [self.signatureCache setObject:[NSMethodSignature signatureWithObjCTypes:methodDescription->types] forKey:NSStringFromSelector(methodDescription->name)];
+                NSMethodSignature *signature = [NSMethodSignature signatureWithObjCTypes:methodDescription->types];
+                [self.signatureCache setObject:signature forKey:NSStringFromSelector(methodDescription->name)];
+                if (dispatched && ![NNMultiDispatchManager instancesRespondToSelector:methodDescription->name]) {
+                    [self _addSelector:methodDescription->name types:methodDescription->types signature:signature required:required];
+                }
             }
         }
         
@@ -143,23 +593,121 @@
     }
 }
 
+static const char *_typeSkippingQualifiers(const char *type)
+{
+    while (*type && strchr("rnNoORV", *type)) {
+        ++type;
+    }
+    return type;
+}
+
+- (void)_addSelector:(SEL)aSelector types:(const char *)types signature:(NSMethodSignature *)signature required:(BOOL)required;
+{
+    for (unsigned i = 0; i < self->_selectorCount; ++i) {
+        if (sel_isEqual(self->_selectors[i].selector, aSelector)) {
+            return;
+        }
+    }
+    
+    NNMultiDispatchSelector selector = {
+        .selector = aSelector,
+        .types = types,
+        .required = required,
+        .oneway = signature.isOneway,
+        .argumentCount = (unsigned)signature.numberOfArguments - 2,
+    };
+    
+    // Anything that isn't passed in a general-purpose register the same way a pointer is has to go through NSInvocation.
+    selector.trampolined = *_typeSkippingQualifiers(signature.methodReturnType) == 'v' && selector.argumentCount <= NNMultiDispatchMaxArguments;
+    for (unsigned i = 0; selector.trampolined && i < selector.argumentCount; ++i) {
+        const char *type = _typeSkippingQualifiers([signature getArgumentTypeAtIndex:i + 2]);
+        NSUInteger size = 0;
+        NSGetSizeAndAlignment(type, &size, NULL);
+        selector.trampolined = strchr("@#:^*qQlLiI", *type) && size == sizeof(void *);
+        if (*type == '@') {
+            selector.objectArguments |= 1U << i;
+        }
+    }
+    
+    self->_selectors = realloc(self->_selectors, (self->_selectorCount + 1) * sizeof(NNMultiDispatchSelector));
+    self->_selectors[self->_selectorCount++] = selector;
+}
+
+- (Class)_dispatchClass;
+{
+    Class superclass = object_getClass(self);
+    NSString *className = [NSString stringWithFormat:@"%@_%s", NSStringFromClass(superclass), protocol_getName(self.protocol)];
+    
+    @synchronized([NNMultiDispatchManager class]) {
+        Class dispatchClass = objc_getClass(className.UTF8String);
+        if (!dispatchClass) {
+            dispatchClass = objc_allocateClassPair(superclass, className.UTF8String, 0);
+            for (unsigned i = 0; i < self->_selectorCount; ++i) {
+                NNMultiDispatchSelector *selector = &self->_selectors[i];
+                if (selector->trampolined) {
+                    class_addMethod(dispatchClass, selector->selector, _trampolines[selector->argumentCount], selector->types);
+                }
+            }
+            objc_registerClassPair(dispatchClass);
+        }
+        return dispatchClass;
+    }
+}
+
+- (unsigned)_indexOfSelector:(SEL)aSelector;
+{
+    unsigned selectorIndex = 0;
+    while (selectorIndex < self->_selectorCount && !sel_isEqual(self->_selectors[selectorIndex].selector, aSelector)) {
+        ++selectorIndex;
+    }
+    return selectorIndex;
+}
+
+// Must be called with the lock held. Returns the index of the observer's entry plus one, or zero if it isn't an observer.
+- (NSUInteger)_indexOfObserver:(id)observer;
+{
+    NSUInteger index = 0;
+    for (_NNMultiDispatchObserver *entry in self->_observers) {
+        ++index;
+        if (entry->_observer == observer) {
+            return index;
+        }
+    }
+    return 0;
+}
+
+// Must be called with the lock held.
+- (NSArray *)_liveObservers;
+{
+    NSMutableArray *observers = [NSMutableArray arrayWithCapacity:self->_observers.count + 1];
+    for (_NNMultiDispatchObserver *entry in self->_observers) {
+        if (entry->_observer) {
+            [observers addObject:entry];
+        }
+    }
+    return observers;
+}
+
 - (void)private_forwardInvocation:(NSInvocation *)anInvocation;
 {
-    @synchronized(self) {
-        BOOL required = YES;
-        BOOL instance = YES;
-        BOOL sanity = nn_selector_belongsToProtocol(anInvocation.selector, self.protocol, &required, &instance);
+    BOOL required = YES;
+    BOOL instance = YES;
+    BOOL sanity = nn_selector_belongsToProtocol(anInvocation.selector, self.protocol, &required, &instance);
 
 #ifndef NS_BLOCK_ASSERTIONS
-        NSAssert(sanity && instance, @"Selector %@ is not actually part of protocol %@?!", NSStringFromSelector(anInvocation.selector), NSStringFromProtocol(self.protocol));
+    NSAssert(sanity && instance, @"Selector %@ is not actually part of protocol %@?!", NSStringFromSelector(anInvocation.selector), NSStringFromProtocol(self.protocol));
 #else
-        (void)sanity;
+    (void)sanity;
 #endif
 
-        for (id obj in self.observers) {
-            if ([obj respondsToSelector:anInvocation.selector] || required) {
-                [anInvocation invokeWithTarget:obj];
-            }
+    pthread_mutex_lock(&self->_lock);
+    NSArray *observers = self->_observers;
+    pthread_mutex_unlock(&self->_lock);
+    
+    for (_NNMultiDispatchObserver *entry in observers) {
+        id obj = entry->_observer;
+        if (obj && ([obj respondsToSelector:anInvocation.selector] || required)) {
+            [anInvocation invokeWithTarget:obj];
         }
     }
 }
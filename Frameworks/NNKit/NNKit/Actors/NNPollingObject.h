@@ -15,15 +15,36 @@
 #import <Foundation/Foundation.h>
 
 
+@class NNPollingScheduler;
+
+
 @interface NNPollingObject : NSObject
 
 + (NSString *)notificationName;
 
+// Changing the interval moves the next poll to the new interval after the last one, without waiting for the old deadline. Values less than or equal to zero stop polling once the object has been polled at least once.
 // I think this is the first time where I've wanted the default (atomic, assign, readwrite) flags for a property!
 // Too bad I have all warnings turned on:
 @property (atomic, assign, readwrite) NSTimeInterval interval;
 
+// Fraction of the interval by which each deadline is randomly moved earlier or later, so that objects started together don't keep polling in lockstep. Between 0.0 and 1.0, defaults to 0.0.
+@property (atomic, assign, readwrite) double jitter;
+
+// Relative importance of this object's polls when more are due than the scheduler can run at once. Defaults to 1.0.
+@property (atomic, assign, readwrite) double priority;
+
+// A suspended object keeps its interval and its standing with the scheduler, but is not polled until it is resumed. A poll that is already running finishes. Resuming polls the object at its next deadline, or right away if that passed while it was suspended.
+@property (atomic, assign, readwrite, getter=isSuspended) BOOL suspended;
+
+// Polls using the shared scheduler.
 - (instancetype)initWithQueue:(dispatch_queue_t)queue;
+// Polls are run on queue, unless the scheduler has a virtual clock, in which case they run on the thread advancing it.
+- (instancetype)initWithQueue:(dispatch_queue_t)queue scheduler:(NNPollingScheduler *)scheduler;
 - (void)main;
 
+// Polls as soon as possible, even if the object is suspended or its interval has run out. If a poll is already running, another follows it as soon as it finishes, and any further requests until then are coalesced into that one.
+- (void)pollNow;
+// Like -pollNow, but returns once the requested poll has finished. Notifications are posted synchronously on the main thread, so this must not be called from the main thread unless the scheduler has a virtual clock, in which case the poll runs on the calling thread.
+- (void)pollNowAndWait;
+
 @end
@@ -15,16 +15,20 @@
 #import "NNPollingObject.h"
 
 #import "despatch.h"
+#import "NNPollingScheduler+Private.h"
 
 
 @interface NNPollingObject ()
 
-@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (atomic, assign) BOOL postedNotification;
 
 @end
 
 
-@implementation NNPollingObject
+@implementation NNPollingObject {
+    NSTimeInterval _interval;
+    BOOL _suspended;
+}
 
 + (NSString *)notificationName;
 {
@@ -32,15 +36,20 @@
 }
 
 - (instancetype)initWithQueue:(dispatch_queue_t)queue;
+{
+    return [self initWithQueue:queue scheduler:[NNPollingScheduler sharedScheduler]];
+}
+
+- (instancetype)initWithQueue:(dispatch_queue_t)queue scheduler:(NNPollingScheduler *)scheduler;
 {
     self = [super init];
     if (!self) return nil;
     
     _queue = queue;
+    _scheduler = scheduler;
+    _priority = 1.0;
     
-    dispatch_async(_queue, ^{
-        [self workerLoop];
-    });
+    [scheduler addPollingObject:self];
     
     return self;
 }
@@ -50,26 +59,81 @@
     return [self initWithQueue:dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0)];
 }
 
-- (void)workerLoop;
+- (NSTimeInterval)interval;
 {
-    [self main];
+    @synchronized(self) {
+        return _interval;
+    }
+}
+
+- (void)setInterval:(NSTimeInterval)interval;
+{
+    @synchronized(self) {
+        if (_interval == interval) {
+            return;
+        }
+        _interval = interval;
+    }
+    
+    [self.scheduler retimePollingObject:self];
+}
+
+- (BOOL)isSuspended;
+{
+    @synchronized(self) {
+        return _suspended;
+    }
+}
+
+- (void)setSuspended:(BOOL)suspended;
+{
+    @synchronized(self) {
+        if (_suspended == suspended) {
+            return;
+        }
+        _suspended = suspended;
+    }
     
-    NSTimeInterval interval = self.interval;
-    if (interval <= 0.0) {
+    // The scheduler checks the current value under its own lock, so racing calls settle on whichever value was set last.
+    if (suspended) {
+        [self.scheduler suspendPollingObject:self];
+    } else {
+        [self.scheduler resumePollingObject:self];
+    }
+}
+
+- (void)pollNow;
+{
+    [self.scheduler pollObjectNow:self signal:nil];
+}
+
+- (void)pollNowAndWait;
+{
+    NNPollingScheduler *scheduler = self.scheduler;
+    if (!scheduler) {
+        return;
+    }
+    if (scheduler.virtual) {
+        [scheduler pollObjectNow:self signal:nil];
+        [scheduler advanceClockBy:0.0];
         return;
     }
     
-    __weak id weakSelf = self;
-    double delayInSeconds = interval;
-    dispatch_time_t popTime = dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delayInSeconds * NSEC_PER_SEC));
-    dispatch_after(popTime, self.queue, ^(void){
-        id self = weakSelf;
-        [self workerLoop];
-    });
+    dispatch_semaphore_t done = dispatch_semaphore_create(0);
+    [scheduler pollObjectNow:self signal:done];
+    dispatch_semaphore_wait(done, DISPATCH_TIME_FOREVER);
+}
+
+- (BOOL)poll;
+{
+    self.postedNotification = NO;
+    [self main];
+    return self.postedNotification;
 }
 
 - (void)postNotification:(NSDictionary *)userInfo;
 {
+    self.postedNotification = YES;
     despatch_sync_main_reentrant(^{
         [[NSNotificationCenter defaultCenter] postNotificationName:[[self class] notificationName] object:self userInfo:userInfo];
     });
@@ -1,9 +1,9 @@
 //
-//  _NNWeakSetEnumerator.h
+//  NNPollingScheduler+Private.h
 //  NNKit
 //
-//  Created by Scott Perry on 11/19/13.
-//  Copyright © 2013 Scott Perry.
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
 //
 //  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
 //
@@ -12,14 +12,29 @@
 //  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //
 
-#import <Foundation/Foundation.h>
+#import "NNPollingObject.h"
+#import "NNPollingScheduler.h"
 
 
-@class NNWeakSet;
+@interface NNPollingScheduler (Private)
 
+- (void)addPollingObject:(NNPollingObject *)object;
+- (void)suspendPollingObject:(NNPollingObject *)object;
+- (void)resumePollingObject:(NNPollingObject *)object;
+// Moves the object's pending deadline to match its current interval.
+- (void)retimePollingObject:(NNPollingObject *)object;
+// Signals semaphore, if any, once a poll that started after this call has finished, or once the object is gone.
+- (void)pollObjectNow:(NNPollingObject *)object signal:(dispatch_semaphore_t)semaphore;
 
-@interface _NNWeakSetEnumerator : NSEnumerator
+@end
+
+
+@interface NNPollingObject ()
+
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (nonatomic, weak, readonly) NNPollingScheduler *scheduler;
 
-- (instancetype)initWithWeakSet:(NNWeakSet *)set;
+// Runs -main, returning whether it posted a notification.
+- (BOOL)poll;
 
 @end
@@ -0,0 +1,83 @@
+//
+//  NNPollingScheduler.h
+//  NNKit
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+
+
+/*!
+ * @class NNPollingScheduler
+ *
+ * @discussion
+ * Runs the polls of many NNPollingObjects from a single timer.
+ *
+ * Pending polls are kept in a min-heap of deadlines. Polls that come due within
+ * <code>coalescingInterval</code> of each other run in the same wakeup, and no more
+ * than <code>maxConcurrentPolls</code> run at once. When more polls are due than
+ * can run, objects with a higher <code>priority</code> and objects that have
+ * recently posted notifications go first.
+ *
+ * A scheduler created with <code>-initWithVirtualClock</code> never runs anything
+ * on its own. Time only passes when <code>-advanceClockBy:</code> is called, and
+ * due polls run synchronously on the calling thread in the order the scheduler
+ * ranked them, which makes scheduling deterministic for tests and benchmarks.
+ * Jittered deadlines on a virtual clock are drawn from a fixed seed for the same reason.
+ *
+ * Each object's pending deadline can be moved in place, so suspending, re-timing
+ * and <code>-pollNow</code> take effect without waiting for the old deadline.
+ */
+@interface NNPollingScheduler : NSObject
+
+/*!
+ * @method sharedScheduler
+ *
+ * @discussion
+ * The scheduler used by polling objects created with <code>-initWithQueue:</code>.
+ * Its concurrency is limited to the number of active processors.
+ */
++ (instancetype)sharedScheduler;
+
+- (instancetype)initWithMaxConcurrentPolls:(NSUInteger)maxConcurrentPolls;
+
+/*!
+ * @method initWithVirtualClock
+ *
+ * @discussion
+ * Creates a scheduler whose clock starts at zero and only moves when advanced.
+ */
+- (instancetype)initWithVirtualClock;
+
+@property (nonatomic, readonly, assign) NSUInteger maxConcurrentPolls;
+@property (nonatomic, readonly, assign, getter=isVirtual) BOOL virtual;
+
+// Polls due within this interval of the earliest due poll are run in the same wakeup. Defaults to 5ms.
+@property (atomic, assign) NSTimeInterval coalescingInterval;
+
+// The scheduler's current time. Monotonic, in seconds.
+@property (atomic, readonly, assign) NSTimeInterval now;
+
+// Statistics, for tuning and benchmarks.
+@property (atomic, readonly, assign) NSUInteger wakeupCount;
+@property (atomic, readonly, assign) NSUInteger pollCount;
+
+/*!
+ * @method advanceClockBy:
+ *
+ * @discussion
+ * Moves a virtual clock forward, running every poll that comes due on the way.
+ * Polls due after the new time are left for later, even if they are within the
+ * coalescing interval of one that ran. Throws if the scheduler is not virtual.
+ */
+- (void)advanceClockBy:(NSTimeInterval)interval;
+
+@end
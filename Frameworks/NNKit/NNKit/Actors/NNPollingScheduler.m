@@ -0,0 +1,620 @@
+//
+//  NNPollingScheduler.m
+//  NNKit
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#import "NNPollingScheduler.h"
+
+#import "NNPollingScheduler+Private.h"
+
+
+// How much a single poll that posted a notification moves an object's change rate.
+static const double kNNChangeRateWeight = 0.25;
+
+// Jitter on a virtual clock is drawn from this seed, so that tests see the same deadlines every run.
+static const uint64_t kNNVirtualClockSeed = 0x9E3779B97F4A7C15ULL;
+
+
+typedef NS_ENUM(uint8_t, NNPollingEntryState) {
+    // On the heap, waiting for its deadline.
+    NNPollingEntryScheduled,
+    // Due, waiting for a free slot.
+    NNPollingEntryReady,
+    // Running on the object's queue.
+    NNPollingEntryPolling,
+    // The object is suspended. The deadline is kept for when it is resumed.
+    NNPollingEntryParked,
+    // The object's interval is not positive. Nothing is pending until it is re-timed or asked to poll.
+    NNPollingEntryIdle,
+};
+
+
+@interface _NNPollingScheduleEntry : NSObject
+
+@property (nonatomic, weak) NNPollingObject *object;
+@property (nonatomic, assign) NNPollingEntryState state;
+@property (nonatomic, assign) NSTimeInterval deadline;
+@property (nonatomic, assign) uint64_t sequence;
+@property (nonatomic, assign) NSUInteger heapIndex;
+// When the last poll finished. Meaningless until the entry has polled once.
+@property (nonatomic, assign) NSTimeInterval lastPoll;
+// The deadline is "as soon as possible" rather than derived from the interval, so changing the interval leaves it alone.
+@property (nonatomic, assign) BOOL pinned;
+// A poll was asked for with -pollNow and hasn't started yet. Requested polls run even if the object is suspended.
+@property (nonatomic, assign) BOOL requested;
+// Semaphores to signal when the next poll to start has finished, and those for the poll that is running.
+@property (nonatomic, strong) NSMutableArray *waiters;
+@property (nonatomic, strong) NSArray *pollingWaiters;
+// Exponentially weighted fraction of recent polls that posted a notification.
+@property (nonatomic, assign) double changeRate;
+@property (nonatomic, assign) double rank;
+
+@end
+
+
+@implementation _NNPollingScheduleEntry
+
+- (NSComparisonResult)compareDeadline:(_NNPollingScheduleEntry *)other;
+{
+    if (self.deadline != other.deadline) {
+        return self.deadline < other.deadline ? NSOrderedAscending : NSOrderedDescending;
+    }
+    return self.sequence < other.sequence ? NSOrderedAscending : NSOrderedDescending;
+}
+
+- (NSComparisonResult)compareRank:(_NNPollingScheduleEntry *)other;
+{
+    if (self.rank != other.rank) {
+        return self.rank > other.rank ? NSOrderedAscending : NSOrderedDescending;
+    }
+    return [self compareDeadline:other];
+}
+
+@end
+
+
+@interface NNPollingScheduler ()
+
+// Min-heap of pending polls, ordered by deadline. Each entry knows its index, so deadlines can be moved in place.
+@property (nonatomic, readonly, strong) NSMutableArray *heap;
+// Polls that are due but waiting for a free slot, ordered by rank.
+@property (nonatomic, readonly, strong) NSMutableArray *ready;
+// Every object's entry, whatever its state, by object.
+@property (nonatomic, readonly, strong) NSMapTable *entries;
+@property (nonatomic, assign) NSUInteger inFlight;
+@property (nonatomic, assign) uint64_t nextSequence;
+@property (atomic, readwrite, assign) NSUInteger wakeupCount;
+@property (atomic, readwrite, assign) NSUInteger pollCount;
+
+@property (nonatomic, readonly, strong) dispatch_queue_t queue;
+@property (nonatomic, readonly, strong) dispatch_source_t timer;
+@property (nonatomic, assign) NSTimeInterval armedDeadline;
+
+@end
+
+
+@implementation NNPollingScheduler {
+    NSTimeInterval _virtualNow;
+    uint64_t _randomState;
+}
+
++ (instancetype)sharedScheduler;
+{
+    static NNPollingScheduler *singleton;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        singleton = [[NNPollingScheduler alloc] initWithMaxConcurrentPolls:[[NSProcessInfo processInfo] activeProcessorCount]];
+    });
+    return singleton;
+}
+
+- (instancetype)initWithMaxConcurrentPolls:(NSUInteger)maxConcurrentPolls virtual:(BOOL)virtual;
+{
+    if (!(self = [super init])) { return nil; }
+    
+    _maxConcurrentPolls = MAX(maxConcurrentPolls, (NSUInteger)1);
+    _virtual = virtual;
+    _coalescingInterval = 0.005;
+    _heap = [NSMutableArray new];
+    _ready = [NSMutableArray new];
+    _entries = [NSMapTable weakToStrongObjectsMapTable];
+    _armedDeadline = INFINITY;
+    
+    if (virtual) {
+        _randomState = kNNVirtualClockSeed;
+    } else {
+        arc4random_buf(&_randomState, sizeof(_randomState));
+        // xorshift never leaves zero.
+        _randomState |= 1;
+        
+        _queue = dispatch_queue_create("NNPollingScheduler", DISPATCH_QUEUE_SERIAL);
+        _timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, _queue);
+        __weak NNPollingScheduler *weakSelf = self;
+        dispatch_source_set_event_handler(_timer, ^{
+            NNPollingScheduler *self = weakSelf;
+            [self private_wakeup];
+        });
+        dispatch_source_set_timer(_timer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+        dispatch_resume(_timer);
+    }
+    
+    return self;
+}
+
+- (instancetype)initWithMaxConcurrentPolls:(NSUInteger)maxConcurrentPolls;
+{
+    return [self initWithMaxConcurrentPolls:maxConcurrentPolls virtual:NO];
+}
+
+- (instancetype)initWithVirtualClock;
+{
+    return [self initWithMaxConcurrentPolls:[[NSProcessInfo processInfo] activeProcessorCount] virtual:YES];
+}
+
+- (instancetype)init;
+{
+    return [self initWithMaxConcurrentPolls:[[NSProcessInfo processInfo] activeProcessorCount]];
+}
+
+- (void)dealloc;
+{
+    if (_timer) {
+        dispatch_source_cancel(_timer);
+    }
+}
+
+#pragma mark NNPollingScheduler
+
+- (NSTimeInterval)now;
+{
+    if (self.virtual) {
+        @synchronized(self) {
+            return _virtualNow;
+        }
+    }
+    return [[NSProcessInfo processInfo] systemUptime];
+}
+
+- (void)advanceClockBy:(NSTimeInterval)interval;
+{
+    if (!self.virtual) {
+        @throw [NSException exceptionWithName:@"NNPollingSchedulerException" reason:@"Only a virtual clock can be advanced" userInfo:nil];
+    }
+    
+    NSTimeInterval target = self.now + MAX(interval, 0.0);
+    while (YES) {
+        NSArray *batch;
+        @synchronized(self) {
+            _NNPollingScheduleEntry *next = self.heap.firstObject;
+            if (!next || next.deadline > target) {
+                break;
+            }
+            _virtualNow = MAX(_virtualNow, next.deadline);
+            // Coalescing must not reach past the target, or polls that aren't due yet would run early.
+            [self private_collectPollsDueBy:MIN(_virtualNow + self.coalescingInterval, target)];
+            batch = [self.ready copy];
+            [self.ready removeAllObjects];
+        }
+        
+        // Polls take no time on a virtual clock, so concurrency never has to be limited; they run one after another in rank order.
+        for (_NNPollingScheduleEntry *entry in batch) {
+            NNPollingObject *object;
+            @synchronized(self) {
+                object = [self private_startEntry:entry];
+            }
+            if (!object) {
+                continue;
+            }
+            
+            BOOL changed = [object poll];
+            @synchronized(self) {
+                [self private_completeEntry:entry changed:changed];
+            }
+        }
+    }
+    
+    @synchronized(self) {
+        _virtualNow = target;
+    }
+}
+
+#pragma mark NNPollingScheduler (Private)
+
+- (void)addPollingObject:(NNPollingObject *)object;
+{
+    _NNPollingScheduleEntry *entry = [_NNPollingScheduleEntry new];
+    entry.object = object;
+    entry.pinned = YES;
+    entry.waiters = [NSMutableArray new];
+    
+    @synchronized(self) {
+        [self.entries setObject:entry forKey:object];
+        entry.deadline = self.now;
+        [self private_pushEntry:entry];
+        [self private_armTimer];
+    }
+}
+
+- (void)suspendPollingObject:(NNPollingObject *)object;
+{
+    @synchronized(self) {
+        _NNPollingScheduleEntry *entry = [self.entries objectForKey:object];
+        // The object may have been resumed since it called, so its current state is what counts.
+        // Polls that are due or running finish, and requested polls still happen. Either way the entry is parked once it is done.
+        if (!object.suspended || entry.state != NNPollingEntryScheduled || entry.requested) {
+            return;
+        }
+        
+        [self private_removeEntry:entry];
+        entry.state = NNPollingEntryParked;
+    }
+}
+
+- (void)resumePollingObject:(NNPollingObject *)object;
+{
+    @synchronized(self) {
+        _NNPollingScheduleEntry *entry = [self.entries objectForKey:object];
+        // The object may have been suspended again since it called.
+        if (object.suspended || entry.state != NNPollingEntryParked) {
+            // Never parked: the object was resumed while a poll was due or running.
+            return;
+        }
+        
+        // A deadline that is still ahead is kept. One that passed while suspended is due now.
+        NSTimeInterval now = self.now;
+        if (entry.deadline <= now) {
+            entry.deadline = now;
+            entry.pinned = YES;
+        }
+        [self private_pushEntry:entry];
+        [self private_armTimer];
+    }
+}
+
+- (void)retimePollingObject:(NNPollingObject *)object;
+{
+    @synchronized(self) {
+        _NNPollingScheduleEntry *entry = [self.entries objectForKey:object];
+        if (!entry || entry.pinned) {
+            return;
+        }
+        
+        NSTimeInterval interval = object.interval;
+        switch (entry.state) {
+            case NNPollingEntryScheduled:
+                if (interval > 0.0) {
+                    entry.deadline = entry.lastPoll + [self private_jitteredInterval:interval forObject:object];
+                    [self private_updateEntry:entry];
+                    [self private_armTimer];
+                } else {
+                    [self private_removeEntry:entry];
+                    entry.state = NNPollingEntryIdle;
+                }
+                break;
+                
+            case NNPollingEntryParked:
+                if (interval > 0.0) {
+                    entry.deadline = entry.lastPoll + [self private_jitteredInterval:interval forObject:object];
+                } else {
+                    entry.state = NNPollingEntryIdle;
+                }
+                break;
+                
+            case NNPollingEntryIdle:
+                if (interval > 0.0) {
+                    entry.deadline = entry.lastPoll + [self private_jitteredInterval:interval forObject:object];
+                    if (object.suspended) {
+                        entry.state = NNPollingEntryParked;
+                    } else {
+                        [self private_pushEntry:entry];
+                        [self private_armTimer];
+                    }
+                }
+                break;
+                
+            case NNPollingEntryReady:
+            case NNPollingEntryPolling:
+                // The new interval is picked up when the poll finishes.
+                break;
+        }
+    }
+}
+
+- (void)pollObjectNow:(NNPollingObject *)object signal:(dispatch_semaphore_t)semaphore;
+{
+    @synchronized(self) {
+        _NNPollingScheduleEntry *entry = [self.entries objectForKey:object];
+        if (!entry) {
+            if (semaphore) {
+                dispatch_semaphore_signal(semaphore);
+            }
+            return;
+        }
+        
+        if (semaphore) {
+            [entry.waiters addObject:semaphore];
+        }
+        entry.requested = YES;
+        
+        NSTimeInterval now = self.now;
+        switch (entry.state) {
+            case NNPollingEntryScheduled:
+                if (entry.deadline > now) {
+                    entry.deadline = now;
+                    [self private_updateEntry:entry];
+                    [self private_armTimer];
+                }
+                entry.pinned = YES;
+                break;
+                
+            case NNPollingEntryParked:
+            case NNPollingEntryIdle:
+                entry.deadline = now;
+                entry.pinned = YES;
+                [self private_pushEntry:entry];
+                [self private_armTimer];
+                break;
+                
+            case NNPollingEntryReady:
+                // About to start, which satisfies the request.
+                break;
+                
+            case NNPollingEntryPolling:
+                // The running poll may have read its state before the request was made, so another follows it. Further requests until then are coalesced into that one.
+                break;
+        }
+    }
+}
+
+#pragma mark Internal
+
+// All of the following must be called while synchronized on self.
+
+- (void)private_setEntry:(_NNPollingScheduleEntry *)entry atHeapIndex:(NSUInteger)index;
+{
+    self.heap[index] = entry;
+    entry.heapIndex = index;
+}
+
+- (void)private_siftUpEntry:(_NNPollingScheduleEntry *)entry;
+{
+    NSMutableArray *heap = self.heap;
+    NSUInteger index = entry.heapIndex;
+    while (index > 0) {
+        NSUInteger parent = (index - 1) / 2;
+        if ([heap[parent] compareDeadline:entry] != NSOrderedDescending) {
+            break;
+        }
+        [self private_setEntry:heap[parent] atHeapIndex:index];
+        index = parent;
+    }
+    [self private_setEntry:entry atHeapIndex:index];
+}
+
+- (void)private_siftDownEntry:(_NNPollingScheduleEntry *)entry;
+{
+    NSMutableArray *heap = self.heap;
+    NSUInteger count = heap.count;
+    NSUInteger index = entry.heapIndex;
+    while (YES) {
+        NSUInteger child = index * 2 + 1;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1 < count && [heap[child + 1] compareDeadline:heap[child]] == NSOrderedAscending) {
+            child++;
+        }
+        if ([heap[child] compareDeadline:entry] != NSOrderedAscending) {
+            break;
+        }
+        [self private_setEntry:heap[child] atHeapIndex:index];
+        index = child;
+    }
+    [self private_setEntry:entry atHeapIndex:index];
+}
+
+- (void)private_pushEntry:(_NNPollingScheduleEntry *)entry;
+{
+    entry.sequence = self.nextSequence++;
+    entry.state = NNPollingEntryScheduled;
+    entry.heapIndex = self.heap.count;
+    [self.heap addObject:entry];
+    [self private_siftUpEntry:entry];
+}
+
+// Restores the heap after an entry's deadline moved in either direction.
+- (void)private_updateEntry:(_NNPollingScheduleEntry *)entry;
+{
+    [self private_siftUpEntry:entry];
+    [self private_siftDownEntry:entry];
+}
+
+- (void)private_removeEntry:(_NNPollingScheduleEntry *)entry;
+{
+    NSMutableArray *heap = self.heap;
+    NSUInteger index = entry.heapIndex;
+    _NNPollingScheduleEntry *last = heap.lastObject;
+    [heap removeLastObject];
+    entry.heapIndex = NSNotFound;
+    
+    if (last != entry) {
+        [self private_setEntry:last atHeapIndex:index];
+        [self private_updateEntry:last];
+    }
+}
+
+- (NSTimeInterval)private_jitteredInterval:(NSTimeInterval)interval forObject:(NNPollingObject *)object;
+{
+    double jitter = MIN(MAX(object.jitter, 0.0), 1.0);
+    if (jitter == 0.0) {
+        return interval;
+    }
+    
+    // xorshift64*, which is plenty for spreading deadlines and cheap enough to run for every poll.
+    _randomState ^= _randomState >> 12;
+    _randomState ^= _randomState << 25;
+    _randomState ^= _randomState >> 27;
+    double unit = (double)((_randomState * 0x2545F4914F6CDD1DULL) >> 11) * 0x1.0p-53;
+    
+    return interval * (1.0 + jitter * (unit * 2.0 - 1.0));
+}
+
+// Called when an entry's object is gone. Nobody is left to poll, so anyone waiting for a poll is released.
+- (void)private_abandonEntry:(_NNPollingScheduleEntry *)entry;
+{
+    for (dispatch_semaphore_t semaphore in entry.waiters) {
+        dispatch_semaphore_signal(semaphore);
+    }
+    [entry.waiters removeAllObjects];
+}
+
+// Moves every poll due by horizon from the heap to the ready list.
+- (void)private_collectPollsDueBy:(NSTimeInterval)horizon;
+{
+    BOOL collected = NO;
+    while (self.heap.count && [self.heap.firstObject deadline] <= horizon) {
+        _NNPollingScheduleEntry *entry = self.heap.firstObject;
+        [self private_removeEntry:entry];
+        
+        NNPollingObject *object = entry.object;
+        if (!object) {
+            // The object is gone, and with it its place in the schedule.
+            [self private_abandonEntry:entry];
+            continue;
+        }
+        if (object.suspended && !entry.requested) {
+            entry.state = NNPollingEntryParked;
+            continue;
+        }
+        entry.state = NNPollingEntryReady;
+        entry.rank = object.priority * (1.0 + entry.changeRate);
+        [self.ready addObject:entry];
+        collected = YES;
+    }
+    
+    if (collected) {
+        self.wakeupCount++;
+        [self.ready sortUsingSelector:@selector(compareRank:)];
+    }
+}
+
+// Marks a ready entry as polling and returns its object, or nil if the object is gone.
+- (NNPollingObject *)private_startEntry:(_NNPollingScheduleEntry *)entry;
+{
+    NNPollingObject *object = entry.object;
+    if (!object) {
+        [self private_abandonEntry:entry];
+        return nil;
+    }
+    
+    entry.state = NNPollingEntryPolling;
+    entry.pinned = NO;
+    entry.requested = NO;
+    entry.pollingWaiters = [entry.waiters copy];
+    [entry.waiters removeAllObjects];
+    return object;
+}
+
+- (void)private_completeEntry:(_NNPollingScheduleEntry *)entry changed:(BOOL)changed;
+{
+    self.pollCount++;
+    entry.changeRate = entry.changeRate * (1.0 - kNNChangeRateWeight) + (changed ? kNNChangeRateWeight : 0.0);
+    
+    NSTimeInterval now = self.now;
+    entry.lastPoll = now;
+    for (dispatch_semaphore_t semaphore in entry.pollingWaiters) {
+        dispatch_semaphore_signal(semaphore);
+    }
+    entry.pollingWaiters = nil;
+    
+    NNPollingObject *object = entry.object;
+    if (!object) {
+        [self private_abandonEntry:entry];
+        return;
+    }
+    
+    if (entry.requested) {
+        entry.deadline = now;
+        entry.pinned = YES;
+        [self private_pushEntry:entry];
+        [self private_armTimer];
+        return;
+    }
+    
+    NSTimeInterval interval = object.interval;
+    if (interval <= 0.0) {
+        entry.state = NNPollingEntryIdle;
+        return;
+    }
+    
+    entry.deadline = now + [self private_jitteredInterval:interval forObject:object];
+    if (object.suspended) {
+        entry.state = NNPollingEntryParked;
+        return;
+    }
+    [self private_pushEntry:entry];
+    [self private_armTimer];
+}
+
+- (void)private_armTimer;
+{
+    if (self.virtual) {
+        return;
+    }
+    
+    _NNPollingScheduleEntry *next = self.heap.firstObject;
+    if (!next || next.deadline >= self.armedDeadline) {
+        return;
+    }
+    
+    self.armedDeadline = next.deadline;
+    NSTimeInterval delay = MAX(next.deadline - self.now, 0.0);
+    dispatch_source_set_timer(self.timer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), DISPATCH_TIME_FOREVER, (uint64_t)(self.coalescingInterval * NSEC_PER_SEC));
+}
+
+- (void)private_launchReadyPolls;
+{
+    while (self.inFlight < self.maxConcurrentPolls && self.ready.count) {
+        _NNPollingScheduleEntry *entry = self.ready.firstObject;
+        [self.ready removeObjectAtIndex:0];
+        
+        NNPollingObject *object = [self private_startEntry:entry];
+        if (!object) {
+            continue;
+        }
+        
+        self.inFlight++;
+        __weak NNPollingObject *weakObject = object;
+        dispatch_async(object.queue, ^{
+            NNPollingObject *object = weakObject;
+            BOOL changed = [object poll];
+            @synchronized(self) {
+                self.inFlight--;
+                [self private_completeEntry:entry changed:changed];
+                [self private_launchReadyPolls];
+            }
+        });
+    }
+}
+
+// Called on the scheduler's queue when the timer fires.
+- (void)private_wakeup;
+{
+    @synchronized(self) {
+        self.armedDeadline = INFINITY;
+        [self private_collectPollsDueBy:self.now + self.coalescingInterval];
+        [self private_launchReadyPolls];
+        [self private_armTimer];
+    }
+}
+
+@end
@@ -25,7 +25,10 @@
  * references to its members.
  *
  * No compaction is required, members are automatically removed when they are
- * deallocated.
+ * deallocated. Members are kept in a fixed number of separately locked hash
+ * tables, so threads working with different members rarely contend.
+ * Enumeration works on a snapshot of the members, so the set can be mutated
+ * while it is being enumerated.
  *
  * This collection type may be slower than NSHashTable, but it also has
  * fewer bugs.
@@ -14,28 +14,209 @@
 
 #import "NNWeakSet.h"
 
-#import "_NNWeakArrayTombstone.h"
-#import "_NNWeakSetEnumerator.h"
-#import "NNCleanupProxy.h"
+#import <objc/runtime.h>
+#import <pthread.h>
 
 
-@interface NNWeakSet ()
+// Members are spread over independently locked tables by hash, so threads working with different members rarely wait on each other.
+#define NNWeakSetShardBits 4
+#define NNWeakSetShardCount (1 << NNWeakSetShardBits)
 
-@property (nonatomic, readonly, strong) NSMutableSet *backingStore;
 
-- (void)_removeObjectAllowingNil:(id)object;
+typedef NS_ENUM(uint8_t, NNWeakSetSlotState) {
+    NNWeakSetSlotEmpty = 0,
+    NNWeakSetSlotOccupied,
+    // Left behind by a removed or deallocated member so probing continues past it. Reused by insertions.
+    NNWeakSetSlotDeleted,
+};
+
+typedef struct {
+    NNWeakSetSlotState state;
+    // The member's hash, kept for rehashing after it may have been deallocated.
+    NSUInteger hash;
+    // A weak reference, only accessed through objc_loadWeak and objc_storeWeak. Reads as nil once the member has been deallocated.
+    __unsafe_unretained id target;
+} NNWeakSetSlot;
+
+typedef struct {
+    pthread_mutex_t lock;
+    // Open-addressed with linear probing. capacity is zero or a power of two.
+    NNWeakSetSlot *slots;
+    NSUInteger capacity;
+    // Occupied slots, including those whose member has been deallocated but not yet swept.
+    NSUInteger occupied;
+    NSUInteger deleted;
+} NNWeakSetShard;
+
+
+static __autoreleasing id *_slotTarget(NNWeakSetSlot *slot)
+{
+    return (__autoreleasing id *)(void *)&slot->target;
+}
+
+static NSUInteger _mixHash(NSUInteger hash)
+{
+    // Object hashes are often addresses, whose low bits are all alike. The shard comes from the high bits of the mixed hash and the probe position from the low bits.
+#if __LP64__
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+#else
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bU;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35U;
+    hash ^= hash >> 16;
+#endif
+    return hash;
+}
+
+static NNWeakSetShard *_shardForHash(NNWeakSetShard *shards, NSUInteger hash)
+{
+    return &shards[_mixHash(hash) >> (sizeof(NSUInteger) * 8 - NNWeakSetShardBits)];
+}
+
+// Returns the member in the slot, or nil after marking the slot deleted if its member has been deallocated.
+static id _loadSlot(NNWeakSetShard *shard, NNWeakSetSlot *slot)
+{
+    id target = objc_loadWeak(_slotTarget(slot));
+    if (!target) {
+        objc_storeWeak(_slotTarget(slot), nil);
+        slot->state = NNWeakSetSlotDeleted;
+        shard->occupied--;
+        shard->deleted++;
+    }
+    return target;
+}
+
+// Must be called with the shard locked. Returns the slot holding object itself, or NULL. Members that have the same hash but aren't object or in checked are added to candidates, to be compared by the caller once the lock has been released. If insertion is not NULL, it is set to the slot where object should be inserted if it isn't a member.
+static NNWeakSetSlot *_findSlot(NNWeakSetShard *shard, id object, NSUInteger hash, NSArray *checked, NSMutableArray **candidates, NNWeakSetSlot **insertion)
+{
+    if (insertion) { *insertion = NULL; }
+    if (!shard->capacity) { return NULL; }
+    
+    NSUInteger mask = shard->capacity - 1;
+    for (NSUInteger i = _mixHash(hash) & mask, probes = 0; probes < shard->capacity; i = (i + 1) & mask, ++probes) {
+        NNWeakSetSlot *slot = &shard->slots[i];
+        if (slot->state == NNWeakSetSlotOccupied && slot->hash == hash) {
+            id target = _loadSlot(shard, slot);
+            if (target == object) {
+                return slot;
+            }
+            if (target && (!checked || [checked indexOfObjectIdenticalTo:target] == NSNotFound)) {
+                if (!*candidates) { *candidates = [NSMutableArray new]; }
+                [*candidates addObject:target];
+            }
+        }
+        if (slot->state == NNWeakSetSlotEmpty) {
+            if (insertion && !*insertion) { *insertion = slot; }
+            return NULL;
+        }
+        if (slot->state == NNWeakSetSlotDeleted && insertion && !*insertion) {
+            *insertion = slot;
+        }
+    }
+    return NULL;
+}
+
+// Locks the shard and returns with it still locked. Returns the slot holding the member equal to object, setting member to it, or NULL if there isn't one. If insertion is not NULL, it is set as for _findSlot.
+static NNWeakSetSlot *_lockAndFindSlot(NNWeakSetShard *shard, id object, NSUInteger hash, id *member, NNWeakSetSlot **insertion)
+{
+    // -isEqual: can run arbitrary code, including code that uses the set, so it is only called with the lock released. Each pass looks for the member found equal so far by identity and collects any other members with the same hash that haven't been compared yet, which may have been added while the lock was released.
+    id probe = object;
+    NSMutableArray *checked = nil;
+    pthread_mutex_lock(&shard->lock);
+    while (YES) {
+        NSMutableArray *candidates = nil;
+        NNWeakSetSlot *slot = _findSlot(shard, probe, hash, checked, &candidates, insertion);
+        if (slot) {
+            if (member) { *member = probe; }
+            return slot;
+        }
+        if (!candidates) {
+            return NULL;
+        }
+        pthread_mutex_unlock(&shard->lock);
+        
+        for (id candidate in candidates) {
+            if ([candidate isEqual:object]) {
+                probe = candidate;
+                break;
+            }
+        }
+        if (!checked) { checked = [NSMutableArray new]; }
+        [checked addObjectsFromArray:candidates];
+        
+        pthread_mutex_lock(&shard->lock);
+    }
+}
+
+static void _resizeShard(NNWeakSetShard *shard, NSUInteger minimumCapacity)
+{
+    NSUInteger capacity = 8;
+    while (capacity < minimumCapacity * 2) {
+        capacity *= 2;
+    }
+    
+    NNWeakSetSlot *oldSlots = shard->slots;
+    NSUInteger oldCapacity = shard->capacity;
+    shard->slots = calloc(capacity, sizeof(NNWeakSetSlot));
+    shard->capacity = capacity;
+    shard->occupied = 0;
+    shard->deleted = 0;
+    
+    // Weak references are registered by address with the runtime, so each one has to be stored anew rather than copied.
+    for (NSUInteger i = 0; i < oldCapacity; ++i) {
+        NNWeakSetSlot *oldSlot = &oldSlots[i];
+        if (oldSlot->state != NNWeakSetSlotOccupied) { continue; }
+        
+        id target = objc_loadWeak(_slotTarget(oldSlot));
+        objc_storeWeak(_slotTarget(oldSlot), nil);
+        if (!target) { continue; }
+        
+        NSUInteger mask = capacity - 1;
+        NSUInteger j = _mixHash(oldSlot->hash) & mask;
+        while (shard->slots[j].state != NNWeakSetSlotEmpty) {
+            j = (j + 1) & mask;
+        }
+        shard->slots[j].state = NNWeakSetSlotOccupied;
+        shard->slots[j].hash = oldSlot->hash;
+        objc_storeWeak(_slotTarget(&shard->slots[j]), target);
+        shard->occupied++;
+    }
+    
+    free(oldSlots);
+}
+
+// Calls block with each live member of the shard, sweeping the slots of deallocated members as it goes.
+static void _enumerateShard(NNWeakSetShard *shard, void (^block)(id target))
+{
+    for (NSUInteger i = 0; i < shard->capacity; ++i) {
+        NNWeakSetSlot *slot = &shard->slots[i];
+        if (slot->state != NNWeakSetSlotOccupied) { continue; }
+        
+        id target = _loadSlot(shard, slot);
+        if (target) {
+            block(target);
+        }
+    }
+}
+
+
+@interface NNWeakSet () {
+    NNWeakSetShard _shards[NNWeakSetShardCount];
+}
 
 @end
 
 
 /**
  
- collection -> tombstone                    // Unavoidable. The whole point of this exercise.
- tombstone -> object [style = "dotted"];    // Obvious.
- cleanup -> tombstone [style = "dotted"];   // For removing the tombstone from the collection.
- cleanup -> collection [style = "dotted"];  // For removing the tombstone from the collection.
- object -> cleanup;                         // Object association, the only strong reference to the proxy.
- object -> tombstone [style = "dotted];     // Object association so the collection can look at the object and find the tombstone.
+ collection -> shard                        // One of a fixed number, chosen by the member's hash.
+ shard -> slot                              // Open addressing, no allocation per member.
+ slot -> object [style = "dotted"];         // Weak reference, swept lazily once the object is deallocated.
  
  */
 
@@ -46,7 +227,7 @@
 {
     if (!(self = [super init])) { return nil; }
     
-    self->_backingStore = [[NSMutableSet alloc] initWithCapacity:numItems];
+    [self _initShardsWithCapacity:numItems];
     
     return self;
 }
@@ -55,70 +236,149 @@
 {
     if (!(self = [super init])) { return nil; }
     
-    self->_backingStore = [NSMutableSet new];
+    [self _initShardsWithCapacity:0];
     
     return self;
 }
 
+- (void)dealloc;
+{
+    for (unsigned i = 0; i < NNWeakSetShardCount; ++i) {
+        NNWeakSetShard *shard = &self->_shards[i];
+        for (NSUInteger j = 0; j < shard->capacity; ++j) {
+            if (shard->slots[j].state == NNWeakSetSlotOccupied) {
+                objc_storeWeak(_slotTarget(&shard->slots[j]), nil);
+            }
+        }
+        free(shard->slots);
+        pthread_mutex_destroy(&shard->lock);
+    }
+}
+
 #pragma mark NSSet
 
 - (NSUInteger)count;
 {
-    @synchronized(self.backingStore) {
-        return self.backingStore.count;
+    __block NSUInteger count = 0;
+    for (unsigned i = 0; i < NNWeakSetShardCount; ++i) {
+        NNWeakSetShard *shard = &self->_shards[i];
+        pthread_mutex_lock(&shard->lock);
+        _enumerateShard(shard, ^(id target) {
+            count++;
+        });
+        pthread_mutex_unlock(&shard->lock);
     }
+    return count;
 }
 
 - (id)member:(id)object;
 {
-    @synchronized(self.backingStore) {
-        return ((_NNWeakArrayTombstone *)[self.backingStore member:object]).target;
-    }
+    if (!object) { return nil; }
+    
+    NSUInteger hash = [object hash];
+    NNWeakSetShard *shard = _shardForHash(self->_shards, hash);
+    id member = nil;
+    _lockAndFindSlot(shard, object, hash, &member, NULL);
+    pthread_mutex_unlock(&shard->lock);
+    return member;
 }
 
 - (NSEnumerator *)objectEnumerator;
 {
-    @synchronized(self.backingStore) {
-        return [[_NNWeakSetEnumerator alloc] initWithWeakSet:self];
+    return [[self _liveObjects] objectEnumerator];
+}
+
+- (NSArray *)allObjects;
+{
+    return [self _liveObjects];
+}
+
+- (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state objects:(id __unsafe_unretained [])buffer count:(NSUInteger)len;
+{
+    if (state->state == 0) {
+        // The members are enumerated from a snapshot, which is autoreleased so that it lives as long as the enumeration does.
+        __autoreleasing NSArray *snapshot = [self _liveObjects];
+        state->extra[0] = (unsigned long)(__bridge void *)snapshot;
+        state->mutationsPtr = &state->extra[1];
+        state->state = 1;
     }
+    
+    NSArray *snapshot = (__bridge NSArray *)(void *)state->extra[0];
+    NSUInteger index = state->state - 1;
+    NSUInteger count = MIN(len, snapshot.count - index);
+    [snapshot getObjects:buffer range:NSMakeRange(index, count)];
+    state->itemsPtr = buffer;
+    state->state += count;
+    return count;
 }
 
 #pragma mark NSMutableSet
 
 - (void)addObject:(id)object;
 {
-    _NNWeakArrayTombstone *tombstone = [_NNWeakArrayTombstone tombstoneWithTarget:object];
-    NNCleanupProxy *proxy = [NNCleanupProxy cleanupProxyForTarget:object withKey:(uintptr_t)self];
-    
-    __weak NNWeakSet *weakCollection = self;
-    __weak _NNWeakArrayTombstone *weakTombstone = tombstone;
-    proxy.cleanupBlock = ^{
-        NNWeakSet *collection = weakCollection;
-        [collection _removeObjectAllowingNil:weakTombstone];
-    };
+    NSParameterAssert(object);
     
-    @synchronized(self.backingStore) {
-        [self.backingStore addObject:tombstone];
+    NSUInteger hash = [object hash];
+    NNWeakSetShard *shard = _shardForHash(self->_shards, hash);
+    NNWeakSetSlot *slot;
+    if (!_lockAndFindSlot(shard, object, hash, NULL, &slot)) {
+        // Keep the table at most three quarters full, counting deleted slots since they lengthen probes too.
+        if (!slot || (slot->state == NNWeakSetSlotEmpty && (shard->occupied + shard->deleted + 1) * 4 > shard->capacity * 3)) {
+            _resizeShard(shard, shard->occupied + 1);
+            NSMutableArray *candidates = nil;
+            _findSlot(shard, object, hash, nil, &candidates, &slot);
+        }
+        if (slot->state == NNWeakSetSlotDeleted) {
+            shard->deleted--;
+        }
+        slot->state = NNWeakSetSlotOccupied;
+        slot->hash = hash;
+        objc_storeWeak(_slotTarget(slot), object);
+        shard->occupied++;
     }
+    pthread_mutex_unlock(&shard->lock);
 }
 
 - (void)removeObject:(id)object;
 {
-    [NNCleanupProxy cancelCleanupForTarget:object withKey:(uintptr_t)self];
-    @synchronized(self.backingStore) {
-        [self.backingStore removeObject:object];
+    if (!object) { return; }
+    
+    NSUInteger hash = [object hash];
+    NNWeakSetShard *shard = _shardForHash(self->_shards, hash);
+    NNWeakSetSlot *slot = _lockAndFindSlot(shard, object, hash, NULL, NULL);
+    if (slot) {
+        objc_storeWeak(_slotTarget(slot), nil);
+        slot->state = NNWeakSetSlotDeleted;
+        shard->occupied--;
+        shard->deleted++;
     }
+    pthread_mutex_unlock(&shard->lock);
 }
 
 #pragma mark Private
 
-- (void)_removeObjectAllowingNil:(id)object;
+- (void)_initShardsWithCapacity:(NSUInteger)numItems;
 {
-    if (!object) { return; }
-    
-    @synchronized(self.backingStore) {
-        [self.backingStore removeObject:object];
+    for (unsigned i = 0; i < NNWeakSetShardCount; ++i) {
+        pthread_mutex_init(&self->_shards[i].lock, NULL);
+        if (numItems) {
+            _resizeShard(&self->_shards[i], numItems / NNWeakSetShardCount + 1);
+        }
     }
 }
 
-@end
\ No newline at end of file
+- (NSArray *)_liveObjects;
+{
+    NSMutableArray *objects = [NSMutableArray new];
+    for (unsigned i = 0; i < NNWeakSetShardCount; ++i) {
+        NNWeakSetShard *shard = &self->_shards[i];
+        pthread_mutex_lock(&shard->lock);
+        _enumerateShard(shard, ^(id target) {
+            [objects addObject:target];
+        });
+        pthread_mutex_unlock(&shard->lock);
+    }
+    return objects;
+}
+
+@end
@@ -25,6 +25,7 @@
 #import <NNKit/NNDelegateProxy.h>
 #import <NNKit/NNMultiDispatchManager.h>
 #import <NNKit/NNPollingObject.h>
+#import <NNKit/NNPollingScheduler.h>
 #import <NNKit/NNSelfInvalidatingObject.h>
 #import <NNKit/NNService.h>
 #import <NNKit/NNServiceManager.h>
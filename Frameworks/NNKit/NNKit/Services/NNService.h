@@ -78,6 +78,17 @@ typedef NS_ENUM(uint8_t, NNServiceType) {
  */
 + (Protocol *)subscriberProtocol;
 
+/*!
+ * @method startsConcurrently
+ *
+ * @discussion
+ * Services that return YES have <code>startService</code> called on a
+ * background queue, at the same time as other such services whose dependencies
+ * have all started. Their <code>startService</code> must be thread-safe and
+ * must not wait on the main thread. Default implementation returns NO.
+ */
++ (BOOL)startsConcurrently;
+
 /*!
  * @method startService
  *
@@ -64,6 +64,11 @@
     return @protocol(NSObject);
 }
 
++ (BOOL)startsConcurrently;
+{
+    return NO;
+}
+
 - (id)init;
 {
     if (!(self = [super init])) { return nil; }
@@ -75,7 +80,7 @@
 
 - (void)startService;
 {
-    NSAssert([[NSThread currentThread] isMainThread], @"Service must be started on the main thread");
+    NSAssert([[NSThread currentThread] isMainThread] || [self.class startsConcurrently], @"Service must be started on the main thread");
 }
 
 - (void)stopService;
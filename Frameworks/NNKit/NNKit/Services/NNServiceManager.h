@@ -56,6 +56,20 @@
  */
 - (void)registerService:(Class)service;
 
+/*!
+ * @method registerServices:
+ *
+ * @discussion
+ * Registers each of <i>services</i> with the service manager, then starts the
+ * ones whose dependencies have all been met. Services are started in dependency
+ * order, and services that start concurrently are started in parallel once their
+ * dependencies have started.
+ *
+ * @param services
+ * A set of service Classes to be registered with this service manager.
+ */
+- (void)registerServices:(NSSet *)services;
+
 /*!
  * @method instanceForService
  *
@@ -69,6 +83,18 @@
  */
 - (NNService *)instanceForService:(Class)service;
 
+/*!
+ * @method serviceStartLatencies
+ *
+ * @discussion
+ * How long each service took to start, for a report of startup costs.
+ *
+ * @result
+ * A dictionary mapping the Class of each service that has been started to the
+ * duration of its most recent <code>startService</code>, in seconds.
+ */
+- (NSDictionary *)serviceStartLatencies;
+
 /*!
  * @method addObserver:forService:
  *
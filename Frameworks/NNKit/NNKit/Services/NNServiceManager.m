@@ -42,8 +42,12 @@ static BOOL _serviceIsValid(Class service)
 @property (nonatomic, strong, readonly) NNService *instance;
 @property (nonatomic, strong, readonly) NSSet *dependencies;
 @property (nonatomic, strong, readonly) Protocol *subscriberProtocol;
+@property (nonatomic, assign, readonly) BOOL startsConcurrently;
+// Duration of the most recent -startService, or zero if the service has never been started.
+@property (nonatomic, assign, readonly) NSTimeInterval startLatency;
 
 - (instancetype)initWithService:(Class)service;
+- (void)startInstance;
 
 @end
 
@@ -61,10 +65,18 @@ static BOOL _serviceIsValid(Class service)
     self->_type = [service serviceType];
     self->_dependencies = [service dependencies] ?: [NSSet set];
     self->_subscriberProtocol = [service subscriberProtocol] ?: @protocol(NSObject);
+    self->_startsConcurrently = [service startsConcurrently];
 
     return self;
 }
 
+- (void)startInstance;
+{
+    NSDate *start = [NSDate date];
+    [self.instance startService];
+    self->_startLatency = -[start timeIntervalSinceNow];
+}
+
 @end
 
 
@@ -80,6 +92,9 @@ static BOOL _serviceIsValid(Class service)
 // Class => NSMutableSet<Class>
 @property (nonatomic, strong) NSMutableDictionary *dependantServices;
 
+// Class. Non-nil while services are being started, collecting the services asked for in the meantime.
+@property (nonatomic, strong) NSMutableSet *deferredServices;
+
 @end
 
 
@@ -122,11 +137,14 @@ static BOOL _serviceIsValid(Class service)
     Class *buffer = (__unsafe_unretained Class *)nn_autofree(malloc(numClasses * sizeof(Class *)));
     (void)objc_getClassList(buffer, numClasses);
     
+    NSMutableSet *services = [NSMutableSet new];
     for (size_t i = 0; i < numClasses; ++i) {
         if (classIsService(buffer[i])) {
-            [self registerService:buffer[i]];
+            [services addObject:buffer[i]];
         }
     }
+    
+    [self registerServices:services];
 }
 
 - (instancetype)init;
@@ -165,6 +183,9 @@ static BOOL _serviceIsValid(Class service)
     NSMutableString *result = [NSMutableString stringWithFormat:@"<%@: %p>, services:", NSStringFromClass([self class]), self];
     for (Class service in self->_lookup) {
         [result appendFormat:@"\n\t%@: %@", ([self->_runningServices containsObject:service] ? @"running" : @"stopped"), service];
+        if (SERVICEINFO(service).startLatency) {
+            [result appendFormat:@" (started in %.1fms)", SERVICEINFO(service).startLatency * 1000.0];
+        }
     }
     return result;
 }
@@ -172,35 +193,20 @@ static BOOL _serviceIsValid(Class service)
 #pragma mark - NNServiceManager
 
 - (void)registerService:(Class)service;
+{
+    [self registerServices:[NSSet setWithObject:service]];
+}
+
+- (void)registerServices:(NSSet *)services;
 {
     NSAssert([NSThread isMainThread], @"Boundary call was not made on main thread");
     
-    NSParameterAssert(_serviceIsValid(service));
-    if (SERVICEINFO(service)) {
-        return;
+    for (Class service in services) {
+        [self _registerService:service];
     }
     
-    _NNServiceInfo *info = [[_NNServiceInfo alloc] initWithService:service];
-    
-    @synchronized([NNServiceManager class]) {
-        if ([claimedServices containsObject:service]) {
-            @throw [NSException exceptionWithName:NSInternalInconsistencyException reason:[NSString stringWithFormat:@"Service %@ already being managed", NSStringFromClass(service)] userInfo:nil];
-        }
-        [claimedServices addObject:service];
-    }
-    
-    self.lookup[service] = info;
-
-    for (Class dependency in info.dependencies) {
-        NSMutableSet *deps = self.dependantServices[dependency];
-        if (!deps) {
-            self.dependantServices[dependency] = deps = [NSMutableSet new];
-        }
-
-        [deps addObject:service];
-    }
-
-    [self _startServiceIfReady:service];
+    // Nothing is started until every service is registered, so the whole dependency graph is known when startup is planned.
+    [self _startServicesIfReady:services];
 }
 
 - (NNService *)instanceForService:(Class)service;
@@ -211,6 +217,19 @@ static BOOL _serviceIsValid(Class service)
     return SERVICEINFO(service).instance;
 }
 
+- (NSDictionary *)serviceStartLatencies;
+{
+    NSAssert([NSThread isMainThread], @"Boundary call was not made on main thread");
+    
+    NSMutableDictionary *result = [NSMutableDictionary new];
+    for (Class service in self.lookup) {
+        if (SERVICEINFO(service).startLatency) {
+            result[service] = @(SERVICEINFO(service).startLatency);
+        }
+    }
+    return result;
+}
+
 - (void)addObserver:(id)observer forService:(Class)service;
 {
     NSAssert([NSThread isMainThread], @"Boundary call was not made on main thread");
@@ -253,7 +272,7 @@ static BOOL _serviceIsValid(Class service)
         [self _stopServiceIfDone:service];
     }); } withKey:((uintptr_t)service ^ (uintptr_t)self)];
     
-    [self _startServiceIfReady:service];
+    [self _startServicesIfReady:[NSSet setWithObject:service]];
 }
 
 - (void)removeSubscriber:(id)subscriber forService:(Class)service;
@@ -273,21 +292,144 @@ static BOOL _serviceIsValid(Class service)
 
 #pragma mark Private
 
-- (void)_startServiceIfReady:(Class)service;
+- (void)_registerService:(Class)service;
 {
-    if ([self.runningServices containsObject:service]) {
+    NSParameterAssert(_serviceIsValid(service));
+    if (SERVICEINFO(service)) {
         return;
     }
     
-    if (SERVICEINFO(service).type == NNServiceTypeOnDemand && SERVICEINFO(service).subscribers.count == 0) {
-        return;
+    _NNServiceInfo *info = [[_NNServiceInfo alloc] initWithService:service];
+    
+    @synchronized([NNServiceManager class]) {
+        if ([claimedServices containsObject:service]) {
+            @throw [NSException exceptionWithName:NSInternalInconsistencyException reason:[NSString stringWithFormat:@"Service %@ already being managed", NSStringFromClass(service)] userInfo:nil];
+        }
+        [claimedServices addObject:service];
     }
     
-    if (![SERVICEINFO(service).dependencies isSubsetOfSet:self.runningServices]) {
+    self.lookup[service] = info;
+
+    for (Class dependency in info.dependencies) {
+        NSMutableSet *deps = self.dependantServices[dependency];
+        if (!deps) {
+            self.dependantServices[dependency] = deps = [NSMutableSet new];
+        }
+
+        [deps addObject:service];
+    }
+}
+
+- (BOOL)_serviceIsWanted:(Class)service;
+{
+    return SERVICEINFO(service).type != NNServiceTypeOnDemand || SERVICEINFO(service).subscribers.count > 0;
+}
+
+- (void)_startServicesIfReady:(NSSet *)services;
+{
+    // Starting a service can land back here, for example when it subscribes to another service. A nested pass could start a service that the outer pass has already planned to start, so those requests wait for the outer pass to finish and are planned afresh.
+    if (self.deferredServices) {
+        [self.deferredServices unionSet:services];
         return;
     }
+    
+    self.deferredServices = [services mutableCopy];
+    while (self.deferredServices.count) {
+        NSSet *batch = self.deferredServices;
+        self.deferredServices = [NSMutableSet new];
+        [self _startServices:batch];
+    }
+    self.deferredServices = nil;
+}
 
-    [self _startService:service];
+- (void)_startServices:(NSSet *)services;
+{
+    // Anything that could start now: the services themselves, and transitively the services that depend on them.
+    NSMutableSet *candidates = [NSMutableSet new];
+    NSMutableArray *unvisited = [services.allObjects mutableCopy];
+    while (unvisited.count) {
+        Class service = unvisited.lastObject;
+        [unvisited removeLastObject];
+        if ([candidates containsObject:service] || [self.runningServices containsObject:service] || !SERVICEINFO(service) || ![self _serviceIsWanted:service]) {
+            continue;
+        }
+        
+        [candidates addObject:service];
+        [unvisited addObjectsFromArray:[self.dependantServices[service] allObjects]];
+    }
+    
+    // Topological sort: each candidate waits for its dependencies that aren't running yet, and is ready once they have all started. Candidates with a dependency that can't start now never become ready.
+    // Class => NSMutableSet<Class>
+    NSMutableDictionary *waiting = [NSMutableDictionary new];
+    NSMutableArray *ready = [NSMutableArray new];
+    for (Class service in candidates) {
+        NSMutableSet *dependencies = [SERVICEINFO(service).dependencies mutableCopy];
+        [dependencies minusSet:self.runningServices];
+        if (dependencies.count) {
+            waiting[service] = dependencies;
+        } else {
+            [ready addObject:service];
+        }
+    }
+    
+    dispatch_semaphore_t finished = dispatch_semaphore_create(0);
+    NSMutableArray *finishedServices = [NSMutableArray new];
+    NSUInteger startingServices = 0;
+    
+    while (ready.count || startingServices) {
+        // Collect the services that have finished starting in the background, only blocking when there is nothing else to do.
+        while (dispatch_semaphore_wait(finished, (ready.count || !startingServices) ? DISPATCH_TIME_NOW : DISPATCH_TIME_FOREVER) == 0) {
+            Class service;
+            @synchronized(finishedServices) {
+                service = finishedServices.firstObject;
+                [finishedServices removeObjectAtIndex:0];
+            }
+            startingServices--;
+            [self _didStartService:service waiting:waiting ready:ready];
+        }
+        if (!ready.count) {
+            continue;
+        }
+        
+        // Services that start in the background are sent off first, so that they overlap with the services started on the main thread.
+        NSUInteger index = [ready indexOfObjectPassingTest:^BOOL(Class service, NSUInteger idx, BOOL *stop) {
+            return SERVICEINFO(service).startsConcurrently;
+        }];
+        Class service = ready[index == NSNotFound ? 0 : index];
+        [ready removeObjectAtIndex:index == NSNotFound ? 0 : index];
+        
+        _NNServiceInfo *info = SERVICEINFO(service);
+        NSParameterAssert(![self.runningServices containsObject:service]);
+        info.instance.subscriberDispatcher.enabled = YES;
+        
+        if (info.startsConcurrently) {
+            startingServices++;
+            dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_HIGH, 0), ^{
+                [info startInstance];
+                @synchronized(finishedServices) {
+                    [finishedServices addObject:service];
+                }
+                dispatch_semaphore_signal(finished);
+            });
+        } else {
+            [info startInstance];
+            [self _didStartService:service waiting:waiting ready:ready];
+        }
+    }
+}
+
+- (void)_didStartService:(Class)service waiting:(NSMutableDictionary *)waiting ready:(NSMutableArray *)ready;
+{
+    [self.runningServices addObject:service];
+    
+    for (Class dependantClass in self.dependantServices[service]) {
+        NSMutableSet *dependencies = waiting[dependantClass];
+        [dependencies removeObject:service];
+        if (dependencies && !dependencies.count) {
+            [waiting removeObjectForKey:dependantClass];
+            [ready addObject:dependantClass];
+        }
+    }
 }
 
 - (void)_stopServiceIfDone:(Class)service;
@@ -311,23 +453,6 @@ static BOOL _serviceIsValid(Class service)
     [self _stopService:service];
 }
 
-- (void)_startService:(Class)service;
-{
-    NSParameterAssert(![self.runningServices containsObject:service]);
-
-    NNService *instance = SERVICEINFO(service).instance;
-    
-    instance.subscriberDispatcher.enabled = YES;
-    
-    [instance startService];
-    
-    [self.runningServices addObject:service];
-    
-    for (Class dependantClass in self.dependantServices[service]) {
-        [self _startServiceIfReady:dependantClass];
-    }
-}
-
 - (void)_stopService:(Class)service;
 {
     NSParameterAssert([self.runningServices containsObject:service]);
@@ -15,6 +15,8 @@
 #import <XCTest/XCTest.h>
 #import <NNKit/NNKit.h>
 #import <NNKit/NNMultiDispatchManager.h>
+#import <malloc/malloc.h>
+#import <objc/runtime.h>
 
 
 unsigned callCount = 0;
@@ -64,6 +66,78 @@ dispatch_group_t group;
 @end
 
 
+@protocol NNMultiDispatchManagerOrderingProtocol <NSObject>
+- (oneway void)record:(NSNumber *)value;
+- (void)count:(NSUInteger)increment;
+- (oneway void)update:(id)key value:(NSNumber *)value;
+- (oneway void)tally:(NSUInteger)increment;
+// Doubles aren't passed like pointers, so this is forwarded through NSInvocation.
+- (oneway void)recordDouble:(double)value;
+@end
+
+
+@interface NNMultiDispatchManagerOrderingObject : NSObject <NNMultiDispatchManagerOrderingProtocol>
+@property (nonatomic, readonly, strong) NSMutableArray *values;
+@property (nonatomic, readonly, assign) NSUInteger total;
+@property (nonatomic, readonly, strong) NSMutableDictionary *latestValues;
+@property (nonatomic, readonly, assign) NSUInteger updateCount;
+@end
+@implementation NNMultiDispatchManagerOrderingObject
+- (instancetype)init;
+{
+    if (!(self = [super init])) { return nil; }
+    _values = [NSMutableArray new];
+    _latestValues = [NSMutableDictionary new];
+    return self;
+}
+- (oneway void)record:(NSNumber *)value;
+{
+    NSAssert([NSThread isMainThread], @"Oneway messages must be delivered on the main thread");
+    [self.values addObject:value];
+    dispatch_group_leave(group);
+}
+- (void)count:(NSUInteger)increment;
+{
+    _total += increment;
+}
+- (oneway void)update:(id)key value:(NSNumber *)value;
+{
+    NSNumber *previous = self.latestValues[key];
+    NSAssert(!previous || previous.unsignedIntegerValue < value.unsignedIntegerValue, @"Updates must not be delivered out of order");
+    self.latestValues[key] = value;
+    [self.values addObject:key];
+    _updateCount++;
+}
+- (oneway void)tally:(NSUInteger)increment;
+{
+    _total += increment;
+}
+- (oneway void)recordDouble:(double)value;
+{
+    [self.values addObject:@(value)];
+    dispatch_group_leave(group);
+}
+@end
+
+
+@interface NNMultiDispatchManagerDoublingObject : NNMultiDispatchManagerOrderingObject
+@end
+@implementation NNMultiDispatchManagerDoublingObject
+- (void)count:(NSUInteger)increment;
+{
+    [super count:increment * 2];
+}
+@end
+
+
+static size_t blocksInUse(void)
+{
+    malloc_statistics_t stats;
+    malloc_zone_statistics(NULL, &stats);
+    return stats.blocks_in_use;
+}
+
+
 @interface NNMultiDispatchManagerTests : XCTestCase
 
 @end
@@ -184,4 +258,247 @@ dispatch_group_t group;
     XCTAssertEqual(callCount, (unsigned)0, @"");
 }
 
+- (void)testAsyncOrdering;
+{
+    NNMultiDispatchManager *manager = [[NNMultiDispatchManager alloc] initWithProtocol:@protocol(NNMultiDispatchManagerOrderingProtocol)];
+    __attribute__((objc_precise_lifetime)) NNMultiDispatchManagerOrderingObject *observer = [NNMultiDispatchManagerOrderingObject new];
+    [manager addObserver:observer];
+    
+    // Messages sent from other threads while a batch is pending are delivered with it, and messages from the same thread keep their order.
+    NSUInteger const messageCount = 1000;
+    for (NSUInteger i = 0; i < messageCount; ++i) {
+        dispatch_group_enter(group);
+    }
+    dispatch_sync(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        for (NSUInteger i = 0; i < messageCount; ++i) {
+            [(id<NNMultiDispatchManagerOrderingProtocol>)manager record:@(i)];
+        }
+    });
+    
+    while(!despatch_group_yield(group));
+    XCTAssertEqual(observer.values.count, messageCount, @"");
+    for (NSUInteger i = 0; i < observer.values.count; ++i) {
+        XCTAssertEqualObjects(observer.values[i], @(i), @"");
+    }
+}
+
+- (void)testDisabledAsyncDispatch;
+{
+    NNMultiDispatchManager *manager = [[NNMultiDispatchManager alloc] initWithProtocol:@protocol(NNMultiDispatchManagerOrderingProtocol)];
+    __attribute__((objc_precise_lifetime)) NNMultiDispatchManagerOrderingObject *observer = [NNMultiDispatchManagerOrderingObject new];
+    [manager addObserver:observer];
+    
+    manager.enabled = NO;
+    [(id<NNMultiDispatchManagerOrderingProtocol>)manager record:@0];
+    manager.enabled = YES;
+    dispatch_group_enter(group);
+    [(id<NNMultiDispatchManagerOrderingProtocol>)manager record:@1];
+    
+    while(!despatch_group_yield(group));
+    XCTAssertEqualObjects(observer.values, @[@1], @"");
+}
+
+- (void)testCoalescing;
+{
+    NNMultiDispatchManager *manager = [[NNMultiDispatchManager alloc] initWithProtocol:@protocol(NNMultiDispatchManagerOrderingProtocol)];
+    [manager coalesceSelector:@selector(update:value:) byArgumentAtIndex:0];
+    __attribute__((objc_precise_lifetime)) NNMultiDispatchManagerOrderingObject *observer = [NNMultiDispatchManagerOrderingObject new];
+    [manager addObserver:observer];
+    
+    NSArray *keys = @[@"a", @"b", @"c", @"d"];
+    NSUInteger const messageCount = 1000;
+    // The main queue is blocked until every message has been sent, so only the last message for each key is delivered.
+    dispatch_sync(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        for (NSUInteger i = 0; i < messageCount; ++i) {
+            [(id<NNMultiDispatchManagerOrderingProtocol>)manager update:keys[i % keys.count] value:@(i)];
+        }
+    });
+    
+    // Anything already queued for the main queue runs before this.
+    dispatch_group_async(group, dispatch_get_main_queue(), ^{});
+    while(!despatch_group_yield(group));
+    
+    XCTAssertEqual(observer.updateCount, keys.count, @"");
+    XCTAssertEqual(manager.staleMessageCount, messageCount - keys.count, @"");
+    for (NSUInteger i = 0; i < keys.count; ++i) {
+        XCTAssertEqualObjects(observer.latestValues[keys[i]], @(messageCount - keys.count + i), @"");
+    }
+}
+
+- (void)testCoalescingUnderLoad;
+{
+    NNMultiDispatchManager *manager = [[NNMultiDispatchManager alloc] initWithProtocol:@protocol(NNMultiDispatchManagerOrderingProtocol)];
+    [manager coalesceSelector:@selector(update:value:) byArgumentAtIndex:0];
+    __attribute__((objc_precise_lifetime)) NNMultiDispatchManagerOrderingObject *observer = [NNMultiDispatchManagerOrderingObject new];
+    [manager addObserver:observer];
+    
+    NSArray *keys = @[@"a", @"b", @"c", @"d"];
+    NSUInteger const messageCount = 100000;
+    // Messages are sent while the main queue delivers them, so some are coalesced and some aren't.
+    dispatch_group_async(group, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        for (NSUInteger i = 0; i < messageCount; ++i) {
+            [(id<NNMultiDispatchManagerOrderingProtocol>)manager update:keys[i % keys.count] value:@(i)];
+        }
+    });
+    while(!despatch_group_yield(group));
+    dispatch_group_async(group, dispatch_get_main_queue(), ^{});
+    while(!despatch_group_yield(group));
+    
+    NSLog(@"%lu messages: %lu delivered, %lu dropped as stale", (unsigned long)messageCount, (unsigned long)observer.updateCount, (unsigned long)manager.staleMessageCount);
+    XCTAssertEqual(observer.updateCount + manager.staleMessageCount, messageCount, @"");
+    for (NSUInteger i = 0; i < keys.count; ++i) {
+        XCTAssertEqualObjects(observer.latestValues[keys[i]], @(messageCount - keys.count + i), @"");
+    }
+}
+
+- (void)testCoalescingDoesNotReorder;
+{
+    NNMultiDispatchManager *manager = [[NNMultiDispatchManager alloc] initWithProtocol:@protocol(NNMultiDispatchManagerOrderingProtocol)];
+    [manager coalesceSelector:@selector(update:value:) byArgumentAtIndex:NSNotFound];
+    __attribute__((objc_precise_lifetime)) NNMultiDispatchManagerOrderingObject *observer = [NNMultiDispatchManagerOrderingObject new];
+    [manager addObserver:observer];
+    
+    // A coalesced message is delivered where the newest of its kind was sent, after the uncoalesced messages sent before it.
+    dispatch_group_enter(group);
+    [(id<NNMultiDispatchManagerOrderingProtocol>)manager update:@"a" value:@0];
+    [(id<NNMultiDispatchManagerOrderingProtocol>)manager record:@0];
+    [(id<NNMultiDispatchManagerOrderingProtocol>)manager update:@"b" value:@1];
+    dispatch_group_async(group, dispatch_get_main_queue(), ^{});
+    while(!despatch_group_yield(group));
+    
+    NSArray *expected = @[@0, @"b"];
+    XCTAssertEqualObjects(observer.values, expected, @"");
+    XCTAssertEqual(manager.staleMessageCount, (NSUInteger)1, @"");
+}
+
+- (void)testForwardedMessagesKeepTheirOrder;
+{
+    NNMultiDispatchManager *manager = [[NNMultiDispatchManager alloc] initWithProtocol:@protocol(NNMultiDispatchManagerOrderingProtocol)];
+    __attribute__((objc_precise_lifetime)) NNMultiDispatchManagerOrderingObject *observer = [NNMultiDispatchManagerOrderingObject new];
+    [manager addObserver:observer];
+    
+    // Messages that are forwarded through NSInvocation wait in the same queue as the trampolined ones.
+    NSUInteger const messageCount = 1000;
+    for (NSUInteger i = 0; i < messageCount; ++i) {
+        dispatch_group_enter(group);
+    }
+    dispatch_sync(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        for (NSUInteger i = 0; i < messageCount; ++i) {
+            if (i % 2) {
+                [(id<NNMultiDispatchManagerOrderingProtocol>)manager recordDouble:i];
+            } else {
+                [(id<NNMultiDispatchManagerOrderingProtocol>)manager record:@(i)];
+            }
+        }
+    });
+    
+    while(!despatch_group_yield(group));
+    XCTAssertEqual(observer.values.count, messageCount, @"");
+    for (NSUInteger i = 0; i < observer.values.count; ++i) {
+        XCTAssertEqual([observer.values[i] unsignedIntegerValue], i, @"");
+    }
+}
+
+- (void)testObserverChangingClass;
+{
+    NNMultiDispatchManager *manager = [[NNMultiDispatchManager alloc] initWithProtocol:@protocol(NNMultiDispatchManagerOrderingProtocol)];
+    __attribute__((objc_precise_lifetime)) NNMultiDispatchManagerOrderingObject *observer = [NNMultiDispatchManagerOrderingObject new];
+    [manager addObserver:observer];
+    
+    [(id<NNMultiDispatchManagerOrderingProtocol>)manager count:1];
+    XCTAssertEqual(observer.total, (NSUInteger)1, @"");
+    
+    // Implementations looked up for the observer's old class must not be used once it has a new one.
+    object_setClass(observer, [NNMultiDispatchManagerDoublingObject class]);
+    [(id<NNMultiDispatchManagerOrderingProtocol>)manager count:1];
+    XCTAssertEqual(observer.total, (NSUInteger)3, @"");
+}
+
+- (void)testDispatchLeavesReferenceCountsAlone;
+{
+    __attribute__((objc_precise_lifetime)) NNMultiDispatchManagerOrderingObject *observer = [NNMultiDispatchManagerOrderingObject new];
+    CFIndex retainCount = CFGetRetainCount((__bridge CFTypeRef)observer);
+    __weak NNMultiDispatchManager *weakManager = nil;
+    
+    // <NSObject> methods like -release are oneway void and pointer-sized, but must never be dispatched to the observers.
+    @autoreleasepool {
+        NNMultiDispatchManager *manager = [[NNMultiDispatchManager alloc] initWithProtocol:@protocol(NNMultiDispatchManagerOrderingProtocol)];
+        weakManager = manager;
+        [manager addObserver:observer];
+        [(id<NNMultiDispatchManagerOrderingProtocol>)manager count:1];
+        dispatch_group_enter(group);
+        [(id<NNMultiDispatchManagerOrderingProtocol>)manager record:@1];
+    }
+    while(!despatch_group_yield(group));
+    dispatch_group_async(group, dispatch_get_main_queue(), ^{});
+    while(!despatch_group_yield(group));
+    
+    XCTAssertNil(weakManager, @"");
+    XCTAssertEqual(CFGetRetainCount((__bridge CFTypeRef)observer), retainCount, @"");
+    XCTAssertEqualObjects(observer.values, @[@1], @"");
+    XCTAssertEqual(observer.total, (NSUInteger)1, @"");
+}
+
+- (void)testDispatchAllocations;
+{
+    NNMultiDispatchManager *manager = [[NNMultiDispatchManager alloc] initWithProtocol:@protocol(NNMultiDispatchManagerOrderingProtocol)];
+    NSMutableArray *observers = [NSMutableArray new];
+    for (unsigned i = 0; i < 8; ++i) {
+        [observers addObject:[NNMultiDispatchManagerOrderingObject new]];
+        [manager addObserver:observers.lastObject];
+    }
+    
+    NSUInteger const dispatchCount = 100000;
+    NSUInteger const warmUpPasses = 2;
+    NSUInteger const passes = 5;
+    BOOL allocationFree = NO;
+    NSUInteger pass = 0;
+    // The first passes grow the queue of pending oneway messages to hold a whole pass, and warm up anything else that's allocated lazily.
+    for (; pass < warmUpPasses + passes && !allocationFree; ++pass) {
+        size_t before, after;
+        @autoreleasepool {
+            before = blocksInUse();
+            for (NSUInteger i = 0; i < dispatchCount; ++i) {
+                [(id<NNMultiDispatchManagerOrderingProtocol>)manager count:1];
+                [(id<NNMultiDispatchManagerOrderingProtocol>)manager tally:1];
+            }
+            after = blocksInUse();
+        }
+        if (pass >= warmUpPasses) {
+            NSLog(@"%ld blocks allocated while dispatching", (long)after - (long)before);
+            allocationFree = after == before;
+        }
+        
+        // The oneway messages are delivered once the main queue gets a chance to run.
+        dispatch_group_async(group, dispatch_get_main_queue(), ^{});
+        while(!despatch_group_yield(group));
+    }
+    
+    // Other threads in the process may allocate while a pass runs, but dispatching itself must never allocate, so some pass has to see no new blocks at all.
+    XCTAssertTrue(allocationFree, @"");
+    for (NNMultiDispatchManagerOrderingObject *observer in observers) {
+        XCTAssertEqual(observer.total, dispatchCount * pass * 2, @"");
+    }
+}
+
+- (void)testDispatchPerformance;
+{
+    NNMultiDispatchManager *manager = [[NNMultiDispatchManager alloc] initWithProtocol:@protocol(NNMultiDispatchManagerOrderingProtocol)];
+    NSMutableArray *observers = [NSMutableArray new];
+    for (unsigned i = 0; i < 8; ++i) {
+        [observers addObject:[NNMultiDispatchManagerOrderingObject new]];
+        [manager addObserver:observers.lastObject];
+    }
+    
+    NSUInteger const dispatchCount = 100000;
+    [self measureBlock:^{
+        NSDate *start = [NSDate date];
+        for (NSUInteger i = 0; i < dispatchCount; ++i) {
+            [(id<NNMultiDispatchManagerOrderingProtocol>)manager count:1];
+        }
+        NSTimeInterval elapsed = -[start timeIntervalSinceNow];
+        NSLog(@"%.0f dispatches per second to %lu observers", dispatchCount / elapsed, (unsigned long)observers.count);
+    }];
+}
+
 @end
@@ -20,32 +20,40 @@
 
 @interface NNPollingObjectTests : XCTestCase
 
+@property (nonatomic, strong) NNPollingScheduler *scheduler;
+
 @end
 
 
-dispatch_group_t pollingObjectGroup;
+@interface NNTestObject : NNPollingObject
 
+@property (atomic, assign) NSUInteger polls;
+// Quiet objects don't post notifications, so they can be waited on from the main thread.
+@property (nonatomic, assign) BOOL quiet;
+@property (nonatomic, copy) void (^onPoll)(NNTestObject *object);
+
+- (instancetype)initWithScheduler:(NNPollingScheduler *)scheduler;
 
-@interface NNTestObject : NNPollingObject
 @end
+
 @implementation NNTestObject
 
-- (instancetype)init;
+- (instancetype)initWithScheduler:(NNPollingScheduler *)scheduler;
 {
-    if (!(self = [super init])) { return nil; }
+    if (!(self = [super initWithQueue:dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0) scheduler:scheduler])) { return nil; }
     self.interval = 0.0001;
-    dispatch_group_enter(pollingObjectGroup);
     return self;
 }
 
 - (void)main;
 {
-    [self postNotification:nil];
-}
-
-- (void)dealloc;
-{
-    dispatch_group_leave(pollingObjectGroup);
+    self.polls++;
+    if (self.onPoll) {
+        self.onPoll(self);
+    }
+    if (!self.quiet) {
+        [self postNotification:nil];
+    }
 }
 
 @end
@@ -56,19 +64,12 @@ static int iterations;
 
 @implementation NNPollingObjectTests
 
-+ (void)initialize;
-{
-    static dispatch_once_t onceToken;
-    dispatch_once(&onceToken, ^{
-        pollingObjectGroup = dispatch_group_create();
-    });
-}
-
 - (void)setUp
 {
     [super setUp];
     
     iterations = 0;
+    self.scheduler = [[NNPollingScheduler alloc] initWithVirtualClock];
     
     [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(objectNotification:) name:[NNTestObject notificationName] object:nil];
 }
@@ -80,48 +81,44 @@ static int iterations;
     [super tearDown];
 }
 
+- (NNTestObject *)objectWithInterval:(NSTimeInterval)interval;
+{
+    NNTestObject *object = [[NNTestObject alloc] initWithScheduler:self.scheduler];
+    object.interval = interval;
+    return object;
+}
+
 - (void)testBasicPolling
 {
     #pragma clang diagnostic push
     #pragma clang diagnostic ignored "-Wunused-variable"
-    __attribute__((objc_precise_lifetime)) NNTestObject *obj = [NNTestObject new];
+    __attribute__((objc_precise_lifetime)) NNTestObject *obj = [[NNTestObject alloc] initWithScheduler:self.scheduler];
     #pragma clang diagnostic pop
     
-    NSDate *until = [NSDate dateWithTimeIntervalSinceNow:0.05];
-    while ([[NSDate date] compare:until] == NSOrderedAscending && !iterations) {
-        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:until];
-    }
+    [self.scheduler advanceClockBy:0.05];
     XCTAssert(iterations > 0, @"Polling object iterated zero times!");
 }
 
 - (void)testZeroInterval
 {
-    __attribute__((objc_precise_lifetime)) NNTestObject *obj = [NNTestObject new];
-    obj.interval = 0.0;
+    __attribute__((objc_precise_lifetime)) NNTestObject *obj = [self objectWithInterval:0.0];
     
-    NSDate *until = [NSDate dateWithTimeIntervalSinceNow:0.01];
-    while ([[NSDate date] compare:until] == NSOrderedAscending && iterations < 2) {
-        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:until];
-    }
+    [self.scheduler advanceClockBy:1.0];
     XCTAssert(iterations == 1, @"Polling object iterated more than once!");
 }
 
 - (void)testObjectDeath
 {
+    __weak NNTestObject *weakObj;
     @autoreleasepool {
-        #pragma clang diagnostic push
-        #pragma clang diagnostic ignored "-Wunused-variable"
-        __attribute__((objc_precise_lifetime)) NNTestObject *obj = [NNTestObject new];
-        #pragma clang diagnostic pop
+        __attribute__((objc_precise_lifetime)) NNTestObject *obj = [self objectWithInterval:1.0];
+        weakObj = obj;
+        [self.scheduler advanceClockBy:0.0];
     }
-    
-    while(!despatch_group_yield(pollingObjectGroup));
+    XCTAssertNil(weakObj, @"Scheduler kept the polling object alive!");
     iterations = 0;
     
-    NSDate *until = [NSDate dateWithTimeIntervalSinceNow:0.05];
-    while ([[NSDate date] compare:until] == NSOrderedAscending && !iterations) {
-        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:until];
-    }
+    [self.scheduler advanceClockBy:5.0];
     XCTAssert(iterations == 0, @"Object continued polling after it was released!");
 }
 
@@ -136,6 +133,203 @@ static int iterations;
     }
 }
 
+#pragma mark Pause and resume
+
+- (void)testSuspendingCancelsPendingPoll
+{
+    NNTestObject *obj = [self objectWithInterval:1.0];
+    [self.scheduler advanceClockBy:0.0];
+    XCTAssertEqual(obj.polls, (NSUInteger)1);
+    
+    obj.suspended = YES;
+    [self.scheduler advanceClockBy:10.0];
+    XCTAssertEqual(obj.polls, (NSUInteger)1);
+    
+    // The deadline passed while suspended, so resuming polls right away.
+    obj.suspended = NO;
+    [self.scheduler advanceClockBy:0.0];
+    XCTAssertEqual(obj.polls, (NSUInteger)2);
+    [self.scheduler advanceClockBy:1.0];
+    XCTAssertEqual(obj.polls, (NSUInteger)3);
+}
+
+- (void)testSuspendingFromInsidePoll
+{
+    NNTestObject *obj = [self objectWithInterval:1.0];
+    obj.onPoll = ^(NNTestObject *polled) {
+        polled.suspended = YES;
+    };
+    
+    [self.scheduler advanceClockBy:5.0];
+    XCTAssertEqual(obj.polls, (NSUInteger)1);
+    
+    obj.onPoll = nil;
+    obj.suspended = NO;
+    [self.scheduler advanceClockBy:1.0];
+    XCTAssertEqual(obj.polls, (NSUInteger)3);
+}
+
+#pragma mark Polling now
+
+- (void)testPollNowCoalescesWithPendingPoll
+{
+    NNTestObject *obj = [self objectWithInterval:1.0];
+    [self.scheduler advanceClockBy:0.0];
+    
+    [self.scheduler advanceClockBy:0.25];
+    [obj pollNow];
+    [obj pollNow];
+    [obj pollNow];
+    [self.scheduler advanceClockBy:0.0];
+    XCTAssertEqual(obj.polls, (NSUInteger)2);
+    
+    // The next poll follows the requested one by the interval.
+    [self.scheduler advanceClockBy:0.9];
+    XCTAssertEqual(obj.polls, (NSUInteger)2);
+    [self.scheduler advanceClockBy:0.1];
+    XCTAssertEqual(obj.polls, (NSUInteger)3);
+}
+
+- (void)testPollNowDuringPollRunsOneMorePoll
+{
+    NNTestObject *obj = [self objectWithInterval:10.0];
+    obj.onPoll = ^(NNTestObject *polled) {
+        if (polled.polls == 1) {
+            [polled pollNow];
+            [polled pollNow];
+        }
+    };
+    
+    [self.scheduler advanceClockBy:0.0];
+    XCTAssertEqual(obj.polls, (NSUInteger)2);
+    [self.scheduler advanceClockBy:5.0];
+    XCTAssertEqual(obj.polls, (NSUInteger)2);
+}
+
+- (void)testPollNowWhileSuspended
+{
+    NNTestObject *obj = [self objectWithInterval:1.0];
+    [self.scheduler advanceClockBy:0.0];
+    
+    obj.suspended = YES;
+    [obj pollNow];
+    [self.scheduler advanceClockBy:0.0];
+    XCTAssertEqual(obj.polls, (NSUInteger)2);
+    
+    // Polling on request doesn't resume the object.
+    XCTAssertTrue(obj.suspended);
+    [self.scheduler advanceClockBy:5.0];
+    XCTAssertEqual(obj.polls, (NSUInteger)2);
+}
+
+- (void)testPollNowAfterIntervalRanOut
+{
+    NNTestObject *obj = [self objectWithInterval:0.0];
+    [self.scheduler advanceClockBy:0.0];
+    XCTAssertEqual(obj.polls, (NSUInteger)1);
+    
+    [obj pollNow];
+    [self.scheduler advanceClockBy:5.0];
+    XCTAssertEqual(obj.polls, (NSUInteger)2);
+}
+
+- (void)testPollNowAndWait
+{
+    NNTestObject *obj = [self objectWithInterval:10.0];
+    [self.scheduler advanceClockBy:0.0];
+    
+    [obj pollNowAndWait];
+    XCTAssertEqual(obj.polls, (NSUInteger)2);
+    XCTAssertEqual(self.scheduler.now, 0.0);
+}
+
+- (void)testPollNowAndWaitOnRealClock
+{
+    NNPollingScheduler *scheduler = [[NNPollingScheduler alloc] initWithMaxConcurrentPolls:2];
+    // Holds the first poll back until the object is quiet, since the main thread is about to block.
+    dispatch_queue_t q = dispatch_queue_create("NNPollingObjectTests", DISPATCH_QUEUE_SERIAL);
+    dispatch_suspend(q);
+    NNTestObject *obj = [[NNTestObject alloc] initWithQueue:q scheduler:scheduler];
+    obj.quiet = YES;
+    obj.interval = 1000.0;
+    dispatch_resume(q);
+    
+    dispatch_semaphore_t done = dispatch_semaphore_create(0);
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        [obj pollNowAndWait];
+        [obj pollNowAndWait];
+        dispatch_semaphore_signal(done);
+    });
+    
+    XCTAssertEqual(dispatch_semaphore_wait(done, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(NSEC_PER_SEC))), 0L);
+    XCTAssert(obj.polls >= 2, @"Waiting returned before the requested polls finished!");
+}
+
+#pragma mark Re-timing
+
+- (void)testChangingIntervalMovesPendingPoll
+{
+    NNTestObject *obj = [self objectWithInterval:10.0];
+    [self.scheduler advanceClockBy:0.0];
+    
+    // Shortening the interval doesn't wait out the old deadline.
+    obj.interval = 1.0;
+    [self.scheduler advanceClockBy:1.0];
+    XCTAssertEqual(obj.polls, (NSUInteger)2);
+    
+    // Nor does stopping.
+    obj.interval = 0.0;
+    [self.scheduler advanceClockBy:5.0];
+    XCTAssertEqual(obj.polls, (NSUInteger)2);
+    
+    // Starting again counts from the last poll, which was long enough ago that the next is due now.
+    obj.interval = 1.0;
+    [self.scheduler advanceClockBy:0.0];
+    XCTAssertEqual(obj.polls, (NSUInteger)3);
+    [self.scheduler advanceClockBy:1.0];
+    XCTAssertEqual(obj.polls, (NSUInteger)4);
+}
+
+#pragma mark Jitter
+
+- (NSArray *)secondPollTimesWithScheduler:(NNPollingScheduler *)scheduler;
+{
+    NSMutableArray *times = [NSMutableArray new];
+    NSMutableArray *objects = [NSMutableArray new];
+    for (NSUInteger i = 0; i < 20; ++i) {
+        NNTestObject *obj = [[NNTestObject alloc] initWithScheduler:scheduler];
+        obj.quiet = YES;
+        obj.interval = 1.0;
+        obj.jitter = 0.5;
+        obj.onPoll = ^(NNTestObject *polled) {
+            if (polled.polls == 2) {
+                [times addObject:@(scheduler.now)];
+            }
+        };
+        [objects addObject:obj];
+    }
+    
+    [scheduler advanceClockBy:0.0];
+    [scheduler advanceClockBy:0.499];
+    XCTAssertEqual(times.count, (NSUInteger)0, @"Jitter moved a deadline by more than its fraction of the interval!");
+    [scheduler advanceClockBy:1.001];
+    XCTAssertEqual(times.count, objects.count, @"Jitter moved a deadline by more than its fraction of the interval!");
+    
+    return times;
+}
+
+- (void)testJitterSpreadsDeadlines
+{
+    self.scheduler.coalescingInterval = 0.0;
+    NSArray *times = [self secondPollTimesWithScheduler:self.scheduler];
+    XCTAssert([NSSet setWithArray:times].count > 1, @"Jittered objects still polled in lockstep!");
+    
+    // A virtual clock always draws the same jitter.
+    NNPollingScheduler *other = [[NNPollingScheduler alloc] initWithVirtualClock];
+    other.coalescingInterval = 0.0;
+    XCTAssertEqualObjects([self secondPollTimesWithScheduler:other], times);
+}
+
 - (void)objectNotification:(NSNotification *)notification;
 {
     XCTAssert([[NSThread currentThread] isMainThread], @"Poll notification was not dispatched on the main thread!");
@@ -0,0 +1,254 @@
+//
+//  NNPollingSchedulerTests.m
+//  NNKit
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#import <XCTest/XCTest.h>
+
+#import <NNKit/NNKit.h>
+#import <NNKit/NNPollingObject+Protected.h>
+
+
+@interface NNScheduledTestObject : NNPollingObject
+
+@property (nonatomic, assign) NSUInteger polls;
+@property (nonatomic, assign) BOOL postsNotifications;
+@property (nonatomic, copy) void (^onPoll)(NNScheduledTestObject *object);
+
+@end
+
+@implementation NNScheduledTestObject
+
+- (void)main;
+{
+    self.polls++;
+    if (self.onPoll) {
+        self.onPoll(self);
+    }
+    if (self.postsNotifications) {
+        [self postNotification:nil];
+    }
+}
+
+@end
+
+
+@interface NNPollingSchedulerTests : XCTestCase
+
+@property (nonatomic, strong) NNPollingScheduler *scheduler;
+
+@end
+
+
+@implementation NNPollingSchedulerTests
+
+- (void)setUp
+{
+    [super setUp];
+    
+    self.scheduler = [[NNPollingScheduler alloc] initWithVirtualClock];
+}
+
+- (NNScheduledTestObject *)objectWithInterval:(NSTimeInterval)interval;
+{
+    NNScheduledTestObject *object = [[NNScheduledTestObject alloc] initWithQueue:dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0) scheduler:self.scheduler];
+    object.interval = interval;
+    return object;
+}
+
+- (void)testNothingRunsUntilClockAdvances
+{
+    NNScheduledTestObject *object = [self objectWithInterval:1.0];
+    XCTAssertEqual(object.polls, (NSUInteger)0);
+    
+    [self.scheduler advanceClockBy:0.0];
+    XCTAssertEqual(object.polls, (NSUInteger)1);
+    
+    [self.scheduler advanceClockBy:0.5];
+    XCTAssertEqual(object.polls, (NSUInteger)1);
+    
+    [self.scheduler advanceClockBy:0.5];
+    XCTAssertEqual(object.polls, (NSUInteger)2);
+    
+    [self.scheduler advanceClockBy:10.0];
+    XCTAssertEqual(object.polls, (NSUInteger)12);
+}
+
+- (void)testDuePollsShareAWakeup
+{
+    NSMutableArray *objects = [NSMutableArray new];
+    for (NSUInteger i = 0; i < 100; ++i) {
+        // Deadlines within the coalescing interval of each other.
+        [objects addObject:[self objectWithInterval:1.0 + i * 0.00001]];
+    }
+    
+    [self.scheduler advanceClockBy:0.0];
+    XCTAssertEqual(self.scheduler.wakeupCount, (NSUInteger)1);
+    
+    // Just past the last deadline, so that every poll is due by the time the clock stops.
+    [self.scheduler advanceClockBy:1.001];
+    XCTAssertEqual(self.scheduler.wakeupCount, (NSUInteger)2);
+    XCTAssertEqual(self.scheduler.pollCount, (NSUInteger)200);
+}
+
+- (void)testAdvancingStopsAtTheTarget
+{
+    NNScheduledTestObject *early = [self objectWithInterval:1.0];
+    // Due within the coalescing interval of early, but after the target.
+    NNScheduledTestObject *late = [self objectWithInterval:1.003];
+    
+    [self.scheduler advanceClockBy:0.0];
+    XCTAssertEqual(early.polls, (NSUInteger)1);
+    XCTAssertEqual(late.polls, (NSUInteger)1);
+    
+    [self.scheduler advanceClockBy:1.001];
+    XCTAssertEqual(self.scheduler.now, 1.001);
+    XCTAssertEqual(early.polls, (NSUInteger)2);
+    XCTAssertEqual(late.polls, (NSUInteger)1);
+    
+    [self.scheduler advanceClockBy:0.01];
+    XCTAssertEqual(late.polls, (NSUInteger)2);
+}
+
+- (void)testZeroIntervalPollsOnce
+{
+    NNScheduledTestObject *object = [self objectWithInterval:0.0];
+    [self.scheduler advanceClockBy:5.0];
+    XCTAssertEqual(object.polls, (NSUInteger)1);
+}
+
+- (void)testReleasedObjectsStopPolling
+{
+    __block NSUInteger polls = 0;
+    @autoreleasepool {
+        __attribute__((objc_precise_lifetime)) NNScheduledTestObject *object = [self objectWithInterval:1.0];
+        object.onPoll = ^(NNScheduledTestObject *polled) { polls++; };
+        [self.scheduler advanceClockBy:1.0];
+        XCTAssertEqual(polls, (NSUInteger)2);
+    }
+    
+    [self.scheduler advanceClockBy:5.0];
+    XCTAssertEqual(polls, (NSUInteger)2);
+}
+
+- (void)testSuspendedObjectsWaitToBeResumed
+{
+    NNScheduledTestObject *object = [self objectWithInterval:1.0];
+    [self.scheduler advanceClockBy:0.0];
+    XCTAssertEqual(object.polls, (NSUInteger)1);
+    
+    object.suspended = YES;
+    [self.scheduler advanceClockBy:5.0];
+    XCTAssertEqual(object.polls, (NSUInteger)1);
+    
+    // Resuming polls right away, then on the object's interval.
+    object.suspended = NO;
+    [self.scheduler advanceClockBy:0.0];
+    XCTAssertEqual(object.polls, (NSUInteger)2);
+    [self.scheduler advanceClockBy:1.0];
+    XCTAssertEqual(object.polls, (NSUInteger)3);
+}
+
+- (void)testResumingBeforeTheNextPollChangesNothing
+{
+    NNScheduledTestObject *object = [self objectWithInterval:1.0];
+    [self.scheduler advanceClockBy:0.0];
+    
+    object.suspended = YES;
+    object.suspended = NO;
+    [self.scheduler advanceClockBy:0.5];
+    XCTAssertEqual(object.polls, (NSUInteger)1);
+    [self.scheduler advanceClockBy:0.5];
+    XCTAssertEqual(object.polls, (NSUInteger)2);
+}
+
+- (void)testPriorityOrdersPolls
+{
+    NSMutableArray *order = [NSMutableArray new];
+    void (^record)(NNScheduledTestObject *) = ^(NNScheduledTestObject *polled) {
+        [order addObject:@(polled.priority)];
+    };
+    
+    NNScheduledTestObject *low = [self objectWithInterval:1.0];
+    NNScheduledTestObject *high = [self objectWithInterval:1.0];
+    NNScheduledTestObject *medium = [self objectWithInterval:1.0];
+    low.priority = 0.5;
+    high.priority = 4.0;
+    medium.priority = 2.0;
+    low.onPoll = high.onPoll = medium.onPoll = record;
+    
+    [self.scheduler advanceClockBy:0.0];
+    XCTAssertEqualObjects(order, (@[@4.0, @2.0, @0.5]));
+}
+
+- (void)testChangingObjectsPollFirst
+{
+    NSMutableArray *order = [NSMutableArray new];
+    
+    NNScheduledTestObject *idle = [self objectWithInterval:1.0];
+    NNScheduledTestObject *busy = [self objectWithInterval:1.0];
+    busy.postsNotifications = YES;
+    idle.onPoll = ^(NNScheduledTestObject *polled) { [order addObject:@"idle"]; };
+    busy.onPoll = ^(NNScheduledTestObject *polled) { [order addObject:@"busy"]; };
+    
+    // Equal priority and registered first, so idle goes first until busy's notifications have been noticed.
+    [self.scheduler advanceClockBy:0.0];
+    XCTAssertEqualObjects(order, (@[@"idle", @"busy"]));
+    
+    [order removeAllObjects];
+    [self.scheduler advanceClockBy:1.0];
+    XCTAssertEqualObjects(order, (@[@"busy", @"idle"]));
+}
+
+- (void)testRealClockSchedulerPolls
+{
+    NNPollingScheduler *scheduler = [[NNPollingScheduler alloc] initWithMaxConcurrentPolls:2];
+    dispatch_group_t group = dispatch_group_create();
+    
+    NSMutableArray *objects = [NSMutableArray new];
+    for (NSUInteger i = 0; i < 8; ++i) {
+        dispatch_group_enter(group);
+        NNScheduledTestObject *object = [[NNScheduledTestObject alloc] initWithQueue:dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0) scheduler:scheduler];
+        object.onPoll = ^(NNScheduledTestObject *polled) {
+            dispatch_group_leave(group);
+        };
+        [objects addObject:object];
+    }
+    
+    XCTAssertEqual(dispatch_group_wait(group, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(NSEC_PER_SEC))), 0L);
+    XCTAssertThrows([scheduler advanceClockBy:1.0]);
+}
+
+#pragma mark Benchmarks
+
+// Hundreds of windows' worth of polling objects at mixed intervals for a virtual minute.
+- (void)testSchedulingThroughput
+{
+    const NSUInteger objectCount = 500;
+    
+    [self measureBlock:^{
+        NNPollingScheduler *scheduler = [[NNPollingScheduler alloc] initWithVirtualClock];
+        NSMutableArray *objects = [NSMutableArray new];
+        for (NSUInteger i = 0; i < objectCount; ++i) {
+            NNScheduledTestObject *object = [[NNScheduledTestObject alloc] initWithQueue:dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0) scheduler:scheduler];
+            object.interval = (i % 10 == 0) ? 1.0 / 24.0 : 1.0;
+            [objects addObject:object];
+        }
+        
+        NSDate *start = [NSDate date];
+        [scheduler advanceClockBy:60.0];
+        NSTimeInterval elapsed = -[start timeIntervalSinceNow];
+        NSLog(@"%lu objects, 60s virtual: %lu polls in %lu wakeups, %.0fns per poll", (unsigned long)objectCount, (unsigned long)scheduler.pollCount, (unsigned long)scheduler.wakeupCount, elapsed * 1e9 / scheduler.pollCount);
+    }];
+}
+
+@end
@@ -15,6 +15,7 @@
 #import "NNTestCase.h"
 
 #import <mach/mach.h>
+#import <objc/runtime.h>
 
 #import "NNServiceManager.h"
 #import "NNService+Protected.h"
@@ -120,6 +121,114 @@ static BOOL serviceERunning = NO;
 @end
 
 
+/*
+ G -> F
+ H -> F
+ I -> G
+ I -> H
+ 
+ F, G and H start concurrently, I starts on the main thread.
+ G and H may start at the same time, I starts once they both have.
+ */
+
+static NSMutableArray *startEvents;
+
+static void recordStartEvent(NSString *event)
+{
+    @synchronized(startEvents) {
+        [startEvents addObject:event];
+    }
+}
+
+@interface TestConcurrentService : NNService @end
+@implementation TestConcurrentService
++ (NNServiceType)serviceType { return NNServiceTypePersistent; }
++ (BOOL)startsConcurrently { return YES; }
+- (void)startService {
+    [super startService];
+    recordStartEvent([NSString stringWithFormat:@"begin %@", NSStringFromClass(self.class)]);
+    usleep(50000);
+    recordStartEvent([NSString stringWithFormat:@"end %@", NSStringFromClass(self.class)]);
+}
+@end
+
+@interface TestServiceF : TestConcurrentService @end
+@implementation TestServiceF
+@end
+
+@interface TestServiceG : TestConcurrentService @end
+@implementation TestServiceG
++ (NSSet *)dependencies { return [NSSet setWithObject:[TestServiceF self]]; }
+@end
+
+@interface TestServiceH : TestConcurrentService @end
+@implementation TestServiceH
++ (NSSet *)dependencies { return [NSSet setWithObject:[TestServiceF self]]; }
+@end
+
+@interface TestServiceI : NNService @end
+@implementation TestServiceI
++ (NNServiceType)serviceType { return NNServiceTypePersistent; }
++ (NSSet *)dependencies { return [NSSet setWithArray:@[[TestServiceG self], [TestServiceH self]]]; }
+- (void)startService {
+    [super startService];
+    NSAssert([NSThread isMainThread], @"");
+    recordStartEvent(@"begin TestServiceI");
+    recordStartEvent(@"end TestServiceI");
+}
+@end
+
+
+/*
+ J starts on the main thread and subscribes to K, which starts concurrently and is already starting by then.
+ */
+
+static NNServiceManager *reentrantManager;
+
+@interface TestServiceK : TestConcurrentService @end
+@implementation TestServiceK
+@end
+
+@interface TestServiceJ : NNService @end
+@implementation TestServiceJ
++ (NNServiceType)serviceType { return NNServiceTypePersistent; }
+- (void)startService {
+    [super startService];
+    [reentrantManager addSubscriber:self forService:[TestServiceK self]];
+}
+@end
+
+
+// Services in the synthetic graph are made at runtime as subclasses of this one.
+static NSDictionary *graphDependencies;
+static BOOL graphStartsConcurrently;
+static NSMutableSet *graphStartedServices;
+
+@interface TestGraphService : NNService @end
+@implementation TestGraphService
++ (NNServiceType)serviceType { return NNServiceTypePersistent; }
++ (NSSet *)dependencies { return graphDependencies[NSStringFromClass(self)]; }
++ (BOOL)startsConcurrently { return graphStartsConcurrently; }
+- (void)startService {
+    [super startService];
+    @synchronized(graphStartedServices) {
+        NSAssert([[self.class dependencies] isSubsetOfSet:graphStartedServices], @"Service started before its dependencies");
+    }
+    // Stands in for the I/O a real service does when it starts.
+    usleep(2000);
+    @synchronized(graphStartedServices) {
+        [graphStartedServices addObject:self.class];
+    }
+}
+- (void)stopService {
+    @synchronized(graphStartedServices) {
+        [graphStartedServices removeObject:self.class];
+    }
+    [super stopService];
+}
+@end
+
+
 unsigned eventsDispatched;
 
 
@@ -296,6 +405,101 @@ unsigned eventsDispatched;
     XCTAssertFalse(serviceERunning, @"");
 }
 
+- (void)testConcurrentStartOrdering;
+{
+    startEvents = [NSMutableArray new];
+    NNServiceManager *manager = [NNServiceManager new];
+    [manager registerServices:[NSSet setWithArray:@[[TestServiceI self], [TestServiceH self], [TestServiceG self], [TestServiceF self]]]];
+    
+    NSArray *events = [startEvents copy];
+    XCTAssertEqual(events.count, (NSUInteger)8, @"");
+    NSDictionary *dependencies = @{
+        @"TestServiceG" : @[@"TestServiceF"],
+        @"TestServiceH" : @[@"TestServiceF"],
+        @"TestServiceI" : @[@"TestServiceG", @"TestServiceH"],
+    };
+    for (NSString *service in dependencies) {
+        NSUInteger begin = [events indexOfObject:[@"begin " stringByAppendingString:service]];
+        for (NSString *dependency in dependencies[service]) {
+            XCTAssertTrue([events indexOfObject:[@"end " stringByAppendingString:dependency]] < begin, @"%@ started before %@ finished starting", service, dependency);
+        }
+    }
+    
+    // Neither G nor H waits for the other.
+    NSUInteger beginG = [events indexOfObject:@"begin TestServiceG"];
+    NSUInteger beginH = [events indexOfObject:@"begin TestServiceH"];
+    XCTAssertTrue(MAX(beginG, beginH) < MIN([events indexOfObject:@"end TestServiceG"], [events indexOfObject:@"end TestServiceH"]), @"");
+    
+    NSDictionary *startLatencies = [manager serviceStartLatencies];
+    XCTAssertEqual(startLatencies.count, (NSUInteger)4, @"");
+    XCTAssertTrue([startLatencies[[TestServiceF self]] doubleValue] >= 0.05, @"");
+}
+
+- (void)testRegisteringDependantFirst;
+{
+    startEvents = [NSMutableArray new];
+    NNServiceManager *manager = [NNServiceManager new];
+    [manager registerService:[TestServiceI self]];
+    [manager registerService:[TestServiceG self]];
+    XCTAssertEqual(startEvents.count, (NSUInteger)0, @"");
+    [manager registerService:[TestServiceF self]];
+    XCTAssertEqual(startEvents.count, (NSUInteger)4, @"");
+    [manager registerService:[TestServiceH self]];
+    XCTAssertEqualObjects(startEvents.lastObject, @"end TestServiceI", @"");
+    XCTAssertEqual(startEvents.count, (NSUInteger)8, @"");
+}
+
+- (void)testSubscribingWhileStarting;
+{
+    startEvents = [NSMutableArray new];
+    reentrantManager = [NNServiceManager new];
+    [reentrantManager registerServices:[NSSet setWithArray:@[[TestServiceJ self], [TestServiceK self]]]];
+    
+    XCTAssertEqualObjects(startEvents, (@[@"begin TestServiceK", @"end TestServiceK"]), @"");
+    XCTAssertEqual([reentrantManager serviceStartLatencies].count, (NSUInteger)2, @"");
+    reentrantManager = nil;
+}
+
+- (void)testStartupPerformance;
+{
+    // 100 services in layers of 10, each depending on up to three services in the layer before it.
+    NSMutableArray *graph = [NSMutableArray new];
+    NSMutableDictionary *dependencies = [NSMutableDictionary new];
+    srandom(100);
+    for (unsigned i = 0; i < 100; ++i) {
+        NSString *name = [NSString stringWithFormat:@"TestGraphService%u", i];
+        Class service = objc_getClass(name.UTF8String);
+        if (!service) {
+            service = objc_allocateClassPair([TestGraphService self], name.UTF8String, 0);
+            objc_registerClassPair(service);
+        }
+        
+        NSMutableSet *serviceDependencies = [NSMutableSet new];
+        if (i >= 10) {
+            for (unsigned j = 0; j < 3; ++j) {
+                [serviceDependencies addObject:graph[(i / 10 - 1) * 10 + random() % 10]];
+            }
+        }
+        dependencies[name] = serviceDependencies;
+        [graph addObject:service];
+    }
+    graphDependencies = dependencies;
+    graphStartedServices = [NSMutableSet new];
+    
+    for (unsigned concurrent = 0; concurrent < 2; ++concurrent) {
+        graphStartsConcurrently = concurrent;
+        @autoreleasepool {
+            NNServiceManager *manager = [NNServiceManager new];
+            NSDate *start = [NSDate date];
+            [manager registerServices:[NSSet setWithArray:graph]];
+            NSTimeInterval elapsed = -[start timeIntervalSinceNow];
+            NSLog(@"Started %lu services %@ in %.1fms", (unsigned long)graph.count, concurrent ? @"concurrently" : @"serially", elapsed * 1000.0);
+            XCTAssertEqual(graphStartedServices.count, graph.count, @"");
+        }
+        XCTAssertEqual(graphStartedServices.count, (NSUInteger)0, @"");
+    }
+}
+
 // This test must run last.
 - (void)testZSharedManager;
 {
@@ -17,6 +17,69 @@
 #import <NNKit/NNKit.h>
 
 
+// A single lock around a weak hash table, for comparison with the contention benchmarks.
+@interface NNWeakSetTestsLockedTable : NSObject
+@property (nonatomic, readonly, strong) NSHashTable *table;
+@end
+@implementation NNWeakSetTestsLockedTable
+- (instancetype)init;
+{
+    if (!(self = [super init])) { return nil; }
+    _table = [NSHashTable weakObjectsHashTable];
+    return self;
+}
+- (void)addObject:(id)object;
+{
+    @synchronized(self) {
+        [self.table addObject:object];
+    }
+}
+- (void)removeObject:(id)object;
+{
+    @synchronized(self) {
+        [self.table removeObject:object];
+    }
+}
+- (id)member:(id)object;
+{
+    @synchronized(self) {
+        return [self.table member:object];
+    }
+}
+- (NSArray *)allObjects;
+{
+    @synchronized(self) {
+        return self.table.allObjects;
+    }
+}
+@end
+
+
+// Equal by value, and uses the set from -isEqual:, which deadlocks if the set compares members while holding its lock.
+@interface NNWeakSetTestsReentrantValue : NSObject
+@property (nonatomic, readonly, assign) NSUInteger value;
+@property (nonatomic, weak) NNWeakSet *set;
+@end
+@implementation NNWeakSetTestsReentrantValue
+- (instancetype)initWithValue:(NSUInteger)value set:(NNWeakSet *)set;
+{
+    if (!(self = [super init])) { return nil; }
+    _value = value;
+    _set = set;
+    return self;
+}
+- (NSUInteger)hash;
+{
+    return self.value;
+}
+- (BOOL)isEqual:(id)object;
+{
+    (void)self.set.count;
+    return [object isKindOfClass:[NNWeakSetTestsReentrantValue class]] && [object value] == self.value;
+}
+@end
+
+
 @interface NNWeakSetTests : NNTestCase
 
 @end
@@ -66,6 +129,24 @@
     XCTAssertEqual(set.count, (NSUInteger)0, @"");
 }
 
+- (void)testEqualMembersComparedWithoutLock;
+{
+    NNWeakSet *set = [NNWeakSet new];
+    __attribute__((objc_precise_lifetime)) NNWeakSetTestsReentrantValue *a = [[NNWeakSetTestsReentrantValue alloc] initWithValue:7 set:set];
+    __attribute__((objc_precise_lifetime)) NNWeakSetTestsReentrantValue *b = [[NNWeakSetTestsReentrantValue alloc] initWithValue:7 set:set];
+    __attribute__((objc_precise_lifetime)) NNWeakSetTestsReentrantValue *c = [[NNWeakSetTestsReentrantValue alloc] initWithValue:8 set:set];
+    
+    [set addObject:a];
+    XCTAssertEqual([set member:b], a, @"");
+    XCTAssertNil([set member:c], @"");
+    
+    [set addObject:b];
+    XCTAssertEqual(set.count, (NSUInteger)1, @"");
+    
+    [set removeObject:b];
+    XCTAssertEqual(set.count, (NSUInteger)0, @"");
+}
+
 - (void)testWeakRemoval;
 {
     NNWeakSet *set = [NNWeakSet new];
@@ -100,6 +181,101 @@
     XCTAssertEqual(set.count, (NSUInteger)1, @"");
 }
 
+- (void)testEnumerationSkipsDeallocatedMembers;
+{
+    NNWeakSet *set = [NNWeakSet new];
+    NSMutableArray *members = [NSMutableArray new];
+    
+    @autoreleasepool {
+        for (unsigned i = 0; i < 1000; ++i) {
+            id object = [NSObject new];
+            [set addObject:object];
+            if (i % 2) {
+                [members addObject:object];
+            }
+        }
+    }
+    
+    NSUInteger enumCount = 0;
+    for (id obj in set) {
+        XCTAssertTrue([members containsObject:obj], @"");
+        enumCount++;
+    }
+    XCTAssertEqual(enumCount, members.count, @"");
+    XCTAssertEqual(set.count, members.count, @"");
+    for (id obj in members) {
+        XCTAssertEqual([set member:obj], obj, @"");
+    }
+}
+
+- (void)testMutationDuringEnumeration;
+{
+    NNWeakSet *set = [NNWeakSet new];
+    NSMutableArray *members = [NSMutableArray new];
+    for (unsigned i = 0; i < 100; ++i) {
+        [members addObject:[NSObject new]];
+        [set addObject:members.lastObject];
+    }
+    
+    // Enumeration works from a snapshot, so members can be removed as they're visited.
+    NSUInteger enumCount = 0;
+    for (id obj in set) {
+        [set removeObject:obj];
+        enumCount++;
+    }
+    XCTAssertEqual(enumCount, members.count, @"");
+    XCTAssertEqual(set.count, (NSUInteger)0, @"");
+}
+
+- (void)testContention;
+{
+    NSUInteger const memberCount = 64;
+    NSUInteger const operationCount = 200000;
+    NSMutableArray *members = [NSMutableArray new];
+    for (NSUInteger i = 0; i < memberCount; ++i) {
+        [members addObject:[NSObject new]];
+    }
+    
+    for (NSUInteger threadCount = 1; threadCount <= 16; threadCount *= 2) {
+        NNWeakSet *set = [NNWeakSet new];
+        NNWeakSetTestsLockedTable *lockedTable = [NNWeakSetTestsLockedTable new];
+        for (id member in members) {
+            [set addObject:member];
+            [lockedTable addObject:member];
+        }
+        
+        // Mostly lookups, some churn, and the occasional enumeration, the way a subscriber list is used.
+        NSTimeInterval (^run)(id) = ^(id collection){
+            NSDate *start = [NSDate date];
+            dispatch_apply(threadCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t thread) {
+                for (NSUInteger i = 0; i < operationCount / threadCount; ++i) {
+                    @autoreleasepool {
+                        id member = members[(i * 7 + thread) % memberCount];
+                        switch (i % 16) {
+                            case 0:
+                                [collection removeObject:member];
+                                [collection addObject:member];
+                                break;
+                            case 1:
+                                (void)[collection allObjects];
+                                break;
+                            default:
+                                (void)[collection member:member];
+                                break;
+                        }
+                    }
+                }
+            });
+            return -[start timeIntervalSinceNow];
+        };
+        
+        NSTimeInterval lockedTime = run(lockedTable);
+        NSTimeInterval shardedTime = run(set);
+        NSLog(@"%lu threads: %.0f operations per second (single lock: %.0f)", (unsigned long)threadCount, operationCount / shardedTime, operationCount / lockedTime);
+        XCTAssertEqual(set.count, memberCount, @"");
+    }
+}
+
 - (void)testMemoryLeaks;
 {
     NNWeakSet *set = [NNWeakSet new];
@@ -17,7 +17,9 @@
 
 @interface NSScreen (SWAdditions)
 
+// Served from the current SWScreenTopology, so this is cheap to call repeatedly.
 + (CGFloat)sw_totalScreenHeight;
++ (CGFloat)sw_totalScreenHeightOfScreens:(NSArray *)screens;
 
 - (CGDirectDisplayID)sw_screenNumber;
 
@@ -14,14 +14,21 @@
 
 #import "NSScreen+SWAdditions.h"
 
+#import "SWScreenTopology.h"
+
 
 @implementation NSScreen (SWAdditions)
 
 + (CGFloat)sw_totalScreenHeight;
 {
-    return [[[NSScreen screens] nn_reduce:^id(id accumulator, id item) {
+    return [SWScreenTopology currentTopology].totalScreenHeight;
+}
+
++ (CGFloat)sw_totalScreenHeightOfScreens:(NSArray *)screens;
+{
+    return [[screens nn_reduce:^id(id accumulator, id item) {
         if (!accumulator) { accumulator = @(0.0); }
-        CGRect screenFrame = [item private_sw_absoluteFrame];
+        CGRect screenFrame = [item private_sw_absoluteFrameAmongScreens:screens];
         CGFloat screenHeight = screenFrame.origin.y + screenFrame.size.height;
         if ([accumulator floatValue] < screenFrame.origin.y + screenFrame.size.height) {
             accumulator = @(screenHeight);
@@ -36,10 +43,10 @@
     return [description[@"NSScreenNumber"] unsignedIntValue];
 }
 
-- (CGRect)private_sw_absoluteFrame;
+- (CGRect)private_sw_absoluteFrameAmongScreens:(NSArray *)screens;
 {
     CGPoint offset = CGPointZero;
-    for (NSScreen *screen in [NSScreen screens]) {
+    for (NSScreen *screen in screens) {
         if (screen.frame.origin.x < offset.x) {
             offset.x = screen.frame.origin.x;
         }
@@ -32,6 +32,14 @@
 {
     [[NNServiceManager sharedManager] registerAllPossibleServices];
     
+    // Cold start report, slowest service first.
+    NSDictionary *startLatencies = [[NNServiceManager sharedManager] serviceStartLatencies];
+    NSMutableArray *startReport = [NSMutableArray new];
+    for (Class service in [[startLatencies keysSortedByValueUsingSelector:@selector(compare:)] reverseObjectEnumerator]) {
+        [startReport addObject:[NSString stringWithFormat:@"%@ %.1fms", NSStringFromClass(service), [startLatencies[service] doubleValue] * 1000.0]];
+    }
+    SWLog(@"Started services: %@", [startReport componentsJoinedByString:@", "]);
+    
     NSURL *feedURL = [NSURL URLWithString:[SWPreferencesService sharedService].appcastURL];
     if (!feedURL) {
         [SWPreferencesService sharedService].appcastURL = nil;
@@ -14,11 +14,12 @@
 
 #import "SWCoreWindowController.h"
 
-#import "NSSet+SWChaining.h"
+#import "SWApplication.h"
 #import "SWEventTap.h"
 #import "SWHUDCollectionView.h"
-#import "SWWindow.h"
+#import "SWWindowGroup.h"
 #import "SWWindowThumbnailView.h"
+#import "windowListDiff.h"
 
 
 @interface SWCoreWindowController () <SWHUDCollectionViewDataSource, SWHUDCollectionViewDelegate>
@@ -26,7 +27,6 @@
 @property (nonatomic, assign, readwrite) BOOL interfaceLoaded;
 @property (nonatomic, assign, readonly) NSScreen *screen;
 @property (nonatomic, strong, readwrite) SWHUDCollectionView *collectionView;
-@property (nonatomic, strong, readonly) NSMutableDictionary *collectionCells;
 
 @end
 
@@ -39,7 +39,6 @@
 {
     BailUnless(self = [super initWithWindow:nil], nil);
     
-    _collectionCells = [NSMutableDictionary new];
     _screen = screen;
 
     Check(![self isWindowLoaded]);
@@ -104,10 +103,6 @@
 - (void)updateWindowList:(NSOrderedSet *)windowList;
 {
     SWTimeTask(SWCodeBlock({
-        // Throw out any cells that aren't needed anymore.
-        NSSet *removedWindows = [[NSSet setWithArray:self.collectionCells.allKeys] sw_minusSet:windowList.set];
-        [self.collectionCells removeObjectsForKeys:removedWindows.allObjects];
-
         _windowList = windowList;
         [self.collectionView reloadData];
     }), @"Updating switcher window list");
@@ -158,11 +153,33 @@
     SWWindow *window = index < self.windowList.count ? self.windowList[index] : nil;
     BailUnless(window, [[NSView alloc] initWithFrame:CGRectZero]);
 
-    if (!self.collectionCells[window]) {
-        self.collectionCells[window] = [[SWWindowThumbnailView alloc] initWithFrame:CGRectZero window:window];
-    }
+    return [[SWWindowThumbnailView alloc] initWithFrame:CGRectZero window:window];
+}
+
+- (uint32_t)HUDCollectionView:(SWHUDCollectionView *)view identifierForCellAtIndex:(NSUInteger)index;
+{
+    // Boundary method, index may not be in-bounds.
+    SWWindow *window = index < self.windowList.count ? self.windowList[index] : nil;
+    return window.windowID;
+}
 
-    return self.collectionCells[window];
+- (uint64_t)HUDCollectionView:(SWHUDCollectionView *)view fingerprintForCellAtIndex:(NSUInteger)index;
+{
+    // Boundary method, index may not be in-bounds.
+    SWWindow *window = index < self.windowList.count ? self.windowList[index] : nil;
+    BailUnless([window isKindOfClass:[SWWindowGroup class]], 0);
+
+    // A thumbnail is built from its group's windows and their frames, and its application's icon.
+    uint64_t fingerprint = kSWWindowListFingerprintSeed;
+    pid_t pid = window.application.pid;
+    fingerprint = SWWindowListFingerprint(fingerprint, &pid, sizeof(pid));
+    for (SWWindow *member in CLASS_CAST(SWWindowGroup, window).windows) {
+        CGWindowID windowID = member.windowID;
+        CGRect frame = member.frame;
+        fingerprint = SWWindowListFingerprint(fingerprint, &windowID, sizeof(windowID));
+        fingerprint = SWWindowListFingerprint(fingerprint, &frame, sizeof(frame));
+    }
+    return fingerprint;
 }
 
 #pragma mark - SWHUDCollectionViewDelegate
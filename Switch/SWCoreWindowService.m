@@ -14,6 +14,9 @@
 
 #import "SWCoreWindowService.h"
 
+#import <stdatomic.h>
+
+#import "inputQueue.h"
 #import "NSScreen+SWAdditions.h"
 #import "SWAccessibilityService.h"
 #import "SWApplication.h"
@@ -23,14 +26,37 @@
 #import "SWScrollControl.h"
 #import "SWStateMachine.h"
 #import "SWWindow.h"
+#import "SWWindowContentsService.h"
 #import "SWWindowListService.h"
 
 
 static NSTimeInterval const kWindowDisplayDelay = 0.2;
 static int const kScrollThreshold = 50;
-
-
-@interface SWCoreWindowService () <SWWindowListSubscriber, SWStateMachineDelegate, SWInterfaceControllerDelegate>
+static size_t const kInputQueueCapacity = 256;
+
+
+// The state machine state that hotkey blocks consult, in addition to their own, to decide whether to swallow an event.
+typedef NS_OPTIONS(unsigned, SWEventTapState) {
+    SWEventTapStateActive           = 1 << 0,
+    SWEventTapStateInterfaceVisible = 1 << 1,
+};
+
+
+@interface SWCoreWindowService () <SWWindowListSubscriber, SWStateMachineDelegate, SWInterfaceControllerDelegate> {
+    // Hotkey blocks run on the event tap's thread. They read a copy of the state machine's state and pass inputs to the main thread through the queue, then wake it with the source.
+    _Atomic(unsigned) _eventTapState;
+    // Whether Switch is invoked, as the event tap's thread has seen it: set by the invoking keydown, cleared when the modifier is released, the invocation is cancelled, or the main thread ends it. Only the event tap's thread touches these, so swallowing keys never waits on the main thread catching up.
+    _Bool _tapInvoked;
+    uint64_t _tapInvokedAt;
+    // Inputs are numbered in the order the event tap's thread posts them. _tapInvokedInput is the number of the input that invoked Switch.
+    uint64_t _tapInputsPosted;
+    uint64_t _tapInvokedInput;
+    // The main thread can end an invocation on its own, by clicking outside the interface or raising a window. Whenever an invocation ends it publishes how many inputs it had handled, so the event tap's thread can tell whether its invocation was among them.
+    uint64_t _inputsHandled;
+    _Atomic(uint64_t) _invocationEndedAfter;
+    SWInputQueue *_inputs;
+    dispatch_source_t _inputSource;
+}
 
 #pragma mark - State machine inputs
 @property (nonatomic, strong) NSTimer *displayTimer;
@@ -56,7 +82,17 @@ static int const kScrollThreshold = 50;
 
     self->_interface = [[SWInterfaceController alloc] initWithDelegate:self];
 
+    self->_inputs = SWInputQueueCreate(kInputQueueCapacity);
+    BailUnless(self->_inputs, nil);
+
     @weakify(self);
+    self->_inputSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_DATA_OR, 0, 0, dispatch_get_main_queue());
+    dispatch_source_set_event_handler(self->_inputSource, ^{
+        @strongify(self);
+        [self private_handleInputs];
+    });
+    dispatch_resume(self->_inputSource);
+
     self->_scroller = [[SWScrollControl alloc] initWithThreshold:kScrollThreshold incHandler:^{
         @strongify(self);
         [self.stateMachine incrementWithInvoke:false direction:SWIncrementDirectionIncreasing isRepeating:true];
@@ -92,12 +128,37 @@ static int const kScrollThreshold = 50;
             [self private_hideInterface];
         }
     }];
-    // set [SWEventTap sharedService].suppressKeyEvents = self.stateMachine.invoked;
-    RAC([SWEventTap sharedService], suppressKeyEvents) = RACObserve(self, stateMachine.invoked);
+    // capture window contents only as often as the interface shows them, based on stateMachine.interfaceVisible, .windowList, and .selectedWindow
+    [[RACSignal merge:@[RACObserve(self, stateMachine.interfaceVisible), RACObserve(self, stateMachine.windowList), RACObserve(self, stateMachine.selectedWindow)]]
+    subscribeNext:^(id x) {
+        @strongify(self);
+        [self private_updateCaptureDemand];
+    }];
+    // copy the state machine's state for the event tap's thread, based on stateMachine.active and .interfaceVisible
+    [[RACSignal merge:@[RACObserve(self, stateMachine.active), RACObserve(self, stateMachine.interfaceVisible)]]
+    subscribeNext:^(id x) {
+        @strongify(self);
+        [self private_updateEventTapState];
+    }];
+    // tell the event tap's thread when an invocation ends, based on stateMachine.invoked
+    [RACObserve(self, stateMachine.invoked) subscribeNext:^(NSNumber *invoked) {
+        @strongify(self);
+        if (!invoked.boolValue) {
+            atomic_store(&self->_invocationEndedAfter, self->_inputsHandled);
+        }
+    }];
 
     return self;
 }
 
+- (void)dealloc;
+{
+    if (self->_inputSource) {
+        dispatch_source_cancel(self->_inputSource);
+    }
+    SWInputQueueDestroy(self->_inputs);
+}
+
 #pragma mark - NNService
 
 + (NNServiceType)serviceType;
@@ -118,31 +179,32 @@ static int const kScrollThreshold = 50;
     SWEventTap *eventTap = [SWEventTap sharedService];
 
     BOOL (^updateSelector)(CGEventRef, BOOL, SWIncrementDirection) = ^(CGEventRef event, BOOL invokesInterface, SWIncrementDirection direction) {
+        SWTraceScope("SWCoreWindowService hotkey: selection");
+        uint64_t start = SWTraceNow();
         @strongify(self);
         BailUnless(event, YES);
 
         // If this hotKey doesn't invoke the interface and it is not already active, pass the event through and do nothing.
-        if (!invokesInterface && !self.stateMachine.invoked) {
+        if (!invokesInterface && ![self private_tapInvoked]) {
             return YES;
         }
 
-        // The event is passed by reference. Copy it in case it mutates after control returns to the caller. Released in the async block below.
-        event = CGEventCreateCopy(event);
-        dispatch_async(dispatch_get_main_queue(), ^{
-            @strongify(self);
-
-            // Avoid leaking the event if this block early-returns.
-            NNCFAutorelease(event);
-
-            if (CGEventGetType(event) == kCGEventKeyDown) {
-                _Bool autorepeat = CGEventGetIntegerValueField(event, kCGKeyboardEventAutorepeat);
-
-                [self.stateMachine incrementWithInvoke:invokesInterface direction:direction isRepeating:autorepeat];
-
-                [self.scroller reset];
-            }
-        });
+        if (CGEventGetType(event) != kCGEventKeyDown) {
+            return NO;
+        }
 
+        uint32_t flags = 0;
+        if (invokesInterface) { flags |= SWInputFlagInvoke; }
+        if (direction == SWIncrementDirectionDecreasing) { flags |= SWInputFlagDecreasing; }
+        if (CGEventGetIntegerValueField(event, kCGKeyboardEventAutorepeat)) { flags |= SWInputFlagRepeating; }
+        if (![self private_postInput:(SWInput){ .kind = SWInputKindIncrement, .flags = flags, .timestamp = start }]) {
+            return YES;
+        }
+        if (invokesInterface && ![self private_tapInvoked]) {
+            self->_tapInvoked = true;
+            self->_tapInvokedAt = start;
+            self->_tapInvokedInput = self->_tapInputsPosted - 1;
+        }
         return NO;
     };
 
@@ -176,33 +238,28 @@ static int const kScrollThreshold = 50;
 
     // Closing a window is bound to option-W when the interface is open.
     [eventTap registerHotKey:[SWHotKey hotKeyWithKeycode:kVK_ANSI_W modifiers:SWHotKeyModifierOption] object:self block:^BOOL(CGEventRef event) {
+        SWTraceScope("SWCoreWindowService hotkey: close window");
         @strongify(self);
 
         if (CGEventGetType(event) != kCGEventKeyDown) {
             return YES;
         }
 
-        dispatch_async(dispatch_get_main_queue(), ^{
-            @strongify(self);
-            [self.stateMachine closeWindow];
-        });
-        return !self.stateMachine.interfaceVisible;
+        if (![self private_postInput:(SWInput){ .kind = SWInputKindCloseWindow, .timestamp = SWTraceNow() }]) {
+            return YES;
+        }
+        return ![self private_tapInterfaceVisible];
     }];
 
     // Showing the preferences is bound to option-, when the interface is open. This action closes the interface.
     [eventTap registerHotKey:[SWHotKey hotKeyWithKeycode:kVK_ANSI_Comma modifiers:SWHotKeyModifierOption] object:self block:^BOOL(CGEventRef event) {
+        SWTraceScope("SWCoreWindowService hotkey: preferences");
         @strongify(self);
         if (CGEventGetType(event) == kCGEventKeyDown) {
-            dispatch_async(dispatch_get_main_queue(), ^{
-                @strongify(self);
-                if (self.stateMachine.active) {
-                    dispatch_async(dispatch_get_main_queue(), ^{
-                        @strongify(self);
-                        [[SWPreferencesService sharedService] showPreferencesWindow:self];
-                    });
-                }
-                [self.stateMachine cancelInvocation];
-            });
+            if (![self private_postInput:(SWInput){ .kind = SWInputKindShowPreferences, .timestamp = SWTraceNow() }]) {
+                return YES;
+            }
+            self->_tapInvoked = false;
             return NO;
         }
         return YES;
@@ -210,25 +267,33 @@ static int const kScrollThreshold = 50;
 
     // Cancelling the switcher is bound to option-escape. This action closes the interface.
     [eventTap registerHotKey:[SWHotKey hotKeyWithKeycode:kVK_Escape modifiers:SWHotKeyModifierOption] object:self block:^(CGEventRef event){
+        SWTraceScope("SWCoreWindowService hotkey: cancel");
         @strongify(self);
         if (CGEventGetType(event) == kCGEventKeyDown) {
-            dispatch_async(dispatch_get_main_queue(), ^{
-                @strongify(self);
-                [self.stateMachine cancelInvocation];
-            });
-            return (BOOL)!self.stateMachine.active;
+            if (![self private_postInput:(SWInput){ .kind = SWInputKindCancel, .timestamp = SWTraceNow() }]) {
+                return YES;
+            }
+            BOOL active = [self private_tapInvoked] || ([self private_eventTapState] & SWEventTapStateActive);
+            self->_tapInvoked = false;
+            return !active;
         }
         return YES;
     }];
 
     // Releasing the option key when the interface is open raises the selected window. If that action is successful, it will close the interface.
     [eventTap registerModifier:SWHotKeyModifierOption object:self block:^(BOOL matched) {
-        dispatch_async(dispatch_get_main_queue(), ^{
-            @strongify(self);
-            if (!matched) {
-                [self.stateMachine endInvocation];
-            }
-        });
+        SWTraceScope("SWCoreWindowService hotkey: modifier");
+        @strongify(self);
+        if (!matched) {
+            self->_tapInvoked = false;
+            [self private_postInput:(SWInput){ .kind = SWInputKindEnd, .timestamp = SWTraceNow() }];
+        }
+    }];
+
+    // Keep key and scroll events from other applications while Switch is invoked.
+    [eventTap registerKeyEventSuppressorWithObject:self block:^BOOL{
+        @strongify(self);
+        return [self private_tapInvoked];
     }];
 }
 
@@ -243,6 +308,7 @@ static int const kScrollThreshold = 50;
     [eventTap removeBlockForHotKey:[SWHotKey hotKeyWithKeycode:kVK_ANSI_Comma modifiers:SWHotKeyModifierOption] object:self];
     [eventTap removeBlockForHotKey:[SWHotKey hotKeyWithKeycode:kVK_Escape modifiers:SWHotKeyModifierOption] object:self];
     [eventTap removeBlockForModifier:SWHotKeyModifierOption object:self];
+    [eventTap removeKeyEventSuppressorForObject:self];
 
     [super stopService];
 }
@@ -371,6 +437,93 @@ static int const kScrollThreshold = 50;
     self.displayTimer = nil;
 }
 
+// Called on the event tap's thread. Allocates nothing.
+- (BOOL)private_postInput:(SWInput)input;
+{
+    if (!Check(SWInputQueuePush(self->_inputs, &input))) {
+        return NO;
+    }
+    self->_tapInputsPosted += 1;
+    dispatch_source_merge_data(self->_inputSource, 1);
+    return YES;
+}
+
+// Called on the event tap's thread. Forgets an invocation once the main thread has ended it, however it ended.
+- (BOOL)private_tapInvoked;
+{
+    if (self->_tapInvoked && atomic_load(&self->_invocationEndedAfter) > self->_tapInvokedInput) {
+        self->_tapInvoked = false;
+    }
+    return self->_tapInvoked;
+}
+
+// Called on the event tap's thread.
+- (SWEventTapState)private_eventTapState;
+{
+    return atomic_load(&self->_eventTapState);
+}
+
+// Called on the event tap's thread. Whether the interface is showing, or would be by now if the main thread has fallen behind.
+- (BOOL)private_tapInterfaceVisible;
+{
+    if ([self private_eventTapState] & SWEventTapStateInterfaceVisible) {
+        return YES;
+    }
+    return [self private_tapInvoked] && SWTraceNanoseconds(SWTraceNow() - self->_tapInvokedAt) >= (uint64_t)(kWindowDisplayDelay * NSEC_PER_SEC);
+}
+
+- (void)private_updateEventTapState;
+{
+    SWEventTapState state = 0;
+    if (self.stateMachine.active) { state |= SWEventTapStateActive; }
+    if (self.stateMachine.interfaceVisible) { state |= SWEventTapStateInterfaceVisible; }
+    atomic_store(&self->_eventTapState, state);
+}
+
+- (void)private_handleInputs;
+{
+    SWInput input;
+    size_t count;
+    // Inputs that queued up while the main thread was busy are handled in one pass, with runs of key repeats applied as a single selection change.
+    while ((count = SWInputQueuePopCoalesced(self->_inputs, &input))) {
+        self->_inputsHandled += count;
+        switch (input.kind) {
+            case SWInputKindIncrement: {
+                SWTraceScope("SWCoreWindowService hotkey: update selection");
+                _Bool invokesInterface = !!(input.flags & SWInputFlagInvoke);
+                if (invokesInterface && !self.stateMachine.invoked) {
+                    SWTraceIntervalBegin(&SWInvocationTraceInterval, input.timestamp);
+                }
+                SWIncrementDirection direction = (input.flags & SWInputFlagDecreasing) ? SWIncrementDirectionDecreasing : SWIncrementDirectionIncreasing;
+                [self.stateMachine incrementWithInvoke:invokesInterface direction:direction isRepeating:!!(input.flags & SWInputFlagRepeating) count:count];
+                [self.scroller reset];
+                break;
+            }
+            case SWInputKindCloseWindow:
+                [self.stateMachine closeWindow];
+                break;
+            case SWInputKindCancel:
+                [self.stateMachine cancelInvocation];
+                break;
+            case SWInputKindEnd: {
+                SWTraceScope("SWCoreWindowService hotkey: end invocation");
+                [self.stateMachine endInvocation];
+                break;
+            }
+            case SWInputKindShowPreferences:
+                if (self.stateMachine.active) {
+                    @weakify(self);
+                    dispatch_async(dispatch_get_main_queue(), ^{
+                        @strongify(self);
+                        [[SWPreferencesService sharedService] showPreferencesWindow:self];
+                    });
+                }
+                [self.stateMachine cancelInvocation];
+                break;
+        }
+    }
+}
+
 - (void)private_showInterface;
 {
     @weakify(self);
@@ -398,6 +551,15 @@ static int const kScrollThreshold = 50;
     [self.interface shouldShowInterface:false];
 }
 
+- (void)private_updateCaptureDemand;
+{
+    if (self.stateMachine.interfaceVisible) {
+        [[SWWindowContentsService sharedService] setShownWindowGroups:self.stateMachine.windowList selectedWindowGroup:self.stateMachine.selectedWindow];
+    } else {
+        [[SWWindowContentsService sharedService] setShownWindowGroups:nil selectedWindowGroup:nil];
+    }
+}
+
 - (void)private_raiseWindowWithStartTime:(NSDate *)start;
 {
     SWWindow *selectedWindow = self.stateMachine.selectedWindow;
@@ -18,11 +18,12 @@
 typedef BOOL (^SWEventTapKeyFilter)(CGEventRef event);
 typedef void (^SWEventTapModifierCallback)(BOOL matched);
 typedef void (^SWEventTapCallback)(CGEventRef event);
+typedef BOOL (^SWEventTapSuppressor)(void);
 
 
 @interface SWEventTap : NNService
 
-@property (nonatomic, assign, readwrite) BOOL suppressKeyEvents;
+// Blocks are called on the event tap's thread, and should hand off any work that touches application state.
 
 // For key bindings. Block can return NO to stop the event's further propagation.
 - (void)registerHotKey:(SWHotKey *)hotKey object:(id)owner block:(SWEventTapKeyFilter)eventFilter;
@@ -36,4 +37,8 @@ typedef void (^SWEventTapCallback)(CGEventRef event);
 - (void)registerForEventsWithType:(CGEventType)eventType object:(id)owner block:(SWEventTapCallback)eventCallback;
 - (void)removeBlockForEventsWithType:(CGEventType)eventType object:(id)owner;
 
+// For consuming the keyboard. Asked about every key and scroll event that hot keys don't swallow, which is kept from other applications if any block returns YES.
+- (void)registerKeyEventSuppressorWithObject:(id)owner block:(SWEventTapSuppressor)suppressor;
+- (void)removeKeyEventSuppressorForObject:(id)owner;
+
 @end
@@ -17,12 +17,25 @@
 #import "SWEventTap.h"
 
 #import <NNKit/NNService+Protected.h>
+#import <stdatomic.h>
 
+#import "eventDispatch.h"
 #import "SWAPIEnabledWorker.h"
 #import "SWHotKey.h"
 
 
-@interface SWEventTap ()
+static void releaseHandler(const void *handler) { CFRelease(handler); }
+
+
+@interface SWEventTap () {
+    // The registrations below, compiled for eventCallback.
+    SWEventDispatcher *_dispatcher;
+    
+    // The tap is serviced by its own thread so that it keeps up while the main thread is busy.
+    CFRunLoopRef _threadRunLoop;
+    dispatch_semaphore_t _threadStopped;
+    _Atomic(bool) _threadStopping;
+}
 
 @property (nonatomic, assign, readwrite) CFMachPortRef eventTap;
 @property (nonatomic, assign, readwrite) SWHotKeyModifierKey modifiers;
@@ -31,6 +44,7 @@
 @property (nonatomic, strong, readonly) NSMutableDictionary *eventTypeCallbacks;
 @property (nonatomic, strong, readonly) NSMutableDictionary *modifierCallbacks;
 @property (nonatomic, strong, readonly) NSMutableDictionary *keyFilters;
+@property (nonatomic, strong, readonly) NSMutableDictionary *keySuppressors;
 
 @end
 
@@ -45,6 +59,10 @@ static CGEventRef eventCallback(CGEventTapProxy proxy, CGEventType type, CGEvent
     _eventTypeCallbacks = [NSMutableDictionary new];
     _modifierCallbacks = [NSMutableDictionary new];
     _keyFilters = [NSMutableDictionary new];
+    _keySuppressors = [NSMutableDictionary new];
+    _dispatcher = SWEventDispatcherCreate();
+    BailUnless(_dispatcher, nil);
+    [self private_publishDispatchTable];
     
     return self;
 }
@@ -52,6 +70,7 @@ static CGEventRef eventCallback(CGEventTapProxy proxy, CGEventType type, CGEvent
 - (void)dealloc;
 {
     [self private_removeEventTap];
+    SWEventDispatcherDestroy(self->_dispatcher);
 }
 
 #pragma mark - NNService
@@ -91,11 +110,15 @@ static CGEventRef eventCallback(CGEventTapProxy proxy, CGEventType type, CGEvent
     Assert(!self.keyFilters[hotKey][ownerKey]);
     
     [self.keyFilters[hotKey] setObject:eventFilter forKey:ownerKey];
+    [self private_publishDispatchTable];
 }
 
 - (void)removeBlockForHotKey:(SWHotKey *)hotKey object:(id)owner;
 {
+    SWLogMainThreadOnly();
+
     [self.keyFilters[hotKey] removeObjectForKey:@((uintptr_t)owner)];
+    [self private_publishDispatchTable];
 }
 
 - (void)registerModifier:(SWHotKeyModifierKey)modifiers object:(id)owner block:(SWEventTapModifierCallback)eventCallback;
@@ -112,11 +135,15 @@ static CGEventRef eventCallback(CGEventTapProxy proxy, CGEventType type, CGEvent
     Assert(!self.modifierCallbacks[@(modifiers)][ownerKey]);
     
     [self.modifierCallbacks[@(modifiers)] setObject:eventCallback forKey:@((uintptr_t)owner)];
+    [self private_publishDispatchTable];
 }
 
 - (void)removeBlockForModifier:(SWHotKeyModifierKey)modifiers object:(id)owner;
 {
+    SWLogMainThreadOnly();
+
     [self.modifierCallbacks[@(modifiers)] removeObjectForKey:@((uintptr_t)owner)];
+    [self private_publishDispatchTable];
 }
 
 - (void)registerForEventsWithType:(CGEventType)eventType object:(id)owner block:(SWEventTapCallback)eventCallback;
@@ -133,20 +160,83 @@ static CGEventRef eventCallback(CGEventTapProxy proxy, CGEventType type, CGEvent
     Assert(!self.eventTypeCallbacks[@(eventType)][ownerKey]);
     
     [self.eventTypeCallbacks[@(eventType)] setObject:eventCallback forKey:@((uintptr_t)owner)];
+    [self private_publishDispatchTable];
 }
 
 - (void)removeBlockForEventsWithType:(CGEventType)eventType object:(id)owner;
 {
+    SWLogMainThreadOnly();
+
     [self.eventTypeCallbacks[@(eventType)] removeObjectForKey:@((uintptr_t)owner)];
+    [self private_publishDispatchTable];
+}
+
+- (void)registerKeyEventSuppressorWithObject:(id)owner block:(SWEventTapSuppressor)suppressor;
+{
+    SWLogMainThreadOnly();
+
+    NSNumber *ownerKey = @((uintptr_t)owner);
+    
+    // I don't love this limitation, but removing it is complicated and enables questionable functionality anyway.
+    Assert(!self.keySuppressors[ownerKey]);
+    
+    [self.keySuppressors setObject:suppressor forKey:ownerKey];
+    [self private_publishDispatchTable];
+}
+
+- (void)removeKeyEventSuppressorForObject:(id)owner;
+{
+    SWLogMainThreadOnly();
+
+    [self.keySuppressors removeObjectForKey:@((uintptr_t)owner)];
+    [self private_publishDispatchTable];
 }
 
 #pragma mark - Internal
 
+// Registrations change rarely and events arrive constantly, so the work of organizing registrations happens here instead of in eventCallback.
+- (void)private_publishDispatchTable;
+{
+    NSMutableData *entries = [NSMutableData new];
+    void (^addEntries)(SWEventDispatchKind, uint32_t, NSDictionary *) = ^(SWEventDispatchKind kind, uint32_t key, NSDictionary *blocksByOwner) {
+        [blocksByOwner enumerateKeysAndObjectsUsingBlock:^(NSNumber *owner, id block, BOOL *stop) {
+            SWEventDispatchEntry entry = { .kind = kind, .key = key, .owner = owner.unsignedLongValue, .handler = CFBridgingRetain(block) };
+            [entries appendBytes:&entry length:sizeof(entry)];
+        }];
+    };
+    
+    [self.keyFilters enumerateKeysAndObjectsUsingBlock:^(SWHotKey *hotKey, NSDictionary *filters, BOOL *stop) {
+        addEntries(SWEventDispatchKindHotKey, SWEventDispatchHotKey(hotKey.code, (uint16_t)hotKey.modifiers), filters);
+    }];
+    [self.modifierCallbacks enumerateKeysAndObjectsUsingBlock:^(NSNumber *modifiers, NSDictionary *callbacks, BOOL *stop) {
+        addEntries(SWEventDispatchKindModifier, modifiers.unsignedIntValue, callbacks);
+    }];
+    [self.eventTypeCallbacks enumerateKeysAndObjectsUsingBlock:^(NSNumber *eventType, NSDictionary *callbacks, BOOL *stop) {
+        addEntries(SWEventDispatchKindEventType, eventType.unsignedIntValue, callbacks);
+    }];
+    addEntries(SWEventDispatchKindKeySuppressor, 0, self.keySuppressors);
+    
+    SWEventDispatchTable *table = SWEventDispatchTableCreate(entries.bytes, entries.length / sizeof(SWEventDispatchEntry), releaseHandler);
+    if (!Check(table)) {
+        return;
+    }
+    SWEventDispatcherPublish(self->_dispatcher, table);
+}
+
 // Called from dealloc, use direct ivar access.
 - (void)private_removeEventTap;
 {
+    if (self->_threadRunLoop) {
+        // The thread removes the run loop source on its way out. Wait for it so that no callback is running once this returns.
+        atomic_store(&self->_threadStopping, true);
+        CFRunLoopStop(self->_threadRunLoop);
+        dispatch_semaphore_wait(self->_threadStopped, DISPATCH_TIME_FOREVER);
+        CFRelease(self->_threadRunLoop);
+        self->_threadRunLoop = NULL;
+        self->_threadStopped = nil;
+    }
     if (self->_runLoopSource) {
-        CFRunLoopRemoveSource(CFRunLoopGetCurrent(), self->_runLoopSource, kCFRunLoopCommonModes);
+        CFRelease(self->_runLoopSource);
         self->_runLoopSource = NULL;
     }
     if (self->_eventTap) {
@@ -183,48 +273,69 @@ static CGEventRef eventCallback(CGEventTapProxy proxy, CGEventType type, CGEvent
         return NO;
     });
     
-    // Add to the current run loop.
-    CFRunLoopAddSource(CFRunLoopGetCurrent(), self.runLoopSource, kCFRunLoopCommonModes);
-    
-    // Enable the event tap.
-    CGEventTapEnable(self.eventTap, true);
+    // Service the tap on a dedicated thread. The thread adds the source to its run loop and enables the tap before signalling.
+    dispatch_semaphore_t started = dispatch_semaphore_create(0);
+    self->_threadStopped = dispatch_semaphore_create(0);
+    atomic_store(&self->_threadStopping, false);
+    NSThread *thread = [[NSThread alloc] initWithTarget:self selector:NNSelfSelector1(private_runEventTapWithStartedSemaphore:) object:started];
+    thread.name = @"SWEventTap";
+    thread.qualityOfService = NSQualityOfServiceUserInteractive;
+    [thread start];
+    dispatch_semaphore_wait(started, DISPATCH_TIME_FOREVER);
     
     return YES;
 }
 
-static CGEventRef eventCallback(CGEventTapProxy proxy, CGEventType type, CGEventRef event, void *refcon)
+- (void)private_runEventTapWithStartedSemaphore:(dispatch_semaphore_t)started;
 {
-#if DEBUG
-    Assert([NSThread isMainThread]);
-#endif
+    CFRunLoopRef runLoop = CFRunLoopGetCurrent();
+    self->_threadRunLoop = (CFRunLoopRef)CFRetain(runLoop);
+    CFRunLoopAddSource(runLoop, self->_runLoopSource, kCFRunLoopCommonModes);
+    CGEventTapEnable(self->_eventTap, true);
+    dispatch_semaphore_signal(started);
     
-    SWEventTap *eventTap = (__bridge SWEventTap *)refcon;
+    // A stop that lands before the run loop starts running is caught by the timeout.
+    while (!atomic_load(&self->_threadStopping)) {
+        @autoreleasepool {
+            CFRunLoopRunInMode(kCFRunLoopDefaultMode, 1.0, false);
+        }
+    }
+    
+    CGEventTapEnable(self->_eventTap, false);
+    CFRunLoopRemoveSource(runLoop, self->_runLoopSource, kCFRunLoopCommonModes);
+    dispatch_semaphore_signal(self->_threadStopped);
+}
 
-    //
-    // Event tap administration
-    //
-    if (type == kCGEventTapDisabledByTimeout) {
-        dispatch_async(dispatch_get_main_queue(), ^{
-            // Re-enable the event tap.
-            SWLog(@"Event tap timed out?!");
-            CGEventTapEnable(eventTap.eventTap, true);
-        });
-        return event;
-    } else if (type == kCGEventTapDisabledByUserInput) {
-        NotTested();
-        return event;
+// Suppressors are asked on the event tap's thread as each event arrives, so they answer from the registrant's own view of its state rather than whatever the main thread last published.
+static BOOL suppressesKeyEvents(const SWEventDispatchTable *table)
+{
+    const SWEventDispatchEntry *entries;
+    size_t count = SWEventDispatchTableEntries(table, SWEventDispatchKindKeySuppressor, &entries);
+    for (size_t i = 0; i < count; ++i) {
+        if (((__bridge SWEventTapSuppressor)entries[i].handler)()) {
+            return YES;
+        }
     }
+    return NO;
+}
+
+// Allocates nothing: registrations are read from the dispatch table, and blocks are called through it without being retained.
+static CGEventRef dispatchEvent(SWEventTap *eventTap, const SWEventDispatchTable *table, CGEventType type, CGEventRef event)
+{
+    const SWEventDispatchEntry *entries;
+    size_t count;
     
     //
     // Event type callbacks.
     //
-    for (SWEventTapCallback callback in [eventTap.eventTypeCallbacks[@(type)] allValues]) {
-        callback(event);
+    count = SWEventDispatchTableFind(table, SWEventDispatchKindEventType, type, &entries);
+    for (size_t i = 0; i < count; ++i) {
+        ((__bridge SWEventTapCallback)entries[i].handler)(event);
     }
     
     // Prevent other applications from receiving scroll events when the application is consuming keyboard events.
     if (type == kCGEventScrollWheel) {
-        return eventTap.suppressKeyEvents ? NULL : event;
+        return suppressesKeyEvents(table) ? NULL : event;
     }
     
     // Escape if the event is not a key/modifier change event.
@@ -235,27 +346,26 @@ static CGEventRef eventCallback(CGEventTapProxy proxy, CGEventType type, CGEvent
     //
     // Modifier key callbacks.
     //
-    SWHotKey *key = [SWHotKey hotKeyFromEvent:event];
+    SWHotKeyModifierKey modifiers = SWHotKeyModifiersFromEventFlags(CGEventGetFlags(event));
     if (type == kCGEventFlagsChanged) {
-        SWHotKeyModifierKey flagChanges = key.modifiers ^ eventTap.modifiers;
+        SWHotKeyModifierKey flagChanges = modifiers ^ eventTap.modifiers;
         
-        for (NSNumber *boxedRegisteredModifiers in eventTap.modifierCallbacks) {
-            SWHotKeyModifierKey registeredModifiers = boxedRegisteredModifiers.unsignedIntValue;
+        count = SWEventDispatchTableEntries(table, SWEventDispatchKindModifier, &entries);
+        for (size_t i = 0; i < count; ++i) {
+            SWHotKeyModifierKey registeredModifiers = entries[i].key;
             
             // Changes can't affect registrant.
             if (!(flagChanges & registeredModifiers)) continue;
             
             // Changes didn't affect registrant
             BOOL matched = (eventTap.modifiers & registeredModifiers) == registeredModifiers;
-            BOOL matches = (key.modifiers & registeredModifiers) == registeredModifiers;
+            BOOL matches = (modifiers & registeredModifiers) == registeredModifiers;
             if (matched == matches) continue;
             
-            for (SWEventTapModifierCallback callback in [eventTap.modifierCallbacks[boxedRegisteredModifiers] allValues]) {
-                callback(matches);
-            }
+            ((__bridge SWEventTapModifierCallback)entries[i].handler)(matches);
         }
         
-        eventTap.modifiers = key.modifiers;
+        eventTap.modifiers = modifiers;
         
         return event;
     }
@@ -263,16 +373,49 @@ static CGEventRef eventCallback(CGEventTapProxy proxy, CGEventType type, CGEvent
     //
     // Hotkey callbacks.
     //
-    
-    for (SWEventTapKeyFilter filter in [eventTap.keyFilters[key] allValues]) {
-        if (!filter(event)) {
+    CGKeyCode keycode = (CGKeyCode)CGEventGetIntegerValueField(event, kCGKeyboardEventKeycode);
+    count = SWEventDispatchTableFind(table, SWEventDispatchKindHotKey, SWEventDispatchHotKey(keycode, (uint16_t)modifiers), &entries);
+    for (size_t i = 0; i < count; ++i) {
+        if (!((__bridge SWEventTapKeyFilter)entries[i].handler)(event)) {
             event = NULL;
             break;
         }
     }
 
-    return eventTap.suppressKeyEvents ? NULL : event;
+    return (event && suppressesKeyEvents(table)) ? NULL : event;
 }
 
+static CGEventRef eventCallback(CGEventTapProxy proxy, CGEventType type, CGEventRef event, void *refcon)
+{
+#if DEBUG
+    Assert(![NSThread isMainThread]);
+#endif
+    SWTraceScope("SWEventTap eventCallback");
+    
+    SWEventTap *eventTap = (__bridge SWEventTap *)refcon;
+
+    //
+    // Event tap administration
+    //
+    if (type == kCGEventTapDisabledByTimeout) {
+        // Re-enable the event tap.
+        CGEventTapEnable(eventTap->_eventTap, true);
+        dispatch_async(dispatch_get_main_queue(), ^{
+            SWLog(@"Event tap timed out?!");
+        });
+        return event;
+    } else if (type == kCGEventTapDisabledByUserInput) {
+        NotTested();
+        return event;
+    }
+    
+    const SWEventDispatchTable *table = SWEventDispatcherBeginRead(eventTap->_dispatcher);
+    if (table) {
+        event = dispatchEvent(eventTap, table, type, event);
+    }
+    SWEventDispatcherEndRead(eventTap->_dispatcher);
+    
+    return event;
+}
 
 @end
@@ -41,6 +41,10 @@
 - (NSUInteger)HUDCollectionViewNumberOfCells:(SWHUDCollectionView *)view;
 - (NSView *)HUDCollectionView:(SWHUDCollectionView *)view viewForCellAtIndex:(NSUInteger)index;
 
+// Cells are kept across reloads by identifier, as long as their fingerprint doesn't change. Cells are only requested for identifiers that are new, or whose fingerprint changed.
+- (uint32_t)HUDCollectionView:(SWHUDCollectionView *)view identifierForCellAtIndex:(NSUInteger)index;
+- (uint64_t)HUDCollectionView:(SWHUDCollectionView *)view fingerprintForCellAtIndex:(NSUInteger)index;
+
 @end
 
 
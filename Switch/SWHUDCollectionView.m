@@ -14,9 +14,21 @@
 
 #import "SWHUDCollectionView.h"
 
-#import "NSLayoutConstraint+SWConstraintHelpers.h"
 #import "SWHUDView.h"
 #import "SWSelectionBoxView.h"
+#import "collectionUpdate.h"
+#import "gridLayout.h"
+
+
+static SWGridRect SWGridRectFromCGRect(CGRect rect)
+{
+    return (SWGridRect){ rect.origin.x, rect.origin.y, rect.size.width, rect.size.height };
+}
+
+static CGRect CGRectFromSWGridRect(SWGridRect rect)
+{
+    return CGRectMake(rect.x, rect.y, rect.width, rect.height);
+}
 
 
 @interface SWHUDCollectionView ()
@@ -25,14 +37,17 @@
 @property (nonatomic, assign, readwrite) CGFloat maxCellSize;
 @property (nonatomic, assign, readwrite) NSUInteger numberOfCells;
 @property (nonatomic, strong, readonly) NSMutableArray *cells;
+// One SWWindowListEntry per cell: its identifier and fingerprint.
+@property (nonatomic, strong, readwrite) NSData *cellEntries;
+// Cells discarded by the last reload, keyed by @[identifier, fingerprint], in case their windows come back.
+@property (nonatomic, strong, readwrite) NSMutableDictionary *reusePool;
 
 // Persistent views.
 @property (nonatomic, strong, readonly) SWHUDView *hud;
 @property (nonatomic, strong, readonly) SWSelectionBoxView *selectionBox;
 
-// Constraint tracking.
-@property (nonatomic, strong, readwrite) NSArray *selectionBoxConstraints;
-@property (nonatomic, strong, readwrite) NSArray *collectionConstraints;
+// Layout, created once maxCellSize is known.
+@property (nonatomic, assign, readwrite) SWGridLayoutCache *layoutCache;
 
 // Internal state.
 @property (nonatomic, assign, readwrite) BOOL reloading;
@@ -50,6 +65,8 @@
     BailUnless(self = [super initWithFrame:frame], nil);
     
     _cells = [NSMutableArray new];
+    _cellEntries = [NSData data];
+    _reusePool = [NSMutableDictionary new];
     _hud = [[SWHUDView alloc] initWithFrame:CGRectZero];
     _selectionBox = [[SWSelectionBoxView alloc] initWithFrame:CGRectZero];
     _selectedIndex = NSNotFound;
@@ -57,6 +74,11 @@
     return self;
 }
 
+- (void)dealloc;
+{
+    SWGridLayoutCacheDestroy(_layoutCache);
+}
+
 #pragma mark - NSResponder
 
 - (BOOL)acceptsFirstResponder;
@@ -120,15 +142,9 @@
 
 #pragma mark - NSView
 
-+ (BOOL)requiresConstraintBasedLayout;
-{
-    return YES;
-}
-
 - (void)viewWillMoveToSuperview:(NSView *)newSuperview;
 {
     if (![self.subviews containsObject:self.hud]) {
-        self.hud.translatesAutoresizingMaskIntoConstraints = NO;
         [self addSubview:self.hud];
     }
 
@@ -136,16 +152,10 @@
     [self selectCellAtIndex:self.selectedIndex];
 }
 
-- (void)updateConstraints;
+- (void)resizeSubviewsWithOldSize:(NSSize)oldSize;
 {
-    if (!self.collectionConstraints) {
-        [self private_updateConstraintsForCollection];
-    }
-
-    if (!self.selectionBoxConstraints) {
-        [self private_updateConstraintsForSelectionBox];
-    }
-    [super updateConstraints];
+    // Subviews are laid out by the grid, not autoresized.
+    [self private_layoutSubviews];
 }
 
 #pragma mark - SWHUDCollectionView
@@ -178,11 +188,7 @@
     
     self.selectedIndex = index;
     
-    if (self.selectedIndex < self.numberOfCells) {
-        [self private_constraintsForSelectionBoxNeedUpdate];
-    } else if ([self.hud.subviews containsObject:self.selectionBox]) {
-        [self.selectionBox removeFromSuperview];
-    }
+    [self private_layoutSelectionBox];
 }
 
 - (void)deselectCell;
@@ -207,16 +213,14 @@
 
 - (NSUInteger)private_indexForCellAtPoint:(NSPoint)point;
 {
-    for (NSUInteger i = 0; i < self.numberOfCells; ++i) {
-        NSPoint relativePoint = [self convertPoint:point toView:self.cells[i]];
-        CGRect cellFrame = CLASS_CAST(NSView, self.cells[i]).bounds;
-        
-        if (NSPointInRect(relativePoint, cellFrame)) {
-            return i;
-        }
-    }
+    // Cells are where the grid put them, so the cell under the point comes straight from the layout.
+    const SWGridLayout *layout = [self private_layout];
+    if (!layout) { return NSNotFound; }
     
-    return NSNotFound;
+    NSPoint localPoint = [self convertPoint:point fromView:nil];
+    size_t index = SWGridLayoutCellAtPoint(layout, localPoint.x, localPoint.y);
+    
+    return index < self.numberOfCells ? index : NSNotFound;
 }
 
 - (void)private_reloadDataIfNeeded;
@@ -229,6 +233,8 @@
         self.numberOfCells = 0;
         [self.cells makeObjectsPerformSelector:NNTypedSelector(NSView, removeFromSuperview)];
         [self.cells removeAllObjects];
+        self.cellEntries = [NSData data];
+        [self.reusePool removeAllObjects];
     };
     
     self.reloading = NO;
@@ -241,168 +247,131 @@
         BailWithBlockUnless(!self.reloading, cleanupData);
     }
     
-    cleanupData();
-    
-    self.numberOfCells = [dataSource HUDCollectionViewNumberOfCells:self];
+    NSUInteger numberOfCells = [dataSource HUDCollectionViewNumberOfCells:self];
     // dataSource side effect may have called reloadData, in which case it's not safe to continue anymore.
     BailWithBlockUnless(!self.reloading, cleanupData);
     
-    for (NSUInteger i = 0; i < self.numberOfCells; i++) {
-        NSView *cell = [dataSource HUDCollectionView:self viewForCellAtIndex:i];
+    NSMutableData *cellEntries = [NSMutableData dataWithLength:numberOfCells * sizeof(SWWindowListEntry)];
+    SWWindowListEntry *newEntries = cellEntries.mutableBytes;
+    for (NSUInteger i = 0; i < numberOfCells; i++) {
+        newEntries[i].windowID = [dataSource HUDCollectionView:self identifierForCellAtIndex:i];
+        newEntries[i].fingerprint = [dataSource HUDCollectionView:self fingerprintForCellAtIndex:i];
         // dataSource side effect may have called reloadData, in which case it's not safe to continue anymore.
         BailWithBlockUnless(!self.reloading, cleanupData);
-        
-        [self.cells insertObject:cell atIndex:i];
-        [self.hud addSubview:cell];
     }
     
-    if (self.selectionBox) {
-        [self.hud addSubview:self.selectionBox positioned:NSWindowBelow relativeTo:nil];
-    }
+    size_t oldCount = self.cells.count;
+    NSMutableData *planBuffer = [NSMutableData dataWithLength:numberOfCells * sizeof(SWCollectionUpdateCell) + oldCount * sizeof(size_t)];
+    SWCollectionUpdateCell *plan = planBuffer.mutableBytes;
+    size_t *discarded = (size_t *)(plan + numberOfCells);
+    size_t discardCount = SWCollectionUpdatePlan(self.cellEntries.bytes, oldCount, newEntries, numberOfCells, plan, discarded);
     
-    [self private_constraintsForCollectionNeedUpdate];
-    [self private_constraintsForSelectionBoxNeedUpdate];
-}
-
-- (void)private_constraintsForCollectionNeedUpdate;
-{
-    if (self.collectionConstraints) {
-        [self removeConstraints:self.collectionConstraints];
-        self.collectionConstraints = nil;
-    }
-    [self setNeedsUpdateConstraints:YES];
-}
-
-- (void)private_updateConstraintsForCollection;
-{
-    if (!Check(!self.collectionConstraints.count)) {
-        [self removeConstraints:self.collectionConstraints];
-        self.collectionConstraints = nil;
-    }
-
-    NSMutableArray *constraints = [NSMutableArray new];
-
-    NSDictionary *views = @{
-        @"hud" : self.hud,
-        @"collection" : self,
-    };
-
-    NSDictionary *metrics = @{
-        @"hudPadding" : @(kNNScreenToWindowInset),
-        @"cellPadding" : @(kNNWindowToThumbInset),
-        @"maxThumbSize" : @(self.maxCellSize),
-        @"emptyHUDSize" : @(self.maxCellSize + (kNNWindowToThumbInset * 2.0)),
-        @"windowWidth" : @(self.frame.size.width),
-        @"windowHeight" : @(self.frame.size.height),
-    };
-
-    // Maintain the size of the frame in case there are too many objects in the collection and Auto Layout attempts to enlarge it.
-    [constraints addObjectsFromArray:[NSLayoutConstraint constraintsWithVisualFormat:@"H:[collection(windowWidth)]" options:NSLayoutFormatAlignAllCenterY metrics:metrics views:views]];
-    [constraints addObjectsFromArray:[NSLayoutConstraint constraintsWithVisualFormat:@"V:[collection(windowHeight)]" options:NSLayoutFormatAlignAllCenterY metrics:metrics views:views]];
+    // Collect the new list of cells before touching the view hierarchy, so bailing out leaves nothing half-applied.
+    NSMutableArray *cells = [NSMutableArray arrayWithCapacity:numberOfCells];
+    NSMutableIndexSet *insertedIndexes = [NSMutableIndexSet new];
+    for (NSUInteger i = 0; i < numberOfCells; i++) {
+        if (plan[i].oldIndex != SIZE_MAX) {
+            [cells addObject:self.cells[plan[i].oldIndex]];
+            continue;
+        }
     
-    // Center the HUD inside its container view.
-    [constraints addObjectsFromArray:[NSLayoutConstraint sw_constraintsCenteringView:self.hud toView:self]];
-
-    // Establish flexible minimum HUD size, for when there are no cells to display.
-    [constraints addObjectsFromArray:[NSLayoutConstraint constraintsWithVisualFormat:@"H:[hud(>=emptyHUDSize@500)]" options:NSLayoutFormatAlignAllCenterY metrics:metrics views:views]];
-    [constraints addObjectsFromArray:[NSLayoutConstraint constraintsWithVisualFormat:@"V:[hud(>=emptyHUDSize@500)]" options:NSLayoutFormatAlignAllCenterY metrics:metrics views:views]];
-
-    // Ensure that the hud always has a minimum padding within its container view.
-    [constraints addObjectsFromArray:[NSLayoutConstraint constraintsWithVisualFormat:@"H:|-(>=hudPadding)-[hud]-(>=hudPadding)-|" options:NSLayoutFormatAlignAllCenterY metrics:metrics views:views]];
-    [constraints addObjectsFromArray:[NSLayoutConstraint constraintsWithVisualFormat:@"V:|-(>=hudPadding)-[hud]-(>=hudPadding)-|" options:NSLayoutFormatAlignAllCenterY metrics:metrics views:views]];
-
-    for (NSUInteger i = 0; i < self.numberOfCells; i++) {
-        NSView *prevCell = i != 0 ? self.cells[i - 1] : nil;
-        NSView *cell = self.cells[i];
-        NSView *nextCell = i < (self.numberOfCells - 1) ? self.cells[i + 1] : nil;
-
-        NSDictionary *cellViews = @{
-            @"prevCell" : prevCell ?: [NSNull null],
-            @"cell": cell,
-            @"nextCell" : nextCell ?: [NSNull null],
-            @"hud" : self.hud,
-        };
-
-        if (!prevCell) {
-            // First cell in the collection establishes the size that all of the others follow. Max size, with lower priority so it will be compromised if layout pressure exists due to too many cells.
-            [constraints addObjectsFromArray:[NSLayoutConstraint constraintsWithVisualFormat:@"[cell(maxThumbSize@750)]" options:NSLayoutFormatAlignAllCenterY metrics:metrics views:cellViews]];
-
-            // First cell in the collection must have RHS padding to its superview (the hud).
-            [constraints addObjectsFromArray:[NSLayoutConstraint constraintsWithVisualFormat:@"H:|-(cellPadding)-[cell]" options:NSLayoutFormatAlignAllCenterY metrics:metrics views:cellViews]];
+        id poolKey = @[@(newEntries[i].windowID), @(newEntries[i].fingerprint)];
+        NSView *cell = self.reusePool[poolKey];
+        if (cell) {
+            [self.reusePool removeObjectForKey:poolKey];
         } else {
-            // Non-first cells set their width (and thus their size due to the aspect ratio constraint) to be equal to the first cell's width.
-            [constraints addObject:[NSLayoutConstraint constraintWithItem:cell attribute:NSLayoutAttributeWidth
-                                                             relatedBy:NSLayoutRelationEqual
-                                                                toItem:self.cells[0] attribute:NSLayoutAttributeWidth
-                                                            multiplier:1.f constant:0.f]];
-
-            // Middle cells in the collection must have LHS padding to their neighbouring cell.
-            [constraints addObjectsFromArray:[NSLayoutConstraint constraintsWithVisualFormat:@"H:[prevCell]-(cellPadding)-[cell]" options:NSLayoutFormatAlignAllCenterY metrics:metrics views:cellViews]];
+            cell = [dataSource HUDCollectionView:self viewForCellAtIndex:i];
+            // dataSource side effect may have called reloadData, in which case it's not safe to continue anymore.
+            BailWithBlockUnless(!self.reloading, cleanupData);
         }
-
-        // Cells have a fixed aspect ratio (square).
-        [constraints addObject:[NSLayoutConstraint constraintWithItem:cell attribute:NSLayoutAttributeHeight
-                                                         relatedBy:NSLayoutRelationEqual
-                                                            toItem:cell attribute:NSLayoutAttributeWidth
-                                                        multiplier:1.f constant:0.f]];
-
-        // Cell must have top/bottom padding to its superview (the hud).
-        [constraints addObjectsFromArray:[NSLayoutConstraint constraintsWithVisualFormat:@"V:|-(cellPadding)-[cell]-(cellPadding)-|" options:NSLayoutFormatAlignAllCenterY metrics:metrics views:cellViews]];
-
-        if (!nextCell) {
-            // Last cell in the collection must have LHS padding to its superview (the hud).
-            [constraints addObjectsFromArray:[NSLayoutConstraint constraintsWithVisualFormat:@"H:[cell]-(cellPadding)-|" options:NSLayoutFormatAlignAllCenterY metrics:metrics views:cellViews]];
+    
+        [cells addObject:cell];
+        [insertedIndexes addIndex:i];
+    }
+    
+    // Pooled cells only outlive one reload, which is enough to cover windows that briefly drop out of the list.
+    const SWWindowListEntry *oldEntries = self.cellEntries.bytes;
+    NSMutableDictionary *reusePool = [NSMutableDictionary new];
+    for (size_t i = 0; i < discardCount; i++) {
+        NSView *cell = self.cells[discarded[i]];
+        [cell removeFromSuperview];
+        reusePool[@[@(oldEntries[discarded[i]].windowID), @(oldEntries[discarded[i]].fingerprint)]] = cell;
+    }
+    self.reusePool = reusePool;
+    
+    // Only new cells fade in, and only if the collection was already showing something.
+    BOOL animated = oldCount > 0;
+    for (NSView *cell in [cells objectsAtIndexes:insertedIndexes]) {
+        if (animated) {
+            cell.alphaValue = 0.0;
         }
+        [self.hud addSubview:cell];
+    }
+    
+    [self.cells setArray:cells];
+    self.cellEntries = cellEntries;
+    self.numberOfCells = numberOfCells;
+    
+    [self private_layoutSubviews];
+    
+    if (animated && insertedIndexes.count) {
+        [NSAnimationContext runAnimationGroup:^(NSAnimationContext *context) {
+            context.duration = durationOfCellInsertionFade;
+            for (NSView *cell in [cells objectsAtIndexes:insertedIndexes]) {
+                cell.animator.alphaValue = 1.0;
+            }
+        } completionHandler:nil];
     }
-
-    self.collectionConstraints = [constraints copy];
-    [self addConstraints:self.collectionConstraints];
 }
 
-- (void)private_constraintsForSelectionBoxNeedUpdate;
+- (const SWGridLayout *)private_layout;
 {
-    if (self.selectionBoxConstraints) {
-        [self removeConstraints:self.selectionBoxConstraints];
-        self.selectionBoxConstraints = nil;
+    // Nothing can be laid out until the data source has said how big cells can be.
+    if (self.maxCellSize == 0) { return NULL; }
+
+    if (!self.layoutCache) {
+        self.layoutCache = SWGridLayoutCacheCreate((SWGridMetrics){
+            .maxCellSize = self.maxCellSize,
+            .cellPadding = kNNWindowToThumbInset,
+            .boundsInset = kNNScreenToWindowInset,
+        });
+        BailUnless(self.layoutCache, NULL);
     }
-    [self setNeedsUpdateConstraints:YES];
+
+    return SWGridLayoutCacheGet(self.layoutCache, SWGridRectFromCGRect(self.bounds), self.numberOfCells);
 }
 
-- (void)private_updateConstraintsForSelectionBox;
+- (void)private_layoutSubviews;
 {
-    if (!Check(!self.selectionBoxConstraints.count)) {
-        [self removeConstraints:self.selectionBoxConstraints];
-        self.selectionBoxConstraints = nil;
+    const SWGridLayout *layout = [self private_layout];
+    if (!layout) { return; }
+
+    self.hud.frame = CGRectFromSWGridRect(layout->hudFrame);
+    for (NSUInteger i = 0; i < self.numberOfCells; i++) {
+        CLASS_CAST(NSView, self.cells[i]).frame = CGRectFromSWGridRect(layout->cellFrames[i]);
     }
 
-    NSMutableArray *constraints = [NSMutableArray new];
+    [self private_layoutSelectionBox];
+}
 
-    if (self.selectedIndex < self.numberOfCells) {
-        Check(self.selectionBox);
-        
-        // Selection box (re)insertion into the view hierarchy happens during layout-time to prevent the box appearing to jump between its old location (pre-deselection) and its new location.
-        if (![self.hud.subviews containsObject:self.selectionBox]) {
-            [self.hud addSubview:self.selectionBox positioned:NSWindowBelow relativeTo:nil];
+- (void)private_layoutSelectionBox;
+{
+    const SWGridLayout *layout = self.selectedIndex < self.numberOfCells ? [self private_layout] : NULL;
+    if (!layout) {
+        if ([self.hud.subviews containsObject:self.selectionBox]) {
+            [self.selectionBox removeFromSuperview];
         }
+        return;
+    }
 
-        NSView *selectedView = self.cells[self.selectedIndex];
-
-        // Constraint: selection box must be centered over selection thumb
-        [constraints addObjectsFromArray:[NSLayoutConstraint sw_constraintsCenteringView:self.selectionBox toView:selectedView]];
+    // Selection box is centered over the selected thumb, and larger than it by a constant.
+    CGFloat outset = (kNNWindowToThumbInset + kNNItemBorderWidth) / 2.0;
+    self.selectionBox.frame = NSInsetRect(CGRectFromSWGridRect(layout->cellFrames[self.selectedIndex]), -outset, -outset);
 
-        // Selection box height and width must be thumb [height|width] + const
-        [constraints addObject:[NSLayoutConstraint constraintWithItem:self.selectionBox attribute:NSLayoutAttributeWidth
-                                                         relatedBy:NSLayoutRelationEqual
-                                                            toItem:selectedView attribute:NSLayoutAttributeWidth
-                                                        multiplier:1.f constant:(kNNWindowToThumbInset + kNNItemBorderWidth)]];
-        [constraints addObject:[NSLayoutConstraint constraintWithItem:self.selectionBox attribute:NSLayoutAttributeHeight
-                                                         relatedBy:NSLayoutRelationEqual
-                                                            toItem:selectedView attribute:NSLayoutAttributeHeight
-                                                        multiplier:1.f constant:(kNNWindowToThumbInset + kNNItemBorderWidth)]];
+    // The box's frame is set before it's (re)inserted into the view hierarchy to prevent it appearing to jump between its old location (pre-deselection) and its new location.
+    if (![self.hud.subviews containsObject:self.selectionBox]) {
+        [self.hud addSubview:self.selectionBox positioned:NSWindowBelow relativeTo:nil];
     }
-
-    self.selectionBoxConstraints = [constraints copy];
-    [self addConstraints:self.selectionBoxConstraints];
 }
 
 @end
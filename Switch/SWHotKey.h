@@ -23,6 +23,23 @@ typedef NS_OPTIONS(unsigned, SWHotKeyModifierKey) {
     SWHotKeyModifierCmd      = cmdKey,
 };
 
+static inline SWHotKeyModifierKey SWHotKeyModifiersFromEventFlags(CGEventFlags flags) {
+    SWHotKeyModifierKey modifiers = 0;
+    if ((flags & kCGEventFlagMaskAlternate) == kCGEventFlagMaskAlternate) {
+        modifiers |= SWHotKeyModifierOption;
+    }
+    if ((flags & kCGEventFlagMaskShift) == kCGEventFlagMaskShift) {
+        modifiers |= SWHotKeyModifierShift;
+    }
+    if ((flags & kCGEventFlagMaskControl) == kCGEventFlagMaskControl) {
+        modifiers |= SWHotKeyModifierControl;
+    }
+    if ((flags & kCGEventFlagMaskCommand) == kCGEventFlagMaskCommand) {
+        modifiers |= SWHotKeyModifierCmd;
+    }
+    return modifiers;
+}
+
 
 @interface SWHotKey : NSObject <NSCopying>
 
@@ -85,20 +85,7 @@ static NSDictionary *specialKeys = nil;
 
 + (SWHotKey *)hotKeyFromEvent:(CGEventRef)event;
 {
-    SWHotKeyModifierKey modifiers = 0;
-    if ((CGEventGetFlags(event) & kCGEventFlagMaskAlternate) == kCGEventFlagMaskAlternate) {
-        modifiers |= SWHotKeyModifierOption;
-    }
-    if ((CGEventGetFlags(event) & kCGEventFlagMaskShift) == kCGEventFlagMaskShift) {
-        modifiers |= SWHotKeyModifierShift;
-    }
-    if ((CGEventGetFlags(event) & kCGEventFlagMaskControl) == kCGEventFlagMaskControl) {
-        modifiers |= SWHotKeyModifierControl;
-    }
-    if ((CGEventGetFlags(event) & kCGEventFlagMaskCommand) == kCGEventFlagMaskCommand) {
-        modifiers |= SWHotKeyModifierCmd;
-    }
-    
+    SWHotKeyModifierKey modifiers = SWHotKeyModifiersFromEventFlags(CGEventGetFlags(event));
     CGKeyCode keycode = (CGKeyCode)CGEventGetIntegerValueField(event, kCGKeyboardEventKeycode);
 
     return [self hotKeyWithKeycode:keycode modifiers:modifiers];
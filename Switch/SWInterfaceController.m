@@ -18,6 +18,7 @@
 #import "SWCoreWindowController.h"
 #import "SWEventTap.h"
 #import "SWPreferencesService.h"
+#import "SWScreenTopology.h"
 #import "SWWindow.h"
 
 
@@ -157,8 +158,9 @@
     }();
 
     // …and each value is a windowList of the windows on that screen.
+    SWScreenTopology *topology = [SWScreenTopology currentTopology];
     for (SWWindow *window in windowList) {
-        NSNumber *screenNumber = @([window screen].sw_screenNumber);
+        NSNumber *screenNumber = @([topology displayIDForFlippedFrame:window.flippedFrame]);
 
         /** This shouldn't be possible! We just built windowsByScreen.
          * I think Past Me intended this to check self.windowControllersByScreenID[screenNumber],
@@ -184,6 +186,7 @@
 - (void)private_showInterface;
 {
     SWLogMainThreadOnly();
+    SWTraceScope("SWInterfaceController private_showInterface");
     Check(self.windowList);
     Check(!self.windowControllersByScreenID);
 
@@ -235,9 +238,11 @@
     // layoutSubviewsIfNeeded isn't instant due to Auto Layout magic, so let everything take effect before showing the window.
     dispatch_async(dispatch_get_main_queue(), ^{
         if (self.showInterface) {
+            SWTraceScope("SWInterfaceController orderFront:");
             for (SWCoreWindowController *windowController in self.windowControllersByScreenID.allValues) {
                 [windowController.window orderFront:self];
             }
+            SWTraceIntervalEnd(&SWInvocationTraceInterval, "invocation");
         }
     });
 }
@@ -14,15 +14,22 @@
 
 #import <Foundation/Foundation.h>
 
+#import "trace.h"
+
 
 @interface SWLoggingService : NNService
 
 - (NSString *)logDirectoryPath;
 - (void)rotateLogIfNecessary;
 - (void)takeWindowListSnapshot;
+// Writes the spans traced so far to the log directory, as Chrome trace-event JSON and as a summary of each span's latency percentiles.
+- (void)takeTraceSnapshot;
 
 @end
 
+// From the hotkey that invokes the interface to the interface's first appearance on screen.
+extern SWTraceInterval SWInvocationTraceInterval;
+
 #define SWLog(fmt, ...) do { \
         [[SWLoggingService sharedService] rotateLogIfNecessary]; \
         Log(fmt, ##__VA_ARGS__); \
@@ -46,6 +53,7 @@
 
 #define SWTimeTask(codeBlock, fmt, ...) do { \
         NSDate *start = [NSDate new]; \
+        SWTraceScope(__PRETTY_FUNCTION__); \
         codeBlock \
         NSString *logmsg = [NSString stringWithFormat:fmt, ##__VA_ARGS__]; \
         NSTimeInterval elapsed = -[start timeIntervalSinceNow]; \
@@ -18,6 +18,13 @@
 #import "SWWindowListService.h"
 
 
+SWTraceInterval SWInvocationTraceInterval;
+
+// Enough for every thread's ring buffer several times over.
+static const size_t kSWTraceSnapshotCapacity = 16 * SWTraceBufferCapacity;
+static const size_t kSWTraceSnapshotMaxNames = 64;
+
+
 @interface SWLoggingService ()
 
 @property (nonatomic, strong) NSDateComponents *logDate;
@@ -141,6 +148,46 @@
     handle = nil;
 }
 
+- (void)takeTraceSnapshot;
+{
+    SWTraceEvent *events = calloc(kSWTraceSnapshotCapacity, sizeof(*events));
+    SWTraceSummary *summaries = calloc(kSWTraceSnapshotMaxNames, sizeof(*summaries));
+    BailWithBlockUnless(events && summaries, ^{
+        free(events);
+        free(summaries);
+    });
+    size_t count = SWTraceCopyEvents(events, kSWTraceSnapshotCapacity, 0);
+    size_t summaryCount = SWTraceSummarize(events, count, summaries, kSWTraceSnapshotMaxNames);
+    
+    NSString *logDir = [self logDirectoryPath];
+    uint64_t timestamp = (uint64_t)[[NSDate date] timeIntervalSince1970];
+    
+    if ([self private_createDirectory:logDir]) {
+        NSString *traceFile = [logDir stringByAppendingPathComponent:[NSString stringWithFormat:@"trace-%llu.json", timestamp]];
+        FILE *file = fopen(traceFile.fileSystemRepresentation, "w");
+        if (!file || !SWTraceWriteChromeJSON(events, count, file)) {
+            Log(@"Failed to write trace to %@", traceFile);
+        }
+        if (file) {
+            fclose(file);
+        }
+        
+        NSMutableString *summary = [NSMutableString new];
+        for (size_t i = 0; i < summaryCount; ++i) {
+            const SWTraceHistogram *durations = &summaries[i].durations;
+            [summary appendFormat:@"%s: %llu spans, p50 %.3fms, p99 %.3fms, p99.9 %.3fms, max %.3fms\n", summaries[i].name, durations->count, SWTraceHistogramPercentile(durations, 50.0) / 1e6, SWTraceHistogramPercentile(durations, 99.0) / 1e6, SWTraceHistogramPercentile(durations, 99.9) / 1e6, durations->max / 1e6];
+        }
+        NSString *summaryFile = [logDir stringByAppendingPathComponent:[NSString stringWithFormat:@"latency-%llu.txt", timestamp]];
+        NSError *error = nil;
+        if (![summary writeToFile:summaryFile atomically:YES encoding:NSUTF8StringEncoding error:&error]) {
+            Log(@"Failed to write latency summary to %@: %@", summaryFile, error);
+        }
+    }
+    
+    free(events);
+    free(summaries);
+}
+
 #pragma mark - Internal
 
 - (NSString *)private_logFilePath;
@@ -24,6 +24,10 @@
 @property (nonatomic, assign, readwrite) _Bool multimonGroupByMonitor;
 @property (nonatomic, assign, readwrite) _Bool showStatusItem;
 @property (nonatomic, strong, readwrite, null_resettable) NSString *appcastURL;
+// Application quirks, as arrays of quirk names (see windowTable.h) keyed by window owner name. They replace the quirks Switch knows about for the same application, and are read when the window list service starts.
+@property (nonatomic, strong, readwrite, null_resettable) NSDictionary *windowQuirks;
+// The most memory, in bytes, kept for thumbnails of windows between invocations of the interface, so they can be shown before the windows are captured again.
+@property (nonatomic, strong, readwrite, null_resettable) NSNumber *thumbnailCacheSize;
 
 - (void)showPreferencesWindow:(nonnull id)sender;
 
@@ -37,6 +37,8 @@ static NSString const * const kSWMultimonInterfaceKey = @"multimonInterface";
 static NSString const * const kSWMultimonGroupByMonitorKey = @"multimonGroupByMonitor";
 static NSString const * const kSWShowStatusItemKey = @"showStatusItem";
 static NSString const * const kSWAppcastURLKey = @"SUFeedURL";
+static NSString const * const kSWWindowQuirksKey = @"windowQuirks";
+static NSString const * const kSWThumbnailCacheSizeKey = @"thumbnailCacheSize";
 
 
 @interface SWPreferencesService ()
@@ -118,6 +120,8 @@ generateBoolPropertyMethods(setMultimonInterface:, multimonInterface, kSWMultimo
 generateBoolPropertyMethods(setMultimonGroupByMonitor:, multimonGroupByMonitor, kSWMultimonGroupByMonitorKey)
 generateBoolPropertyMethods(setShowStatusItem:, showStatusItem, kSWShowStatusItemKey)
 generateObjectPropertyMethods(setAppcastURL:, appcastURL, kSWAppcastURLKey)
+generateObjectPropertyMethods(setWindowQuirks:, windowQuirks, kSWWindowQuirksKey)
+generateObjectPropertyMethods(setThumbnailCacheSize:, thumbnailCacheSize, kSWThumbnailCacheSizeKey)
 
 #pragma mark Preferences: default values
 
@@ -132,6 +136,8 @@ generateObjectPropertyMethods(setAppcastURL:, appcastURL, kSWAppcastURLKey)
             kSWMultimonGroupByMonitorKey : @NO,
             kSWShowStatusItemKey : @YES,
             kSWAppcastURLKey : @"https://raw.github.com/numist/Switch/develop/appcast.xml",
+            kSWWindowQuirksKey : @{},
+            kSWThumbnailCacheSizeKey : @(8 * 1024 * 1024),
         };
     });
     return _defaultValues;
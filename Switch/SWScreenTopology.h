@@ -0,0 +1,40 @@
+//
+//  SWScreenTopology.h
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#import <Cocoa/Cocoa.h>
+
+#import "windowTable.h"
+
+
+// An immutable snapshot of the screen configuration, for assigning windows to screens without querying every screen for every window.
+@interface SWScreenTopology : NSObject
+
+// The snapshot for the current configuration. It is cached until the screen configuration or the main screen changes, so callers that assign many windows should fetch it once and hold on to it for the duration of the pass.
++ (instancetype)currentTopology;
+
+- (instancetype)initWithScreens:(NSArray *)screens mainScreen:(NSScreen *)mainScreen;
+
+@property (nonatomic, copy, readonly) NSArray *screens;
+@property (nonatomic, strong, readonly) NSScreen *mainScreen;
+@property (nonatomic, assign, readonly) CGFloat totalScreenHeight;
+
+// The screen that frame (in window list coordinates) overlaps the most, or nil if there are no screens.
+- (NSScreen *)screenForFlippedFrame:(CGRect)flippedFrame;
+// As above, but the screen's display ID, or 0 if there are no screens.
+- (CGDirectDisplayID)displayIDForFlippedFrame:(CGRect)flippedFrame;
+
+// Sets the screen of every row of table to the index in screens of the screen it overlaps the most.
+- (void)assignScreensInWindowTable:(SWWindowTable *)table;
+
+@end
@@ -0,0 +1,97 @@
+//
+//  SWScreenTopology.m
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#import "SWScreenTopology.h"
+
+#import "displayTopology.h"
+#import "NSScreen+SWAdditions.h"
+
+
+static SWScreenTopology *currentTopology;
+
+
+@implementation SWScreenTopology {
+    SWDisplayTopology _topology;
+}
+
+#pragma mark - Initialization
+
++ (void)initialize;
+{
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        [[NSNotificationCenter defaultCenter] addObserverForName:NSApplicationDidChangeScreenParametersNotification object:nil queue:nil usingBlock:^(NSNotification *note) {
+            @synchronized([SWScreenTopology class]) {
+                currentTopology = nil;
+            }
+        }];
+    });
+}
+
++ (instancetype)currentTopology;
+{
+    // The main screen follows keyboard focus, so it can change without the screen parameters changing.
+    NSScreen *mainScreen = [NSScreen mainScreen];
+    
+    @synchronized([SWScreenTopology class]) {
+        if (!currentTopology || currentTopology.mainScreen != mainScreen) {
+            currentTopology = [[SWScreenTopology alloc] initWithScreens:[NSScreen screens] mainScreen:mainScreen];
+        }
+        return currentTopology;
+    }
+}
+
+- (instancetype)initWithScreens:(NSArray *)screens mainScreen:(NSScreen *)mainScreen;
+{
+    BailUnless(self = [super init], nil);
+    BailUnless(SWDisplayTopologyInit(&self->_topology, screens.count), nil);
+    
+    _screens = [screens copy];
+    _mainScreen = mainScreen;
+    
+    for (NSScreen *screen in screens) {
+        CGRect bounds = CGDisplayBounds(screen.sw_screenNumber);
+        SWDisplayTopologyAddDisplay(&self->_topology, screen.sw_screenNumber, (SWWindowTableRect){ .x = bounds.origin.x, .y = bounds.origin.y, .width = bounds.size.width, .height = bounds.size.height }, screen == mainScreen);
+    }
+    
+    _totalScreenHeight = [NSScreen sw_totalScreenHeightOfScreens:screens];
+    
+    return self;
+}
+
+- (void)dealloc;
+{
+    SWDisplayTopologyDestroy(&self->_topology);
+}
+
+#pragma mark - SWScreenTopology
+
+- (NSScreen *)screenForFlippedFrame:(CGRect)flippedFrame;
+{
+    size_t display = SWDisplayTopologyDisplayForRect(&self->_topology, (SWWindowTableRect){ .x = flippedFrame.origin.x, .y = flippedFrame.origin.y, .width = flippedFrame.size.width, .height = flippedFrame.size.height });
+    return display != SIZE_MAX ? self.screens[display] : nil;
+}
+
+- (CGDirectDisplayID)displayIDForFlippedFrame:(CGRect)flippedFrame;
+{
+    size_t display = SWDisplayTopologyDisplayForRect(&self->_topology, (SWWindowTableRect){ .x = flippedFrame.origin.x, .y = flippedFrame.origin.y, .width = flippedFrame.size.width, .height = flippedFrame.size.height });
+    return display != SIZE_MAX ? self->_topology.displayIDs[display] : 0;
+}
+
+- (void)assignScreensInWindowTable:(SWWindowTable *)table;
+{
+    SWDisplayTopologyAssignScreens(&self->_topology, table);
+}
+
+@end
@@ -25,7 +25,6 @@
     
     self.border = kNNItemBorderWidth;
     self.radius = kNNSelectionRoundRectRadius;
-    self.translatesAutoresizingMaskIntoConstraints = NO;
     
     return self;
 }
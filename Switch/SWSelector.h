@@ -18,6 +18,7 @@
 @class SWWindow;
 
 
+// Selectors are backed by an SWSelection value. Selectors made from one another share their window list's index, which is built once per call to -updateWithWindowList:.
 @interface SWSelector : NSObject
 
 @property (nonatomic, copy, readonly) SWWindow *selectedWindow;
@@ -30,7 +31,20 @@
 - (instancetype)incrementWithoutWrapping;
 - (instancetype)decrement;
 - (instancetype)decrementWithoutWrapping;
+// Equivalent to steps increments (or decrements, if steps is negative), in one step.
+- (instancetype)moveBy:(NSInteger)steps wrapping:(_Bool)wrapping;
 - (instancetype)selectIndex:(NSInteger)index;
 - (instancetype)updateWithWindowList:(NSOrderedSet *)windowList;
 
 @end
+
+
+// Updates its selection in place, for owners that change the selection often and don't need the previous one.
+@interface SWMutableSelector : SWSelector
+
+- (void)move:(NSInteger)steps wrapping:(_Bool)wrapping;
+// Throws NSRangeException like -selectIndex:.
+- (void)setSelectedIndex:(NSInteger)index;
+- (void)setWindowList:(NSOrderedSet *)windowList;
+
+@end
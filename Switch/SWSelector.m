@@ -13,43 +13,139 @@
 //
 
 #import "SWSelector.h"
+
+#import "selection.h"
 #import "SWWindow.h"
 
 
-@implementation SWSelector
+_Static_assert(SWSelectionNone == NSNotFound, "SWSelectionNone must match NSNotFound");
 
-#pragma mark - Initialization
 
-- (instancetype)initWithWindowList:(NSOrderedSet *)windowList selectedIndex:(NSInteger)index;
+// A window list and its index, shared by the selectors made from one another.
+@interface _SWSelectorWindowList : NSObject {
+    SWSelectionMap *_map;
+}
+
+@property (nonatomic, strong, readonly) NSOrderedSet *windows;
+
+- (instancetype)initWithWindows:(NSOrderedSet *)windows;
+- (intptr_t)indexOfWindow:(id)window;
+
+@end
+
+
+@implementation _SWSelectorWindowList
+
+// Windows are found by ID. Most of the unit tests for SWSelector just shove NSNumbers into the collections instead of SWWindow objects, which are found by hash.
+static uint32_t keyForWindow(id window)
+{
+    if ([window respondsToSelector:NNTypedSelector(SWWindow, windowID)]) {
+        return [window windowID];
+    }
+    return (uint32_t)[window hash];
+}
+
+static BOOL windowMatches(id selectedWindow, id window)
+{
+    if (![selectedWindow respondsToSelector:NNTypedSelector1(SWWindow, isSameWindow:)]) {
+        return [selectedWindow isEqual:window];
+    }
+    return [selectedWindow isSameWindow:window];
+}
+
+- (instancetype)initWithWindows:(NSOrderedSet *)windows;
 {
     BailUnless(self = [super init], nil);
     
-    if ((windowList && !windowList.count) || index == NSNotFound) {
-        Check(index == NSNotFound);
-        index = NSNotFound;
-    } else if (windowList.count) {
-        while (index < 0) {
-            index += windowList.count;
-        }
-        if ((NSUInteger)index >= windowList.count) {
-            index = index % (NSInteger)windowList.count;
-        }
+    _windows = windows;
+    
+    uint32_t *keys = malloc(MAX(windows.count, 1) * sizeof(*keys));
+    BailUnless(keys, nil);
+    NSUInteger i = 0;
+    for (id window in windows) {
+        keys[i++] = keyForWindow(window);
     }
+    _map = SWSelectionMapCreate(keys, windows.count);
+    free(keys);
+    BailUnless(_map, nil);
     
-    _windowList = windowList;
-    _selectedIndex = index;
-    _selectedWindow = (NSUInteger)index >= windowList.count ? nil : windowList[(NSUInteger)index];
+    return self;
+}
+
+- (void)dealloc;
+{
+    SWSelectionMapDestroy(self->_map);
+}
+
+- (intptr_t)indexOfWindow:(id)window;
+{
+    if (window == nil) {
+        return SWSelectionNone;
+    }
+    
+    intptr_t index = SWSelectionMapFind(self->_map, keyForWindow(window));
+    if (index == SWSelectionNone || windowMatches(window, self.windows[(NSUInteger)index])) {
+        return index;
+    }
+    
+    // Another window has the same key. Rare enough to search the list for.
+    NSUInteger match = [self.windows indexOfObjectPassingTest:^BOOL(id obj, NSUInteger idx, BOOL *stop) {
+        return windowMatches(window, obj);
+    }];
+    return match == NSNotFound ? SWSelectionNone : (intptr_t)match;
+}
+
+@end
+
+
+@interface SWSelector () {
+@protected
+    SWSelection _selection;
+    _SWSelectorWindowList *_list;
+}
+
+@end
+
+
+@implementation SWSelector
+
+#pragma mark - Initialization
+
+- (instancetype)initWithWindowList:(_SWSelectorWindowList *)list selection:(SWSelection)selection;
+{
+    BailUnless(self = [super init], nil);
+    
+    _list = list;
+    _selection = selection;
     
     return self;
 }
 
 - (instancetype)init;
 {
-    return [self initWithWindowList:nil selectedIndex:0];
+    return [self initWithWindowList:nil selection:SWSelectionMake(false, 0, 0)];
 }
 
 #pragma mark - SWSelector
 
+- (SWWindow *)selectedWindow;
+{
+    if (self->_selection.index < 0 || (NSUInteger)self->_selection.index >= self->_list.windows.count) {
+        return nil;
+    }
+    return self->_list.windows[(NSUInteger)self->_selection.index];
+}
+
+- (NSInteger)selectedIndex;
+{
+    return self->_selection.index;
+}
+
+- (NSOrderedSet *)windowList;
+{
+    return self->_list.windows;
+}
+
 - (NSUInteger)selectedUIndex;
 {
     if (self.selectedIndex < 0) {
@@ -61,127 +157,71 @@
 
 - (instancetype)increment;
 {
-    NSInteger newSelectedIndex = (self.selectedIndex == NSNotFound)
-                               ? 0
-                               : self.selectedIndex + 1;
-
-    if (self.windowList && !self.windowList.count) {
-        Check(self.selectedIndex == NSNotFound);
-        return self;
-    }
-    
-    return [[[self class] alloc] initWithWindowList:self.windowList selectedIndex:newSelectedIndex];
+    return [self moveBy:1 wrapping:true];
 }
 
 - (instancetype)incrementWithoutWrapping;
 {
-    if (!self.windowList) {
-        return [self increment];
-    }
-    
-    if (self.selectedUIndex != (self.windowList.count - 1)) {
-        return [self increment];
-    }
-    
-    return self;
+    return [self moveBy:1 wrapping:false];
 }
 
 - (instancetype)decrement;
 {
-    Check(!self.windowList || self.selectedUIndex < self.windowList.count || self.selectedIndex == NSNotFound);
-
-    NSInteger newSelectedIndex = (self.selectedIndex == NSNotFound)
-                               ? (NSInteger)self.windowList.count - 1
-                               : self.selectedIndex - 1;
-    
-    if (self.windowList && !self.windowList.count) {
-        Check(self.selectedIndex == NSNotFound);
-        return self;
-    }
-    
-    return [[[self class] alloc] initWithWindowList:self.windowList selectedIndex:newSelectedIndex];
+    return [self moveBy:-1 wrapping:true];
 }
 
 - (instancetype)decrementWithoutWrapping;
 {
-    if (!self.windowList) {
-        return [self decrement];
-    }
-    
-    if (self.selectedIndex != 0) {
-        return [self decrement];
-    }
-    
-    return self;
+    return [self moveBy:-1 wrapping:false];
+}
+
+- (instancetype)moveBy:(NSInteger)steps wrapping:(_Bool)wrapping;
+{
+    SWSelection selection = self->_selection;
+    SWSelectionMove(&selection, steps, wrapping);
+    return [[[self class] alloc] initWithWindowList:self->_list selection:selection];
 }
 
 - (instancetype)selectIndex:(NSInteger)index;
 {
-    if (self.windowList) {
-        if (!self.windowList.count) {
-            Check(self.selectedIndex == NSNotFound);
-            if (index != NSNotFound) {
-                @throw [self private_exceptionForInvalidIndex:index functionName:__PRETTY_FUNCTION__];
-            }
-            index = NSNotFound;
-        } else if (index > (NSInteger)self.windowList.count) {
-            if (index != NSNotFound) {
-                @throw [self private_exceptionForInvalidIndex:index functionName:__PRETTY_FUNCTION__];
-            }
-            index = NSNotFound;
-        } else {
-            if (index < 0) {
-                @throw [self private_exceptionForInvalidIndex:index functionName:__PRETTY_FUNCTION__];
-            }
-            index = MAX(index, 0);
-            
-            Check(index < (NSInteger)self.windowList.count);
-            index = MIN(index, (NSInteger)self.windowList.count - 1);
-        }
+    SWSelection selection = self->_selection;
+    if (!SWSelectionSelect(&selection, [self private_clampedIndex:index])) {
+        @throw [self private_exceptionForInvalidIndex:index functionName:__PRETTY_FUNCTION__];
     }
-    
-    return [[[self class] alloc] initWithWindowList:self.windowList selectedIndex:index];
+    return [[[self class] alloc] initWithWindowList:self->_list selection:selection];
 }
 
 - (instancetype)updateWithWindowList:(NSOrderedSet *)windowList;
 {
-    // Carry over the current selected index by default.
-    NSInteger newSelectedIndex = self.selectedIndex;
-    NSUInteger selectedWindowIndex;
-    
-    if (windowList && !windowList.count) {
-        // Empty set? Selected window not found.
-        newSelectedIndex = NSNotFound;
-    } else if (!Check(windowList) || !self.windowList) {
-        newSelectedIndex = self.selectedIndex;
-    } else if ((selectedWindowIndex = [self private_indexOfWindow:self.selectedWindow inWindowList:windowList]) != NSNotFound) {
-        // Select the same window group as was previously selected, if it's still there.
-        newSelectedIndex = (NSInteger)selectedWindowIndex;
-    } else if ((NSInteger)windowList.count <= newSelectedIndex) {
-        // Clamp the selected index to the end of the window list.
-        newSelectedIndex = (NSInteger)windowList.count - 1;
-    }
-    
-    return [[[self class] alloc] initWithWindowList:windowList selectedIndex:newSelectedIndex];
+    SWSelection selection = self->_selection;
+    _SWSelectorWindowList *list = [self private_updateSelection:&selection withWindowList:windowList];
+    return [[[self class] alloc] initWithWindowList:list selection:selection];
 }
 
-- (NSUInteger)private_indexOfWindow:(id)selectedWindow inWindowList:(NSOrderedSet *)windowList;
+#pragma mark - Internal
+
+// Selecting one past the end of the list is a caller error, but it has always been forgiven by selecting the last window instead.
+- (NSInteger)private_clampedIndex:(NSInteger)index;
 {
-    if (selectedWindow == nil) {
-        return NSNotFound;
-    }
-    if (!Check(windowList != nil)) {
-        return NSNotFound;
+    if (self->_selection.hasList && self->_selection.count && index == (NSInteger)self->_selection.count) {
+        Check(index < (NSInteger)self->_selection.count);
+        return index - 1;
     }
+    return index;
+}
+
+// Returns the new window list.
+- (_SWSelectorWindowList *)private_updateSelection:(SWSelection *)selection withWindowList:(NSOrderedSet *)windowList;
+{
+    Check(windowList);
+    _SWSelectorWindowList *list = windowList ? [[_SWSelectorWindowList alloc] initWithWindows:windowList] : nil;
     
-    // Most of the unit tests for this class just shove NSNumbers into the collections instead of SWWindow objects
-    if (![selectedWindow respondsToSelector:NNTypedSelector1(SWWindow, isSameWindow:)]) {
-        return [windowList indexOfObject:selectedWindow];
+    intptr_t previousIndex = SWSelectionNone;
+    if (self->_list && list) {
+        previousIndex = [list indexOfWindow:self.selectedWindow];
     }
-    
-    return [windowList indexOfObjectPassingTest:^BOOL(id obj, NSUInteger idx, BOOL *stop) {
-        return [selectedWindow isSameWindow:obj];
-    }];
+    SWSelectionUpdate(selection, list != nil, list.windows.count, previousIndex);
+    return list;
 }
 
 - (NSException *)private_exceptionForInvalidIndex:(NSInteger)index functionName:(const char *)functionName;
@@ -193,3 +233,25 @@
 }
 
 @end
+
+
+@implementation SWMutableSelector
+
+- (void)move:(NSInteger)steps wrapping:(_Bool)wrapping;
+{
+    SWSelectionMove(&self->_selection, steps, wrapping);
+}
+
+- (void)setSelectedIndex:(NSInteger)index;
+{
+    if (!SWSelectionSelect(&self->_selection, [self private_clampedIndex:index])) {
+        @throw [self private_exceptionForInvalidIndex:index functionName:__PRETTY_FUNCTION__];
+    }
+}
+
+- (void)setWindowList:(NSOrderedSet *)windowList;
+{
+    self->_list = [self private_updateSelection:&self->_selection withWindowList:windowList];
+}
+
+@end
@@ -52,6 +52,8 @@ typedef NS_ENUM(uint8_t, SWIncrementDirection) {
 #pragma mark - Keyboard interactions
 // Key events return whether the event should be allowed to propagate.
 - (void)incrementWithInvoke:(_Bool)invokesInterface direction:(SWIncrementDirection)direction isRepeating:(_Bool)autorepeat;
+// Applies count identical key events at once, updating the selection a single time.
+- (void)incrementWithInvoke:(_Bool)invokesInterface direction:(SWIncrementDirection)direction isRepeating:(_Bool)autorepeat count:(NSUInteger)count;
 - (void)closeWindow;
 - (void)cancelInvocation;
 - (void)endInvocation;
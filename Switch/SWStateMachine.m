@@ -47,7 +47,7 @@
 #pragma mark - Selector state
 
 @property (nonatomic, readwrite, assign) _Bool selectorAdjusted;
-@property (nonatomic, readwrite, strong) SWSelector *selector;
+@property (nonatomic, readwrite, strong) SWMutableSelector *selector;
 @property (nonatomic, readwrite, assign) int scrollOffset;
 
 @end
@@ -88,7 +88,7 @@
         self.displayTimer = true;
         
         Check(!self.selector);
-        self.selector = [SWSelector new];
+        self.selector = [SWMutableSelector new];
 
         Check(!self.windowList.count);
         Check(!self.windowListLoaded);
@@ -166,7 +166,7 @@
     [self private_raiseWindowIfNeeded];
 }
 
-- (void)setSelector:(SWSelector *)selector {
+- (void)setSelector:(SWMutableSelector *)selector {
     SWLogMainThreadOnly();
     if (selector == _selector) {
         return;
@@ -181,6 +181,7 @@
 - (void)displayTimerCompleted;
 {
     SWLogMainThreadOnly();
+    SWTraceScope("SWStateMachine displayTimerCompleted");
     if (!self.pendingSwitch) {
         StateLog(@"State machine display timer completed");
         self.displayTimer = false;
@@ -190,12 +191,19 @@
 #pragma mark - Keyboard interactions
 
 - (void)incrementWithInvoke:(_Bool)invokesInterface direction:(SWIncrementDirection)direction isRepeating:(_Bool)autorepeat;
+{
+    [self incrementWithInvoke:invokesInterface direction:direction isRepeating:autorepeat count:1];
+}
+
+- (void)incrementWithInvoke:(_Bool)invokesInterface direction:(SWIncrementDirection)direction isRepeating:(_Bool)autorepeat count:(NSUInteger)count;
 {
     SWLogMainThreadOnly();
-    StateLog(@"State machine key event with invoke:%@ direction:%@ repeating:%@",
+    SWTraceScope("SWStateMachine incrementWithInvoke");
+    StateLog(@"State machine key event with invoke:%@ direction:%@ repeating:%@ count:%lu",
           invokesInterface ? @"true" : @"false",
           direction == SWIncrementDirectionIncreasing ? @"increasing" : @"decreasing",
-          autorepeat ? @"true" : @"false");
+          autorepeat ? @"true" : @"false",
+          (unsigned long)count);
     
     if (invokesInterface) {
         self.invoked = true;
@@ -206,11 +214,9 @@
         self.pendingSwitch = false;
     }
     
-    if (autorepeat) {
-        self.selector = direction == SWIncrementDirectionIncreasing ? self.selector.incrementWithoutWrapping : self.selector.decrementWithoutWrapping;
-    } else {
-        self.selector = direction == SWIncrementDirectionIncreasing ? self.selector.increment : self.selector.decrement;
-    }
+    NSInteger steps = direction == SWIncrementDirectionIncreasing ? (NSInteger)count : -(NSInteger)count;
+    [self.selector move:steps wrapping:!autorepeat];
+    [self private_updateSelectedWindow];
     
     self.scrollOffset = 0;
 }
@@ -218,6 +224,7 @@
 - (void)closeWindow;
 {
     SWLogMainThreadOnly();
+    SWTraceScope("SWStateMachine closeWindow");
     StateLog(@"State machine event close window");
 
     if (self.interfaceVisible) {
@@ -231,6 +238,7 @@
 - (void)cancelInvocation;
 {
     SWLogMainThreadOnly();
+    SWTraceScope("SWStateMachine cancelInvocation");
     StateLog(@"State machine event cancel invocation");
 
     if (self.invoked) {
@@ -241,6 +249,7 @@
 - (void)endInvocation;
 {
     SWLogMainThreadOnly();
+    SWTraceScope("SWStateMachine endInvocation");
     StateLog(@"State machine event end invocation");
 
     if (self.invoked) {
@@ -254,6 +263,7 @@
 - (void)selectWindow:(SWWindow *)window;
 {
     SWLogMainThreadOnly();
+    SWTraceScope("SWStateMachine selectWindow");
     StateLog(@"State machine mouse select window group: %@", window);
 
     if (!self.windowList) { return; }
@@ -262,12 +272,14 @@
 
     NSUInteger index = [self.selector.windowList indexOfObject:window];
     Check(index < self.selector.windowList.count || index == NSNotFound);
-    self.selector = [self.selector selectIndex:(NSInteger)index];
+    [self.selector setSelectedIndex:(NSInteger)index];
+    [self private_updateSelectedWindow];
 }
 
 - (void)activateWindow:(SWWindow *)window;
 {
     SWLogMainThreadOnly();
+    SWTraceScope("SWStateMachine activateWindow");
     StateLog(@"State machine mouse activate window group: %@", window);
 
     if (!self.windowList) { return; }
@@ -288,6 +300,7 @@
 - (void)updateWindowList:(NSOrderedSet *)windowList;
 {
     SWLogMainThreadOnly();
+    SWTraceScope("SWStateMachine updateWindowList");
     StateLog(@"State machine update window groups: %@", windowList);
 
     [self private_updateWindowList:windowList];
@@ -302,10 +315,11 @@
         Assert(self.windowListLoaded);
         Assert(self.selector.windowList == nil);
         if (self.selector.selectedIndex == 1 && [self.windowList count] > 1 && ![CLASS_CAST(SWWindow, [self.windowList objectAtIndex:0]).application isActiveApplication]) {
-            self.selector = [[SWSelector new] updateWithWindowList:self.windowList];
+            self.selector = [SWMutableSelector new];
         }
         self.selectorAdjusted = YES;
-        self.selector = [self.selector updateWithWindowList:self.windowList];
+        [self.selector setWindowList:self.windowList];
+        [self private_updateSelectedWindow];
     }
 }
 
@@ -325,7 +339,8 @@
     if (!self.windowListLoaded) {
         self.windowListLoaded = true;
     } else if (self.selectorAdjusted) {
-        self.selector = [self.selector updateWithWindowList:windowList];
+        [self.selector setWindowList:windowList];
+        [self private_updateSelectedWindow];
     }
 
     if (self.pendingSwitch && [[windowList firstObject] isEqual:self.selectedWindow] && [self.selectedWindow.application isActiveApplication]) {
@@ -73,6 +73,12 @@
     [self openLogFolder:self];
 }
 
+- (IBAction)traceSnapshot:(id)sender;
+{
+    [[SWLoggingService sharedService] takeTraceSnapshot];
+    [self openLogFolder:self];
+}
+
 - (IBAction)openLogFolder:(id)sender;
 {
     [[NSWorkspace sharedWorkspace] openFile:[[SWLoggingService sharedService] logDirectoryPath]];
@@ -121,6 +127,11 @@
         [menu addItem:menuItem];
         [debugItems addObject:menuItem];
         
+        menuItem = [[NSMenuItem alloc] initWithTitle:@"Save Trace…" action:NNSelfSelector1(traceSnapshot:) keyEquivalent:@""];
+        menuItem.target = self;
+        [menu addItem:menuItem];
+        [debugItems addObject:menuItem];
+        
         menuItem = [[NSMenuItem alloc] initWithTitle:@"Open Log Folder…" action:NNSelfSelector1(openLogFolder:) keyEquivalent:@""];
         menuItem.target = self;
         [menu addItem:menuItem];
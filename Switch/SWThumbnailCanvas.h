@@ -0,0 +1,44 @@
+//
+//  SWThumbnailCanvas.h
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+
+
+// A downscaled copy of a window's content that can be brought up to date by redrawing only the regions that changed.
+// The canvas is published as a grid of tiles, each with an image of its own, so an update only copies out (and a layer only uploads) the tiles it touched. A single image of the whole canvas would be copied in full on the next write for as long as a layer held on to it.
+@interface SWThumbnailCanvas : NSObject
+
+- (instancetype)initWithMaximumPixelSize:(CGFloat)maximumPixelSize;
+
+@property (nonatomic, assign, readonly) CGFloat maximumPixelSize;
+@property (nonatomic, assign, readonly) NSUInteger generation;
+
+// The size of the canvas in pixels.
+@property (nonatomic, assign, readonly) CGSize pixelSize;
+@property (nonatomic, assign, readonly) NSUInteger tileCount;
+// Indexes of the tiles whose images were replaced by the last update.
+@property (nonatomic, strong, readonly) NSIndexSet *updatedTiles;
+
+// Owned by the canvas, valid until the tile is next updated.
+- (CGImageRef)imageForTileAtIndex:(NSUInteger)index;
+// The tile's place on the canvas in pixels, with the origin at the top left.
+- (CGRect)rectForTileAtIndex:(NSUInteger)index;
+
+// A snapshot of the whole canvas, made on demand. Owned by the canvas, valid until the next update. Updating the canvas while the snapshot is still referenced elsewhere copies the canvas, so this is not for display.
+@property (nonatomic, assign, readonly) CGImageRef image;
+
+// Redraws the parts of the canvas covered by dirtyRects (see SWWindowContentsSubscriber), or all of it if the update does not directly follow the canvas' current generation. Updates older than the canvas' current generation are ignored. Pass a generation of 0 if it is not known. Returns the number of bytes copied into new tile images.
+- (size_t)updateWithImage:(CGImageRef)image dirtyRects:(NSArray *)dirtyRects generation:(NSUInteger)generation;
+
+@end
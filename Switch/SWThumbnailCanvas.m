@@ -0,0 +1,267 @@
+//
+//  SWThumbnailCanvas.m
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#import "SWThumbnailCanvas.h"
+
+
+// Tiles are at most this many pixels on a side. Smaller tiles copy less per update at the cost of more layers.
+static const size_t kTileSize = 64;
+
+
+@interface SWThumbnailCanvas () {
+    // One for each tile, row by row from the top left. NULL until the tile has been drawn.
+    CGImageRef *_tiles;
+    size_t _columns;
+    size_t _rows;
+}
+
+@property (nonatomic, assign, readwrite) NSUInteger generation;
+@property (nonatomic, strong, readwrite) NSIndexSet *updatedTiles;
+@property (nonatomic, assign) CGContextRef context;
+@property (nonatomic, assign) CGSize sourceSize;
+
+@end
+
+
+@implementation SWThumbnailCanvas
+
+#pragma mark - Initialization
+
+- (instancetype)initWithMaximumPixelSize:(CGFloat)maximumPixelSize;
+{
+    BailUnless(self = [super init], nil);
+    
+    _maximumPixelSize = maximumPixelSize;
+    _updatedTiles = [NSIndexSet indexSet];
+    
+    return self;
+}
+
+- (void)dealloc;
+{
+    if (_image) {
+        CGImageRelease(_image);
+    }
+    [self private_releaseTiles];
+    if (_context) {
+        CGContextRelease(_context);
+    }
+}
+
+#pragma mark - SWThumbnailCanvas
+
+@synthesize image = _image;
+
+- (CGImageRef)image;
+{
+    if (!_image && self.context) {
+        _image = CGBitmapContextCreateImage(self.context);
+    }
+    return _image;
+}
+
+- (CGSize)pixelSize;
+{
+    if (!self.context) {
+        return CGSizeZero;
+    }
+    return CGSizeMake(CGBitmapContextGetWidth(self.context), CGBitmapContextGetHeight(self.context));
+}
+
+- (NSUInteger)tileCount;
+{
+    return _columns * _rows;
+}
+
+- (CGImageRef)imageForTileAtIndex:(NSUInteger)index;
+{
+    BailUnless(index < self.tileCount, NULL);
+    
+    return _tiles[index];
+}
+
+- (CGRect)rectForTileAtIndex:(NSUInteger)index;
+{
+    BailUnless(index < self.tileCount, CGRectZero);
+    
+    CGSize pixelSize = self.pixelSize;
+    CGFloat x = (CGFloat)((index % _columns) * kTileSize);
+    CGFloat y = (CGFloat)((index / _columns) * kTileSize);
+    return CGRectMake(x, y, MIN((CGFloat)kTileSize, pixelSize.width - x), MIN((CGFloat)kTileSize, pixelSize.height - y));
+}
+
+- (size_t)updateWithImage:(CGImageRef)image dirtyRects:(NSArray *)dirtyRects generation:(NSUInteger)generation;
+{
+    BailUnless(image, 0);
+    
+    // Updates can be coalesced but not reordered, so one that isn't newer than the canvas is stale.
+    if (generation && self.generation && generation <= self.generation) {
+        return 0;
+    }
+    
+    self.updatedTiles = [NSIndexSet indexSet];
+    
+    CGSize sourceSize = CGSizeMake(CGImageGetWidth(image), CGImageGetHeight(image));
+    BOOL incremental = dirtyRects && generation && self.generation && generation == self.generation + 1 && NNNSSizesEqual(sourceSize, self.sourceSize);
+    self.generation = generation;
+    
+    if (!incremental) {
+        [self private_createContextForSourceSize:sourceSize];
+    }
+    BailUnless(self.context, 0);
+    
+    size_t canvasWidth = CGBitmapContextGetWidth(self.context);
+    size_t canvasHeight = CGBitmapContextGetHeight(self.context);
+    CGRect canvasRect = CGRectMake(0.0, 0.0, canvasWidth, canvasHeight);
+    NSMutableIndexSet *updatedTiles = [NSMutableIndexSet new];
+    
+    CGContextSaveGState(self.context);
+    
+    if (incremental) {
+        if (!dirtyRects.count) {
+            CGContextRestoreGState(self.context);
+            return 0;
+        }
+        
+        CGFloat scaleX = canvasWidth / sourceSize.width;
+        CGFloat scaleY = canvasHeight / sourceSize.height;
+        CGRect *clipRects = calloc(dirtyRects.count, sizeof(*clipRects));
+        for (NSUInteger i = 0; i < dirtyRects.count; ++i) {
+            CGRect dirtyRect = [dirtyRects[i] rectValue];
+            
+            // Scale into canvas pixels (rounding outward), then flip into the context's bottom-left origin.
+            CGFloat minX = floor(CGRectGetMinX(dirtyRect) * scaleX);
+            CGFloat maxX = ceil(CGRectGetMaxX(dirtyRect) * scaleX);
+            CGFloat minY = floor(CGRectGetMinY(dirtyRect) * scaleY);
+            CGFloat maxY = ceil(CGRectGetMaxY(dirtyRect) * scaleY);
+            clipRects[i] = CGRectIntersection(canvasRect, CGRectMake(minX, canvasHeight - maxY, maxX - minX, maxY - minY));
+            if (CGRectIsEmpty(clipRects[i])) {
+                continue;
+            }
+            
+            // Tiles are numbered from the top left, the same way dirtyRects are.
+            size_t firstColumn = (size_t)minX / kTileSize;
+            size_t lastColumn = MIN(_columns - 1, ((size_t)maxX - 1) / kTileSize);
+            size_t firstRow = (size_t)minY / kTileSize;
+            size_t lastRow = MIN(_rows - 1, ((size_t)maxY - 1) / kTileSize);
+            for (size_t row = firstRow; row <= lastRow; ++row) {
+                [updatedTiles addIndexesInRange:NSMakeRange(row * _columns + firstColumn, lastColumn - firstColumn + 1)];
+            }
+        }
+        CGContextClipToRects(self.context, clipRects, dirtyRects.count);
+        free(clipRects);
+    } else {
+        [updatedTiles addIndexesInRange:NSMakeRange(0, self.tileCount)];
+    }
+    
+    CGContextSetBlendMode(self.context, kCGBlendModeCopy);
+    CGContextSetInterpolationQuality(self.context, kCGInterpolationHigh);
+    CGContextDrawImage(self.context, canvasRect, image);
+    CGContextRestoreGState(self.context);
+    
+    if (_image) {
+        CGImageRelease(_image);
+        _image = NULL;
+    }
+    
+    size_t result = 0;
+    for (NSUInteger index = updatedTiles.firstIndex; index != NSNotFound; index = [updatedTiles indexGreaterThanIndex:index]) {
+        result += [self private_copyTileAtIndex:index];
+    }
+    self.updatedTiles = updatedTiles;
+    
+    return result;
+}
+
+#pragma mark - Internal
+
+- (void)private_createContextForSourceSize:(CGSize)sourceSize;
+{
+    if (self.context && NNNSSizesEqual(sourceSize, self.sourceSize)) {
+        return;
+    }
+    
+    [self private_releaseTiles];
+    if (self.context) {
+        CGContextRelease(self.context);
+        self.context = NULL;
+    }
+    self.sourceSize = sourceSize;
+    
+    if (sourceSize.width < 1.0 || sourceSize.height < 1.0) {
+        return;
+    }
+    
+    CGFloat scale = MIN(1.0, self.maximumPixelSize / MAX(sourceSize.width, sourceSize.height));
+    size_t width = (size_t)MAX(1.0, round(sourceSize.width * scale));
+    size_t height = (size_t)MAX(1.0, round(sourceSize.height * scale));
+    
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateWithName(kCGColorSpaceSRGB);
+    self.context = CGBitmapContextCreate(NULL, width, height, 8, 0, colorSpace, kCGBitmapByteOrder32Host | (CGBitmapInfo)kCGImageAlphaPremultipliedFirst);
+    CGColorSpaceRelease(colorSpace);
+    
+    if (self.context) {
+        _columns = (width + kTileSize - 1) / kTileSize;
+        _rows = (height + kTileSize - 1) / kTileSize;
+        _tiles = calloc(_columns * _rows, sizeof(*_tiles));
+    }
+}
+
+- (void)private_releaseTiles;
+{
+    for (size_t i = 0; i < _columns * _rows; ++i) {
+        if (_tiles[i]) {
+            CGImageRelease(_tiles[i]);
+        }
+    }
+    free(_tiles);
+    _tiles = NULL;
+    _columns = 0;
+    _rows = 0;
+}
+
+// Replaces the tile's image with a copy of its pixels, so that the next update can write to the context without copying anything that a layer still holds. Returns the number of bytes copied.
+- (size_t)private_copyTileAtIndex:(NSUInteger)index;
+{
+    CGRect rect = [self rectForTileAtIndex:index];
+    size_t x = (size_t)rect.origin.x;
+    size_t y = (size_t)rect.origin.y;
+    size_t width = (size_t)rect.size.width;
+    size_t height = (size_t)rect.size.height;
+    
+    // The context's first row is the top of the canvas.
+    size_t bytesPerRow = CGBitmapContextGetBytesPerRow(self.context);
+    const uint8_t *pixels = CGBitmapContextGetData(self.context);
+    size_t tileBytesPerRow = width * 4;
+    CFMutableDataRef data = CFDataCreateMutable(NULL, (CFIndex)(tileBytesPerRow * height));
+    CFDataSetLength(data, (CFIndex)(tileBytesPerRow * height));
+    uint8_t *tilePixels = CFDataGetMutableBytePtr(data);
+    for (size_t row = 0; row < height; ++row) {
+        memcpy(tilePixels + row * tileBytesPerRow, pixels + (y + row) * bytesPerRow + x * 4, tileBytesPerRow);
+    }
+    
+    CGDataProviderRef provider = CGDataProviderCreateWithCFData(data);
+    CGImageRef tile = CGImageCreate(width, height, 8, 32, tileBytesPerRow, CGBitmapContextGetColorSpace(self.context), CGBitmapContextGetBitmapInfo(self.context), provider, NULL, false, kCGRenderingIntentDefault);
+    CGDataProviderRelease(provider);
+    CFRelease(data);
+    
+    if (_tiles[index]) {
+        CGImageRelease(_tiles[index]);
+    }
+    _tiles[index] = tile;
+    
+    return tileBytesPerRow * height;
+}
+
+@end
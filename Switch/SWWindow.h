@@ -14,20 +14,31 @@
 
 #import <Foundation/Foundation.h>
 
-
-typedef NSPoint NNVec2;
+#import "windowTable.h"
 
 
 @class SWApplication;
 
 
+// Interns a string in table as UTF-8, without allocating for names of reasonable length.
+extern SWWindowTableAtom SWWindowTableInternString(SWWindowTable *table, NSString *string);
+
+
 @interface SWWindow : NSObject <NSCopying>
 
 + (instancetype)windowWithDescription:(NSDictionary *)description;
+// Builds a window from a description that has already been decoded into a row of table.
++ (instancetype)windowWithDescription:(NSDictionary *)description windowTable:(const SWWindowTable *)table row:(size_t)row;
+
+// Decodes a window description into a new row of table. Returns the row's index, or SIZE_MAX on failure.
++ (size_t)appendDescription:(NSDictionary *)description toWindowTable:(SWWindowTable *)table;
+// Appends a row for the window to table. Returns the row's index, or SIZE_MAX on failure.
+- (size_t)appendToWindowTable:(SWWindowTable *)table;
 
 @property (nonatomic, strong, readonly) SWApplication *application;
 @property (atomic, copy, readonly) NSDictionary *windowDescription;
 
+- (CGFloat)alpha;
 - (CGRect)frame;
 - (CGRect)flippedFrame;
 - (NSString *)name;
@@ -37,9 +48,6 @@ typedef NSPoint NNVec2;
 - (NSString *)displayName;
 
 - (BOOL)isSameWindow:(SWWindow *)window;
-- (BOOL)isRelatedToLowerWindow:(SWWindow *)window;
-- (NNVec2)offsetOfCenterToCenterOfWindow:(SWWindow *)window;
-- (NSSize)sizeDifferenceFromWindow:(SWWindow *)window;
 - (BOOL)enclosedByWindow:(SWWindow *)window;
 
 @end
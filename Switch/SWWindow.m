@@ -13,16 +13,50 @@
 //
 
 #import "SWWindow.h"
-#import "SWWindow+TweetbotQuirks.h"
 
 #import <Haxcessibility/HAXElement+Protected.h>
 #import <Haxcessibility/Haxcessibility.h>
 
 #import "NSScreen+SWAdditions.h"
 #import "SWApplication.h"
+#import "SWScreenTopology.h"
 
 
-@implementation SWWindow
+SWWindowTableAtom SWWindowTableInternString(SWWindowTable *table, NSString *string)
+{
+    if (!string.length) {
+        return SWWindowTableAtomNone;
+    }
+    
+    const char *utf8 = CFStringGetCStringPtr((__bridge CFStringRef)string, kCFStringEncodingUTF8);
+    if (utf8) {
+        return SWWindowTableIntern(table, utf8, strlen(utf8));
+    }
+    
+    char buffer[256];
+    NSUInteger length = 0;
+    NSRange remaining;
+    if ([string getBytes:buffer maxLength:sizeof(buffer) usedLength:&length encoding:NSUTF8StringEncoding options:NSStringEncodingConversionAllowLossy range:NSMakeRange(0, string.length) remainingRange:&remaining] && remaining.length == 0) {
+        return SWWindowTableIntern(table, buffer, length);
+    }
+    
+    NSData *data = [string dataUsingEncoding:NSUTF8StringEncoding allowLossyConversion:YES];
+    return SWWindowTableIntern(table, data.bytes, data.length);
+}
+
+static SWWindowTableRect SWWindowTableRectFromCGRect(CGRect rect)
+{
+    return (SWWindowTableRect){ .x = rect.origin.x, .y = rect.origin.y, .width = rect.size.width, .height = rect.size.height };
+}
+
+
+@implementation SWWindow {
+    // Decoded from the description once, when the window is created.
+    CGWindowID _windowID;
+    CGRect _flippedFrame;
+    CGFloat _alpha;
+    NSString *_name;
+}
 
 #pragma mark - Initialization
 
@@ -31,7 +65,25 @@
     return [[self alloc] initWithDescription:description];
 }
 
++ (instancetype)windowWithDescription:(NSDictionary *)description windowTable:(const SWWindowTable *)table row:(size_t)row;
+{
+    NSParameterAssert(row < table->count);
+    SWWindow *result = [[self alloc] initWithDescription:description decoded:NO];
+    if (result) {
+        SWWindowTableRect bounds = table->bounds[row];
+        result->_windowID = table->windowIDs[row];
+        result->_flippedFrame = CGRectMake(bounds.x, bounds.y, bounds.width, bounds.height);
+        result->_alpha = table->alphas[row];
+    }
+    return result;
+}
+
 - (instancetype)initWithDescription:(NSDictionary *)description;
+{
+    return [self initWithDescription:description decoded:YES];
+}
+
+- (instancetype)initWithDescription:(NSDictionary *)description decoded:(BOOL)decode;
 {
     BailUnless(self = [super init], nil);
     
@@ -41,6 +93,13 @@
 
     _windowDescription = [description copy];
     _application = [SWApplication applicationWithPID:[[self.windowDescription objectForKey:(NSString *)kCGWindowOwnerPID] intValue] name:[self.windowDescription objectForKey:(NSString *)kCGWindowOwnerName]];
+    _name = [self.windowDescription objectForKey:(__bridge NSString *)kCGWindowName];
+    
+    if (decode) {
+        _windowID = (CGWindowID)[[self.windowDescription objectForKey:(__bridge NSString *)kCGWindowNumber] unsignedLongValue];
+        _flippedFrame = [[self class] private_boundsFromDescription:self.windowDescription];
+        _alpha = [[self.windowDescription objectForKey:(__bridge NSString *)kCGWindowAlpha] doubleValue];
+    }
     
     return self;
 }
@@ -83,12 +142,40 @@
 
 #pragma mark - SWWindow
 
++ (size_t)appendDescription:(NSDictionary *)description toWindowTable:(SWWindowTable *)table;
+{
+    return SWWindowTableAppend(table,
+        (uint32_t)[description[(__bridge NSString *)kCGWindowNumber] unsignedLongValue],
+        [description[(__bridge NSString *)kCGWindowOwnerPID] intValue],
+        [description[(__bridge NSString *)kCGWindowLayer] longLongValue],
+        [description[(__bridge NSString *)kCGWindowAlpha] doubleValue],
+        SWWindowTableRectFromCGRect([self private_boundsFromDescription:description]),
+        SWWindowTableInternString(table, description[(__bridge NSString *)kCGWindowName]),
+        SWWindowTableInternString(table, description[(__bridge NSString *)kCGWindowOwnerName])
+    );
+}
+
+- (size_t)appendToWindowTable:(SWWindowTable *)table;
+{
+    return SWWindowTableAppend(table,
+        self.windowID,
+        self.application.pid,
+        [self.windowDescription[(__bridge NSString *)kCGWindowLayer] longLongValue],
+        self.alpha,
+        SWWindowTableRectFromCGRect(self.flippedFrame),
+        SWWindowTableInternString(table, self.name),
+        SWWindowTableInternString(table, self.application.name)
+    );
+}
+
+- (CGFloat)alpha;
+{
+    return _alpha;
+}
+
 - (CGRect)flippedFrame;
 {
-    CGRect result = {{},{}};
-    bool success = CGRectMakeWithDictionaryRepresentation((__bridge CFDictionaryRef)[self.windowDescription objectForKey:(NSString *)kCGWindowBounds], &result);
-    BailUnless(success, ((CGRect){{0.0,0.0},{0.0,0.0}}));
-    return result;
+    return _flippedFrame;
 }
 
 - (CGRect)frame;
@@ -101,36 +188,17 @@
 
 - (NSString *)name;
 {
-    return [self.windowDescription objectForKey:(__bridge NSString *)kCGWindowName];
+    return _name;
 }
 
 - (NSScreen *)screen;
 {
-    CGRect cgFrame = self.flippedFrame;
-    
-    return [[NSScreen screens] nn_reduce:^id(NSScreen *accumulator, NSScreen *item) {
-        if (!accumulator) {
-            accumulator = [NSScreen mainScreen];
-        }
-        
-        CGFloat (^overlapWithScreen)(NSScreen *) = ^(NSScreen *screen) {
-            CGDirectDisplayID displayID = [screen.deviceDescription[@"NSScreenNumber"] unsignedIntValue];
-            CGRect displayRect = CGDisplayBounds(displayID);
-            CGRect intersection = CGRectIntersection(displayRect, cgFrame);
-            return intersection.size.width * intersection.size.height;
-        };
-
-        if (overlapWithScreen(item) > overlapWithScreen(accumulator)) {
-            return item;
-        } else {
-            return accumulator;
-        }
-    }];
+    return [[SWScreenTopology currentTopology] screenForFlippedFrame:self.flippedFrame];
 }
 
 - (CGWindowID)windowID;
 {
-    return (CGWindowID)[[self.windowDescription objectForKey:(__bridge NSString *)kCGWindowNumber] unsignedLongValue];
+    return _windowID;
 }
 
 - (NSString *)displayName;
@@ -142,82 +210,25 @@
     return result;
 }
 
-- (BOOL)isRelatedToLowerWindow:(SWWindow *)window;
+- (BOOL)enclosedByWindow:(SWWindow *)window;
 {
-    NSParameterAssert(window.application.canBeActivated);
-    
-    // Powerbox (for example) names its windows, but cannot be activated.
-    if (!self.application.canBeActivated) {
-        return YES;
-    }
-    
-    // Windows belonging to different applications are unrelated.
-    if (![self.application isEqual:window.application]) {
-        return NO;
-    }
-
-    // Named windows are (usually) main windows themselves
-    if (self.name.length && window.name.length) {
-        return NO;
-    }
-    
-    // Windows on different screens are not equal
-    if (![self.screen isEqual:window.screen]) {
-        return NO;
-    }
-    
-    // This is a special case for catching the shadow opening for sheets
-    if (self.frame.size.height < 20.0 && [self.windowDescription[(__bridge NSString *)kCGWindowAlpha] floatValue] < 1.0) {
-        return YES;
-    }
-    
-    if ([self.application.name isEqualToString:@"Tweetbot"]) {
-        return [self tweetbot_isRelatedToLowerWindow:window];
-    } else if ([self.application.name isEqualToString:@"MacVim"]) {
-        // MacVim isn't known to have any extraneous unnamed windows… yet?
-        return NO;
-    }
-    
-    // This is intended to fix some window grouping issues around full-screen applications (such as Xcode).
-    if (
-        // higher window and lower window have the same origin.x, and
-        self.frame.origin.x == window.frame.origin.x &&
-        // higher window and lower window have the same size.width, and
-        self.frame.size.width == window.frame.size.width &&
-        // higer window and lower window intersect
-        !CGRectIsNull(CGRectIntersection(self.frame, window.frame))
-    ) {
-        return YES;
-    }
-    
-    return [self enclosedByWindow:window];
+    // Containment doesn't depend on which way the y axis points, so the screen height isn't needed.
+    return CGRectContainsRect(window.flippedFrame, self.flippedFrame);
 }
 
-- (NNVec2)offsetOfCenterToCenterOfWindow:(SWWindow *)window;
-{
-    CGRect selfBounds = self.frame;
-    CGRect windowBounds = window.frame;
-    
-    return (NNVec2){
-        .x = ((windowBounds.origin.x + (windowBounds.size.width / 2.0)) - (selfBounds.origin.x + (selfBounds.size.width / 2.0))),
-        .y = ((windowBounds.origin.y + (windowBounds.size.height / 2.0)) - (selfBounds.origin.y + (selfBounds.size.height / 2.0)))
-    };
-}
+#pragma mark - Internal
 
-- (NSSize)sizeDifferenceFromWindow:(SWWindow *)window;
++ (CGRect)private_boundsFromDescription:(NSDictionary *)description;
 {
-    CGRect selfBounds = self.frame;
-    CGRect windowBounds = window.frame;
+    CGRect result = {{},{}};
+    NSDictionary *bounds = [description objectForKey:(NSString *)kCGWindowBounds];
+    if (!bounds) {
+        return result;
+    }
     
-    return (NSSize){
-        .width = selfBounds.size.width - windowBounds.size.width,
-        .height = selfBounds.size.height - windowBounds.size.height
-    };
-}
-
-- (BOOL)enclosedByWindow:(SWWindow *)window;
-{
-    return CGRectContainsRect(window.frame, self.frame);
+    bool success = CGRectMakeWithDictionaryRepresentation((__bridge CFDictionaryRef)bounds, &result);
+    BailUnless(success, ((CGRect){{0.0,0.0},{0.0,0.0}}));
+    return result;
 }
 
 @end
@@ -18,7 +18,12 @@
 
 @protocol SWWindowContentsSubscriber <NSObject>
 
-- (oneway void)windowContentService:(SWWindowContentsService *)windowService updatedContent:(NSImage *)content forWindow:(SWWindow *)window;
+/*!
+ * @param content The window's contents, already reduced to the largest size a thumbnail is drawn at (which may be smaller than the window's size in pixels).
+ * @param dirtyRects The regions of content (NSValue-wrapped rects in pixels, origin at the top left) that differ from the window's previous content, or nil if all of it should be considered changed.
+ * @param generation Increments by one with each update for a window. Updates for a window arrive in generation order, but coalescing can skip generations. dirtyRects are only meaningful to a subscriber that applied the previous generation.
+ */
+- (oneway void)windowContentService:(SWWindowContentsService *)windowService updatedContent:(NSImage *)content dirtyRects:(NSArray *)dirtyRects generation:(NSUInteger)generation forWindow:(SWWindow *)window;
 
 @end
 
@@ -27,4 +32,11 @@
 
 - (NSImage *)contentForWindow:(SWWindow *)window;
 
+/*!
+ * Sets which windows the interface is showing, which decides how often each window is captured: the selected group's windows at full rate, the other shown windows at a reduced rate, and the rest not at all once they have a frame.
+ * @param windowGroups The window groups being shown, or nil if the interface is hidden.
+ * @param selectedWindowGroup The selected window group, or nil.
+ */
+- (void)setShownWindowGroups:(NSOrderedSet *)windowGroups selectedWindowGroup:(SWWindow *)selectedWindowGroup;
+
 @end
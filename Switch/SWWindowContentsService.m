@@ -16,6 +16,10 @@
 
 #import <NNKit/NNService+Protected.h>
 
+#import "contentStore.h"
+#import "frameCache.h"
+#import "resample.h"
+#import "SWPreferencesService.h"
 #import "SWWindowGroup.h"
 #import "SWWindowListService.h"
 #import "SWWindowWorker.h"
@@ -24,6 +28,10 @@
 @interface _SWWindowContentContainer : NSObject
 
 @property (nonatomic, strong) NSImage *content;
+@property (nonatomic, copy) NSArray *dirtyRects;
+@property (nonatomic, assign) NSUInteger generation;
+// YES when content is already in the frame cache, either because it came from there or because it has been cached since it was captured.
+@property (nonatomic, assign) BOOL cached;
 @property (nonatomic, strong) SWWindow *window;
 @property (nonatomic, strong, readonly) SWWindowWorker *worker;
 
@@ -45,10 +53,28 @@
 @end
 
 
-@interface SWWindowContentsService () <SWWindowListSubscriber>
+static const void *contentStoreRetain(const void *value) { return CFRetain(value); }
+static void contentStoreRelease(const void *value) { CFRelease(value); }
+
+// Frames kept between invocations are for showing something until the first capture lands, so they're kept small.
+static const size_t kSWCachedFrameMaxEdge = 128;
+static const size_t kSWCachedFrameMaxPixels = kSWCachedFrameMaxEdge * kSWCachedFrameMaxEdge;
+
+
+@interface SWWindowContentsService () <SWWindowListSubscriber> {
+    // What -contentForWindow: reads, published from contentContainers so that lookups never wait on the queue.
+    SWContentStore *_contentStore;
+    // The last frame of each window, kept across stops of the service. Queue only.
+    SWFrameCache _frameCache;
+}
 
 @property (nonatomic, strong, readonly) NSMutableDictionary *contentContainers;
 @property (nonatomic, strong, readonly) dispatch_queue_t queue;
+// IDs of the windows the interface is showing, and of the selected group's windows. Queue only.
+@property (nonatomic, copy) NSSet *shownWindowIDs;
+@property (nonatomic, copy) NSSet *selectedWindowIDs;
+// Set when contentContainers has changes that haven't been published to the content store. Queue only.
+@property (nonatomic, assign) BOOL publishPending;
 
 @end
 
@@ -63,12 +89,24 @@
     
     _contentContainers = [NSMutableDictionary new];
     _queue = dispatch_queue_create([[NSString stringWithFormat:@"SWWindowContentsService"] UTF8String], DISPATCH_QUEUE_SERIAL);
+    _contentStore = SWContentStoreCreate((SWContentStoreCallbacks){ .retain = contentStoreRetain, .release = contentStoreRelease });
+    BailUnless(_contentStore, nil);
+    BailUnless(SWFrameCacheInit(&_frameCache, 0), nil);
+    
+    // Subscribers that fall behind only need each window's newest content. Dropping a generation costs them a full redraw of that window's next update.
+    [self.subscriberDispatcher coalesceSelector:@selector(windowContentService:updatedContent:dirtyRects:generation:forWindow:) byArgumentAtIndex:4];
     
     [[NSNotificationCenter defaultCenter] addWeakObserver:self selector:NNSelfSelector1(private_windowUpdateNotification:) name:[SWWindowWorker notificationName] object:nil];
     
     return self;
 }
 
+- (void)dealloc;
+{
+    SWContentStoreDestroy(self->_contentStore);
+    SWFrameCacheDestroy(&self->_frameCache);
+}
+
 #pragma mark - NNService
 
 + (NNServiceType)serviceType;
@@ -92,6 +130,11 @@
     
     self->_contentContainers = [NSMutableDictionary new];
     
+    size_t frameCacheSize = [SWPreferencesService sharedService].thumbnailCacheSize.unsignedIntegerValue;
+    dispatch_async(self.queue, ^{
+        SWFrameCacheSetByteLimit(&self->_frameCache, frameCacheSize);
+    });
+    
     NSOrderedSet *windows = [SWWindowListService sharedService].windows;
     if (windows) {
         [self windowListService:nil updatedList:windows];
@@ -103,8 +146,10 @@
 - (void)stopService;
 {
     dispatch_async(self.queue, ^{
+        [self private_cacheFrames];
         [self.contentContainers removeAllObjects];
         self->_contentContainers = nil;
+        SWContentStorePublish(self->_contentStore, NULL, NULL, 0);
     });
     
     [[NNServiceManager sharedManager] removeObserver:self forService:[SWWindowListService class]];
@@ -116,11 +161,38 @@
 
 - (NSImage *)contentForWindow:(SWWindow *)window;
 {
-    __block _SWWindowContentContainer *contentContainerObject;
-    dispatch_sync(self.queue, ^{
-        contentContainerObject = [self.contentContainers objectForKey:@(window.windowID)];
+    return CFBridgingRelease(SWContentStoreCopyValue(self->_contentStore, window.windowID));
+}
+
+- (void)setShownWindowGroups:(NSOrderedSet *)windowGroups selectedWindowGroup:(SWWindow *)selectedWindowGroup;
+{
+    NSMutableSet *shownWindowIDs = [NSMutableSet new];
+    for (SWWindowGroup *windowGroup in windowGroups) {
+        for (SWWindow *window in windowGroup.windows) {
+            [shownWindowIDs addObject:@(window.windowID)];
+        }
+    }
+    NSMutableSet *selectedWindowIDs = [NSMutableSet new];
+    if ([selectedWindowGroup isKindOfClass:[SWWindowGroup class]]) {
+        for (SWWindow *window in ((SWWindowGroup *)selectedWindowGroup).windows) {
+            [selectedWindowIDs addObject:@(window.windowID)];
+        }
+    } else if (selectedWindowGroup) {
+        [selectedWindowIDs addObject:@(selectedWindowGroup.windowID)];
+    }
+    
+    @weakify(self);
+    dispatch_async(self.queue, ^{
+        @strongify(self);
+        if (!windowGroups) {
+            [self private_cacheFrames];
+        }
+        self.shownWindowIDs = shownWindowIDs;
+        self.selectedWindowIDs = selectedWindowIDs;
+        [self.contentContainers enumerateKeysAndObjectsUsingBlock:^(NSNumber *windowID, _SWWindowContentContainer *contentContainer, BOOL *stop) {
+            contentContainer.worker.demand = [self private_demandForWindowID:windowID];
+        }];
     });
-    return contentContainerObject.content;
 }
 
 #pragma mark - SWWindowListSubscriber
@@ -130,45 +202,163 @@
     @weakify(self);
     dispatch_async(self.queue, ^{
         @strongify(self);
-        // Flatten the window group hierarchy into an unordered set of windows.
-        NSMutableSet *existingWindows = [NSMutableSet new];
-        for (SWWindowGroup *windowGroup in windowList) {
-            for (SWWindow *window in windowGroup.windows) {
-                [existingWindows addObject:window];
-            }
+        [self private_updateContentContainersWithWindowList:windowList forgetMissingWindows:YES];
+    });
+}
+
+- (oneway void)windowListServiceStopped:(SWWindowListService *)service;
+{
+    // The windows haven't gone anywhere, so their frames are kept for next time.
+    @weakify(self);
+    dispatch_async(self.queue, ^{
+        @strongify(self);
+        [self private_cacheFrames];
+        [self private_updateContentContainersWithWindowList:[NSOrderedSet orderedSet] forgetMissingWindows:NO];
+    });
+}
+
+#pragma mark - Internal
+
+// Queue only.
+- (void)private_updateContentContainersWithWindowList:(NSOrderedSet *)windowList forgetMissingWindows:(BOOL)forgetMissingWindows;
+{
+    // Flatten the window group hierarchy into an unordered set of windows.
+    NSMutableSet *existingWindows = [NSMutableSet new];
+    for (SWWindowGroup *windowGroup in windowList) {
+        for (SWWindow *window in windowGroup.windows) {
+            [existingWindows addObject:window];
         }
+    }
 
-        // Update/create content containers for all windows that exist.
-        for (SWWindow *window in existingWindows) {
-            _SWWindowContentContainer *contentContainerObject = [self.contentContainers objectForKey:@(window.windowID)];
-            if (!contentContainerObject) {
-                contentContainerObject = [_SWWindowContentContainer new];
-                [self.contentContainers setObject:contentContainerObject forKey:@(window.windowID)];
-            }
-            
-            contentContainerObject.window = window;
+    // Update/create content containers for all windows that exist.
+    for (SWWindow *window in existingWindows) {
+        _SWWindowContentContainer *contentContainerObject = [self.contentContainers objectForKey:@(window.windowID)];
+        BOOL created = NO;
+        if (!contentContainerObject) {
+            contentContainerObject = [_SWWindowContentContainer new];
+            [self.contentContainers setObject:contentContainerObject forKey:@(window.windowID)];
+            created = YES;
         }
         
-        // Remove content containers for windows that don't exist.
-        for (_SWWindowContentContainer *contentContainer in [self.contentContainers allValues]) {
-            if (![existingWindows containsObject:contentContainer.window]) {
-                [self.contentContainers removeObjectForKey:@(contentContainer.window.windowID)];
+        contentContainerObject.window = window;
+        if (created) {
+            contentContainerObject.worker.demand = [self private_demandForWindowID:@(window.windowID)];
+            [self private_loadCachedFrameIntoContentContainer:contentContainerObject];
+        }
+    }
+    
+    // Remove content containers for windows that don't exist.
+    for (_SWWindowContentContainer *contentContainer in [self.contentContainers allValues]) {
+        if (![existingWindows containsObject:contentContainer.window]) {
+            [self.contentContainers removeObjectForKey:@(contentContainer.window.windowID)];
+            [self private_setNeedsPublish];
+            if (forgetMissingWindows) {
+                SWFrameCacheRemove(&self->_frameCache, contentContainer.window.windowID);
             }
         }
-    });
+    }
 }
 
-- (oneway void)windowListServiceStopped:(SWWindowListService *)service;
+// Queue only.
+- (void)private_loadCachedFrameIntoContentContainer:(_SWWindowContentContainer *)contentContainer;
 {
-    [self windowListService:nil updatedList:[NSOrderedSet orderedSet]];
+    const SWFrameCacheEntry *frame = SWFrameCacheLookup(&self->_frameCache, contentContainer.window.windowID);
+    if (!frame) {
+        return;
+    }
+    
+    CGColorSpaceRef colorSpace = NNCFAutorelease(CGColorSpaceCreateDeviceRGB());
+    CGContextRef context = NNCFAutorelease(CGBitmapContextCreate(NULL, frame->width, frame->height, 8, 0, colorSpace, (CGBitmapInfo)frame->format));
+    if (!Check(context)) {
+        return;
+    }
+    SWFrameCacheDecode(frame, CGBitmapContextGetData(context), CGBitmapContextGetBytesPerRow(context));
+    CGImageRef image = NNCFAutorelease(CGBitmapContextCreateImage(context));
+    if (!Check(image)) {
+        return;
+    }
+    
+    contentContainer.content = [[NSImage alloc] initWithCGImage:image size:NSMakeSize(frame->width, frame->height)];
+    contentContainer.cached = YES;
+    [self private_setNeedsPublish];
 }
 
-#pragma mark - Internal
+// Keeps a small copy of each window's latest capture, to show next time until the window is captured again. Queue only.
+- (void)private_cacheFrames;
+{
+    for (_SWWindowContentContainer *contentContainer in self.contentContainers.objectEnumerator) {
+        if (!contentContainer.content || contentContainer.cached) {
+            continue;
+        }
+        
+        CGImageRef image = [contentContainer.content CGImageForProposedRect:NULL context:nil hints:nil];
+        if (!image) {
+            continue;
+        }
+        
+        size_t width, height;
+        SWResampleFitSize(CGImageGetWidth(image), CGImageGetHeight(image), kSWCachedFrameMaxEdge, kSWCachedFrameMaxPixels, &width, &height);
+        CGBitmapInfo format = kCGBitmapByteOrder32Host | (CGBitmapInfo)kCGImageAlphaPremultipliedFirst;
+        CGColorSpaceRef colorSpace = NNCFAutorelease(CGColorSpaceCreateDeviceRGB());
+        CGContextRef context = NNCFAutorelease(CGBitmapContextCreate(NULL, width, height, 8, 0, colorSpace, format));
+        if (!Check(context)) {
+            continue;
+        }
+        CGContextSetInterpolationQuality(context, kCGInterpolationMedium);
+        CGContextDrawImage(context, CGRectMake(0, 0, width, height), image);
+        
+        SWFrameCacheStore(&self->_frameCache, contentContainer.window.windowID, format, CGBitmapContextGetData(context), width, height, CGBitmapContextGetBytesPerRow(context));
+        contentContainer.cached = YES;
+    }
+}
+
+// Queue only.
+- (SWWindowWorkerDemand)private_demandForWindowID:(NSNumber *)windowID;
+{
+    if ([self.selectedWindowIDs containsObject:windowID]) {
+        return SWWindowWorkerDemandSelected;
+    } else if ([self.shownWindowIDs containsObject:windowID]) {
+        return SWWindowWorkerDemandVisible;
+    }
+    return SWWindowWorkerDemandNone;
+}
+
+// Changes to contentContainers are published together: a run of capture notifications already waiting on the queue results in one new snapshot.
+- (void)private_setNeedsPublish;
+{
+    if (self.publishPending) {
+        return;
+    }
+    self.publishPending = YES;
+    
+    @weakify(self);
+    dispatch_async(self.queue, ^{
+        @strongify(self);
+        self.publishPending = NO;
+        
+        NSUInteger count = self.contentContainers.count;
+        NSMutableData *windowIDs = [NSMutableData dataWithLength:MAX(count, (NSUInteger)1) * sizeof(uint32_t)];
+        NSMutableData *contents = [NSMutableData dataWithLength:MAX(count, (NSUInteger)1) * sizeof(void *)];
+        uint32_t *windowIDBuffer = windowIDs.mutableBytes;
+        const void **contentBuffer = contents.mutableBytes;
+        size_t published = 0;
+        for (_SWWindowContentContainer *contentContainer in self.contentContainers.objectEnumerator) {
+            if (contentContainer.content) {
+                windowIDBuffer[published] = contentContainer.window.windowID;
+                contentBuffer[published] = (__bridge const void *)contentContainer.content;
+                published++;
+            }
+        }
+        
+        Check(SWContentStorePublish(self->_contentStore, windowIDBuffer, contentBuffer, published));
+    });
+}
 
 - (void)private_windowUpdateNotification:(NSNotification *)notification;
 {
     SWWindowWorker *worker = notification.object;
     NSImage *content = notification.userInfo[@"content"];
+    NSArray *dirtyRects = notification.userInfo[@"dirtyRects"];
 
     @weakify(self);
     dispatch_async(self.queue, ^{
@@ -183,11 +373,13 @@
         }
         
         contentContainerObject.content = content;
+        contentContainerObject.cached = NO;
+        contentContainerObject.dirtyRects = dirtyRects;
+        NSUInteger generation = ++contentContainerObject.generation;
+        [self private_setNeedsPublish];
 
-        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
-            @strongify(self);
-            [(id<SWWindowContentsSubscriber>)self.subscriberDispatcher windowContentService:self updatedContent:content forWindow:contentContainerObject.window];
-        });
+        // Sent from the service's serial queue so that subscribers receive each window's generations in order. Queueing a oneway message doesn't block.
+        [(id<SWWindowContentsSubscriber>)self.subscriberDispatcher windowContentService:self updatedContent:content dirtyRects:dirtyRects generation:generation forWindow:contentContainerObject.window];
     });
 }
 
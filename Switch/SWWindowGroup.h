@@ -25,6 +25,4 @@
 
 - (instancetype)initWithWindows:(NSOrderedSet *)windows mainWindow:(SWWindow *)mainWindow;
 
-- (BOOL)isRelatedToLowerGroup:(SWWindowGroup *)group;
-
 @end
@@ -112,61 +112,4 @@
     return (CGRect){.origin = min, .size.width = max.x - min.x, .size.height = max.y - min.y};
 }
 
-#pragma mark - SWWindowGroup
-
-- (BOOL)isRelatedToLowerGroup:(SWWindowGroup *)group;
-{
-    // Ensure concentricity of groups, as a fast fail.
-    if (![self enclosedByWindow:group]) {
-        return NO;
-    }
-    
-    // Ensure that both windows belong to the same application, as a fast fail.
-    if (![self.application isEqual:group.application]) {
-        return NO;
-    }
-    
-    BOOL isSaveDialog = NO;
-    for (SWWindow *window in self.windows) {
-        if ([window.windowDescription[(__bridge NSString *)kCGWindowAlpha] doubleValue] < 1.0 && window.frame.size.height < 12.0 && self.windows.count > 1) {
-            isSaveDialog = YES;
-            break;
-        }
-        
-        if ([window.application.name isEqualToString:@"com.apple.security.pboxd"]
-        || [window.application.name isEqualToString:@"com.apple.appkit.xpc.openAndSav"])
-        {
-            isSaveDialog = YES;
-            /** XXX: in case of recursive calls, should check to make sure the window that the save dialog refers to is not already included in the group. Example:
-             
-             (lldb) po [windowGroupList[7] windows]
-             {(
-             0x6080002268c0 <48051 ((null))>,
-             0x608000225be0 <48050 ()>,
-             0x608000226900 <48045 (Save)>,
-             0x608000226500 <48046 (Save)>,
-             0x608000226520 <48043 (Untitled.txt)>
-             )}
-             
-             (lldb) po [((NSOrderedSet *)[windowGroupList[7] windows])[2] application]
-             0x6080002268e0 <82769 (com.apple.appkit.xpc.openAndSavePanelService)>
-             (lldb) p (CGRect)[((NSOrderedSet *)[windowGroupList[7] windows])[2] frame]
-             (CGRect) $8 = (x=222, y=69), (width=489, height=319)
-
-             (lldb) po [((NSOrderedSet *)[windowGroupList[7] windows])[3] application]
-             0x608000226560 <82763 (TextEdit)>
-             (lldb) p (CGRect)[((NSOrderedSet *)[windowGroupList[7] windows])[3] frame]
-             (CGRect) $7 = (x=222, y=69), (width=490, height=319)
-             
-             (lldb) p (CGRect)[((NSOrderedSet *)[windowGroupList[7] windows])[4] frame]
-             (CGRect) $9 = (x=147, y=47), (width=640, height=412)
-             
-             */
-            break;
-        }
-    }
-    
-    return isSaveDialog;
-}
-
 @end
@@ -0,0 +1,38 @@
+//
+//  SWWindowListDelta.h
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+
+
+// The difference between two successive window lists from CGWindowListCopyWindowInfo, keyed on window number.
+@interface SWWindowListDelta : NSObject
+
+// A fingerprint of everything in a window description that Switch cares about. Memory usage, which churns constantly, is left out.
++ (uint64_t)fingerprintForWindowInfo:(NSDictionary *)windowInfo;
+
+// Packs a window info list into an array of SWWindowListEntry for diffing.
++ (NSData *)entriesForWindowInfoList:(NSArray *)windowInfoList;
+
+// oldEntries may be nil, in which case every window is inserted.
++ (instancetype)deltaFromEntries:(NSData *)oldEntries toEntries:(NSData *)newEntries;
+
+// Sets of CGWindowIDs.
+@property (nonatomic, copy, readonly) NSIndexSet *insertedWindowIDs;
+@property (nonatomic, copy, readonly) NSIndexSet *removedWindowIDs;
+@property (nonatomic, copy, readonly) NSIndexSet *movedWindowIDs;
+@property (nonatomic, copy, readonly) NSIndexSet *updatedWindowIDs;
+
+@property (nonatomic, assign, readonly, getter=isEmpty) BOOL empty;
+
+@end
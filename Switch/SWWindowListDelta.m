@@ -0,0 +1,147 @@
+//
+//  SWWindowListDelta.m
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#import "SWWindowListDelta.h"
+
+#import "windowListDiff.h"
+
+
+static uint64_t fingerprintObject(uint64_t fingerprint, id object)
+{
+    if (!object) {
+        uint8_t missing = 0;
+        return SWWindowListFingerprint(fingerprint, &missing, sizeof(missing));
+    }
+    
+    if ([object isKindOfClass:[NSNumber class]]) {
+        double value = [object doubleValue];
+        return SWWindowListFingerprint(fingerprint, &value, sizeof(value));
+    }
+    
+    if ([object isKindOfClass:[NSString class]]) {
+        CFStringRef string = (__bridge CFStringRef)object;
+        CFIndex length = CFStringGetLength(string);
+        const UniChar *characters = CFStringGetCharactersPtr(string);
+        if (characters) {
+            fingerprint = SWWindowListFingerprint(fingerprint, characters, (size_t)length * sizeof(UniChar));
+        } else {
+            UniChar buffer[64];
+            for (CFIndex location = 0; location < length; location += 64) {
+                CFRange range = CFRangeMake(location, MIN(length - location, (CFIndex)64));
+                CFStringGetCharacters(string, range, buffer);
+                fingerprint = SWWindowListFingerprint(fingerprint, buffer, (size_t)range.length * sizeof(UniChar));
+            }
+        }
+        // Terminate the string so that adjacent fields can't trade characters.
+        return SWWindowListFingerprint(fingerprint, &length, sizeof(length));
+    }
+    
+    if ([object isKindOfClass:[NSDictionary class]]) {
+        CGRect rect;
+        if (CGRectMakeWithDictionaryRepresentation((__bridge CFDictionaryRef)object, &rect)) {
+            return SWWindowListFingerprint(fingerprint, &rect, sizeof(rect));
+        }
+    }
+    
+    NSUInteger hash = [object hash];
+    return SWWindowListFingerprint(fingerprint, &hash, sizeof(hash));
+}
+
+
+@implementation SWWindowListDelta
+
++ (uint64_t)fingerprintForWindowInfo:(NSDictionary *)windowInfo;
+{
+    static NSArray *keys;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        keys = @[
+            (__bridge NSString *)kCGWindowNumber,
+            (__bridge NSString *)kCGWindowOwnerPID,
+            (__bridge NSString *)kCGWindowLayer,
+            (__bridge NSString *)kCGWindowAlpha,
+            (__bridge NSString *)kCGWindowBounds,
+            (__bridge NSString *)kCGWindowName,
+            (__bridge NSString *)kCGWindowOwnerName,
+            (__bridge NSString *)kCGWindowIsOnscreen,
+            (__bridge NSString *)kCGWindowSharingState,
+            (__bridge NSString *)kCGWindowStoreType,
+        ];
+    });
+    
+    uint64_t fingerprint = kSWWindowListFingerprintSeed;
+    for (NSString *key in keys) {
+        fingerprint = fingerprintObject(fingerprint, windowInfo[key]);
+    }
+    return fingerprint;
+}
+
++ (NSData *)entriesForWindowInfoList:(NSArray *)windowInfoList;
+{
+    NSMutableData *result = [NSMutableData dataWithLength:windowInfoList.count * sizeof(SWWindowListEntry)];
+    SWWindowListEntry *entries = result.mutableBytes;
+    for (NSUInteger i = 0; i < windowInfoList.count; ++i) {
+        NSDictionary *windowInfo = windowInfoList[i];
+        entries[i].windowID = [windowInfo[(__bridge NSString *)kCGWindowNumber] unsignedIntValue];
+        entries[i].fingerprint = [self fingerprintForWindowInfo:windowInfo];
+    }
+    return result;
+}
+
++ (instancetype)deltaFromEntries:(NSData *)oldEntries toEntries:(NSData *)newEntries;
+{
+    size_t oldCount = oldEntries.length / sizeof(SWWindowListEntry);
+    size_t newCount = newEntries.length / sizeof(SWWindowListEntry);
+    NSMutableData *changeBuffer = [NSMutableData dataWithLength:SWWindowListDiffCapacity(oldCount, newCount) * sizeof(SWWindowListChange)];
+    SWWindowListChange *changes = changeBuffer.mutableBytes;
+    size_t changeCount = SWWindowListDiff(oldEntries.bytes, oldCount, newEntries.bytes, newCount, changes);
+    
+    NSMutableIndexSet *inserted = [NSMutableIndexSet new];
+    NSMutableIndexSet *removed = [NSMutableIndexSet new];
+    NSMutableIndexSet *moved = [NSMutableIndexSet new];
+    NSMutableIndexSet *updated = [NSMutableIndexSet new];
+    for (size_t i = 0; i < changeCount; ++i) {
+        switch (changes[i].kind) {
+            case SWWindowListChangeInsert:
+                [inserted addIndex:changes[i].windowID];
+                break;
+            case SWWindowListChangeRemove:
+                [removed addIndex:changes[i].windowID];
+                break;
+            case SWWindowListChangeMove:
+                [moved addIndex:changes[i].windowID];
+                break;
+            case SWWindowListChangeUpdate:
+                [updated addIndex:changes[i].windowID];
+                break;
+        }
+    }
+    
+    SWWindowListDelta *result = [self new];
+    result->_insertedWindowIDs = inserted;
+    result->_removedWindowIDs = removed;
+    result->_movedWindowIDs = moved;
+    result->_updatedWindowIDs = updated;
+    result->_empty = (changeCount == 0);
+    return result;
+}
+
+#pragma mark - NSObject
+
+- (NSString *)description;
+{
+    return [NSString stringWithFormat:@"%p <+%lu -%lu ~%lu >%lu>", self, (unsigned long)self.insertedWindowIDs.count, (unsigned long)self.removedWindowIDs.count, (unsigned long)self.updatedWindowIDs.count, (unsigned long)self.movedWindowIDs.count];
+}
+
+@end
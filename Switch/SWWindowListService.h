@@ -28,6 +28,8 @@
 @interface SWWindowListService : NNService
 
 + (NSOrderedSet *)filterInfoDictionariesToWindowObjects:(NSArray *)infoDicts;
+// windowsByID maps window IDs (NSNumbers) to window objects that are known to be current and are used in place of building new ones.
++ (NSOrderedSet *)filterInfoDictionariesToWindowObjects:(NSArray *)infoDicts reusingWindows:(NSDictionary *)windowsByID;
 + (NSOrderedSet *)filterWindowObjectsToWindowGroups:(NSOrderedSet *)rawWindowList;
 + (NSOrderedSet *)sortedWindowGroups:(NSOrderedSet *)windowGroups;
 
@@ -18,15 +18,22 @@
 
 #import "SWApplication.h"
 #import "SWPreferencesService.h"
+#import "SWScreenTopology.h"
 #import "SWWindow.h"
 #import "SWWindowGroup.h"
+#import "SWWindowListDelta.h"
 #import "SWWindowListWorker.h"
 
 
-@interface SWWindowListService ()
+@interface SWWindowListService () {
+    // Reused by every update, so decoding a window list only allocates when it's larger than any before it.
+    SWWindowTable _windowTable;
+}
 
 @property (nonatomic, copy, readwrite) NSOrderedSet *windows;
 @property (nonatomic, strong, readwrite) SWWindowListWorker *worker;
+// The window objects built by the last update, by window ID.
+@property (nonatomic, copy) NSDictionary *windowsByID;
 
 @end
 
@@ -42,12 +49,22 @@ static NSMutableSet *loggedWindows;
 {
     SWLogMainThreadOnly();
     BailUnless(self = [super init], nil);
+    BailUnless(SWWindowTableInit(&self->_windowTable, 0), nil);
+    [[self class] private_setUserQuirksInWindowTable:&self->_windowTable];
+    
+    // Each list is complete, so subscribers that fall behind only need the newest one.
+    [self.subscriberDispatcher coalesceSelector:@selector(windowListService:updatedList:) byArgumentAtIndex:NSNotFound];
     
     [[NSNotificationCenter defaultCenter] addWeakObserver:self selector:NNSelfSelector1(private_workerUpdatedWindowList:) name:[SWWindowListWorker notificationName] object:nil];
     
     return self;
 }
 
+- (void)dealloc;
+{
+    SWWindowTableDestroy(&self->_windowTable);
+}
+
 #pragma mark - NNService
 
 + (NNServiceType)serviceType;
@@ -79,6 +96,7 @@ static NSMutableSet *loggedWindows;
     loggedWindows = nil;
     self.worker = nil;
     self.windows = nil;
+    self.windowsByID = nil;
     
     [(id<SWWindowListSubscriber>)self.subscriberDispatcher windowListServiceStopped:self];
     
@@ -89,89 +107,80 @@ static NSMutableSet *loggedWindows;
 
 + (NSOrderedSet *)filterInfoDictionariesToWindowObjects:(NSArray *)infoDicts;
 {
-    return [NSOrderedSet orderedSetWithArray:[[infoDicts nn_filter:(nn_filter_block_t)^(NSDictionary *windowInfo) {
-        NSString *applicationName = windowInfo[(__bridge NSString *)kCGWindowOwnerName];
-        
-        // Non-normal windows are filtered out as the accuracy of their ordering in the window list cannot be guaranteed.
-        BOOL normalWindow = ([windowInfo[(__bridge NSString *)kCGWindowLayer] longValue] == kCGNormalWindowLevel);
-        BOOL transparentWindow = ([windowInfo[(__bridge NSString *)kCGWindowAlpha] doubleValue] == 0.0);
-        
-        BOOL msWordWindow = [applicationName isEqualToString:@"Microsoft Word"];
-        BOOL badMSWordWindow = msWordWindow && [windowInfo[(__bridge NSString *)kCGWindowName] isEqualToString:@"Microsoft Word"];
-        
-        BOOL isolatorWindow = [applicationName isEqualToString:@"Isolator"];
-        BOOL isolatorShield = isolatorWindow && ([windowInfo[(__bridge NSString *)kCGWindowAlpha] doubleValue] < 0.9);
+    return [self filterInfoDictionariesToWindowObjects:infoDicts reusingWindows:nil];
+}
 
-        return normalWindow && !transparentWindow && !badMSWordWindow && !isolatorShield;
-    }] nn_map:(nn_map_block_t)^(NSDictionary *windowInfo) {
-        return [SWWindow windowWithDescription:windowInfo];
-    }]];
++ (NSOrderedSet *)filterInfoDictionariesToWindowObjects:(NSArray *)infoDicts reusingWindows:(NSDictionary *)windowsByID;
+{
+    SWWindowTable table;
+    BailUnless(SWWindowTableInit(&table, infoDicts.count), nil);
+    [self private_setUserQuirksInWindowTable:&table];
+    NSOrderedSet *result = [self private_filterInfoDictionaries:infoDicts intoWindowTable:&table reusingWindows:windowsByID];
+    SWWindowTableDestroy(&table);
+    return result;
 }
 
 + (NSOrderedSet *)filterWindowObjectsToWindowGroups:(NSOrderedSet *)rawWindowList;
 {
-    NSMutableOrderedSet *mutableWindowGroupList = [NSMutableOrderedSet new];
-    
-    __block NSMutableOrderedSet *windows = [NSMutableOrderedSet new];
-    __block SWWindow *mainWindow = nil;
-    dispatch_block_t addWindowGroup = ^{
-        if (windows.count) {
-            SWWindowGroup *group = [[SWWindowGroup alloc] initWithWindows:[windows reversedOrderedSet] mainWindow:mainWindow];
-            
-            if (mutableWindowGroupList.count && [group isRelatedToLowerGroup:mutableWindowGroupList.lastObject]) {
-                NSMutableOrderedSet *windowList = [group.windows mutableCopy];
-                [windowList addObjectsFromArray:((SWWindowGroup *)mutableWindowGroupList.lastObject).windows.array];
-                group = [[SWWindowGroup alloc] initWithWindows:windowList mainWindow:((SWWindowGroup *)mutableWindowGroupList.lastObject).mainWindow];
-                [mutableWindowGroupList removeObject:mutableWindowGroupList.lastObject];
-            }
-            
-            [mutableWindowGroupList addObject:group];
-            
-            if (![loggedWindows containsObject:group]) {
-                [loggedWindows addObject:group];
-            }
-
-            windows = [NSMutableOrderedSet new];
-            mainWindow = nil;
+    SWWindowTable table;
+    BailUnless(SWWindowTableInit(&table, rawWindowList.count), nil);
+    [self private_setUserQuirksInWindowTable:&table];
+    for (SWWindow *window in rawWindowList) {
+        if (!Check([window appendToWindowTable:&table] != SIZE_MAX)) {
+            SWWindowTableDestroy(&table);
+            return nil;
         }
-    };
-    
-    for (NSInteger i = (NSInteger)rawWindowList.count - 1; i >= 0; --i) {
-        SWWindow *window = rawWindowList[(NSUInteger)i];
+    }
+    NSOrderedSet *result = [self private_groupWindows:rawWindowList inWindowTable:&table topology:[SWScreenTopology currentTopology]];
+    SWWindowTableDestroy(&table);
+    return result;
+}
 
-        if (mainWindow && ![window isRelatedToLowerWindow:mainWindow]) {
-            addWindowGroup();
+// XXX: This cannot be tested unless SW provides a type that encapsulates an NSScreen
++ (NSOrderedSet *)sortedWindowGroups:(NSOrderedSet *)windowGroups;
+{
+    return [self private_sortedWindowGroups:windowGroups topology:[SWScreenTopology currentTopology]];
+}
+
+- (void)refreshWindowListAndWait;
+{
+    SWLogBackgroundThreadOnly();
+    // Polling through the worker's scheduler means this never runs alongside a scheduled refresh, and one that was already running is followed by a fresh one.
+    [self.worker pollNowAndWait];
+}
+
+#pragma mark - Internal
+
+// Sets the quirks from the user's preferences, which replace the table's own for the same applications. Malformed rules and unknown quirk names are logged and skipped.
++ (void)private_setUserQuirksInWindowTable:(SWWindowTable *)table;
+{
+    NSDictionary *rules = [SWPreferencesService sharedService].windowQuirks;
+    if (![rules isKindOfClass:[NSDictionary class]]) {
+        SWLog(@"Ignoring window quirks preference, which is not a dictionary: %@", rules);
+        return;
+    }
+    
+    [rules enumerateKeysAndObjectsUsingBlock:^(NSString *ownerName, NSArray *quirkNames, BOOL *stop) {
+        if (![ownerName isKindOfClass:[NSString class]] || ![quirkNames isKindOfClass:[NSArray class]]) {
+            SWLog(@"Ignoring malformed window quirks rule %@: %@", ownerName, quirkNames);
+            return;
         }
         
-        if (window.application.canBeActivated) {
-            // Some applications don't name their windows, some people juggle geese. Make sure there's always a main window for the group.
-            if (!mainWindow) {
-                mainWindow = window;
-            } else
-            // Named windows always supercede unnamed siblings in the same window group.
-            if (window.name.length && !mainWindow.name.length) {
-                mainWindow = window;
+        SWWindowTableQuirks quirks = 0;
+        for (NSString *quirkName in quirkNames) {
+            SWWindowTableQuirks quirk = [quirkName isKindOfClass:[NSString class]] ? SWWindowTableQuirkNamed(quirkName.UTF8String, strlen(quirkName.UTF8String)) : 0;
+            if (!quirk) {
+                SWLog(@"Ignoring unknown window quirk %@ for %@", quirkName, ownerName);
             }
+            quirks |= quirk;
         }
         
-        [windows addObject:window];
-    }
-    if (mainWindow) {
-        addWindowGroup();
-    }
-    
-    // Hacky filter to remove Finder Quicklook windows
-    for (SWWindowGroup *group in [mutableWindowGroupList copy]) {
-        if (group.windows.count == 1 && [group.application.name isEqualToString:@"Finder"] && group.mainWindow.name.length == 0 && !group.application.isActiveApplication) {
-            [mutableWindowGroupList removeObject:group];
-        }
-    }
-    
-    return [mutableWindowGroupList reversedOrderedSet];
+        const char *owner = ownerName.UTF8String;
+        Check(SWWindowTableSetQuirks(table, owner, strlen(owner), quirks));
+    }];
 }
 
-// XXX: This cannot be tested unless SW provides a type that encapsulates an NSScreen
-+ (NSOrderedSet *)sortedWindowGroups:(NSOrderedSet *)windowGroups;
++ (NSOrderedSet *)private_sortedWindowGroups:(NSOrderedSet *)windowGroups topology:(SWScreenTopology *)topology;
 {
     // Default behaviour is to order by recency
     NSOrderedSet *result = windowGroups;
@@ -185,8 +194,7 @@ static NSMutableSet *loggedWindows;
 
         // Break up the windows into separate lists by screen
         for (SWWindowGroup *windowGroup in windowGroups) {
-            // TODO: SW wrapper for NSScreen because this is gross.
-            CGDirectDisplayID displayID = [windowGroup.screen.deviceDescription[@"NSScreenNumber"] unsignedIntValue];
+            CGDirectDisplayID displayID = [topology displayIDForFlippedFrame:windowGroup.flippedFrame];
 
             if (!windowsByDisplayID[@(displayID)]) {
                 [orderedDisplayIDs addObject:@(displayID)];
@@ -215,13 +223,88 @@ static NSMutableSet *loggedWindows;
     return result;
 }
 
-- (void)refreshWindowListAndWait;
+// Decodes infoDicts into an empty table and filters them. Afterwards the table holds one row for each of the returned windows, in the same order.
++ (NSOrderedSet *)private_filterInfoDictionaries:(NSArray *)infoDicts intoWindowTable:(SWWindowTable *)table reusingWindows:(NSDictionary *)windowsByID;
 {
-    SWLogBackgroundThreadOnly();
-    [self.worker refreshWindowListAndWait];
+    NSParameterAssert(table->count == 0);
+    
+    for (NSDictionary *windowInfo in infoDicts) {
+        BailUnless([SWWindow appendDescription:windowInfo toWindowTable:table] != SIZE_MAX, nil);
+    }
+    
+    NSMutableData *rowBuffer = [NSMutableData dataWithLength:MAX(table->count, (size_t)1) * sizeof(size_t)];
+    size_t *rows = rowBuffer.mutableBytes;
+    size_t rowCount = SWWindowTableFilter(table, rows);
+    
+    NSMutableOrderedSet *result = [NSMutableOrderedSet orderedSetWithCapacity:rowCount];
+    size_t keptCount = 0;
+    for (size_t i = 0; i < rowCount; ++i) {
+        size_t row = rows[i];
+        SWWindow *window = windowsByID[@(table->windowIDs[row])] ?: [SWWindow windowWithDescription:infoDicts[row] windowTable:table row:row];
+        
+        // Duplicate descriptions collapse into one window, so they must collapse into one row too.
+        NSUInteger count = result.count;
+        [result addObject:window];
+        if (result.count > count) {
+            rows[keptCount++] = row;
+        }
+    }
+    SWWindowTableCompact(table, rows, keptCount);
+    
+    return result;
 }
 
-#pragma mark - Internal
+// Groups windows, given a table holding one row for each of them in the same order.
++ (NSOrderedSet *)private_groupWindows:(NSOrderedSet *)windows inWindowTable:(SWWindowTable *)table topology:(SWScreenTopology *)topology;
+{
+    NSParameterAssert(windows.count == table->count);
+    
+    // Which screen a window is on and whether its application can be activated aren't part of the window list. Screens are assigned to the whole table in one pass, and applications are asked at most once each.
+    [topology assignScreensInWindowTable:table];
+    NSMapTable *canBeActivatedByApplication = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsObjectPointerPersonality valueOptions:NSPointerFunctionsStrongMemory];
+    for (size_t row = 0; row < table->count; ++row) {
+        SWWindow *window = windows[row];
+        
+        NSNumber *canBeActivated = [canBeActivatedByApplication objectForKey:window.application];
+        if (!canBeActivated) {
+            canBeActivated = @(window.application.canBeActivated);
+            [canBeActivatedByApplication setObject:canBeActivated forKey:window.application];
+        }
+        if (!canBeActivated.boolValue) {
+            continue;
+        }
+        table->flags[row] |= SWWindowTableFlagCanBeActivated;
+        
+        // Applications without an owner name in their description are named by their running application instead.
+        if (table->ownerNames[row] == SWWindowTableAtomNone && window.application.name.length) {
+            table->ownerNames[row] = SWWindowTableInternString(table, window.application.name);
+        }
+    }
+    
+    NSMutableData *groupBuffer = [NSMutableData dataWithLength:MAX(table->count, (size_t)1) * sizeof(SWWindowTableGroup)];
+    SWWindowTableGroup *groups = groupBuffer.mutableBytes;
+    size_t groupCount = SWWindowTableGroupWindows(table, groups);
+    
+    NSMutableOrderedSet *mutableWindowGroupList = [NSMutableOrderedSet new];
+    for (size_t i = 0; i < groupCount; ++i) {
+        NSOrderedSet *groupWindows = [[NSOrderedSet alloc] initWithOrderedSet:windows range:NSMakeRange(groups[i].start, groups[i].count) copyItems:NO];
+        SWWindowGroup *group = [[SWWindowGroup alloc] initWithWindows:groupWindows mainWindow:windows[groups[i].mainWindow]];
+        
+        if (![loggedWindows containsObject:group]) {
+            [loggedWindows addObject:group];
+        }
+        
+        // Hacky filter to remove Finder Quicklook windows
+        size_t mainWindow = groups[i].mainWindow;
+        if (groups[i].count == 1 && (SWWindowTableQuirksOfRow(table, mainWindow) & SWWindowTableQuirkHideLoneUnnamedWindowsWhenInactive) && table->names[mainWindow] == SWWindowTableAtomNone && !group.application.isActiveApplication) {
+            continue;
+        }
+        
+        [mutableWindowGroupList addObject:group];
+    }
+    
+    return [mutableWindowGroupList reversedOrderedSet];
+}
 
 - (void)private_workerUpdatedWindowList:(NSNotification *)notification;
 {
@@ -231,15 +314,43 @@ static NSMutableSet *loggedWindows;
     
     NSParameterAssert([notification.userInfo[@"windows"] isKindOfClass:[NSArray class]]);
     
-    [self private_updateWindowList:notification.userInfo[@"windows"]];
+    [self private_updateWindowList:notification.userInfo[@"windows"] delta:notification.userInfo[@"delta"]];
 }
 
 - (void)private_updateWindowList:(NSArray *)windowInfoList;
+{
+    [self private_updateWindowList:windowInfoList delta:nil];
+}
+
+// Without a delta, every window object is rebuilt. With one, only windows that were inserted or updated are.
+- (void)private_updateWindowList:(NSArray *)windowInfoList delta:(SWWindowListDelta *)delta;
 {
     BailUnless(windowInfoList,);
-    NSOrderedSet *windowObjectList = [[self class] filterInfoDictionariesToWindowObjects:windowInfoList];
-    NSOrderedSet *windowGroupList = [[self class] filterWindowObjectsToWindowGroups:windowObjectList];
-    NSOrderedSet *sortedWindowGroupList = [[self class] sortedWindowGroups:windowGroupList];
+    
+    NSDictionary *reusableWindows = nil;
+    if (delta && self.windowsByID) {
+        NSMutableDictionary *windowsByID = [self.windowsByID mutableCopy];
+        for (NSIndexSet *changedWindowIDs in @[delta.insertedWindowIDs, delta.updatedWindowIDs, delta.removedWindowIDs]) {
+            [changedWindowIDs enumerateIndexesUsingBlock:^(NSUInteger windowID, BOOL *stop) {
+                [windowsByID removeObjectForKey:@(windowID)];
+            }];
+        }
+        reusableWindows = windowsByID;
+    }
+    
+    SWWindowTableRemoveAll(&self->_windowTable);
+    NSOrderedSet *windowObjectList = [[self class] private_filterInfoDictionaries:windowInfoList intoWindowTable:&self->_windowTable reusingWindows:reusableWindows];
+    BailUnless(windowObjectList,);
+    NSMutableDictionary *windowsByID = [NSMutableDictionary dictionaryWithCapacity:windowObjectList.count];
+    for (SWWindow *window in windowObjectList) {
+        windowsByID[@(window.windowID)] = window;
+    }
+    self.windowsByID = windowsByID;
+    
+    // One snapshot of the screens serves the whole update.
+    SWScreenTopology *topology = [SWScreenTopology currentTopology];
+    NSOrderedSet *windowGroupList = [[self class] private_groupWindows:windowObjectList inWindowTable:&self->_windowTable topology:topology];
+    NSOrderedSet *sortedWindowGroupList = [[self class] private_sortedWindowGroups:windowGroupList topology:topology];
     
     if (![self.windows isEqualToOrderedSet:sortedWindowGroupList]) {
         self.windows = sortedWindowGroupList;
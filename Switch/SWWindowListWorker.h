@@ -14,6 +14,4 @@
 
 @interface SWWindowListWorker : NNPollingObject
 
-- (void)refreshWindowListAndWait;
-
 @end
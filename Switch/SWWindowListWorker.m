@@ -16,6 +16,8 @@
 
 #import <NNKit/NNPollingObject+Protected.h>
 
+#import "SWWindowListDelta.h"
+
 
 static NSTimeInterval refreshInterval = 0.1;
 
@@ -23,7 +25,7 @@ static NSTimeInterval refreshInterval = 0.1;
 @interface SWWindowListWorker ()
 
 @property (nonatomic, copy, readwrite) NSArray *windowInfoList;
-@property (nonatomic, strong) dispatch_queue_t private_queue;
+@property (nonatomic, copy) NSData *windowListEntries;
 
 @end
 
@@ -37,7 +39,6 @@ static NSTimeInterval refreshInterval = 0.1;
     dispatch_queue_t q = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
     if (!(self = [super initWithQueue:q])) { return nil; }
     
-    self.private_queue = q;
     self.interval = refreshInterval;
 
     return self;
@@ -50,14 +51,7 @@ static NSTimeInterval refreshInterval = 0.1;
     [self private_refreshWindowList];
 }
 
-#pragma mark - SWWindowListWorker
-
-- (void)refreshWindowListAndWait;
-{
-    dispatch_sync(self.private_queue, ^{
-        [self private_refreshWindowList];
-    });
-}
+#pragma mark - Internal
 
 - (void)private_refreshWindowList;
 {
@@ -66,9 +60,12 @@ static NSTimeInterval refreshInterval = 0.1;
     SWTimeTask(SWCodeBlock({
         CFArrayRef cgWindowInfoList = CGWindowListCopyWindowInfo(kCGWindowListOptionOnScreenOnly | kCGWindowListExcludeDesktopElements,  kCGNullWindowID);
         NSArray *windowInfoList = CFBridgingRelease(cgWindowInfoList);
-        if (![self.windowInfoList isEqualToArray:windowInfoList]) {
+        NSData *windowListEntries = [SWWindowListDelta entriesForWindowInfoList:windowInfoList];
+        SWWindowListDelta *delta = [SWWindowListDelta deltaFromEntries:self.windowListEntries toEntries:windowListEntries];
+        if (!delta.empty) {
             self.windowInfoList = windowInfoList;
-            [self postNotification:@{@"windows" : self.windowInfoList}];
+            self.windowListEntries = windowListEntries;
+            [self postNotification:@{@"windows" : self.windowInfoList, @"delta" : delta}];
         }
     }), @"Copying window info list");
 }
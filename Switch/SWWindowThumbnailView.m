@@ -18,6 +18,7 @@
 #import <QuartzCore/QuartzCore.h>
 
 #import "SWApplication.h"
+#import "SWThumbnailCanvas.h"
 #import "SWWindowContentsService.h"
 #import "SWWindowGroup.h"
 #import "SWWindowListService.h"
@@ -27,6 +28,7 @@
 
 @property (nonatomic, strong, readonly) NSOrderedSet *windowIDList;
 @property (nonatomic, strong, readonly) NSMutableDictionary *windowFrames;
+@property (nonatomic, strong, readonly) NSMutableDictionary *canvases;
 @property (nonatomic, assign) BOOL valid;
 
 
@@ -65,6 +67,7 @@
     }
     _windowIDList = windowIDList;
     _windowFrames = windowFrames;
+    _canvases = [NSMutableDictionary new];
     
     _valid = YES;
     
@@ -72,7 +75,6 @@
     // View initialization
     //
     
-    self.translatesAutoresizingMaskIntoConstraints = NO;
     [self setWantsLayer:YES];
     self.layerContentsRedrawPolicy = NSViewLayerContentsRedrawOnSetNeedsDisplay;
     [self private_createLayers];
@@ -80,7 +82,8 @@
     for (SWWindow *window in _windowGroup.windows) {
         NSImage *content = [[SWWindowContentsService sharedService] contentForWindow:window];
         if (content) {
-            [self private_sublayerForWindow:window].contents = content;
+            // The generation of this content is unknown, so the next update will redraw the whole thumbnail.
+            [self private_updateWindow:window content:content dirtyRects:nil generation:0];
         }
     }
     
@@ -143,6 +146,7 @@
         frame.origin.y += scaledYOffset;
         
         layer.frame = frame;
+        [self private_layoutTilesOfLayer:layer canvas:self.canvases[@(window.windowID)]];
     }
     
     [self private_updateIconLayout];
@@ -236,7 +240,7 @@
 
 #pragma mark - SWWindowContentsSubscriber
 
-- (oneway void)windowContentService:(SWWindowContentsService *)windowService updatedContent:(NSImage *)content forWindow:(SWWindow *)window;
+- (oneway void)windowContentService:(SWWindowContentsService *)windowService updatedContent:(NSImage *)content dirtyRects:(NSArray *)dirtyRects generation:(NSUInteger)generation forWindow:(SWWindow *)window;
 {
     if (!self.valid) {
         return;
@@ -251,7 +255,7 @@
         [self setNeedsLayout:YES];
     }
     
-    [self private_sublayerForWindow:window].contents = content;
+    [self private_updateWindow:window content:content dirtyRects:dirtyRects generation:generation];
 }
 
 #pragma mark - Internal
@@ -272,7 +276,10 @@
     [self.layer addSublayer:self.thumbnailLayer];
     
     for (sw_unused SWWindow *window in self.windowGroup.windows) {
-        [self.thumbnailLayer addSublayer:newLayer()];
+        // Each window's layer holds one sublayer per canvas tile, laid out from the top left.
+        CALayer *windowLayer = newLayer();
+        windowLayer.geometryFlipped = YES;
+        [self.thumbnailLayer addSublayer:windowLayer];
     }
     
     self.iconLayer = newLayer();
@@ -301,6 +308,84 @@
     };
 }
 
+- (void)private_updateWindow:(SWWindow *)window content:(NSImage *)content dirtyRects:(NSArray *)dirtyRects generation:(NSUInteger)generation;
+{
+    SWThumbnailCanvas *canvas = self.canvases[@(window.windowID)];
+    if (generation && canvas.generation >= generation) {
+        // Already showing this content or something newer.
+        return;
+    }
+    
+    CGImageRef image = [content CGImageForProposedRect:NULL context:nil hints:nil];
+    if (!Check(image)) {
+        return;
+    }
+    
+    if (!canvas) {
+        CGFloat backingScaleFactor = [[[NSScreen screens] valueForKeyPath:@"@max.backingScaleFactor"] doubleValue];
+        canvas = [[SWThumbnailCanvas alloc] initWithMaximumPixelSize:kNNMaxWindowThumbnailSize * MAX(1.0, backingScaleFactor)];
+        self.canvases[@(window.windowID)] = canvas;
+    }
+    
+    if ([canvas updateWithImage:image dirtyRects:dirtyRects generation:generation]) {
+        [self private_updateTilesOfLayer:[self private_sublayerForWindow:window] canvas:canvas];
+    }
+}
+
+// Only the tiles the canvas just replaced get new contents, so only they are uploaded.
+- (void)private_updateTilesOfLayer:(CALayer *)layer canvas:(SWThumbnailCanvas *)canvas;
+{
+    if (!layer) {
+        return;
+    }
+    
+    NSIndexSet *updatedTiles = canvas.updatedTiles;
+    if (layer.sublayers.count != canvas.tileCount) {
+        layer.sublayers = nil;
+        for (NSUInteger i = 0; i < canvas.tileCount; ++i) {
+            CALayer *tileLayer = [CALayer layer];
+            tileLayer.magnificationFilter = kCAFilterTrilinear;
+            tileLayer.minificationFilter = kCAFilterTrilinear;
+            tileLayer.contentsGravity = kCAGravityResize;
+            // Antialiased edges would show the seams between tiles.
+            tileLayer.edgeAntialiasingMask = 0;
+            tileLayer.actions = @{@"contents" : [NSNull null], @"position" : [NSNull null], @"bounds" : [NSNull null]};
+            [layer addSublayer:tileLayer];
+        }
+        updatedTiles = [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, canvas.tileCount)];
+    }
+    
+    // The canvas' size can change with a full update.
+    if (updatedTiles.count == canvas.tileCount) {
+        [self private_layoutTilesOfLayer:layer canvas:canvas];
+    }
+    
+    NSArray *tileLayers = layer.sublayers;
+    [updatedTiles enumerateIndexesUsingBlock:^(NSUInteger index, BOOL *stop) {
+        ((CALayer *)tileLayers[index]).contents = (__bridge id)[canvas imageForTileAtIndex:index];
+    }];
+}
+
+// Fits the canvas into the layer, keeping its aspect ratio.
+- (void)private_layoutTilesOfLayer:(CALayer *)layer canvas:(SWThumbnailCanvas *)canvas;
+{
+    CGSize pixelSize = canvas.pixelSize;
+    if (!layer || layer.sublayers.count != canvas.tileCount || pixelSize.width < 1.0 || pixelSize.height < 1.0) {
+        return;
+    }
+    
+    CGSize layerSize = layer.bounds.size;
+    CGFloat scale = MIN(layerSize.width / pixelSize.width, layerSize.height / pixelSize.height);
+    CGFloat xOffset = (layerSize.width - pixelSize.width * scale) / 2.0;
+    CGFloat yOffset = (layerSize.height - pixelSize.height * scale) / 2.0;
+    
+    NSArray *tileLayers = layer.sublayers;
+    for (NSUInteger i = 0; i < tileLayers.count; ++i) {
+        CGRect rect = [canvas rectForTileAtIndex:i];
+        ((CALayer *)tileLayers[i]).frame = CGRectMake(xOffset + rect.origin.x * scale, yOffset + rect.origin.y * scale, rect.size.width * scale, rect.size.height * scale);
+    }
+}
+
 - (CALayer *)private_sublayerForWindow:(SWWindow *)window;
 {
     NSUInteger windowCount = self.windowGroup.windows.count;
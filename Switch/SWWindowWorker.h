@@ -12,13 +12,31 @@
 //  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //
 
+@class NNPollingScheduler;
 @class SWWindow;
 
 
+typedef NS_ENUM(uint8_t, SWWindowWorkerDemand) {
+    // The window isn't shown. The worker captures the window once, keeps that frame, and is suspended until there is demand.
+    SWWindowWorkerDemandNone,
+    // The window's thumbnail is shown. Captured at a reduced rate.
+    SWWindowWorkerDemandVisible,
+    // The window is selected. Captured at full rate while its content is changing.
+    SWWindowWorkerDemandSelected,
+};
+
+
 @interface SWWindowWorker : NNPollingObject
 
 - (instancetype)initWithModelObject:(SWWindow *)window __attribute__((nonnull(1)));
+- (instancetype)initWithModelObject:(SWWindow *)window scheduler:(NNPollingScheduler *)scheduler __attribute__((nonnull(1, 2)));
 
 - (CGWindowID) windowID;
 
+// How much the interface wants this window's content. Also orders captures when more are due than can run at once.
+@property (atomic, assign) SWWindowWorkerDemand demand;
+
+// Returns a new capture of the window's contents, or NULL if the window could not be captured. Simulations override this to run workers without a window server.
+- (CGImageRef)copyWindowImage CF_RETURNS_RETAINED;
+
 @end
@@ -16,20 +16,40 @@
 
 #import <NNKit/NNPollingObject+Protected.h>
 
-#import "imageComparators.h"
+#import "resample.h"
 #import "SWWindow.h"
+#import "tileHash.h"
 
 
 static const NSTimeInterval NNPollingIntervalFast = 1.0 / (24.0 * 1000.0 / 1001.0); // 24p applied to NTSC, drawn on 1's.
+static const NSTimeInterval NNPollingIntervalVisible = 1.0 / 6.0;
 static const NSTimeInterval NNPollingIntervalSlow = 1.0;
 
+// Priority of polls by demand, relative to NNPollingObject's default of 1.0.
+static const double SWWindowWorkerVisiblePriority = 2.0;
+static const double SWWindowWorkerSelectedPriority = 4.0;
 
-@interface SWWindowWorker ()
+// Captures are reduced to the largest size the interface can draw them: a maximum-size thumbnail on a Retina display.
+static const CGFloat SWWindowWorkerMaxBackingScaleFactor = 2.0;
+// Thumbnail pixels shared by all live workers (32MiB at 32bpp). Each worker gets an equal share, capped by the size above.
+static const size_t SWWindowWorkerPixelBudget = 8 * 1024 * 1024;
+
+static NSUInteger liveWorkerCount = 0;
+
+
+@interface SWWindowWorker () {
+    SWTileHash _tileHash;
+    // Hashes the thumbnail instead of the capture, for captures the resampler can't read.
+    SWTileHash _thumbnailHash;
+    CGContextRef _thumbnailContext;
+    // Guards demand together with the decision to suspend, which happen on different queues.
+    NSObject *_demandLock;
+    SWWindowWorkerDemand _demand;
+}
 
 @property (nonatomic, copy, readonly) SWWindow *window;
 
 @property (nonatomic, assign) _Bool firstUpdate;
-@property (nonatomic, strong) NSImage *previousCapture;
 
 @end
 
@@ -39,18 +59,42 @@ static const NSTimeInterval NNPollingIntervalSlow = 1.0;
 #pragma mark - Initialization
 
 - (instancetype)initWithModelObject:(SWWindow *)window;
+{
+    return [self initWithModelObject:window scheduler:[NNPollingScheduler sharedScheduler]];
+}
+
+- (instancetype)initWithModelObject:(SWWindow *)window scheduler:(NNPollingScheduler *)scheduler;
 {
     BailUnless(window, nil);
-    if (!(self = [super initWithQueue:dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0)])) { return nil; }
+    if (!(self = [super initWithQueue:dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0) scheduler:scheduler])) { return nil; }
     
     _window = window;
+    _demandLock = [NSObject new];
+    _demand = SWWindowWorkerDemandNone;
     self.interval = NNPollingIntervalSlow;
     
     _firstUpdate = true;
+    SWTileHashInit(&_tileHash, kSWTileHashDefaultTileSize);
+    SWTileHashInit(&_thumbnailHash, kSWTileHashDefaultTileSize);
+    
+    @synchronized([SWWindowWorker class]) {
+        liveWorkerCount++;
+    }
     
     return self;
 }
 
+- (void)dealloc;
+{
+    @synchronized([SWWindowWorker class]) {
+        liveWorkerCount--;
+    }
+    
+    SWTileHashDestroy(&_tileHash);
+    SWTileHashDestroy(&_thumbnailHash);
+    CGContextRelease(_thumbnailContext);
+}
+
 #pragma mark - NNPollingObject
 
 - (oneway void)main;
@@ -58,7 +102,7 @@ static const NSTimeInterval NNPollingIntervalSlow = 1.0;
     SWLogBackgroundThreadOnly();
 
     SWTimeTask(SWCodeBlock({
-        CGImageRef cgImage = NNCFAutorelease(CGWindowListCreateImage(CGRectNull, kCGWindowListOptionIncludingWindow, self.window.windowID, kCGWindowImageBoundsIgnoreFraming));
+        CGImageRef cgImage = NNCFAutorelease([self copyWindowImage]);
         CGFloat width = CGImageGetWidth(cgImage);
         CGFloat height = CGImageGetHeight(cgImage);
         
@@ -66,43 +110,29 @@ static const NSTimeInterval NNPollingIntervalSlow = 1.0;
             cgImage = NULL;
         }
         
-        NSImage *image = [[NSImage alloc] initWithCGImage:cgImage size:NSMakeSize(width, height)];
-        
         if (cgImage) {
-            BOOL imageChanged = NO;
+            NSArray *dirtyRects = nil;
+            CGImageRef thumbnail = [self private_updateThumbnailWithCapture:cgImage dirtyRects:&dirtyRects];
             
-            size_t newWidth = CGImageGetWidth(cgImage);
-            size_t newHeight = CGImageGetHeight(cgImage);
-            { // Did the image change?
-                if (!self.previousCapture) {
-                    imageChanged = YES;
-                } else {
-                    CGFloat oldWidth = self.previousCapture.size.width;
-                    CGFloat oldHeight = self.previousCapture.size.height;
-                    
-                    if (newWidth != oldWidth || newHeight != oldHeight) {
-                        imageChanged = YES;
-                    } else {
-                        imageChanged = imagesDifferByCachedTIFFComparison(image, self.previousCapture);
-                    }
-                }
-            }
-            
-            if (!imageChanged) {
+            if (!thumbnail) {
                 self.interval = MIN(NNPollingIntervalSlow, self.interval * 2.0);
             } else {
                 if (self.firstUpdate) {
                     self.interval = NNPollingIntervalSlow;
-                } else {
+                } else if (self.demand == SWWindowWorkerDemandSelected) {
                     self.interval = NNPollingIntervalFast;
+                } else {
+                    self.interval = NNPollingIntervalVisible;
                 }
                 
-                self.previousCapture = image;
-                
-                [self postNotification:@{
+                NSMutableDictionary *userInfo = [@{
                     @"window" : self.window,
-                    @"content" : [[NSImage alloc] initWithCGImage:cgImage size:NSMakeSize(newWidth, newHeight)],
-                }];
+                    @"content" : [[NSImage alloc] initWithCGImage:thumbnail size:NSMakeSize(CGImageGetWidth(thumbnail), CGImageGetHeight(thumbnail))],
+                } mutableCopy];
+                if (dirtyRects) {
+                    userInfo[@"dirtyRects"] = dirtyRects;
+                }
+                [self postNotification:userInfo];
             }
         } else if ([CFBridgingRelease(CGWindowListCreate(kCGWindowListOptionIncludingWindow, self.window.windowID)) count]) {
             // Didn't get a real image, but the window exists. Try again ASAP.
@@ -115,6 +145,14 @@ static const NSTimeInterval NNPollingIntervalSlow = 1.0;
         if (self.firstUpdate) {
             self.firstUpdate = false;
         }
+        
+        // The last frame is kept by whoever was notified of it, so there's nothing left to do until the window is shown.
+        // Checked and acted on under the demand lock, so demand arriving meanwhile is never undone by this.
+        @synchronized(self->_demandLock) {
+            if (self->_demand == SWWindowWorkerDemandNone && self.interval > 0.0) {
+                self.suspended = YES;
+            }
+        }
     }), @"Window content capture for %@", self.window);
 }
 
@@ -125,4 +163,139 @@ static const NSTimeInterval NNPollingIntervalSlow = 1.0;
     return self.window.windowID;
 }
 
+- (SWWindowWorkerDemand)demand;
+{
+    @synchronized(self->_demandLock) {
+        return self->_demand;
+    }
+}
+
+- (void)setDemand:(SWWindowWorkerDemand)demand;
+{
+    @synchronized(self->_demandLock) {
+        self->_demand = demand;
+        switch (demand) {
+            case SWWindowWorkerDemandNone:
+                self.priority = 1.0;
+                break;
+            case SWWindowWorkerDemandVisible:
+                self.priority = SWWindowWorkerVisiblePriority;
+                break;
+            case SWWindowWorkerDemandSelected:
+                self.priority = SWWindowWorkerSelectedPriority;
+                break;
+        }
+        
+        // Workers without demand suspend themselves after their next capture.
+        if (demand != SWWindowWorkerDemandNone) {
+            self.suspended = NO;
+        }
+    }
+}
+
+- (CGImageRef)copyWindowImage;
+{
+    return CGWindowListCreateImage(CGRectNull, kCGWindowListOptionIncludingWindow, self.window.windowID, kCGWindowImageBoundsIgnoreFraming);
+}
+
+#pragma mark - Internal
+
+// The largest thumbnail a worker may keep, in pixels: an equal share of the budget across all live workers.
+// The worker count is rounded up to a power of two, so windows coming and going only resize every thumbnail when the count crosses one.
++ (size_t)private_pixelAllowance;
+{
+    NSUInteger workers;
+    @synchronized([SWWindowWorker class]) {
+        workers = MAX(liveWorkerCount, (NSUInteger)1);
+    }
+    NSUInteger bucket = 1;
+    while (bucket < workers) {
+        bucket <<= 1;
+    }
+    return SWWindowWorkerPixelBudget / bucket;
+}
+
+// Hashes the capture's pixels tile by tile and downsamples the tiles that changed into the worker's thumbnail. Neither the capture nor any previous capture is retained; the thumbnail is all the worker keeps.
+// Returns NULL if the capture did not change. If only part of the thumbnail changed, dirtyRects is set to the changed regions (NSValue-wrapped rects in thumbnail pixels, origin at the top left of the image). Otherwise it is left nil, meaning the whole image should be considered changed.
+- (CGImageRef)private_updateThumbnailWithCapture:(CGImageRef)cgImage dirtyRects:(NSArray **)dirtyRects;
+{
+    size_t captureWidth = CGImageGetWidth(cgImage);
+    size_t captureHeight = CGImageGetHeight(cgImage);
+    size_t width, height;
+    SWResampleFitSize(captureWidth, captureHeight, (size_t)(kNNMaxWindowThumbnailSize * SWWindowWorkerMaxBackingScaleFactor), [SWWindowWorker private_pixelAllowance], &width, &height);
+    
+    BOOL resized = NO;
+    if (!self->_thumbnailContext || CGBitmapContextGetWidth(self->_thumbnailContext) != width || CGBitmapContextGetHeight(self->_thumbnailContext) != height) {
+        CGContextRelease(self->_thumbnailContext);
+        // Sharing the capture's pixel format lets the resampler work on the capture's bytes directly.
+        self->_thumbnailContext = CGBitmapContextCreate(NULL, width, height, 8, 0, CGImageGetColorSpace(cgImage), CGImageGetBitmapInfo(cgImage));
+        if (!self->_thumbnailContext) {
+            CGColorSpaceRef colorSpace = CGColorSpaceCreateWithName(kCGColorSpaceSRGB);
+            self->_thumbnailContext = CGBitmapContextCreate(NULL, width, height, 8, 0, colorSpace, kCGBitmapByteOrder32Host | (CGBitmapInfo)kCGImageAlphaPremultipliedFirst);
+            CGColorSpaceRelease(colorSpace);
+        }
+        BailUnless(self->_thumbnailContext, NULL);
+        resized = YES;
+    }
+    
+    CFDataRef pixelData = NULL;
+    if (CGImageGetBitsPerPixel(cgImage) == 32 && CGImageGetBitsPerComponent(cgImage) == 8 && CGImageGetBitmapInfo(cgImage) == CGBitmapContextGetBitmapInfo(self->_thumbnailContext)) {
+        pixelData = NNCFAutorelease(CGDataProviderCopyData(CGImageGetDataProvider(cgImage)));
+    }
+    void *thumbnailPixels = CGBitmapContextGetData(self->_thumbnailContext);
+    size_t thumbnailBytesPerRow = CGBitmapContextGetBytesPerRow(self->_thumbnailContext);
+    
+    if (!pixelData) {
+        // The resampler can't read this capture, so let CoreGraphics scale it instead, and look for changes in the thumbnail it produces.
+        SWTileHashInvalidate(&self->_tileHash);
+        CGContextSetInterpolationQuality(self->_thumbnailContext, kCGInterpolationHigh);
+        CGContextSetBlendMode(self->_thumbnailContext, kCGBlendModeCopy);
+        CGContextDrawImage(self->_thumbnailContext, CGRectMake(0.0, 0.0, width, height), cgImage);
+        if (!SWTileHashUpdate(&self->_thumbnailHash, thumbnailPixels, width, height, thumbnailBytesPerRow) && !resized) {
+            return NULL;
+        }
+        
+        // The thumbnail hash's tiles are already in thumbnail pixels.
+        size_t tileCount = self->_thumbnailHash.columns * self->_thumbnailHash.rows;
+        if (!resized && SWTileHashDirtyCount(&self->_thumbnailHash) < tileCount) {
+            NSMutableData *rectBuffer = [NSMutableData dataWithLength:tileCount * sizeof(SWTileRect)];
+            SWTileRect *rects = rectBuffer.mutableBytes;
+            size_t rectCount = SWTileHashCopyDirtyRects(&self->_thumbnailHash, rects);
+            
+            NSMutableArray *result = [NSMutableArray arrayWithCapacity:rectCount];
+            for (size_t i = 0; i < rectCount; ++i) {
+                [result addObject:[NSValue valueWithRect:NSMakeRect(rects[i].x, rects[i].y, rects[i].width, rects[i].height)]];
+            }
+            *dirtyRects = result;
+        }
+        return NNCFAutorelease(CGBitmapContextCreateImage(self->_thumbnailContext));
+    }
+    SWTileHashInvalidate(&self->_thumbnailHash);
+    
+    const UInt8 *pixels = CFDataGetBytePtr(pixelData);
+    size_t bytesPerRow = CGImageGetBytesPerRow(cgImage);
+    if (!SWTileHashUpdate(&self->_tileHash, pixels, captureWidth, captureHeight, bytesPerRow) && !resized) {
+        return NULL;
+    }
+    
+    size_t tileCount = self->_tileHash.columns * self->_tileHash.rows;
+    if (resized || SWTileHashDirtyCount(&self->_tileHash) == tileCount) {
+        SWResampleBox(pixels, captureWidth, captureHeight, bytesPerRow, thumbnailPixels, width, height, thumbnailBytesPerRow, NULL);
+    } else {
+        NSMutableData *rectBuffer = [NSMutableData dataWithLength:tileCount * sizeof(SWTileRect)];
+        SWTileRect *rects = rectBuffer.mutableBytes;
+        size_t rectCount = SWTileHashCopyDirtyRects(&self->_tileHash, rects);
+        
+        NSMutableArray *result = [NSMutableArray arrayWithCapacity:rectCount];
+        for (size_t i = 0; i < rectCount; ++i) {
+            SWTileRect region = SWResampleScaleRect(rects[i], captureWidth, captureHeight, width, height);
+            SWResampleBox(pixels, captureWidth, captureHeight, bytesPerRow, thumbnailPixels, width, height, thumbnailBytesPerRow, &region);
+            [result addObject:[NSValue valueWithRect:NSMakeRect(region.x, region.y, region.width, region.height)]];
+        }
+        *dirtyRects = result;
+    }
+    
+    return NNCFAutorelease(CGBitmapContextCreateImage(self->_thumbnailContext));
+}
+
 @end
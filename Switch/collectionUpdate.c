@@ -0,0 +1,106 @@
+//
+//  collectionUpdate.c
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "collectionUpdate.h"
+
+#include <stdlib.h>
+
+
+enum {
+    kNewInserted = 1 << 0,
+    kNewMoved = 1 << 1,
+    kNewUpdated = 1 << 2,
+    kOldUnpaired = 1 << 3,
+    kOldKept = 1 << 4,
+};
+
+size_t SWCollectionUpdatePlan(const SWWindowListEntry *oldEntries, size_t oldCount, const SWWindowListEntry *newEntries, size_t newCount, SWCollectionUpdateCell *cells, size_t *discarded)
+{
+    size_t discardCount = 0;
+    
+    for (size_t i = 0; i < newCount; ++i) {
+        cells[i] = (SWCollectionUpdateCell){ SIZE_MAX };
+    }
+    
+    SWWindowListChange *changes = malloc(SWWindowListDiffCapacity(oldCount, newCount) * sizeof(*changes) + 1);
+    // Flags for each new cell, followed by flags for each old cell.
+    uint8_t *flags = calloc(newCount + oldCount + 1, sizeof(uint8_t));
+    if (!changes || !flags) {
+        free(changes);
+        free(flags);
+        // Start over with all new cells.
+        for (size_t i = 0; i < oldCount; ++i) {
+            discarded[discardCount++] = i;
+        }
+        return discardCount;
+    }
+    uint8_t *newFlags = flags;
+    uint8_t *oldFlags = flags + newCount;
+    
+    size_t changeCount = SWWindowListDiff(oldEntries, oldCount, newEntries, newCount, changes);
+    for (size_t i = 0; i < changeCount; ++i) {
+        SWWindowListChange change = changes[i];
+        switch (change.kind) {
+            case SWWindowListChangeInsert:
+                newFlags[change.newIndex] |= kNewInserted;
+                break;
+            case SWWindowListChangeRemove:
+                oldFlags[change.oldIndex] |= kOldUnpaired;
+                break;
+            case SWWindowListChangeMove:
+                newFlags[change.newIndex] |= kNewMoved;
+                oldFlags[change.oldIndex] |= kOldUnpaired;
+                cells[change.newIndex].oldIndex = change.oldIndex;
+                break;
+            case SWWindowListChangeUpdate:
+                newFlags[change.newIndex] |= kNewUpdated;
+                break;
+        }
+    }
+    
+    // The diff only names the windows that changed. The rest of the windows common to both lists kept their relative order, so they pair up by walking both lists in step.
+    size_t oldIndex = 0;
+    for (size_t i = 0; i < newCount; ++i) {
+        if (newFlags[i] & (kNewInserted | kNewMoved)) {
+            continue;
+        }
+        while (oldIndex < oldCount && (oldFlags[oldIndex] & kOldUnpaired)) {
+            oldIndex++;
+        }
+        if (oldIndex == oldCount) {
+            break;
+        }
+        cells[i].oldIndex = oldIndex++;
+    }
+    
+    // An updated window's old cell shows what the window used to be, so it's replaced instead of kept.
+    for (size_t i = 0; i < newCount; ++i) {
+        if (newFlags[i] & kNewUpdated) {
+            cells[i].oldIndex = SIZE_MAX;
+        }
+        if (cells[i].oldIndex != SIZE_MAX) {
+            oldFlags[cells[i].oldIndex] |= kOldKept;
+        }
+    }
+    
+    for (size_t i = 0; i < oldCount; ++i) {
+        if (!(oldFlags[i] & kOldKept)) {
+            discarded[discardCount++] = i;
+        }
+    }
+    
+    free(flags);
+    free(changes);
+    return discardCount;
+}
@@ -0,0 +1,48 @@
+//
+//  collectionUpdate.h
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef _COLLECTIONUPDATE_H_
+#define _COLLECTIONUPDATE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "windowListDiff.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Planning a batch update of a row of cells.
+ *
+ * Each cell is identified by a window list entry: the ID of the window (group) it shows and a fingerprint of what it was built from. Given the entries before and after a reload, the plan says which existing cells can stay and which have to be built (or taken from a reuse pool).
+ *
+ * This file has no Cocoa dependencies so it can be built and benchmarked on any platform.
+ */
+
+typedef struct {
+    // The old cell to keep in this position, or SIZE_MAX if a cell has to be provided: the window is new, or its old cell was built from a different fingerprint.
+    size_t oldIndex;
+} SWCollectionUpdateCell;
+
+// Fills in one SWCollectionUpdateCell per new entry, and writes the indexes of the old cells that aren't kept, in old order, to discarded (which must have room for oldCount indexes). Returns the number of discarded cells.
+size_t SWCollectionUpdatePlan(const SWWindowListEntry *oldEntries, size_t oldCount, const SWWindowListEntry *newEntries, size_t newCount, SWCollectionUpdateCell *cells, size_t *discarded);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _COLLECTIONUPDATE_H_
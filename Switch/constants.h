@@ -28,6 +28,7 @@ extern const CGFloat kNNSelectionRoundRectRadius;
 
 // Seconds
 extern const NSTimeInterval delayBeforePresentingSwitcherWindow;
+extern const NSTimeInterval durationOfCellInsertionFade;
 
 // Enum stringification
 NSString *NNStringFromCGWindowLevel(long level);
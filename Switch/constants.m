@@ -36,6 +36,7 @@ const CGFloat kNNSelectionRoundRectRadius = kNNWindowRoundRectRadius - kNNWindow
 
 // Timing
 const NSTimeInterval delayBeforePresentingSwitcherWindow = 0.25;
+const NSTimeInterval durationOfCellInsertionFade = 0.15;
 
 
 __attribute__((const)) NSString *NNStringFromCGWindowLevel(long level)
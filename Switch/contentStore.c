@@ -0,0 +1,158 @@
+//
+//  contentStore.c
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "contentStore.h"
+
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+// Open-addressed, with window ID 0 marking an empty slot. Never modified once published.
+typedef struct {
+    size_t mask;
+    uint32_t *windowIDs;
+    const void **values;
+} snapshot;
+
+struct SWContentStore {
+    SWContentStoreCallbacks callbacks;
+    _Atomic(snapshot *) snapshot;
+    // Incremented by each publish. Its low bit is the epoch new readers join.
+    atomic_uint_fast64_t generation;
+    atomic_size_t readers[2];
+};
+
+static inline size_t slotForWindowID(uint32_t windowID, size_t mask)
+{
+    // Fibonacci hashing; window IDs are mostly sequential.
+    return ((uint64_t)windowID * 0x9E3779B97F4A7C15ull >> 32) & mask;
+}
+
+static snapshot *createSnapshot(const uint32_t *windowIDs, const void *const *values, size_t count)
+{
+    // At most half full.
+    size_t slotCount = 8;
+    while (slotCount < count * 2) {
+        slotCount *= 2;
+    }
+    
+    snapshot *result = malloc(sizeof(*result) + slotCount * (sizeof(*result->windowIDs) + sizeof(*result->values)));
+    if (!result) { return NULL; }
+    result->mask = slotCount - 1;
+    result->values = (const void **)(result + 1);
+    result->windowIDs = (uint32_t *)(result->values + slotCount);
+    memset(result->windowIDs, 0, slotCount * sizeof(*result->windowIDs));
+    
+    for (size_t i = 0; i < count; ++i) {
+        size_t slot = slotForWindowID(windowIDs[i], result->mask);
+        while (result->windowIDs[slot]) {
+            slot = (slot + 1) & result->mask;
+        }
+        result->windowIDs[slot] = windowIDs[i];
+        result->values[slot] = values[i];
+    }
+    return result;
+}
+
+static void destroySnapshot(const SWContentStore *store, snapshot *snapshot)
+{
+    for (size_t slot = 0; slot <= snapshot->mask; ++slot) {
+        if (snapshot->windowIDs[slot]) {
+            store->callbacks.release(snapshot->values[slot]);
+        }
+    }
+    free(snapshot);
+}
+
+SWContentStore *SWContentStoreCreate(SWContentStoreCallbacks callbacks)
+{
+    SWContentStore *store = malloc(sizeof(*store));
+    snapshot *empty = createSnapshot(NULL, NULL, 0);
+    if (!store || !empty) {
+        free(store);
+        free(empty);
+        return NULL;
+    }
+    
+    store->callbacks = callbacks;
+    atomic_init(&store->snapshot, empty);
+    atomic_init(&store->generation, 0);
+    atomic_init(&store->readers[0], 0);
+    atomic_init(&store->readers[1], 0);
+    return store;
+}
+
+void SWContentStoreDestroy(SWContentStore *store)
+{
+    if (!store) { return; }
+    destroySnapshot(store, atomic_load(&store->snapshot));
+    free(store);
+}
+
+const void *SWContentStoreCopyValue(SWContentStore *store, uint32_t windowID)
+{
+    if (!windowID) { return NULL; }
+    
+    // Join the current epoch. If a publish moved readers to the other epoch in the meantime, its writer may not have seen this reader, so join again.
+    atomic_size_t *readers;
+    for (;;) {
+        uint_fast64_t generation = atomic_load(&store->generation);
+        readers = &store->readers[generation & 1];
+        atomic_fetch_add(readers, 1);
+        if (atomic_load(&store->generation) == generation) {
+            break;
+        }
+        atomic_fetch_sub(readers, 1);
+    }
+    
+    // Every writer that publishes after this point waits for this reader before releasing the snapshot it replaced.
+    const snapshot *current = atomic_load(&store->snapshot);
+    const void *value = NULL;
+    for (size_t slot = slotForWindowID(windowID, current->mask); current->windowIDs[slot]; slot = (slot + 1) & current->mask) {
+        if (current->windowIDs[slot] == windowID) {
+            value = store->callbacks.retain(current->values[slot]);
+            break;
+        }
+    }
+    
+    atomic_fetch_sub_explicit(readers, 1, memory_order_release);
+    return value;
+}
+
+bool SWContentStorePublish(SWContentStore *store, const uint32_t *windowIDs, const void *const *values, size_t count)
+{
+    snapshot *next = createSnapshot(windowIDs, values, count);
+    if (!next) { return false; }
+    for (size_t i = 0; i < count; ++i) {
+        store->callbacks.retain(values[i]);
+    }
+    
+    snapshot *previous = atomic_exchange(&store->snapshot, next);
+    
+    // Move new readers to the other epoch, then wait out the readers still in this one. Any of them could be looking at the previous snapshot.
+    unsigned epoch = atomic_fetch_add(&store->generation, 1) & 1;
+    while (atomic_load(&store->readers[epoch])) {
+        sched_yield();
+    }
+    
+    destroySnapshot(store, previous);
+    return true;
+}
+
+uint64_t SWContentStoreGeneration(SWContentStore *store)
+{
+    return atomic_load(&store->generation);
+}
@@ -0,0 +1,61 @@
+//
+//  contentStore.h
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef _CONTENTSTORE_H_
+#define _CONTENTSTORE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A map from window ID to a reference-counted value, read without locks.
+ *
+ * The map is published as immutable snapshots. Readers look up the current snapshot without taking a lock and never wait for a writer; a lookup only retries if a publish lands between two of its loads. A writer replaces the whole snapshot at once, then waits for the readers that may still be looking at the old one before releasing it. Readers mark themselves in one of two epochs, so only the readers that started before the publish are waited for, and each of those holds its epoch for a single lookup.
+ *
+ * Writes are expected to be batched: publishing a snapshot copies every entry, so a writer should publish once for a run of changes rather than once per change.
+ *
+ * This file has no Cocoa dependencies so it can be built and benchmarked on any platform.
+ */
+
+typedef struct {
+    // Called with the value found by SWContentStoreCopyValue, before the reader leaves its epoch. Returns the value.
+    const void *(*retain)(const void *value);
+    void (*release)(const void *value);
+} SWContentStoreCallbacks;
+
+typedef struct SWContentStore SWContentStore;
+
+SWContentStore *SWContentStoreCreate(SWContentStoreCallbacks callbacks);
+// There must be no readers.
+void SWContentStoreDestroy(SWContentStore *store);
+
+// Returns the value for a window ID, retained, or NULL. Safe to call from any thread, at any time.
+const void *SWContentStoreCopyValue(SWContentStore *store, uint32_t windowID);
+
+// Replaces the store's contents with count entries. The store retains the values. Window IDs must be unique and nonzero. Only one thread may publish at a time. Returns false, leaving the contents unchanged, if memory could not be allocated.
+bool SWContentStorePublish(SWContentStore *store, const uint32_t *windowIDs, const void *const *values, size_t count);
+
+// The number of snapshots published so far.
+uint64_t SWContentStoreGeneration(SWContentStore *store);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _CONTENTSTORE_H_
@@ -0,0 +1,149 @@
+//
+//  displayTopology.c
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "displayTopology.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+bool SWDisplayTopologyInit(SWDisplayTopology *topology, size_t capacity)
+{
+    memset(topology, 0, sizeof(*topology));
+    topology->mainDisplay = SIZE_MAX;
+    topology->capacity = capacity ? capacity : 4;
+    topology->displayIDs = malloc(topology->capacity * sizeof(*topology->displayIDs));
+    topology->minX = malloc(topology->capacity * sizeof(*topology->minX));
+    topology->minY = malloc(topology->capacity * sizeof(*topology->minY));
+    topology->maxX = malloc(topology->capacity * sizeof(*topology->maxX));
+    topology->maxY = malloc(topology->capacity * sizeof(*topology->maxY));
+    if (!topology->displayIDs || !topology->minX || !topology->minY || !topology->maxX || !topology->maxY) {
+        SWDisplayTopologyDestroy(topology);
+        return false;
+    }
+    return true;
+}
+
+void SWDisplayTopologyDestroy(SWDisplayTopology *topology)
+{
+    free(topology->displayIDs);
+    free(topology->minX);
+    free(topology->minY);
+    free(topology->maxX);
+    free(topology->maxY);
+    memset(topology, 0, sizeof(*topology));
+    topology->mainDisplay = SIZE_MAX;
+}
+
+size_t SWDisplayTopologyAddDisplay(SWDisplayTopology *topology, uint32_t displayID, SWWindowTableRect bounds, bool mainDisplay)
+{
+    if (topology->count == topology->capacity) {
+        size_t capacity = topology->capacity * 2;
+        #define GROW(column) do { \
+                void *column = realloc(topology->column, capacity * sizeof(*topology->column)); \
+                if (!column) { return SIZE_MAX; } \
+                topology->column = column; \
+            } while (0)
+        GROW(displayIDs);
+        GROW(minX);
+        GROW(minY);
+        GROW(maxX);
+        GROW(maxY);
+        #undef GROW
+        topology->capacity = capacity;
+    }
+    
+    size_t display = topology->count++;
+    topology->displayIDs[display] = displayID;
+    topology->minX[display] = bounds.x;
+    topology->minY[display] = bounds.y;
+    topology->maxX[display] = bounds.x + bounds.width;
+    topology->maxY[display] = bounds.y + bounds.height;
+    if (mainDisplay) {
+        topology->mainDisplay = display;
+    }
+    return display;
+}
+
+static inline double overlap(const SWDisplayTopology *topology, size_t display, SWWindowTableRect rect)
+{
+    // The area of the rects' intersection, which is zero when they don't intersect (CGRectNull has no size).
+    double width = (rect.x + rect.width < topology->maxX[display] ? rect.x + rect.width : topology->maxX[display]) - (rect.x > topology->minX[display] ? rect.x : topology->minX[display]);
+    double height = (rect.y + rect.height < topology->maxY[display] ? rect.y + rect.height : topology->maxY[display]) - (rect.y > topology->minY[display] ? rect.y : topology->minY[display]);
+    width = width > 0.0 ? width : 0.0;
+    height = height > 0.0 ? height : 0.0;
+    return width * height;
+}
+
+size_t SWDisplayTopologyDisplayForRect(const SWDisplayTopology *topology, SWWindowTableRect rect)
+{
+    size_t result = topology->mainDisplay;
+    double resultOverlap = result != SIZE_MAX ? overlap(topology, result, rect) : 0.0;
+    for (size_t display = 0; display < topology->count; ++display) {
+        double displayOverlap = overlap(topology, display, rect);
+        if (displayOverlap > resultOverlap) {
+            result = display;
+            resultOverlap = displayOverlap;
+        }
+    }
+    return result;
+}
+
+// Keeps the better of each window's current display and this one. Written without branches so that it vectorizes.
+static void assignDisplay(uint32_t display, double minX, double minY, double maxX, double maxY, const SWWindowTableRect *restrict bounds, uint32_t *restrict screens, double *restrict bestOverlaps, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        SWWindowTableRect rect = bounds[i];
+        double right = rect.x + rect.width;
+        double bottom = rect.y + rect.height;
+        double width = (right < maxX ? right : maxX) - (rect.x > minX ? rect.x : minX);
+        double height = (bottom < maxY ? bottom : maxY) - (rect.y > minY ? rect.y : minY);
+        width = width > 0.0 ? width : 0.0;
+        height = height > 0.0 ? height : 0.0;
+        double area = width * height;
+        
+        bool better = area > bestOverlaps[i];
+        bestOverlaps[i] = better ? area : bestOverlaps[i];
+        screens[i] = better ? display : screens[i];
+    }
+}
+
+void SWDisplayTopologyAssignScreens(const SWDisplayTopology *topology, SWWindowTable *table)
+{
+    if (!topology->count) {
+        for (size_t row = 0; row < table->count; ++row) {
+            table->screens[row] = kSWWindowTableNoScreen;
+        }
+        return;
+    }
+    
+    // Best overlap so far for each row, in blocks small enough to stay on the stack.
+    enum { blockSize = 256 };
+    double bestOverlaps[blockSize];
+    for (size_t blockStart = 0; blockStart < table->count; blockStart += blockSize) {
+        size_t blockCount = table->count - blockStart < blockSize ? table->count - blockStart : blockSize;
+        const SWWindowTableRect *bounds = table->bounds + blockStart;
+        uint32_t *screens = table->screens + blockStart;
+        
+        // Every window starts out on the main display, so it keeps it unless another display overlaps it more.
+        for (size_t i = 0; i < blockCount; ++i) {
+            screens[i] = topology->mainDisplay != SIZE_MAX ? (uint32_t)topology->mainDisplay : kSWWindowTableNoScreen;
+            bestOverlaps[i] = topology->mainDisplay != SIZE_MAX ? overlap(topology, topology->mainDisplay, bounds[i]) : 0.0;
+        }
+        
+        for (size_t display = 0; display < topology->count; ++display) {
+            assignDisplay((uint32_t)display, topology->minX[display], topology->minY[display], topology->maxX[display], topology->maxY[display], bounds, screens, bestOverlaps, blockCount);
+        }
+    }
+}
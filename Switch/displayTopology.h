@@ -0,0 +1,67 @@
+//
+//  displayTopology.h
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef _DISPLAYTOPOLOGY_H_
+#define _DISPLAYTOPOLOGY_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "windowTable.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Assignment of windows to the display they overlap the most.
+ *
+ * A topology is a snapshot of the displays' bounds in global display coordinates (origin at the top left of the main display, like window bounds). Each window belongs to the display with the largest intersection area. Ties, including windows that intersect no display, go to the main display if it is one of the tied displays. Otherwise they go to the first tied display in the order displays were added. This matches reducing over NSScreen's screens starting from its main screen.
+ *
+ * Display bounds are stored as separate columns of edges, so assigning a whole window table compiles to one branch-free pass per display over the table's bounds.
+ *
+ * This file has no Cocoa dependencies so it can be built and benchmarked on any platform.
+ */
+
+typedef struct {
+    size_t count;
+    size_t capacity;
+    // The display that wins ties, or SIZE_MAX if there is no main display.
+    size_t mainDisplay;
+    
+    uint32_t *displayIDs;
+    double *minX;
+    double *minY;
+    double *maxX;
+    double *maxY;
+} SWDisplayTopology;
+
+bool SWDisplayTopologyInit(SWDisplayTopology *topology, size_t capacity);
+void SWDisplayTopologyDestroy(SWDisplayTopology *topology);
+
+// Adds a display, returning its index or SIZE_MAX if the topology could not grow.
+size_t SWDisplayTopologyAddDisplay(SWDisplayTopology *topology, uint32_t displayID, SWWindowTableRect bounds, bool mainDisplay);
+
+// Returns the index of the display that rect overlaps the most, or SIZE_MAX if there are no displays and no main display.
+size_t SWDisplayTopologyDisplayForRect(const SWDisplayTopology *topology, SWWindowTableRect rect);
+
+// Sets the screen of every row of table to the index of its display, or to kSWWindowTableNoScreen if there are no displays.
+void SWDisplayTopologyAssignScreens(const SWDisplayTopology *topology, SWWindowTable *table);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _DISPLAYTOPOLOGY_H_
@@ -0,0 +1,184 @@
+//
+//  eventDispatch.c
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "eventDispatch.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+struct SWEventDispatchTable {
+    void (*release)(const void *handler);
+    // Replaced tables waiting to be destroyed, linked by the publishing thread.
+    SWEventDispatchTable *next;
+    size_t count;
+    SWEventDispatchEntry entries[];
+};
+
+struct SWEventDispatcher {
+    _Atomic(SWEventDispatchTable *) current;
+    // The table the reader is using, if any.
+    _Atomic(SWEventDispatchTable *) reading;
+    SWEventDispatchTable *retired;
+};
+
+#pragma mark - SWEventDispatchTable
+
+static int compareEntries(const void *a, const void *b)
+{
+    const SWEventDispatchEntry *x = a, *y = b;
+    if (x->kind != y->kind) {
+        return x->kind < y->kind ? -1 : 1;
+    }
+    if (x->key != y->key) {
+        return x->key < y->key ? -1 : 1;
+    }
+    if (x->owner != y->owner) {
+        return x->owner < y->owner ? -1 : 1;
+    }
+    return 0;
+}
+
+SWEventDispatchTable *SWEventDispatchTableCreate(const SWEventDispatchEntry *entries, size_t count, void (*release)(const void *handler))
+{
+    SWEventDispatchTable *table = malloc(sizeof(*table) + count * sizeof(*entries));
+    if (!table) {
+        for (size_t i = 0; release && i < count; ++i) {
+            release(entries[i].handler);
+        }
+        return NULL;
+    }
+    
+    table->release = release;
+    table->next = NULL;
+    table->count = count;
+    if (count) {
+        memcpy(table->entries, entries, count * sizeof(*entries));
+        qsort(table->entries, count, sizeof(*entries), compareEntries);
+    }
+    return table;
+}
+
+void SWEventDispatchTableDestroy(SWEventDispatchTable *table)
+{
+    if (!table) {
+        return;
+    }
+    for (size_t i = 0; table->release && i < table->count; ++i) {
+        table->release(table->entries[i].handler);
+    }
+    free(table);
+}
+
+// The index of the first entry at or after kind and key.
+static size_t lowerBound(const SWEventDispatchTable *table, SWEventDispatchKind kind, uint32_t key)
+{
+    size_t low = 0, high = table->count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        const SWEventDispatchEntry *entry = &table->entries[middle];
+        if (entry->kind < kind || (entry->kind == kind && entry->key < key)) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+size_t SWEventDispatchTableFind(const SWEventDispatchTable *table, SWEventDispatchKind kind, uint32_t key, const SWEventDispatchEntry **entries)
+{
+    size_t first = lowerBound(table, kind, key);
+    size_t last = first;
+    while (last < table->count && table->entries[last].kind == kind && table->entries[last].key == key) {
+        last++;
+    }
+    *entries = &table->entries[first];
+    return last - first;
+}
+
+size_t SWEventDispatchTableEntries(const SWEventDispatchTable *table, SWEventDispatchKind kind, const SWEventDispatchEntry **entries)
+{
+    size_t first = lowerBound(table, kind, 0);
+    size_t last = first;
+    while (last < table->count && table->entries[last].kind == kind) {
+        last++;
+    }
+    *entries = &table->entries[first];
+    return last - first;
+}
+
+#pragma mark - SWEventDispatcher
+
+SWEventDispatcher *SWEventDispatcherCreate(void)
+{
+    SWEventDispatcher *dispatcher = calloc(1, sizeof(*dispatcher));
+    return dispatcher;
+}
+
+void SWEventDispatcherDestroy(SWEventDispatcher *dispatcher)
+{
+    if (!dispatcher) {
+        return;
+    }
+    SWEventDispatchTableDestroy(atomic_load(&dispatcher->current));
+    while (dispatcher->retired) {
+        SWEventDispatchTable *table = dispatcher->retired;
+        dispatcher->retired = table->next;
+        SWEventDispatchTableDestroy(table);
+    }
+    free(dispatcher);
+}
+
+void SWEventDispatcherPublish(SWEventDispatcher *dispatcher, SWEventDispatchTable *table)
+{
+    SWEventDispatchTable *replaced = atomic_exchange(&dispatcher->current, table);
+    if (replaced) {
+        replaced->next = dispatcher->retired;
+        dispatcher->retired = replaced;
+    }
+    
+    // The reader can only be using one table, and once it's no longer current it can't start using it again.
+    SWEventDispatchTable *reading = atomic_load(&dispatcher->reading);
+    SWEventDispatchTable **link = &dispatcher->retired;
+    while (*link) {
+        SWEventDispatchTable *retired = *link;
+        if (retired == reading) {
+            link = &retired->next;
+        } else {
+            *link = retired->next;
+            SWEventDispatchTableDestroy(retired);
+        }
+    }
+}
+
+const SWEventDispatchTable *SWEventDispatcherBeginRead(SWEventDispatcher *dispatcher)
+{
+    SWEventDispatchTable *table = atomic_load(&dispatcher->current);
+    for (;;) {
+        atomic_store(&dispatcher->reading, table);
+        // If the table is still current after announcing it, the writer will see the announcement before it can retire the table.
+        SWEventDispatchTable *current = atomic_load(&dispatcher->current);
+        if (current == table) {
+            return table;
+        }
+        table = current;
+    }
+}
+
+void SWEventDispatcherEndRead(SWEventDispatcher *dispatcher)
+{
+    atomic_store_explicit(&dispatcher->reading, NULL, memory_order_release);
+}
@@ -0,0 +1,87 @@
+//
+//  eventDispatch.h
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef _EVENTDISPATCH_H_
+#define _EVENTDISPATCH_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Event tap registrations, compiled into immutable tables so that dispatching an event never allocates or takes a lock.
+ *
+ * A table is built from a list of registrations whenever one is added or removed, and published to a dispatcher, which hands the current table to a single reader (the event tap's thread). A table being read is never freed: the reader announces the table it's using, and the writer frees replaced tables once the reader has moved on. Neither side waits for the other.
+ *
+ * This file has no Cocoa dependencies so it can be built and benchmarked on any platform.
+ */
+
+typedef enum {
+    // key is an SWEventDispatchHotKey.
+    SWEventDispatchKindHotKey,
+    // key is a modifier mask, called when all of its modifiers become pressed or stop being pressed.
+    SWEventDispatchKindModifier,
+    // key is an event type.
+    SWEventDispatchKindEventType,
+    // key is unused. Asked whether key and scroll events should be kept from other applications.
+    SWEventDispatchKindKeySuppressor,
+} SWEventDispatchKind;
+
+// A key code and modifier mask packed together.
+static inline uint32_t SWEventDispatchHotKey(uint16_t keycode, uint16_t modifiers) {
+    return (uint32_t)keycode << 16 | modifiers;
+}
+
+typedef struct {
+    SWEventDispatchKind kind;
+    uint32_t key;
+    // Identifies the registrant. Entries with the same kind and key are dispatched in owner order.
+    uintptr_t owner;
+    const void *handler;
+} SWEventDispatchEntry;
+
+typedef struct SWEventDispatchTable SWEventDispatchTable;
+
+// Copies and sorts entries. The table takes ownership of each handler, and calls release on it when destroyed. Returns NULL if memory could not be allocated, in which case the handlers are released.
+SWEventDispatchTable *SWEventDispatchTableCreate(const SWEventDispatchEntry *entries, size_t count, void (*release)(const void *handler));
+void SWEventDispatchTableDestroy(SWEventDispatchTable *table);
+
+// Finds the entries registered for a kind and key, and returns how many there are.
+size_t SWEventDispatchTableFind(const SWEventDispatchTable *table, SWEventDispatchKind kind, uint32_t key, const SWEventDispatchEntry **entries);
+
+// All the entries of a kind, ordered by key.
+size_t SWEventDispatchTableEntries(const SWEventDispatchTable *table, SWEventDispatchKind kind, const SWEventDispatchEntry **entries);
+
+typedef struct SWEventDispatcher SWEventDispatcher;
+
+SWEventDispatcher *SWEventDispatcherCreate(void);
+// Destroys every table the dispatcher has. There must be no reader.
+void SWEventDispatcherDestroy(SWEventDispatcher *dispatcher);
+
+// Makes table current. Tables it replaces are destroyed as soon as the reader isn't using them. Only one thread may publish.
+void SWEventDispatcherPublish(SWEventDispatcher *dispatcher, SWEventDispatchTable *table);
+
+// Returns the current table, or NULL, which stays valid until SWEventDispatcherEndRead. Only one thread may read, and reads don't nest.
+const SWEventDispatchTable *SWEventDispatcherBeginRead(SWEventDispatcher *dispatcher);
+void SWEventDispatcherEndRead(SWEventDispatcher *dispatcher);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _EVENTDISPATCH_H_
@@ -0,0 +1,317 @@
+//
+//  frameCache.c
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "frameCache.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+#define kNoEntry SIZE_MAX
+
+// Packet headers: the low 7 bits are the number of pixels in the packet, less one.
+#define kRunPacket 0x80
+#define kMaxPacketLength 128
+
+#pragma mark - Codec
+
+static inline uint16_t quantize(const uint8_t *pixel)
+{
+    return (uint16_t)((pixel[0] >> 4) << 12 | (pixel[1] >> 4) << 8 | (pixel[2] >> 4) << 4 | (pixel[3] >> 4));
+}
+
+static inline void dequantize(uint16_t value, uint8_t *pixel)
+{
+    // 0xF becomes 0xFF, and 0x0 stays 0x0.
+    pixel[0] = (uint8_t)((value >> 12) * 0x11);
+    pixel[1] = (uint8_t)(((value >> 8) & 0xF) * 0x11);
+    pixel[2] = (uint8_t)(((value >> 4) & 0xF) * 0x11);
+    pixel[3] = (uint8_t)((value & 0xF) * 0x11);
+}
+
+static inline uint8_t *writeValue(uint8_t *output, uint16_t value)
+{
+    output[0] = (uint8_t)value;
+    output[1] = (uint8_t)(value >> 8);
+    return output + 2;
+}
+
+static inline uint16_t readValue(const uint8_t *input)
+{
+    return (uint16_t)(input[0] | input[1] << 8);
+}
+
+// Returns a new buffer holding the encoded frame, or NULL.
+static uint8_t *encode(const uint8_t *pixels, size_t width, size_t height, size_t bytesPerRow, size_t *length)
+{
+    size_t pixelCount = width * height;
+    uint16_t *values = malloc(pixelCount * sizeof(*values));
+    // Every pixel as a literal, plus one header per packet.
+    uint8_t *output = malloc(pixelCount * 2 + (pixelCount + kMaxPacketLength - 1) / kMaxPacketLength);
+    if (!values || !output) {
+        free(values);
+        free(output);
+        return NULL;
+    }
+    
+    for (size_t y = 0; y < height; ++y) {
+        const uint8_t *row = pixels + y * bytesPerRow;
+        for (size_t x = 0; x < width; ++x) {
+            values[y * width + x] = quantize(row + x * 4);
+        }
+    }
+    
+    uint8_t *cursor = output;
+    size_t literalStart = 0;
+    size_t i = 0;
+    while (i <= pixelCount) {
+        size_t run = 0;
+        while (i + run < pixelCount && run < kMaxPacketLength && values[i + run] == values[i]) {
+            run++;
+        }
+        
+        // Runs of two or more are cheaper as a run packet than as part of a literal.
+        bool isRun = run >= 2;
+        if (isRun || i == pixelCount || i - literalStart == kMaxPacketLength) {
+            if (i > literalStart) {
+                *cursor++ = (uint8_t)(i - literalStart - 1);
+                for (; literalStart < i; ++literalStart) {
+                    cursor = writeValue(cursor, values[literalStart]);
+                }
+            }
+            if (i == pixelCount) {
+                break;
+            }
+        }
+        
+        if (isRun) {
+            *cursor++ = (uint8_t)(kRunPacket | (run - 1));
+            cursor = writeValue(cursor, values[i]);
+            i += run;
+            literalStart = i;
+        } else {
+            i++;
+        }
+    }
+    free(values);
+    
+    *length = (size_t)(cursor - output);
+    uint8_t *result = realloc(output, *length ? *length : 1);
+    return result ? result : output;
+}
+
+void SWFrameCacheDecode(const SWFrameCacheEntry *entry, void *pixels, size_t bytesPerRow)
+{
+    const uint8_t *input = entry->bytes;
+    const uint8_t *end = input + entry->length;
+    size_t width = entry->width;
+    size_t pixel = 0;
+    
+    while (input < end) {
+        uint8_t header = *input++;
+        size_t count = (size_t)(header & ~kRunPacket) + 1;
+        for (size_t j = 0; j < count; ++j, ++pixel) {
+            uint16_t value = readValue((header & kRunPacket) ? input : input + j * 2);
+            dequantize(value, (uint8_t *)pixels + (pixel / width) * bytesPerRow + (pixel % width) * 4);
+        }
+        input += (header & kRunPacket) ? 2 : count * 2;
+    }
+}
+
+#pragma mark - Index
+
+static inline size_t slotForWindowID(uint32_t windowID, size_t mask)
+{
+    return ((uint64_t)windowID * 0x9E3779B97F4A7C15ull >> 32) & mask;
+}
+
+// Returns the slot holding the window's entry, or the empty slot where it would go.
+static size_t findSlot(const SWFrameCache *cache, uint32_t windowID)
+{
+    size_t mask = cache->slotCount - 1;
+    size_t slot = slotForWindowID(windowID, mask);
+    while (cache->slots[slot] && cache->entries[cache->slots[slot] - 1].windowID != windowID) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+static void removeSlot(SWFrameCache *cache, size_t slot)
+{
+    // Shift later members of the cluster back, so that lookups never stop at a hole before their entry.
+    size_t mask = cache->slotCount - 1;
+    size_t hole = slot;
+    for (size_t next = (hole + 1) & mask; cache->slots[next]; next = (next + 1) & mask) {
+        size_t home = slotForWindowID(cache->entries[cache->slots[next] - 1].windowID, mask);
+        // Move the entry if its home isn't cyclically within (hole, next].
+        if ((next > hole && (home <= hole || home > next)) || (next < hole && home <= hole && home > next)) {
+            cache->slots[hole] = cache->slots[next];
+            hole = next;
+        }
+    }
+    cache->slots[hole] = 0;
+}
+
+static bool growEntries(SWFrameCache *cache)
+{
+    size_t capacity = cache->entryCapacity ? cache->entryCapacity * 2 : 32;
+    SWFrameCacheEntry *entries = realloc(cache->entries, capacity * sizeof(*entries));
+    size_t *slots = calloc(capacity * 2, sizeof(*slots));
+    if (!entries || !slots) {
+        if (entries) { cache->entries = entries; }
+        free(slots);
+        return false;
+    }
+    cache->entries = entries;
+    
+    for (size_t i = capacity; i-- > cache->entryCapacity;) {
+        entries[i].bytes = NULL;
+        entries[i].older = cache->freeEntries;
+        cache->freeEntries = i;
+    }
+    
+    free(cache->slots);
+    cache->slots = slots;
+    cache->slotCount = capacity * 2;
+    for (size_t entry = cache->newest; entry != kNoEntry; entry = entries[entry].older) {
+        slots[findSlot(cache, entries[entry].windowID)] = entry + 1;
+    }
+    
+    cache->entryCapacity = capacity;
+    return true;
+}
+
+#pragma mark - Recency
+
+static void unlinkEntry(SWFrameCache *cache, size_t entry)
+{
+    SWFrameCacheEntry *e = &cache->entries[entry];
+    if (e->newer != kNoEntry) { cache->entries[e->newer].older = e->older; } else { cache->newest = e->older; }
+    if (e->older != kNoEntry) { cache->entries[e->older].newer = e->newer; } else { cache->oldest = e->newer; }
+}
+
+static void linkAsNewest(SWFrameCache *cache, size_t entry)
+{
+    SWFrameCacheEntry *e = &cache->entries[entry];
+    e->newer = kNoEntry;
+    e->older = cache->newest;
+    if (cache->newest != kNoEntry) { cache->entries[cache->newest].newer = entry; } else { cache->oldest = entry; }
+    cache->newest = entry;
+}
+
+static void removeEntry(SWFrameCache *cache, size_t slot)
+{
+    size_t entry = cache->slots[slot] - 1;
+    SWFrameCacheEntry *e = &cache->entries[entry];
+    
+    unlinkEntry(cache, entry);
+    removeSlot(cache, slot);
+    cache->byteCount -= e->length;
+    cache->count--;
+    free(e->bytes);
+    e->bytes = NULL;
+    e->older = cache->freeEntries;
+    cache->freeEntries = entry;
+}
+
+static void evictToLimit(SWFrameCache *cache)
+{
+    while (cache->byteCount > cache->byteLimit && cache->oldest != kNoEntry) {
+        removeEntry(cache, findSlot(cache, cache->entries[cache->oldest].windowID));
+        cache->evictions++;
+    }
+}
+
+#pragma mark - SWFrameCache
+
+bool SWFrameCacheInit(SWFrameCache *cache, size_t byteLimit)
+{
+    memset(cache, 0, sizeof(*cache));
+    cache->byteLimit = byteLimit;
+    cache->freeEntries = cache->newest = cache->oldest = kNoEntry;
+    if (!growEntries(cache)) {
+        SWFrameCacheDestroy(cache);
+        return false;
+    }
+    return true;
+}
+
+void SWFrameCacheDestroy(SWFrameCache *cache)
+{
+    for (size_t entry = cache->newest; entry != kNoEntry; entry = cache->entries[entry].older) {
+        free(cache->entries[entry].bytes);
+    }
+    free(cache->entries);
+    free(cache->slots);
+    memset(cache, 0, sizeof(*cache));
+}
+
+void SWFrameCacheSetByteLimit(SWFrameCache *cache, size_t byteLimit)
+{
+    cache->byteLimit = byteLimit;
+    evictToLimit(cache);
+}
+
+bool SWFrameCacheStore(SWFrameCache *cache, uint32_t windowID, uint32_t format, const void *pixels, size_t width, size_t height, size_t bytesPerRow)
+{
+    SWFrameCacheRemove(cache, windowID);
+    if (!width || !height || width > UINT32_MAX || height > UINT32_MAX) {
+        return false;
+    }
+    
+    size_t length;
+    uint8_t *bytes = encode(pixels, width, height, bytesPerRow, &length);
+    if (!bytes) {
+        return false;
+    }
+    if (length > cache->byteLimit || (cache->freeEntries == kNoEntry && !growEntries(cache))) {
+        free(bytes);
+        return false;
+    }
+    
+    size_t entry = cache->freeEntries;
+    SWFrameCacheEntry *e = &cache->entries[entry];
+    cache->freeEntries = e->older;
+    *e = (SWFrameCacheEntry){ .windowID = windowID, .format = format, .width = (uint32_t)width, .height = (uint32_t)height, .bytes = bytes, .length = length };
+    linkAsNewest(cache, entry);
+    cache->slots[findSlot(cache, windowID)] = entry + 1;
+    cache->byteCount += length;
+    cache->count++;
+    
+    evictToLimit(cache);
+    return true;
+}
+
+const SWFrameCacheEntry *SWFrameCacheLookup(SWFrameCache *cache, uint32_t windowID)
+{
+    size_t slot = findSlot(cache, windowID);
+    if (!cache->slots[slot]) {
+        cache->misses++;
+        return NULL;
+    }
+    
+    size_t entry = cache->slots[slot] - 1;
+    unlinkEntry(cache, entry);
+    linkAsNewest(cache, entry);
+    cache->hits++;
+    return &cache->entries[entry];
+}
+
+void SWFrameCacheRemove(SWFrameCache *cache, uint32_t windowID)
+{
+    size_t slot = findSlot(cache, windowID);
+    if (cache->slots[slot]) {
+        removeEntry(cache, slot);
+    }
+}
@@ -0,0 +1,89 @@
+//
+//  frameCache.h
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef _FRAMECACHE_H_
+#define _FRAMECACHE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A size-limited cache of small, compressed window frames, for showing something in a thumbnail before the window's first capture lands.
+ *
+ * Frames are 32bpp. Each channel is reduced to 4 bits and runs of identical pixels are run-length encoded, which suits window content (large flat areas of interface chrome) and costs at most a little over two bytes per pixel for anything else. Reducing every channel the same way keeps premultiplied pixels valid. The cache keeps its total compressed size under a limit by evicting the least recently used frames.
+ *
+ * This file has no Cocoa dependencies so it can be built and benchmarked on any platform.
+ */
+
+typedef struct {
+    uint32_t windowID;
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint8_t *bytes;
+    size_t length;
+    // Neighbours in recency order, as entry indexes, or SIZE_MAX.
+    size_t newer;
+    size_t older;
+} SWFrameCacheEntry;
+
+typedef struct {
+    size_t byteLimit;
+    size_t byteCount;
+    size_t count;
+    
+    SWFrameCacheEntry *entries;
+    size_t entryCapacity;
+    // Unused entries, linked through their older field.
+    size_t freeEntries;
+    size_t newest;
+    size_t oldest;
+    
+    // Open-addressed index of entry + 1 by window ID.
+    size_t *slots;
+    size_t slotCount;
+    
+    // Statistics, for tuning and benchmarks.
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+} SWFrameCache;
+
+bool SWFrameCacheInit(SWFrameCache *cache, size_t byteLimit);
+void SWFrameCacheDestroy(SWFrameCache *cache);
+
+// Evicts frames until the cache fits in the new limit.
+void SWFrameCacheSetByteLimit(SWFrameCache *cache, size_t byteLimit);
+
+// Compresses and keeps a frame, replacing any the window already had, and evicts the least recently used frames until the cache fits in its limit. format is kept with the frame for the caller to describe its pixels. Returns false if the frame could not be kept (including when it is larger than the limit), in which case the window has no frame.
+bool SWFrameCacheStore(SWFrameCache *cache, uint32_t windowID, uint32_t format, const void *pixels, size_t width, size_t height, size_t bytesPerRow);
+
+// Returns the window's frame, or NULL, without decoding it. Counts as a use. The entry is valid until the cache is next changed.
+const SWFrameCacheEntry *SWFrameCacheLookup(SWFrameCache *cache, uint32_t windowID);
+
+// Decodes a frame into width * height pixels.
+void SWFrameCacheDecode(const SWFrameCacheEntry *entry, void *pixels, size_t bytesPerRow);
+
+void SWFrameCacheRemove(SWFrameCache *cache, uint32_t windowID);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _FRAMECACHE_H_
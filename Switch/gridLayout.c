@@ -0,0 +1,190 @@
+//
+//  gridLayout.c
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "gridLayout.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+
+static double cellSizeForGrid(SWGridMetrics metrics, double width, double height, size_t columns, size_t rows)
+{
+    double fitWidth = (width - (double)(columns + 1) * metrics.cellPadding) / (double)columns;
+    double fitHeight = (height - (double)(rows + 1) * metrics.cellPadding) / (double)rows;
+    return fmin(metrics.maxCellSize, fmin(fitWidth, fitHeight));
+}
+
+SWGridLayout SWGridLayoutMake(SWGridMetrics metrics, SWGridRect bounds, size_t count, SWGridRect *cellFrames)
+{
+    SWGridLayout layout = { .count = count, .cellPadding = metrics.cellPadding, .cellFrames = cellFrames };
+    double width = fmax(0.0, bounds.width - 2.0 * metrics.boundsInset);
+    double height = fmax(0.0, bounds.height - 2.0 * metrics.boundsInset);
+    double padding = metrics.cellPadding;
+    
+    if (count == 0) {
+        // An empty HUD is the size it would be with one cell.
+        double size = metrics.maxCellSize + 2.0 * padding;
+        layout.hudFrame.width = fmin(size, width);
+        layout.hudFrame.height = fmin(size, height);
+    } else {
+        size_t bestRows = 1;
+        double bestSize = cellSizeForGrid(metrics, width, height, count, 1);
+        for (size_t rows = 2; rows <= count && bestSize < metrics.maxCellSize; ++rows) {
+            size_t columns = (count + rows - 1) / rows;
+            // Adding a row without removing a column only makes cells smaller.
+            if (columns == (count + rows - 2) / (rows - 1)) {
+                continue;
+            }
+            // The height available to each row only shrinks from here on, so nothing later can do better.
+            if ((height - (double)(rows + 1) * padding) / (double)rows <= bestSize) {
+                break;
+            }
+            double size = cellSizeForGrid(metrics, width, height, columns, rows);
+            if (size > bestSize) {
+                bestSize = size;
+                bestRows = rows;
+            }
+        }
+        
+        layout.rows = bestRows;
+        layout.columns = (count + bestRows - 1) / bestRows;
+        layout.cellSize = fmax(0.0, floor(bestSize));
+        layout.hudFrame.width = (double)layout.columns * layout.cellSize + (double)(layout.columns + 1) * padding;
+        layout.hudFrame.height = (double)layout.rows * layout.cellSize + (double)(layout.rows + 1) * padding;
+        
+        double stride = layout.cellSize + padding;
+        double top = layout.hudFrame.height - stride;
+        for (size_t i = 0; i < count; ++i) {
+            size_t row = i / layout.columns;
+            size_t column = i % layout.columns;
+            cellFrames[i] = (SWGridRect){ padding + (double)column * stride, top - (double)row * stride, layout.cellSize, layout.cellSize };
+        }
+    }
+    
+    layout.hudFrame.x = bounds.x + floor((bounds.width - layout.hudFrame.width) / 2.0);
+    layout.hudFrame.y = bounds.y + floor((bounds.height - layout.hudFrame.height) / 2.0);
+    return layout;
+}
+
+size_t SWGridLayoutCellAtPoint(const SWGridLayout *layout, double x, double y)
+{
+    if (layout->count == 0 || layout->cellSize <= 0.0) {
+        return SIZE_MAX;
+    }
+    
+    double stride = layout->cellSize + layout->cellPadding;
+    
+    // Columns count from the left edge of the first column, and a cell spans [left, left + cellSize).
+    double left = x - (layout->hudFrame.x + layout->cellPadding);
+    if (left < 0.0) {
+        return SIZE_MAX;
+    }
+    double column = floor(left / stride);
+    if (column >= (double)layout->columns || left - column * stride >= layout->cellSize) {
+        return SIZE_MAX;
+    }
+    
+    // Rows count down from the top edge of the first row, and a cell spans (top - cellSize, top] measured downward.
+    double down = (layout->hudFrame.y + layout->hudFrame.height - layout->cellPadding) - y;
+    if (down <= 0.0) {
+        return SIZE_MAX;
+    }
+    double row = ceil(down / stride) - 1.0;
+    if (row >= (double)layout->rows || down - row * stride > layout->cellSize) {
+        return SIZE_MAX;
+    }
+    
+    size_t index = (size_t)row * layout->columns + (size_t)column;
+    return index < layout->count ? index : SIZE_MAX;
+}
+
+#pragma mark - Cache
+
+enum {
+    kCacheEntries = 4,
+};
+
+typedef struct {
+    bool valid;
+    SWGridRect bounds;
+    uint64_t lastUse;
+    size_t capacity;
+    SWGridRect *cellFrames;
+    SWGridLayout layout;
+} SWGridLayoutCacheEntry;
+
+struct SWGridLayoutCache {
+    SWGridMetrics metrics;
+    uint64_t clock;
+    SWGridLayoutCacheEntry entries[kCacheEntries];
+};
+
+SWGridLayoutCache *SWGridLayoutCacheCreate(SWGridMetrics metrics)
+{
+    SWGridLayoutCache *cache = calloc(1, sizeof(*cache));
+    if (cache) {
+        cache->metrics = metrics;
+    }
+    return cache;
+}
+
+void SWGridLayoutCacheDestroy(SWGridLayoutCache *cache)
+{
+    if (!cache) {
+        return;
+    }
+    for (size_t i = 0; i < kCacheEntries; ++i) {
+        free(cache->entries[i].cellFrames);
+    }
+    free(cache);
+}
+
+static inline bool rectsEqual(SWGridRect a, SWGridRect b)
+{
+    return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+
+const SWGridLayout *SWGridLayoutCacheGet(SWGridLayoutCache *cache, SWGridRect bounds, size_t count)
+{
+    cache->clock++;
+    
+    SWGridLayoutCacheEntry *victim = &cache->entries[0];
+    for (size_t i = 0; i < kCacheEntries; ++i) {
+        SWGridLayoutCacheEntry *entry = &cache->entries[i];
+        if (entry->valid && entry->layout.count == count && rectsEqual(entry->bounds, bounds)) {
+            entry->lastUse = cache->clock;
+            return &entry->layout;
+        }
+        if (!entry->valid || (victim->valid && entry->lastUse < victim->lastUse)) {
+            victim = entry;
+        }
+    }
+    
+    if (victim->capacity < count) {
+        SWGridRect *cellFrames = realloc(victim->cellFrames, count * sizeof(*cellFrames));
+        if (!cellFrames) {
+            return NULL;
+        }
+        victim->cellFrames = cellFrames;
+        victim->capacity = count;
+    }
+    
+    victim->valid = true;
+    victim->bounds = bounds;
+    victim->lastUse = cache->clock;
+    victim->layout = SWGridLayoutMake(cache->metrics, bounds, count, victim->cellFrames);
+    return &victim->layout;
+}
@@ -0,0 +1,83 @@
+//
+//  gridLayout.h
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef _GRIDLAYOUT_H_
+#define _GRIDLAYOUT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Frame layout of the switcher's HUD: a grid of square cells inside a rounded rect centered in the screen.
+ *
+ * Cells are as large as they can be up to a maximum size, with fixed padding between cells and around the edges of the HUD, and a minimum inset between the HUD and the edges of the bounds. As many cells as fit at the maximum size go in a single row; when they don't, the number of rows is chosen to make the cells as large as possible, preferring fewer rows. Rows fill from the top, left to right. Sizes and positions are rounded down to whole points so layouts are exact and repeatable.
+ *
+ * Coordinates have their origin at the bottom left, like a view that isn't flipped. The HUD's frame is in the bounds' coordinates and cell frames are relative to the HUD.
+ *
+ * Because the grid is regular, finding the cell under a point is arithmetic on the layout rather than a search through the cell frames.
+ *
+ * This file has no Cocoa dependencies so it can be built and benchmarked on any platform.
+ */
+
+typedef struct {
+    double x;
+    double y;
+    double width;
+    double height;
+} SWGridRect;
+
+typedef struct {
+    double maxCellSize;
+    // Between cells, and between cells and the edges of the HUD.
+    double cellPadding;
+    // The least space between the HUD and the edges of the bounds.
+    double boundsInset;
+} SWGridMetrics;
+
+typedef struct {
+    size_t count;
+    size_t columns;
+    size_t rows;
+    double cellSize;
+    double cellPadding;
+    SWGridRect hudFrame;
+    // count frames.
+    const SWGridRect *cellFrames;
+} SWGridLayout;
+
+// Lays out count cells in bounds. cellFrames must have room for count frames, and is what the layout's cellFrames points to.
+SWGridLayout SWGridLayoutMake(SWGridMetrics metrics, SWGridRect bounds, size_t count, SWGridRect *cellFrames);
+
+// The index of the cell containing the point (in the bounds' coordinates), or SIZE_MAX if the point isn't in a cell. Like NSPointInRect, cells contain their minimum edges but not their maximum edges.
+size_t SWGridLayoutCellAtPoint(const SWGridLayout *layout, double x, double y);
+
+// Layouts keyed by cell count and bounds size, for a fixed set of metrics. A cache holds the few most recently used layouts.
+typedef struct SWGridLayoutCache SWGridLayoutCache;
+
+// Returns NULL if memory could not be allocated.
+SWGridLayoutCache *SWGridLayoutCacheCreate(SWGridMetrics metrics);
+void SWGridLayoutCacheDestroy(SWGridLayoutCache *cache);
+
+// The returned layout belongs to the cache and is valid until the next call. Returns NULL if memory could not be allocated.
+const SWGridLayout *SWGridLayoutCacheGet(SWGridLayoutCache *cache, SWGridRect bounds, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _GRIDLAYOUT_H_
@@ -12,6 +12,9 @@
 //  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //
 
+#import "tileHash.h"
+
+
 static BOOL (^imagesDifferByCachedTIFFComparison)(NSImage *, NSImage *) = ^(NSImage *a, NSImage *b) {
     static void *tiffContextKey = (void *)1999428944; // Guaranteed random by arc4random()
     NSData *(^TIFFForImage)(NSImage *) = ^(NSImage *image) {
@@ -101,3 +104,23 @@ static BOOL (^imagesDifferByCachedBitmapContextComparison)(NSImage *, NSImage *)
     
     return result;
 };
+
+/// Hashes the raw pixel buffers in fixed-size tiles. SWWindowWorker uses the stateful form of this (SWTileHashUpdate) so it only has to keep the previous capture's tile hashes, which also tell it which regions changed.
+static BOOL (^imagesDifferByTileHashComparison)(CGImageRef, CGImageRef) = ^(CGImageRef a, CGImageRef b) {
+    if (CGImageGetWidth(a) != CGImageGetWidth(b) || CGImageGetHeight(a) != CGImageGetHeight(b)) {
+        return YES;
+    }
+    
+    SWTileHash tileHash;
+    SWTileHashInit(&tileHash, kSWTileHashDefaultTileSize);
+    
+    BOOL result = NO;
+    CGImageRef images[] = { a, b };
+    for (size_t i = 0; i < sizeof(images) / sizeof(*images); ++i) {
+        CFDataRef data = NNCFAutorelease(CGDataProviderCopyData(CGImageGetDataProvider(images[i])));
+        result = SWTileHashUpdate(&tileHash, CFDataGetBytePtr(data), CGImageGetWidth(images[i]), CGImageGetHeight(images[i]), CGImageGetBytesPerRow(images[i]));
+    }
+    
+    SWTileHashDestroy(&tileHash);
+    return result;
+};
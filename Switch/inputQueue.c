@@ -0,0 +1,131 @@
+//
+//  inputQueue.c
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "inputQueue.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+
+
+// Keeps the producer's and consumer's fields from sharing a cache line.
+#define kCacheLineSize 64
+
+struct SWInputQueue {
+    size_t mask;
+    SWInput *inputs;
+    
+    char producerPadding[kCacheLineSize];
+    _Atomic size_t tail;
+    // The consumer's head, as of the last time the producer read it.
+    size_t cachedHead;
+    
+    char consumerPadding[kCacheLineSize];
+    _Atomic size_t head;
+    // The producer's tail, as of the last time the consumer read it.
+    size_t cachedTail;
+    
+    char endPadding[kCacheLineSize];
+};
+
+SWInputQueue *SWInputQueueCreate(size_t capacity)
+{
+    size_t roundedCapacity = 1;
+    while (roundedCapacity < capacity) {
+        roundedCapacity <<= 1;
+    }
+    
+    SWInputQueue *queue = calloc(1, sizeof(*queue));
+    if (!queue) {
+        return NULL;
+    }
+    queue->inputs = calloc(roundedCapacity, sizeof(*queue->inputs));
+    if (!queue->inputs) {
+        free(queue);
+        return NULL;
+    }
+    queue->mask = roundedCapacity - 1;
+    atomic_init(&queue->tail, 0);
+    atomic_init(&queue->head, 0);
+    return queue;
+}
+
+void SWInputQueueDestroy(SWInputQueue *queue)
+{
+    if (!queue) {
+        return;
+    }
+    free(queue->inputs);
+    free(queue);
+}
+
+bool SWInputQueuePush(SWInputQueue *queue, const SWInput *input)
+{
+    size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    if (tail - queue->cachedHead > queue->mask) {
+        queue->cachedHead = atomic_load_explicit(&queue->head, memory_order_acquire);
+        if (tail - queue->cachedHead > queue->mask) {
+            return false;
+        }
+    }
+    
+    queue->inputs[tail & queue->mask] = *input;
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+// Consumer only. Returns the input at the head of the queue without popping it, or NULL.
+static const SWInput *peek(SWInputQueue *queue)
+{
+    size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    if (head == queue->cachedTail) {
+        queue->cachedTail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+        if (head == queue->cachedTail) {
+            return NULL;
+        }
+    }
+    return &queue->inputs[head & queue->mask];
+}
+
+static void discardHead(SWInputQueue *queue)
+{
+    size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+}
+
+bool SWInputQueuePop(SWInputQueue *queue, SWInput *input)
+{
+    const SWInput *next = peek(queue);
+    if (!next) {
+        return false;
+    }
+    
+    *input = *next;
+    discardHead(queue);
+    return true;
+}
+
+size_t SWInputQueuePopCoalesced(SWInputQueue *queue, SWInput *input)
+{
+    if (!SWInputQueuePop(queue, input)) {
+        return 0;
+    }
+    
+    size_t count = 1;
+    const SWInput *next;
+    while (input->kind == SWInputKindIncrement && (next = peek(queue)) && next->kind == input->kind && next->flags == input->flags) {
+        discardHead(queue);
+        ++count;
+    }
+    return count;
+}
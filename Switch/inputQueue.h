@@ -0,0 +1,75 @@
+//
+//  inputQueue.h
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef _INPUTQUEUE_H_
+#define _INPUTQUEUE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A bounded queue of state machine inputs, passed from the event tap's thread to the main thread without locks.
+ *
+ * There is exactly one producer and one consumer. Neither side allocates or waits: pushing to a full queue fails instead of blocking, and popping from an empty queue returns false. The producer and consumer indexes live on separate cache lines, and each side keeps a cached copy of the other's index so that it only reads the shared one when the queue looks full (or empty).
+ *
+ * This file has no Cocoa dependencies so it can be built and benchmarked on any platform.
+ */
+
+typedef enum {
+    SWInputKindIncrement,
+    SWInputKindCloseWindow,
+    SWInputKindCancel,
+    SWInputKindEnd,
+    SWInputKindShowPreferences,
+} SWInputKind;
+
+typedef enum {
+    // Increment inputs only.
+    SWInputFlagInvoke = 1 << 0,
+    SWInputFlagDecreasing = 1 << 1,
+    SWInputFlagRepeating = 1 << 2,
+} SWInputFlag;
+
+typedef struct {
+    SWInputKind kind;
+    uint32_t flags;
+    // When the event that caused the input arrived, in SWTraceNow units.
+    uint64_t timestamp;
+} SWInput;
+
+typedef struct SWInputQueue SWInputQueue;
+
+// Capacity is rounded up to a power of two. Returns NULL if memory could not be allocated.
+SWInputQueue *SWInputQueueCreate(size_t capacity);
+void SWInputQueueDestroy(SWInputQueue *queue);
+
+// Producer only. Returns false if the queue is full.
+bool SWInputQueuePush(SWInputQueue *queue, const SWInput *input);
+
+// Consumer only. Returns false if the queue is empty.
+bool SWInputQueuePop(SWInputQueue *queue, SWInput *input);
+
+// Consumer only. Pops an input along with any identical increments queued right behind it, such as the repeats of a held key, and returns how many were popped. The input has the first one's timestamp. Returns 0 if the queue is empty.
+size_t SWInputQueuePopCoalesced(SWInputQueue *queue, SWInput *input);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _INPUTQUEUE_H_
@@ -0,0 +1,248 @@
+//
+//  resample.c
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "resample.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <emmintrin.h>
+    #define RESAMPLE_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define RESAMPLE_NEON 1
+#endif
+
+
+// The source pixels covered by one destination pixel along one axis: [first, last], where the first and last pixels may only be partially covered.
+typedef struct {
+    size_t first;
+    size_t last;
+    float firstWeight;
+    float lastWeight;
+} span_t;
+
+static span_t spanForPixel(size_t index, double ratio, size_t sourceLength)
+{
+    double start = index * ratio;
+    double end = (index + 1) * ratio;
+    if (end > sourceLength) {
+        end = sourceLength;
+    }
+    
+    span_t result;
+    result.first = (size_t)start;
+    result.last = (size_t)ceil(end) - 1;
+    if (result.last < result.first) {
+        result.last = result.first;
+    }
+    
+    if (result.first == result.last) {
+        result.firstWeight = result.lastWeight = (float)(end - start);
+    } else {
+        result.firstWeight = (float)((result.first + 1) - start);
+        result.lastWeight = (float)(end - result.last);
+    }
+    return result;
+}
+
+static inline float weightForSourcePixel(const span_t *span, size_t index)
+{
+    if (index == span->first) {
+        return span->firstWeight;
+    } else if (index == span->last) {
+        return span->lastWeight;
+    }
+    return 1.0f;
+}
+
+#pragma mark - Kernels
+
+// accumulator[i] += weight * bytes[i], for count bytes (a multiple of 4).
+static void accumulateRow(float *accumulator, const uint8_t *bytes, size_t count, float weight)
+{
+    size_t i = 0;
+#if RESAMPLE_SSE2
+    __m128 w = _mm_set1_ps(weight);
+    __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(bytes + i));
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        __m128 f0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero));
+        __m128 f1 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero));
+        __m128 f2 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero));
+        __m128 f3 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero));
+        _mm_storeu_ps(accumulator + i + 0, _mm_add_ps(_mm_loadu_ps(accumulator + i + 0), _mm_mul_ps(f0, w)));
+        _mm_storeu_ps(accumulator + i + 4, _mm_add_ps(_mm_loadu_ps(accumulator + i + 4), _mm_mul_ps(f1, w)));
+        _mm_storeu_ps(accumulator + i + 8, _mm_add_ps(_mm_loadu_ps(accumulator + i + 8), _mm_mul_ps(f2, w)));
+        _mm_storeu_ps(accumulator + i + 12, _mm_add_ps(_mm_loadu_ps(accumulator + i + 12), _mm_mul_ps(f3, w)));
+    }
+#elif RESAMPLE_NEON
+    for (; i + 16 <= count; i += 16) {
+        uint8x16_t v = vld1q_u8(bytes + i);
+        uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+        uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+        float32x4_t f0 = vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo)));
+        float32x4_t f1 = vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo)));
+        float32x4_t f2 = vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi)));
+        float32x4_t f3 = vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi)));
+        vst1q_f32(accumulator + i + 0, vmlaq_n_f32(vld1q_f32(accumulator + i + 0), f0, weight));
+        vst1q_f32(accumulator + i + 4, vmlaq_n_f32(vld1q_f32(accumulator + i + 4), f1, weight));
+        vst1q_f32(accumulator + i + 8, vmlaq_n_f32(vld1q_f32(accumulator + i + 8), f2, weight));
+        vst1q_f32(accumulator + i + 12, vmlaq_n_f32(vld1q_f32(accumulator + i + 12), f3, weight));
+    }
+#endif
+    for (; i < count; ++i) {
+        accumulator[i] += weight * bytes[i];
+    }
+}
+
+// Reduces the accumulated source pixels covered by span to one destination pixel.
+static inline void reducePixel(const float *accumulator, const span_t *span, float scale, uint8_t *pixel)
+{
+#if RESAMPLE_SSE2
+    __m128 sum = _mm_setzero_ps();
+    for (size_t x = span->first; x <= span->last; ++x) {
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(accumulator + x * 4), _mm_set1_ps(weightForSourcePixel(span, x))));
+    }
+    __m128i rounded = _mm_cvtps_epi32(_mm_mul_ps(sum, _mm_set1_ps(scale)));
+    rounded = _mm_packs_epi32(rounded, rounded);
+    rounded = _mm_packus_epi16(rounded, rounded);
+    int32_t packed = _mm_cvtsi128_si32(rounded);
+    memcpy(pixel, &packed, 4);
+#elif RESAMPLE_NEON
+    float32x4_t sum = vdupq_n_f32(0.0f);
+    for (size_t x = span->first; x <= span->last; ++x) {
+        sum = vmlaq_n_f32(sum, vld1q_f32(accumulator + x * 4), weightForSourcePixel(span, x));
+    }
+    uint32x4_t rounded = vcvtnq_u32_f32(vmulq_n_f32(sum, scale));
+    uint8x8_t narrowed = vqmovn_u16(vcombine_u16(vqmovn_u32(rounded), vdup_n_u16(0)));
+    uint32_t packed = vget_lane_u32(vreinterpret_u32_u8(narrowed), 0);
+    memcpy(pixel, &packed, 4);
+#else
+    float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (size_t x = span->first; x <= span->last; ++x) {
+        float weight = weightForSourcePixel(span, x);
+        for (size_t c = 0; c < 4; ++c) {
+            sum[c] += accumulator[x * 4 + c] * weight;
+        }
+    }
+    for (size_t c = 0; c < 4; ++c) {
+        float value = nearbyintf(sum[c] * scale);
+        pixel[c] = value < 0.0f ? 0 : value > 255.0f ? 255 : (uint8_t)value;
+    }
+#endif
+}
+
+#pragma mark - Public
+
+void SWResampleFitSize(size_t sourceWidth, size_t sourceHeight, size_t maxEdge, size_t maxPixels, size_t *width, size_t *height)
+{
+    double scale = 1.0;
+    size_t longestEdge = sourceWidth > sourceHeight ? sourceWidth : sourceHeight;
+    if (longestEdge && maxEdge < longestEdge) {
+        scale = (double)maxEdge / longestEdge;
+    }
+    double area = (double)sourceWidth * sourceHeight * scale * scale;
+    if (area > maxPixels && area > 0.0) {
+        scale *= sqrt(maxPixels / area);
+    }
+    
+    // The epsilon keeps exact fits (like a 64x36 budget for a 16:9 source) from rounding down a pixel.
+    *width = (size_t)floor(sourceWidth * scale + 1e-6);
+    *height = (size_t)floor(sourceHeight * scale + 1e-6);
+    if (*width < 1) { *width = 1; }
+    if (*height < 1) { *height = 1; }
+}
+
+SWTileRect SWResampleScaleRect(SWTileRect sourceRect, size_t sourceWidth, size_t sourceHeight, size_t width, size_t height)
+{
+    size_t minX = (size_t)floor((double)sourceRect.x * width / sourceWidth);
+    size_t minY = (size_t)floor((double)sourceRect.y * height / sourceHeight);
+    size_t maxX = (size_t)ceil((double)(sourceRect.x + sourceRect.width) * width / sourceWidth);
+    size_t maxY = (size_t)ceil((double)(sourceRect.y + sourceRect.height) * height / sourceHeight);
+    if (maxX > width) { maxX = width; }
+    if (maxY > height) { maxY = height; }
+    
+    return (SWTileRect){ .x = minX, .y = minY, .width = maxX > minX ? maxX - minX : 0, .height = maxY > minY ? maxY - minY : 0 };
+}
+
+bool SWResampleBox(const void *source, size_t sourceWidth, size_t sourceHeight, size_t sourceBytesPerRow, void *destination, size_t width, size_t height, size_t bytesPerRow, const SWTileRect *region)
+{
+    if (!source || !destination || !sourceWidth || !sourceHeight || !width || !height) {
+        return false;
+    }
+    if (width > sourceWidth || height > sourceHeight) {
+        return false;
+    }
+    
+    SWTileRect bounds = { .x = 0, .y = 0, .width = width, .height = height };
+    if (region) {
+        bounds = *region;
+        if (bounds.x + bounds.width > width || bounds.y + bounds.height > height) {
+            return false;
+        }
+        if (!bounds.width || !bounds.height) {
+            return true;
+        }
+    }
+    
+    double ratioX = (double)sourceWidth / width;
+    double ratioY = (double)sourceHeight / height;
+    float scale = (float)(1.0 / (ratioX * ratioY));
+    
+    span_t *columns = malloc(bounds.width * sizeof(*columns));
+    if (!columns) {
+        return false;
+    }
+    for (size_t i = 0; i < bounds.width; ++i) {
+        columns[i] = spanForPixel(bounds.x + i, ratioX, sourceWidth);
+    }
+    
+    // Only the source columns that the region's pixels depend on are accumulated.
+    size_t firstColumn = columns[0].first;
+    size_t columnCount = columns[bounds.width - 1].last + 1 - firstColumn;
+    float *accumulator = malloc(columnCount * 4 * sizeof(*accumulator));
+    if (!accumulator) {
+        free(columns);
+        return false;
+    }
+    
+    const uint8_t *sourceBytes = (const uint8_t *)source + firstColumn * 4;
+    for (size_t j = bounds.y; j < bounds.y + bounds.height; ++j) {
+        span_t rows = spanForPixel(j, ratioY, sourceHeight);
+        
+        memset(accumulator, 0, columnCount * 4 * sizeof(*accumulator));
+        for (size_t y = rows.first; y <= rows.last; ++y) {
+            accumulateRow(accumulator, sourceBytes + y * sourceBytesPerRow, columnCount * 4, weightForSourcePixel(&rows, y));
+        }
+        
+        uint8_t *row = (uint8_t *)destination + j * bytesPerRow;
+        // The accumulator starts at firstColumn, so rebase each span onto it.
+        for (size_t i = 0; i < bounds.width; ++i) {
+            span_t span = columns[i];
+            span.first -= firstColumn;
+            span.last -= firstColumn;
+            reducePixel(accumulator, &span, scale, row + (bounds.x + i) * 4);
+        }
+    }
+    
+    free(accumulator);
+    free(columns);
+    return true;
+}
@@ -0,0 +1,48 @@
+//
+//  resample.h
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef _RESAMPLE_H_
+#define _RESAMPLE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "tileHash.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Downsampling for window captures.
+ *
+ * Captures are reduced once, at capture time, to the largest size the interface can draw them. The filter is an exact area average (box filter) over 32bpp premultiplied pixels, which is the right filter for the large reduction ratios involved (a 5K window shown in a 256 pixel thumbnail) and, unlike windowed-sinc filters, costs the same no matter how large the ratio is.
+ *
+ * This file has no Cocoa dependencies so it can be built and benchmarked on any platform.
+ */
+
+// Computes the largest size with the source's aspect ratio whose longest edge is at most maxEdge pixels and whose area is at most maxPixels. Never upscales, and never returns an empty size.
+void SWResampleFitSize(size_t sourceWidth, size_t sourceHeight, size_t maxEdge, size_t maxPixels, size_t *width, size_t *height);
+
+// Maps a rect in source pixels to the smallest rect of destination pixels whose values depend on it.
+SWTileRect SWResampleScaleRect(SWTileRect sourceRect, size_t sourceWidth, size_t sourceHeight, size_t width, size_t height);
+
+// Box filters source into destination. If region is non-NULL, only the destination pixels inside it are written.
+bool SWResampleBox(const void *source, size_t sourceWidth, size_t sourceHeight, size_t sourceBytesPerRow, void *destination, size_t width, size_t height, size_t bytesPerRow, const SWTileRect *region);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _RESAMPLE_H_
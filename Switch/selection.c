@@ -0,0 +1,146 @@
+//
+//  selection.c
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "selection.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+struct SWSelectionMap {
+    size_t mask;
+    uint32_t *windowIDs;
+    // Index + 1 for each slot, 0 if empty, followed by the window IDs.
+    uint32_t slots[];
+};
+
+#pragma mark - SWSelection
+
+static intptr_t wrapIndex(intptr_t index, size_t count)
+{
+    intptr_t length = (intptr_t)count;
+    index %= length;
+    return index < 0 ? index + length : index;
+}
+
+SWSelection SWSelectionMake(bool hasList, size_t count, intptr_t index)
+{
+    if ((hasList && !count) || index == SWSelectionNone) {
+        index = SWSelectionNone;
+    } else if (count) {
+        index = wrapIndex(index, count);
+    }
+    return (SWSelection){ .index = index, .count = count, .hasList = hasList };
+}
+
+void SWSelectionMove(SWSelection *selection, intptr_t steps, bool wrapping)
+{
+    if (!steps || (selection->hasList && !selection->count)) {
+        return;
+    }
+    
+    intptr_t index = selection->index;
+    if (index == SWSelectionNone) {
+        index = steps > 0 ? 0 : (intptr_t)selection->count - 1;
+        steps += steps > 0 ? -1 : 1;
+    }
+    
+    if (wrapping || !selection->hasList) {
+        index += steps;
+    } else {
+        intptr_t last = (intptr_t)selection->count - 1;
+        index += steps;
+        index = index < 0 ? 0 : index > last ? last : index;
+    }
+    
+    *selection = SWSelectionMake(selection->hasList, selection->count, index);
+}
+
+bool SWSelectionSelect(SWSelection *selection, intptr_t index)
+{
+    if (selection->hasList && index != SWSelectionNone && (index < 0 || (size_t)index >= selection->count)) {
+        return false;
+    }
+    *selection = SWSelectionMake(selection->hasList, selection->count, index);
+    return true;
+}
+
+void SWSelectionUpdate(SWSelection *selection, bool hasList, size_t count, intptr_t previousIndex)
+{
+    intptr_t index = selection->index;
+    
+    if (hasList && !count) {
+        index = SWSelectionNone;
+    } else if (!hasList || !selection->hasList) {
+        // Nothing to follow.
+    } else if (previousIndex != SWSelectionNone) {
+        index = previousIndex;
+    } else if ((intptr_t)count <= index) {
+        index = (intptr_t)count - 1;
+    }
+    
+    *selection = SWSelectionMake(hasList, count, index);
+}
+
+#pragma mark - SWSelectionMap
+
+static inline size_t slotForWindowID(uint32_t windowID, size_t mask)
+{
+    return (size_t)((windowID * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+
+SWSelectionMap *SWSelectionMapCreate(const uint32_t *windowIDs, size_t count)
+{
+    size_t slotCount = 16;
+    while (slotCount < count * 2) {
+        slotCount *= 2;
+    }
+    
+    SWSelectionMap *map = calloc(1, sizeof(*map) + (slotCount + count) * sizeof(*map->slots));
+    if (!map) {
+        return NULL;
+    }
+    map->mask = slotCount - 1;
+    map->windowIDs = map->slots + slotCount;
+    if (count) {
+        memcpy(map->windowIDs, windowIDs, count * sizeof(*windowIDs));
+    }
+    
+    for (size_t i = 0; i < count; ++i) {
+        size_t slot = slotForWindowID(windowIDs[i], map->mask);
+        while (map->slots[slot] && windowIDs[map->slots[slot] - 1] != windowIDs[i]) {
+            slot = (slot + 1) & map->mask;
+        }
+        // The first window with an ID wins.
+        if (!map->slots[slot]) {
+            map->slots[slot] = (uint32_t)i + 1;
+        }
+    }
+    return map;
+}
+
+void SWSelectionMapDestroy(SWSelectionMap *map)
+{
+    free(map);
+}
+
+intptr_t SWSelectionMapFind(const SWSelectionMap *map, uint32_t windowID)
+{
+    for (size_t slot = slotForWindowID(windowID, map->mask); map->slots[slot]; slot = (slot + 1) & map->mask) {
+        if (map->windowIDs[map->slots[slot] - 1] == windowID) {
+            return (intptr_t)map->slots[slot] - 1;
+        }
+    }
+    return SWSelectionNone;
+}
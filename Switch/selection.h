@@ -0,0 +1,72 @@
+//
+//  selection.h
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef _SELECTION_H_
+#define _SELECTION_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The selection in a window list, as a value that is updated in place.
+ *
+ * A selection is an index and the length of the list it indexes; it doesn't hold the list. Moving the selection and selecting an index never allocate. When the window list changes, the selected window is found in the new list through a map from window ID to index that is built once per list, so carrying the selection over doesn't scan the list.
+ *
+ * This file has no Cocoa dependencies so it can be built and benchmarked on any platform.
+ */
+
+// No selection. Equal to NSNotFound.
+#define SWSelectionNone INTPTR_MAX
+
+typedef struct {
+    intptr_t index;
+    size_t count;
+    // Without a list, indexes aren't wrapped or clamped, since there's nothing to wrap or clamp them to.
+    bool hasList;
+} SWSelection;
+
+// Makes a selection, wrapping index into the list. An empty list has no selection.
+SWSelection SWSelectionMake(bool hasList, size_t count, intptr_t index);
+
+// Moves the selection by steps (backward if negative). Wrapping moves go around the ends of the list, others stop at them. The first step from no selection lands on the first or last window.
+void SWSelectionMove(SWSelection *selection, intptr_t steps, bool wrapping);
+
+// Returns false, leaving the selection unchanged, if index is out of the list's bounds and isn't SWSelectionNone.
+bool SWSelectionSelect(SWSelection *selection, intptr_t index);
+
+// Moves the selection to a new list of count windows. previousIndex is where the selected window is in the new list, or SWSelectionNone if it isn't.
+//
+// The selection follows its window when it's still in the list. When it's gone, the selection keeps its position, so the window that took the selected window's place is selected, or the last window if the list got shorter than the selection's index. Neither happens when the selection didn't have a list yet: its index is kept, and wrapped into the new list.
+void SWSelectionUpdate(SWSelection *selection, bool hasList, size_t count, intptr_t previousIndex);
+
+// Window ID to index, for finding a window in a list.
+typedef struct SWSelectionMap SWSelectionMap;
+
+// Returns NULL if memory could not be allocated.
+SWSelectionMap *SWSelectionMapCreate(const uint32_t *windowIDs, size_t count);
+void SWSelectionMapDestroy(SWSelectionMap *map);
+
+// The index of the first window with windowID, or SWSelectionNone.
+intptr_t SWSelectionMapFind(const SWSelectionMap *map, uint32_t windowID);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _SELECTION_H_
@@ -0,0 +1,490 @@
+//
+//  tileHash.c
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "tileHash.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <emmintrin.h>
+    #define TILEHASH_SSE2 1
+    #if defined(__clang__) || defined(__GNUC__)
+        #include <immintrin.h>
+        #define TILEHASH_AVX2 1
+    #endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define TILEHASH_NEON 1
+#endif
+
+#ifndef TILEHASH_SSE2
+    #define TILEHASH_SSE2 0
+#endif
+#ifndef TILEHASH_AVX2
+    #define TILEHASH_AVX2 0
+#endif
+#ifndef TILEHASH_NEON
+    #define TILEHASH_NEON 0
+#endif
+
+
+const size_t kSWTileHashDefaultTileSize = 32;
+
+/*
+ * Each tile is hashed as four interleaved lanes of 64-bit words. Every lane keeps a running sum of its words (s1) and a running sum of those sums (s2), so a word's contribution depends on where in the lane it is.
+ *
+ * Sums alone are linear: edits whose differences cancel out (+d, -2d, +d in consecutive words of a lane, say) would leave both sums unchanged. Each word is first multiplied by an odd constant and rotated, which is a bijection on words that doesn't commute with addition, so structured edits like these no longer cancel. Vector units lack a 64-bit multiply, so the SIMD implementations build it from 32-bit multiplies; SSE2, AVX2, and NEON all produce exactly the same result as the scalar implementation.
+ *
+ * The state for a tile is { s1[0..3], s2[0..3] }. The lanes are only mixed together when the tile is finalized.
+ */
+#define kWordMultiplier 0x9fb21c651e98df25ULL
+#define kWordRotation 29
+#define kLaneCount 4
+#define kStateWords (kLaneCount * 2)
+#define kChunkBytes (kLaneCount * sizeof(uint64_t))
+
+typedef void (*tilehash_span_f)(uint64_t *state, const uint8_t *bytes, size_t length);
+
+
+#pragma mark - Scalar
+
+static inline uint64_t load64(const uint8_t *bytes)
+{
+    uint64_t result;
+    memcpy(&result, bytes, sizeof(result));
+    return result;
+}
+
+static inline uint64_t mixWord(uint64_t word)
+{
+    word *= kWordMultiplier;
+    return (word << kWordRotation) | (word >> (64 - kWordRotation));
+}
+
+static inline void chunkScalar(uint64_t *state, const uint8_t *bytes)
+{
+    for (size_t i = 0; i < kLaneCount; ++i) {
+        state[i] += mixWord(load64(bytes + i * sizeof(uint64_t)));
+        state[kLaneCount + i] += state[i];
+    }
+}
+
+// Tails are zero-padded to a full chunk so every implementation sees the same words.
+static inline void spanTail(uint64_t *state, const uint8_t *bytes, size_t length)
+{
+    if (length) {
+        uint8_t chunk[kChunkBytes] = {0};
+        memcpy(chunk, bytes, length);
+        chunkScalar(state, chunk);
+    }
+}
+
+static void spanScalar(uint64_t *state, const uint8_t *bytes, size_t length)
+{
+    for (; length >= kChunkBytes; bytes += kChunkBytes, length -= kChunkBytes) {
+        chunkScalar(state, bytes);
+    }
+    spanTail(state, bytes, length);
+}
+
+#pragma mark - SSE2
+
+#if TILEHASH_SSE2
+// (lo + hi * 2^32) * k = lo * k_lo + ((lo * k_hi + hi * k_lo) << 32), modulo 2^64.
+static inline __m128i mixWordsSSE2(__m128i words)
+{
+    const __m128i multiplierLow = _mm_set1_epi64x((long long)(kWordMultiplier & 0xffffffffULL));
+    const __m128i multiplierHigh = _mm_set1_epi64x((long long)(kWordMultiplier >> 32));
+    __m128i low = _mm_mul_epu32(words, multiplierLow);
+    __m128i cross = _mm_add_epi64(_mm_mul_epu32(words, multiplierHigh), _mm_mul_epu32(_mm_srli_epi64(words, 32), multiplierLow));
+    __m128i product = _mm_add_epi64(low, _mm_slli_epi64(cross, 32));
+    return _mm_or_si128(_mm_slli_epi64(product, kWordRotation), _mm_srli_epi64(product, 64 - kWordRotation));
+}
+
+static void spanSSE2(uint64_t *state, const uint8_t *bytes, size_t length)
+{
+    __m128i s1a = _mm_loadu_si128((const __m128i *)(state + 0));
+    __m128i s1b = _mm_loadu_si128((const __m128i *)(state + 2));
+    __m128i s2a = _mm_loadu_si128((const __m128i *)(state + 4));
+    __m128i s2b = _mm_loadu_si128((const __m128i *)(state + 6));
+    
+    for (; length >= kChunkBytes; bytes += kChunkBytes, length -= kChunkBytes) {
+        s1a = _mm_add_epi64(s1a, mixWordsSSE2(_mm_loadu_si128((const __m128i *)(bytes + 0))));
+        s1b = _mm_add_epi64(s1b, mixWordsSSE2(_mm_loadu_si128((const __m128i *)(bytes + 16))));
+        s2a = _mm_add_epi64(s2a, s1a);
+        s2b = _mm_add_epi64(s2b, s1b);
+    }
+    
+    _mm_storeu_si128((__m128i *)(state + 0), s1a);
+    _mm_storeu_si128((__m128i *)(state + 2), s1b);
+    _mm_storeu_si128((__m128i *)(state + 4), s2a);
+    _mm_storeu_si128((__m128i *)(state + 6), s2b);
+    
+    spanTail(state, bytes, length);
+}
+#endif
+
+#pragma mark - AVX2
+
+#if TILEHASH_AVX2
+__attribute__((target("avx2")))
+static inline __m256i mixWordsAVX2(__m256i words)
+{
+    const __m256i multiplierLow = _mm256_set1_epi64x((long long)(kWordMultiplier & 0xffffffffULL));
+    const __m256i multiplierHigh = _mm256_set1_epi64x((long long)(kWordMultiplier >> 32));
+    __m256i low = _mm256_mul_epu32(words, multiplierLow);
+    __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(words, multiplierHigh), _mm256_mul_epu32(_mm256_srli_epi64(words, 32), multiplierLow));
+    __m256i product = _mm256_add_epi64(low, _mm256_slli_epi64(cross, 32));
+    return _mm256_or_si256(_mm256_slli_epi64(product, kWordRotation), _mm256_srli_epi64(product, 64 - kWordRotation));
+}
+
+__attribute__((target("avx2")))
+static void spanAVX2(uint64_t *state, const uint8_t *bytes, size_t length)
+{
+    __m256i s1 = _mm256_loadu_si256((const __m256i *)(state + 0));
+    __m256i s2 = _mm256_loadu_si256((const __m256i *)(state + 4));
+    
+    for (; length >= kChunkBytes; bytes += kChunkBytes, length -= kChunkBytes) {
+        s1 = _mm256_add_epi64(s1, mixWordsAVX2(_mm256_loadu_si256((const __m256i *)bytes)));
+        s2 = _mm256_add_epi64(s2, s1);
+    }
+    
+    _mm256_storeu_si256((__m256i *)(state + 0), s1);
+    _mm256_storeu_si256((__m256i *)(state + 4), s2);
+    
+    spanTail(state, bytes, length);
+}
+#endif
+
+#pragma mark - NEON
+
+#if TILEHASH_NEON
+static inline uint64x2_t mixWordsNEON(uint64x2_t words)
+{
+    const uint32x2_t multiplierLow = vdup_n_u32((uint32_t)(kWordMultiplier & 0xffffffffULL));
+    const uint32x2_t multiplierHigh = vdup_n_u32((uint32_t)(kWordMultiplier >> 32));
+    uint32x2_t low = vmovn_u64(words);
+    uint32x2_t high = vshrn_n_u64(words, 32);
+    uint64x2_t cross = vaddq_u64(vmull_u32(low, multiplierHigh), vmull_u32(high, multiplierLow));
+    uint64x2_t product = vaddq_u64(vmull_u32(low, multiplierLow), vshlq_n_u64(cross, 32));
+    return vorrq_u64(vshlq_n_u64(product, kWordRotation), vshrq_n_u64(product, 64 - kWordRotation));
+}
+
+static void spanNEON(uint64_t *state, const uint8_t *bytes, size_t length)
+{
+    uint64x2_t s1a = vld1q_u64(state + 0);
+    uint64x2_t s1b = vld1q_u64(state + 2);
+    uint64x2_t s2a = vld1q_u64(state + 4);
+    uint64x2_t s2b = vld1q_u64(state + 6);
+    
+    for (; length >= kChunkBytes; bytes += kChunkBytes, length -= kChunkBytes) {
+        s1a = vaddq_u64(s1a, mixWordsNEON(vreinterpretq_u64_u8(vld1q_u8(bytes + 0))));
+        s1b = vaddq_u64(s1b, mixWordsNEON(vreinterpretq_u64_u8(vld1q_u8(bytes + 16))));
+        s2a = vaddq_u64(s2a, s1a);
+        s2b = vaddq_u64(s2b, s1b);
+    }
+    
+    vst1q_u64(state + 0, s1a);
+    vst1q_u64(state + 2, s1b);
+    vst1q_u64(state + 4, s2a);
+    vst1q_u64(state + 6, s2b);
+    
+    spanTail(state, bytes, length);
+}
+#endif
+
+#pragma mark - Dispatch
+
+bool SWTileHashImplementationAvailable(SWTileHashImplementation implementation)
+{
+    switch (implementation) {
+        case SWTileHashImplementationAutomatic:
+        case SWTileHashImplementationScalar:
+            return true;
+        case SWTileHashImplementationSSE2:
+            return TILEHASH_SSE2;
+        case SWTileHashImplementationAVX2:
+#if TILEHASH_AVX2
+            return __builtin_cpu_supports("avx2");
+#else
+            return false;
+#endif
+        case SWTileHashImplementationNEON:
+            return TILEHASH_NEON;
+    }
+    return false;
+}
+
+static tilehash_span_f spanForImplementation(SWTileHashImplementation implementation)
+{
+    if (implementation == SWTileHashImplementationAutomatic) {
+        if (SWTileHashImplementationAvailable(SWTileHashImplementationAVX2)) {
+            implementation = SWTileHashImplementationAVX2;
+        } else if (SWTileHashImplementationAvailable(SWTileHashImplementationSSE2)) {
+            implementation = SWTileHashImplementationSSE2;
+        } else if (SWTileHashImplementationAvailable(SWTileHashImplementationNEON)) {
+            implementation = SWTileHashImplementationNEON;
+        }
+    }
+    
+    if (!SWTileHashImplementationAvailable(implementation)) {
+        return spanScalar;
+    }
+    
+    switch (implementation) {
+#if TILEHASH_SSE2
+        case SWTileHashImplementationSSE2:
+            return spanSSE2;
+#endif
+#if TILEHASH_AVX2
+        case SWTileHashImplementationAVX2:
+            return spanAVX2;
+#endif
+#if TILEHASH_NEON
+        case SWTileHashImplementationNEON:
+            return spanNEON;
+#endif
+        default:
+            return spanScalar;
+    }
+}
+
+#pragma mark - Tiling
+
+static inline uint64_t mix64(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+static inline uint64_t finalizeTile(const uint64_t *state)
+{
+    uint64_t result = 0x9e3779b97f4a7c15ULL;
+    for (size_t i = 0; i < kStateWords; ++i) {
+        result = mix64(result ^ state[i]);
+    }
+    return result;
+}
+
+// Walks the pixel rows of one row of tiles in memory order, accumulating into per-column state.
+static void hashBand(tilehash_span_f span, const uint8_t *pixels, size_t width, size_t height, size_t bytesPerRow, size_t tileSize, size_t band, size_t columns, uint64_t *state)
+{
+    size_t firstRow = band * tileSize;
+    size_t lastRow = firstRow + tileSize < height ? firstRow + tileSize : height;
+    
+    memset(state, 0, columns * kStateWords * sizeof(*state));
+    
+    for (size_t y = firstRow; y < lastRow; ++y) {
+        const uint8_t *row = pixels + y * bytesPerRow;
+        for (size_t column = 0; column < columns; ++column) {
+            size_t x = column * tileSize;
+            size_t tileWidth = x + tileSize < width ? tileSize : width - x;
+            span(state + column * kStateWords, row + x * 4, tileWidth * 4);
+        }
+    }
+}
+
+static inline size_t tileCount(size_t length, size_t tileSize)
+{
+    return (length + tileSize - 1) / tileSize;
+}
+
+void SWTileHashCompute(const void *pixels, size_t width, size_t height, size_t bytesPerRow, size_t tileSize, SWTileHashImplementation implementation, uint64_t *hashes)
+{
+    if (!pixels || !width || !height || !tileSize) {
+        return;
+    }
+    
+    tilehash_span_f span = spanForImplementation(implementation);
+    size_t columns = tileCount(width, tileSize);
+    size_t rows = tileCount(height, tileSize);
+    uint64_t *state = malloc(columns * kStateWords * sizeof(*state));
+    if (!state) {
+        return;
+    }
+    
+    for (size_t row = 0; row < rows; ++row) {
+        hashBand(span, pixels, width, height, bytesPerRow, tileSize, row, columns, state);
+        for (size_t column = 0; column < columns; ++column) {
+            hashes[row * columns + column] = finalizeTile(state + column * kStateWords);
+        }
+    }
+    
+    free(state);
+}
+
+#pragma mark - Stateful comparison
+
+bool SWTileHashInit(SWTileHash *tileHash, size_t tileSize)
+{
+    memset(tileHash, 0, sizeof(*tileHash));
+    tileHash->tileSize = tileSize ? tileSize : kSWTileHashDefaultTileSize;
+    tileHash->implementation = SWTileHashImplementationAutomatic;
+    return true;
+}
+
+void SWTileHashDestroy(SWTileHash *tileHash)
+{
+    free(tileHash->hashes);
+    free(tileHash->dirty);
+    free(tileHash->state);
+    memset(tileHash, 0, sizeof(*tileHash));
+}
+
+void SWTileHashInvalidate(SWTileHash *tileHash)
+{
+    tileHash->valid = false;
+}
+
+static bool resize(SWTileHash *tileHash, size_t width, size_t height)
+{
+    size_t columns = tileCount(width, tileHash->tileSize);
+    size_t rows = tileCount(height, tileHash->tileSize);
+    size_t tiles = columns * rows;
+    size_t dirtyWords = tiles / 64 + 1;
+    
+    uint64_t *hashes = realloc(tileHash->hashes, (tiles ? tiles : 1) * sizeof(*hashes));
+    if (hashes) { tileHash->hashes = hashes; }
+    uint64_t *dirty = realloc(tileHash->dirty, dirtyWords * sizeof(*dirty));
+    if (dirty) { tileHash->dirty = dirty; }
+    uint64_t *state = realloc(tileHash->state, (columns ? columns : 1) * kStateWords * sizeof(*state));
+    if (state) { tileHash->state = state; }
+    
+    if (!hashes || !dirty || !state) {
+        tileHash->width = tileHash->height = tileHash->columns = tileHash->rows = 0;
+        tileHash->valid = false;
+        return false;
+    }
+    
+    tileHash->width = width;
+    tileHash->height = height;
+    tileHash->columns = columns;
+    tileHash->rows = rows;
+    tileHash->valid = false;
+    return true;
+}
+
+bool SWTileHashUpdate(SWTileHash *tileHash, const void *pixels, size_t width, size_t height, size_t bytesPerRow)
+{
+    if (!tileHash->hashes || tileHash->width != width || tileHash->height != height) {
+        if (!resize(tileHash, width, height)) {
+            return true;
+        }
+    }
+    
+    size_t tiles = tileHash->columns * tileHash->rows;
+    memset(tileHash->dirty, 0, (tiles / 64 + 1) * sizeof(*tileHash->dirty));
+    if (!pixels || !tiles) {
+        tileHash->valid = false;
+        return true;
+    }
+    
+    tilehash_span_f span = spanForImplementation(tileHash->implementation);
+    bool changed = false;
+    for (size_t row = 0; row < tileHash->rows; ++row) {
+        hashBand(span, pixels, width, height, bytesPerRow, tileHash->tileSize, row, tileHash->columns, tileHash->state);
+        for (size_t column = 0; column < tileHash->columns; ++column) {
+            size_t index = row * tileHash->columns + column;
+            uint64_t hash = finalizeTile(tileHash->state + column * kStateWords);
+            if (!tileHash->valid || tileHash->hashes[index] != hash) {
+                tileHash->hashes[index] = hash;
+                tileHash->dirty[index / 64] |= 1ULL << (index % 64);
+                changed = true;
+            }
+        }
+    }
+    
+    tileHash->valid = true;
+    return changed;
+}
+
+size_t SWTileHashDirtyCount(const SWTileHash *tileHash)
+{
+    size_t result = 0;
+    size_t tiles = tileHash->columns * tileHash->rows;
+    if (!tileHash->dirty) {
+        return 0;
+    }
+    for (size_t i = 0; i < tiles / 64 + 1; ++i) {
+        result += (size_t)__builtin_popcountll(tileHash->dirty[i]);
+    }
+    return result;
+}
+
+size_t SWTileHashCopyDirtyRects(const SWTileHash *tileHash, SWTileRect *rects)
+{
+    size_t columns = tileHash->columns;
+    size_t tileSize = tileHash->tileSize;
+    if (!tileHash->dirty || !columns) {
+        return 0;
+    }
+    
+    // Indices of the rects that ended on the previous row of tiles, ordered by x.
+    size_t *open = malloc(columns * sizeof(*open));
+    size_t *nextOpen = malloc(columns * sizeof(*nextOpen));
+    if (!open || !nextOpen) {
+        free(open);
+        free(nextOpen);
+        return 0;
+    }
+    
+    size_t count = 0;
+    size_t openCount = 0;
+    for (size_t row = 0; row < tileHash->rows; ++row) {
+        size_t nextOpenCount = 0;
+        size_t openIndex = 0;
+        
+        for (size_t column = 0; column < columns; ++column) {
+            if (!SWTileHashTileIsDirty(tileHash, column, row)) {
+                continue;
+            }
+            
+            size_t first = column;
+            while (column + 1 < columns && SWTileHashTileIsDirty(tileHash, column + 1, row)) {
+                ++column;
+            }
+            
+            size_t x = first * tileSize;
+            size_t width = ((column + 1) * tileSize < tileHash->width ? (column + 1) * tileSize : tileHash->width) - x;
+            size_t y = row * tileSize;
+            size_t height = (y + tileSize < tileHash->height ? y + tileSize : tileHash->height) - y;
+            
+            while (openIndex < openCount && rects[open[openIndex]].x < x) {
+                ++openIndex;
+            }
+            
+            if (openIndex < openCount && rects[open[openIndex]].x == x && rects[open[openIndex]].width == width) {
+                rects[open[openIndex]].height += height;
+                nextOpen[nextOpenCount++] = open[openIndex++];
+            } else {
+                rects[count] = (SWTileRect){ .x = x, .y = y, .width = width, .height = height };
+                nextOpen[nextOpenCount++] = count++;
+            }
+        }
+        
+        size_t *swap = open;
+        open = nextOpen;
+        nextOpen = swap;
+        openCount = nextOpenCount;
+    }
+    
+    free(open);
+    free(nextOpen);
+    return count;
+}
@@ -0,0 +1,98 @@
+//
+//  tileHash.h
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef _TILEHASH_H_
+#define _TILEHASH_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Change detection for window captures.
+ *
+ * A 32bpp pixel buffer is divided into square tiles and each tile is reduced to a 64-bit hash. Comparing hashes against the previous poll answers both "did anything change?" and "what changed?" without encoding or retaining the previous image.
+ *
+ * This file has no Cocoa dependencies so it can be built and benchmarked on any platform.
+ */
+
+typedef enum {
+    SWTileHashImplementationAutomatic = 0,
+    SWTileHashImplementationScalar,
+    SWTileHashImplementationSSE2,
+    SWTileHashImplementationAVX2,
+    SWTileHashImplementationNEON,
+} SWTileHashImplementation;
+
+// Pixel coordinates, with the origin at the first byte of the buffer.
+typedef struct {
+    size_t x;
+    size_t y;
+    size_t width;
+    size_t height;
+} SWTileRect;
+
+typedef struct {
+    size_t width;
+    size_t height;
+    size_t tileSize;
+    size_t columns;
+    size_t rows;
+    // columns * rows tile hashes, row-major.
+    uint64_t *hashes;
+    // One bit per tile, row-major. Valid after SWTileHashUpdate.
+    uint64_t *dirty;
+    // Scratch space for hashing one band of tiles at a time.
+    uint64_t *state;
+    _Bool valid;
+    SWTileHashImplementation implementation;
+} SWTileHash;
+
+// Default tile edge length, in pixels.
+extern const size_t kSWTileHashDefaultTileSize;
+
+bool SWTileHashImplementationAvailable(SWTileHashImplementation implementation);
+
+bool SWTileHashInit(SWTileHash *tileHash, size_t tileSize);
+void SWTileHashDestroy(SWTileHash *tileHash);
+
+// Hashes the pixel buffer and compares it to the previous update, returning true if any tile changed. The first update and any update that changes the buffer's dimensions mark every tile dirty.
+bool SWTileHashUpdate(SWTileHash *tileHash, const void *pixels, size_t width, size_t height, size_t bytesPerRow);
+
+// Forgets the previous update so that the next one reports every tile as dirty.
+void SWTileHashInvalidate(SWTileHash *tileHash);
+
+size_t SWTileHashDirtyCount(const SWTileHash *tileHash);
+
+static inline bool SWTileHashTileIsDirty(const SWTileHash *tileHash, size_t column, size_t row)
+{
+    size_t index = row * tileHash->columns + column;
+    return (tileHash->dirty[index / 64] >> (index % 64)) & 1;
+}
+
+// Coalesces the dirty tiles from the last update into rectangles (runs of tiles in a row, merged with identical runs in the rows below), clipped to the buffer. rects must have room for one rect per tile; returns the number of rects written.
+size_t SWTileHashCopyDirtyRects(const SWTileHash *tileHash, SWTileRect *rects);
+
+// Stateless: writes the hash of every tile in the buffer to hashes, which must have room for ceil(width / tileSize) * ceil(height / tileSize) elements.
+void SWTileHashCompute(const void *pixels, size_t width, size_t height, size_t bytesPerRow, size_t tileSize, SWTileHashImplementation implementation, uint64_t *hashes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _TILEHASH_H_
@@ -0,0 +1,289 @@
+//
+//  trace.c
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "trace.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+#define kBufferMask (SWTraceBufferCapacity - 1)
+
+_Static_assert((SWTraceBufferCapacity & kBufferMask) == 0, "SWTraceBufferCapacity must be a power of two");
+
+// Fields are atomic so that a reader copying a slot while its thread overwrites it is well-defined; the copy is discarded afterwards. Relaxed atomic stores cost the same as plain stores.
+typedef struct {
+    _Atomic(const char *) name;
+    _Atomic uint64_t start;
+    _Atomic uint64_t duration;
+} slot;
+
+typedef struct buffer {
+    // The number of spans ever recorded. Only the owning thread writes it.
+    _Atomic uint64_t head;
+    // The number of spans the thread has started writing: head, or head + 1 while a span is being written. Readers check it to tell which slots they may have seen half-overwritten.
+    _Atomic uint64_t writing;
+    uint32_t thread;
+    struct buffer *next;
+    slot slots[SWTraceBufferCapacity];
+} buffer;
+
+// Buffers are never freed: a thread's spans are still worth reading after it exits, and threads are pooled anyway.
+static _Atomic(buffer *) buffers;
+static _Atomic uint32_t threadCount;
+static _Thread_local buffer *threadBuffer;
+
+static buffer *registerThread(void)
+{
+    buffer *b = calloc(1, sizeof(*b));
+    if (!b) {
+        return NULL;
+    }
+    b->thread = atomic_fetch_add_explicit(&threadCount, 1, memory_order_relaxed) + 1;
+    
+    buffer *head = atomic_load_explicit(&buffers, memory_order_relaxed);
+    do {
+        b->next = head;
+    } while (!atomic_compare_exchange_weak_explicit(&buffers, &head, b, memory_order_release, memory_order_relaxed));
+    
+    return threadBuffer = b;
+}
+
+#pragma mark - Recording
+
+uint64_t SWTraceNanoseconds(uint64_t ticks)
+{
+#ifdef __APPLE__
+    static mach_timebase_info_data_t timebase;
+    if (!timebase.denom) {
+        mach_timebase_info(&timebase);
+    }
+    return timebase.numer == timebase.denom ? ticks : (uint64_t)((__uint128_t)ticks * timebase.numer / timebase.denom);
+#else
+    return ticks;
+#endif
+}
+
+void SWTraceRecord(const char *name, uint64_t start, uint64_t end)
+{
+    buffer *b = threadBuffer;
+    if (!b && !(b = registerThread())) {
+        return;
+    }
+    
+    uint64_t head = atomic_load_explicit(&b->head, memory_order_relaxed);
+    // Claim the slot before overwriting it. The fence keeps the claim ordered before the slot stores, so a reader that sees any of them also sees the claim.
+    atomic_store_explicit(&b->writing, head + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot *s = &b->slots[head & kBufferMask];
+    atomic_store_explicit(&s->name, name, memory_order_relaxed);
+    atomic_store_explicit(&s->start, start, memory_order_relaxed);
+    atomic_store_explicit(&s->duration, end > start ? end - start : 0, memory_order_relaxed);
+    atomic_store_explicit(&b->head, head + 1, memory_order_release);
+}
+
+size_t SWTraceCopyEvents(SWTraceEvent *events, size_t capacity, uint64_t since)
+{
+    // Which span each copied event came from, to tell whether it was overwritten while being copied.
+    uint64_t *indexes = malloc(capacity * sizeof(*indexes));
+    if (!indexes) {
+        return 0;
+    }
+    size_t count = 0;
+    
+    for (buffer *b = atomic_load_explicit(&buffers, memory_order_acquire); b && count < capacity; b = b->next) {
+        uint64_t head = atomic_load_explicit(&b->head, memory_order_acquire);
+        // The oldest slot is left out: it's the one the thread writes next.
+        uint64_t first = head >= SWTraceBufferCapacity ? head - SWTraceBufferCapacity + 1 : 0;
+        size_t threadStart = count;
+        
+        // Newest first, so that the most recent spans are the ones that fit.
+        for (uint64_t i = head; i-- > first && count < capacity;) {
+            slot *s = &b->slots[i & kBufferMask];
+            SWTraceEvent event = {
+                .name = atomic_load_explicit(&s->name, memory_order_relaxed),
+                .start = atomic_load_explicit(&s->start, memory_order_relaxed),
+                .duration = atomic_load_explicit(&s->duration, memory_order_relaxed),
+                .thread = b->thread,
+            };
+            if (event.start >= since) {
+                indexes[count] = i;
+                events[count++] = event;
+            }
+        }
+        
+        // The thread may have lapped the copy. Any span whose slot it has started writing since is discarded; they are the oldest, so they were copied last.
+        // Span i's slot is reused by span i + SWTraceBufferCapacity, which is claimed by moving writing past it.
+        atomic_thread_fence(memory_order_acquire);
+        uint64_t writing = atomic_load_explicit(&b->writing, memory_order_relaxed);
+        while (count > threadStart && indexes[count - 1] + SWTraceBufferCapacity < writing) {
+            count--;
+        }
+        
+        // Back into the order the spans ended.
+        for (size_t i = threadStart, j = count; i + 1 < j; ++i, --j) {
+            SWTraceEvent event = events[i];
+            events[i] = events[j - 1];
+            events[j - 1] = event;
+        }
+    }
+    
+    free(indexes);
+    return count;
+}
+
+#pragma mark - Intervals
+
+void SWTraceIntervalBegin(SWTraceInterval *interval, uint64_t start)
+{
+    atomic_store_explicit(&interval->start, start, memory_order_relaxed);
+}
+
+void SWTraceIntervalEnd(SWTraceInterval *interval, const char *name)
+{
+    uint64_t start = atomic_exchange_explicit(&interval->start, 0, memory_order_relaxed);
+    if (start) {
+        SWTraceRecord(name, start, SWTraceNow());
+    }
+}
+
+#pragma mark - Histograms
+
+static inline size_t bucketForValue(uint64_t value)
+{
+    if (value < 64) {
+        return (size_t)value;
+    }
+    unsigned exponent = 63 - (unsigned)__builtin_clzll(value);
+    unsigned shift = exponent - 5;
+    return 64 + (exponent - 6) * 32 + (size_t)((value >> shift) - 32);
+}
+
+// The largest value that lands in a bucket.
+static inline uint64_t valueForBucket(size_t bucket)
+{
+    if (bucket < 64) {
+        return bucket;
+    }
+    unsigned exponent = (unsigned)((bucket - 64) / 32) + 6;
+    unsigned shift = exponent - 5;
+    uint64_t mantissa = 32 + (bucket - 64) % 32;
+    return (mantissa << shift) + ((1ull << shift) - 1);
+}
+
+void SWTraceHistogramInit(SWTraceHistogram *histogram)
+{
+    memset(histogram, 0, sizeof(*histogram));
+    histogram->min = UINT64_MAX;
+}
+
+void SWTraceHistogramRecord(SWTraceHistogram *histogram, uint64_t value)
+{
+    histogram->counts[bucketForValue(value)]++;
+    histogram->count++;
+    histogram->min = value < histogram->min ? value : histogram->min;
+    histogram->max = value > histogram->max ? value : histogram->max;
+}
+
+uint64_t SWTraceHistogramPercentile(const SWTraceHistogram *histogram, double percentile)
+{
+    if (!histogram->count) {
+        return 0;
+    }
+    
+    double rank = percentile / 100.0 * (double)histogram->count;
+    uint64_t target = rank < 1.0 ? 1 : (uint64_t)rank + (rank > (double)(uint64_t)rank);
+    target = target > histogram->count ? histogram->count : target;
+    
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < SWTraceHistogramBucketCount; ++bucket) {
+        seen += histogram->counts[bucket];
+        if (seen >= target) {
+            uint64_t value = valueForBucket(bucket);
+            value = value > histogram->max ? histogram->max : value;
+            return value < histogram->min ? histogram->min : value;
+        }
+    }
+    return histogram->max;
+}
+
+size_t SWTraceSummarize(const SWTraceEvent *events, size_t count, SWTraceSummary *summaries, size_t capacity)
+{
+    size_t summaryCount = 0;
+    
+    for (size_t i = 0; i < count; ++i) {
+        size_t j = 0;
+        // There are only ever a few names, so a linear search beats hashing. Names from different files may be different copies of the same literal.
+        while (j < summaryCount && summaries[j].name != events[i].name && strcmp(summaries[j].name, events[i].name) != 0) {
+            j++;
+        }
+        if (j == summaryCount) {
+            if (summaryCount == capacity) {
+                continue;
+            }
+            summaries[j].name = events[i].name;
+            SWTraceHistogramInit(&summaries[j].durations);
+            summaryCount++;
+        }
+        SWTraceHistogramRecord(&summaries[j].durations, SWTraceNanoseconds(events[i].duration));
+    }
+    
+    return summaryCount;
+}
+
+#pragma mark - Export
+
+static bool writeJSONString(const char *string, FILE *file)
+{
+    if (fputc('"', file) == EOF) {
+        return false;
+    }
+    for (const unsigned char *c = (const unsigned char *)string; *c; ++c) {
+        int result;
+        if (*c == '"' || *c == '\\') {
+            result = fprintf(file, "\\%c", *c);
+        } else if (*c < 0x20) {
+            result = fprintf(file, "\\u%04x", *c);
+        } else {
+            result = fputc(*c, file);
+        }
+        if (result < 0) {
+            return false;
+        }
+    }
+    return fputc('"', file) != EOF;
+}
+
+bool SWTraceWriteChromeJSON(const SWTraceEvent *events, size_t count, FILE *file)
+{
+    uint64_t origin = UINT64_MAX;
+    for (size_t i = 0; i < count; ++i) {
+        origin = events[i].start < origin ? events[i].start : origin;
+    }
+    
+    if (fputs("[", file) == EOF) {
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        // Timestamps and durations are in microseconds.
+        if (fputs(i ? ",\n{\"name\":" : "\n{\"name\":", file) == EOF || !writeJSONString(events[i].name, file)) {
+            return false;
+        }
+        if (fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", events[i].thread, SWTraceNanoseconds(events[i].start - origin) / 1000.0, SWTraceNanoseconds(events[i].duration) / 1000.0) < 0) {
+            return false;
+        }
+    }
+    return fputs("\n]\n", file) != EOF && !ferror(file);
+}
@@ -0,0 +1,140 @@
+//
+//  trace.h
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+// clock_gettime and CLOCK_MONOTONIC are POSIX, and hidden by strict modes like -std=c11 unless asked for. This has to come before the first system header in the translation unit.
+#if !defined(__APPLE__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __APPLE__
+#include <mach/mach_time.h>
+#else
+#include <time.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Span tracing for latency-sensitive paths.
+ *
+ * Each thread records spans into its own fixed-size ring buffer, so recording never takes a lock, allocates (after a thread's first span), or waits for a reader; when a buffer is full the oldest spans are overwritten. Readers copy spans out of every thread's buffer at any time, skipping any that were overwritten while being copied.
+ *
+ * Copied spans can be summarized into log-linear histograms, which keep every value to within 1/32 of itself (like HdrHistogram with two significant digits), or written as Chrome trace-event JSON for chrome://tracing and Perfetto.
+ *
+ * This file has no Cocoa dependencies so it can be built and benchmarked on any platform.
+ */
+
+// The size of each thread's ring buffer. Readers see up to one fewer than this many of a thread's spans.
+#define SWTraceBufferCapacity 4096
+
+typedef struct {
+    // Span names must outlive the trace, so they are expected to be string literals.
+    const char *name;
+    // In SWTraceNow ticks.
+    uint64_t start;
+    uint64_t duration;
+    // A small number assigned to each thread in the order they first record a span.
+    uint32_t thread;
+} SWTraceEvent;
+
+static inline uint64_t SWTraceNow(void) {
+#ifdef __APPLE__
+    return mach_absolute_time();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+#endif
+}
+
+uint64_t SWTraceNanoseconds(uint64_t ticks);
+
+void SWTraceRecord(const char *name, uint64_t start, uint64_t end);
+
+// Copies up to capacity of the most recent spans that started at or after since, from every thread, and returns how many were copied. Spans from each thread are in the order they ended.
+size_t SWTraceCopyEvents(SWTraceEvent *events, size_t capacity, uint64_t since);
+
+#pragma mark Scopes
+
+typedef struct {
+    const char *name;
+    uint64_t start;
+} _SWTraceScope;
+
+static inline void _SWTraceScopeEnd(_SWTraceScope *scope) {
+    SWTraceRecord(scope->name, scope->start, SWTraceNow());
+}
+
+#define _SWTraceConcat(a, b) a ## b
+#define _SWTraceScopeVariable(line) _SWTraceConcat(_swTraceScope, line)
+
+// Records a span from here to the end of the enclosing scope, however it is left.
+#define SWTraceScope(name) __attribute__((cleanup(_SWTraceScopeEnd), unused)) _SWTraceScope _SWTraceScopeVariable(__LINE__) = { (name), SWTraceNow() }
+
+#pragma mark Intervals
+
+// A span that begins and ends in different places, possibly on different threads. Beginning again before it ends moves its start; ending it when it hasn't begun does nothing.
+typedef struct {
+    _Atomic uint64_t start;
+} SWTraceInterval;
+
+void SWTraceIntervalBegin(SWTraceInterval *interval, uint64_t start);
+void SWTraceIntervalEnd(SWTraceInterval *interval, const char *name);
+
+#pragma mark Histograms
+
+// Values below 64 get a bucket each; each power of two above that is split into 32 buckets.
+#define SWTraceHistogramBucketCount (64 + 58 * 32)
+
+typedef struct {
+    uint64_t counts[SWTraceHistogramBucketCount];
+    uint64_t count;
+    uint64_t min;
+    uint64_t max;
+} SWTraceHistogram;
+
+void SWTraceHistogramInit(SWTraceHistogram *histogram);
+void SWTraceHistogramRecord(SWTraceHistogram *histogram, uint64_t value);
+// Returns the value at or below which percentile percent of values fall (to within 1/32), or 0 if the histogram is empty.
+uint64_t SWTraceHistogramPercentile(const SWTraceHistogram *histogram, double percentile);
+
+typedef struct {
+    const char *name;
+    // Durations in nanoseconds.
+    SWTraceHistogram durations;
+} SWTraceSummary;
+
+// Gathers the durations of events into a histogram per span name, in the order each name first appears, and returns the number of names. Names beyond capacity are not summarized.
+size_t SWTraceSummarize(const SWTraceEvent *events, size_t count, SWTraceSummary *summaries, size_t capacity);
+
+#pragma mark Export
+
+// Writes events as a Chrome trace-event JSON array of complete ("X") events, with timestamps relative to the earliest event. Returns false if writing failed.
+bool SWTraceWriteChromeJSON(const SWTraceEvent *events, size_t count, FILE *file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _TRACE_H_
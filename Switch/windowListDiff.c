@@ -0,0 +1,156 @@
+//
+//  windowListDiff.c
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "windowListDiff.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+const uint64_t kSWWindowListFingerprintSeed = 0xcbf29ce484222325ULL;
+
+uint64_t SWWindowListFingerprint(uint64_t fingerprint, const void *bytes, size_t length)
+{
+    // FNV-1a. Window descriptions are short, and fingerprints are mixed once more when compared, so this is plenty.
+    const uint8_t *byte = bytes;
+    for (size_t i = 0; i < length; ++i) {
+        fingerprint ^= byte[i];
+        fingerprint *= 0x100000001b3ULL;
+    }
+    return fingerprint;
+}
+
+size_t SWWindowListDiffCapacity(size_t oldCount, size_t newCount)
+{
+    // Every old window can be removed, every new window inserted, or each window common to both updated and moved.
+    return oldCount + newCount * 2;
+}
+
+static inline size_t slotForWindowID(uint32_t windowID, size_t mask)
+{
+    return (size_t)((windowID * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+
+size_t SWWindowListDiff(const SWWindowListEntry *oldList, size_t oldCount, const SWWindowListEntry *newList, size_t newCount, SWWindowListChange *changes)
+{
+    size_t changeCount = 0;
+    
+    size_t tableSize = 16;
+    while (tableSize < oldCount * 2) {
+        tableSize *= 2;
+    }
+    size_t mask = tableSize - 1;
+    
+    // One allocation for all of the scratch space:
+    //   table:     old index + 1 for each slot, 0 if empty
+    //   oldForNew: old index of each new window, SIZE_MAX if inserted
+    //   tails, predecessors: longest increasing subsequence of old indexes, in new order
+    size_t *scratch = calloc(tableSize + newCount * 3, sizeof(size_t));
+    // Which old windows have been matched, and later which new windows stayed put.
+    bool *flags = calloc((oldCount > newCount ? oldCount : newCount) + 1, sizeof(bool));
+    if (!scratch || !flags) {
+        free(scratch);
+        free(flags);
+        for (size_t i = 0; i < oldCount; ++i) {
+            changes[changeCount++] = (SWWindowListChange){ SWWindowListChangeRemove, oldList[i].windowID, i, SIZE_MAX };
+        }
+        for (size_t i = 0; i < newCount; ++i) {
+            changes[changeCount++] = (SWWindowListChange){ SWWindowListChangeInsert, newList[i].windowID, SIZE_MAX, i };
+        }
+        return changeCount;
+    }
+    size_t *table = scratch;
+    size_t *oldForNew = table + tableSize;
+    size_t *tails = oldForNew + newCount;
+    size_t *predecessors = tails + newCount;
+    
+    for (size_t i = 0; i < oldCount; ++i) {
+        size_t slot = slotForWindowID(oldList[i].windowID, mask);
+        while (table[slot] && oldList[table[slot] - 1].windowID != oldList[i].windowID) {
+            slot = (slot + 1) & mask;
+        }
+        table[slot] = i + 1;
+    }
+    
+    for (size_t i = 0; i < newCount; ++i) {
+        oldForNew[i] = SIZE_MAX;
+        size_t slot = slotForWindowID(newList[i].windowID, mask);
+        while (table[slot]) {
+            size_t oldIndex = table[slot] - 1;
+            if (oldList[oldIndex].windowID == newList[i].windowID) {
+                if (!flags[oldIndex]) {
+                    flags[oldIndex] = true;
+                    oldForNew[i] = oldIndex;
+                }
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+    }
+    
+    for (size_t i = 0; i < oldCount; ++i) {
+        if (!flags[i]) {
+            changes[changeCount++] = (SWWindowListChange){ SWWindowListChangeRemove, oldList[i].windowID, i, SIZE_MAX };
+        }
+    }
+    
+    // Windows on the longest run whose old order is preserved stay put, everything else common to both lists moved.
+    // tails[k] is the new index ending the smallest-valued increasing run of length k + 1 found so far.
+    size_t runLength = 0;
+    for (size_t i = 0; i < newCount; ++i) {
+        if (oldForNew[i] == SIZE_MAX) {
+            continue;
+        }
+        size_t low = 0, high = runLength;
+        while (low < high) {
+            size_t middle = (low + high) / 2;
+            if (oldForNew[tails[middle]] < oldForNew[i]) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        predecessors[i] = low ? tails[low - 1] : SIZE_MAX;
+        tails[low] = i;
+        if (low == runLength) {
+            runLength++;
+        }
+    }
+    
+    memset(flags, 0, newCount * sizeof(bool));
+    if (runLength) {
+        for (size_t i = tails[runLength - 1]; i != SIZE_MAX; i = predecessors[i]) {
+            flags[i] = true;
+        }
+    }
+    
+    for (size_t i = 0; i < newCount; ++i) {
+        size_t oldIndex = oldForNew[i];
+        if (oldIndex == SIZE_MAX) {
+            changes[changeCount++] = (SWWindowListChange){ SWWindowListChangeInsert, newList[i].windowID, SIZE_MAX, i };
+            continue;
+        }
+        if (oldList[oldIndex].fingerprint != newList[i].fingerprint) {
+            changes[changeCount++] = (SWWindowListChange){ SWWindowListChangeUpdate, newList[i].windowID, oldIndex, i };
+        }
+        if (!flags[i]) {
+            changes[changeCount++] = (SWWindowListChange){ SWWindowListChangeMove, newList[i].windowID, oldIndex, i };
+        }
+    }
+    
+    free(flags);
+    free(scratch);
+    return changeCount;
+}
@@ -0,0 +1,67 @@
+//
+//  windowListDiff.h
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef _WINDOWLISTDIFF_H_
+#define _WINDOWLISTDIFF_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Keyed diffing of successive window lists.
+ *
+ * Each window in a list is reduced to its window number and a 64-bit fingerprint of the parts of its description that matter. Diffing two lists then costs one hash table build and lookup per window instead of a deep comparison of every description, and says exactly which windows changed instead of only whether anything did.
+ *
+ * This file has no Cocoa dependencies so it can be built and benchmarked on any platform.
+ */
+
+typedef struct {
+    uint32_t windowID;
+    uint64_t fingerprint;
+} SWWindowListEntry;
+
+typedef enum {
+    SWWindowListChangeInsert,
+    SWWindowListChangeRemove,
+    // The window's position relative to the other windows common to both lists changed. Windows that only shifted because others were inserted or removed before them are not moved.
+    SWWindowListChangeMove,
+    SWWindowListChangeUpdate,
+} SWWindowListChangeKind;
+
+typedef struct {
+    SWWindowListChangeKind kind;
+    uint32_t windowID;
+    size_t oldIndex; // SIZE_MAX for inserts.
+    size_t newIndex; // SIZE_MAX for removes.
+} SWWindowListChange;
+
+// Fingerprints are built by feeding each relevant field through this function, starting from kSWWindowListFingerprintSeed.
+extern const uint64_t kSWWindowListFingerprintSeed;
+uint64_t SWWindowListFingerprint(uint64_t fingerprint, const void *bytes, size_t length);
+
+// The most changes SWWindowListDiff can produce for lists of these sizes.
+size_t SWWindowListDiffCapacity(size_t oldCount, size_t newCount);
+
+// Writes the changes that turn oldList into newList: removes in old order, followed by inserts, updates and moves in new order. A window can be both updated and moved. Returns the number of changes written.
+size_t SWWindowListDiff(const SWWindowListEntry *oldList, size_t oldCount, const SWWindowListEntry *newList, size_t newCount, SWWindowListChange *changes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _WINDOWLISTDIFF_H_
@@ -0,0 +1,568 @@
+//
+//  windowTable.c
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "windowTable.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+static const struct {
+    const char *name;
+    SWWindowTableQuirks quirk;
+} quirkNames[] = {
+    { "hideWindowsNamedAfterOwner", SWWindowTableQuirkHideWindowsNamedAfterOwner },
+    { "hideTranslucentWindows", SWWindowTableQuirkHideTranslucentWindows },
+    { "decoratorWindows", SWWindowTableQuirkDecoratorWindows },
+    { "noChildWindows", SWWindowTableQuirkNoChildWindows },
+    { "savePanelService", SWWindowTableQuirkSavePanelService },
+    { "hideLoneUnnamedWindowsWhenInactive", SWWindowTableQuirkHideLoneUnnamedWindowsWhenInactive },
+};
+
+// Every table starts with these.
+static const struct {
+    const char *ownerName;
+    SWWindowTableQuirks quirks;
+} defaultQuirks[] = {
+    { "Microsoft Word", SWWindowTableQuirkHideWindowsNamedAfterOwner },
+    { "Isolator", SWWindowTableQuirkHideTranslucentWindows },
+    { "Tweetbot", SWWindowTableQuirkDecoratorWindows },
+    { "MacVim", SWWindowTableQuirkNoChildWindows },
+    { "Finder", SWWindowTableQuirkHideLoneUnnamedWindowsWhenInactive },
+    { "com.apple.security.pboxd", SWWindowTableQuirkSavePanelService },
+    { "com.apple.appkit.xpc.openAndSav", SWWindowTableQuirkSavePanelService },
+};
+
+#pragma mark - Storage
+
+static bool growColumns(SWWindowTable *table, size_t capacity)
+{
+    #define GROW(column) do { \
+            void *column = realloc(table->column, capacity * sizeof(*table->column)); \
+            if (!column) { return false; } \
+            table->column = column; \
+        } while (0)
+    GROW(windowIDs);
+    GROW(pids);
+    GROW(layers);
+    GROW(alphas);
+    GROW(bounds);
+    GROW(names);
+    GROW(ownerNames);
+    GROW(flags);
+    GROW(screens);
+    #undef GROW
+    
+    table->capacity = capacity;
+    return true;
+}
+
+static inline uint32_t hashString(const char *string, size_t length)
+{
+    // FNV-1a.
+    uint32_t hash = 0x811c9dc5;
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= (uint8_t)string[i];
+        hash *= 0x01000193;
+    }
+    return hash;
+}
+
+// Indexes every atom in the table into slots, which must be zeroed.
+static void indexAtoms(const SWWindowTable *table, SWWindowTableAtom *slots, size_t slotCount)
+{
+    size_t mask = slotCount - 1;
+    for (size_t atom = 1; atom < table->atomCount; ++atom) {
+        size_t slot = hashString(table->strings + table->atomOffsets[atom], table->atomLengths[atom]) & mask;
+        while (slots[slot]) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = (SWWindowTableAtom)(atom + 1);
+    }
+}
+
+static bool growAtomIndex(SWWindowTable *table)
+{
+    size_t slotCount = table->atomSlotCount ? table->atomSlotCount * 2 : 64;
+    SWWindowTableAtom *slots = calloc(slotCount, sizeof(*slots));
+    if (!slots) { return false; }
+    
+    indexAtoms(table, slots, slotCount);
+    
+    free(table->atomSlots);
+    table->atomSlots = slots;
+    table->atomSlotCount = slotCount;
+    return true;
+}
+
+bool SWWindowTableInit(SWWindowTable *table, size_t capacity)
+{
+    memset(table, 0, sizeof(*table));
+    
+    table->atomCapacity = 64;
+    table->atomOffsets = malloc(table->atomCapacity * sizeof(*table->atomOffsets));
+    table->atomLengths = malloc(table->atomCapacity * sizeof(*table->atomLengths));
+    table->atomQuirks = malloc(table->atomCapacity * sizeof(*table->atomQuirks));
+    table->stringsCapacity = 4096;
+    table->strings = malloc(table->stringsCapacity);
+    if (!table->atomOffsets || !table->atomLengths || !table->atomQuirks || !table->strings || !growAtomIndex(table) || !growColumns(table, capacity ? capacity : 16)) {
+        SWWindowTableDestroy(table);
+        return false;
+    }
+    
+    // Atom 0 is the empty string.
+    table->atomCount = table->pinnedAtomCount = 1;
+    table->atomOffsets[0] = 0;
+    table->atomLengths[0] = 0;
+    table->atomQuirks[0] = 0;
+    
+    for (size_t i = 0; i < sizeof(defaultQuirks) / sizeof(*defaultQuirks); ++i) {
+        if (!SWWindowTableSetQuirks(table, defaultQuirks[i].ownerName, strlen(defaultQuirks[i].ownerName), defaultQuirks[i].quirks)) {
+            SWWindowTableDestroy(table);
+            return false;
+        }
+    }
+    return true;
+}
+
+void SWWindowTableDestroy(SWWindowTable *table)
+{
+    free(table->windowIDs);
+    free(table->pids);
+    free(table->layers);
+    free(table->alphas);
+    free(table->bounds);
+    free(table->names);
+    free(table->ownerNames);
+    free(table->flags);
+    free(table->screens);
+    free(table->strings);
+    free(table->atomOffsets);
+    free(table->atomLengths);
+    free(table->atomQuirks);
+    free(table->atomSlots);
+    memset(table, 0, sizeof(*table));
+}
+
+void SWWindowTableRemoveAll(SWWindowTable *table)
+{
+    table->count = 0;
+    
+    if (table->atomCount > table->pinnedAtomCount) {
+        table->atomCount = table->pinnedAtomCount;
+        table->stringsLength = table->pinnedStringsLength;
+        memset(table->atomSlots, 0, table->atomSlotCount * sizeof(*table->atomSlots));
+        indexAtoms(table, table->atomSlots, table->atomSlotCount);
+    }
+}
+
+SWWindowTableAtom SWWindowTableIntern(SWWindowTable *table, const char *string, size_t length)
+{
+    if (!length) {
+        return SWWindowTableAtomNone;
+    }
+    
+    uint32_t hash = hashString(string, length);
+    size_t mask = table->atomSlotCount - 1;
+    size_t slot = hash & mask;
+    for (; table->atomSlots[slot]; slot = (slot + 1) & mask) {
+        SWWindowTableAtom atom = table->atomSlots[slot] - 1;
+        if (table->atomLengths[atom] == length && memcmp(table->strings + table->atomOffsets[atom], string, length) == 0) {
+            return atom;
+        }
+    }
+    
+    // Not interned yet. Make room for one more string, keeping the index at most half full.
+    if (table->atomCount == table->atomCapacity) {
+        size_t atomCapacity = table->atomCapacity * 2;
+        size_t *offsets = realloc(table->atomOffsets, atomCapacity * sizeof(*offsets));
+        if (offsets) { table->atomOffsets = offsets; }
+        size_t *lengths = realloc(table->atomLengths, atomCapacity * sizeof(*lengths));
+        if (lengths) { table->atomLengths = lengths; }
+        SWWindowTableQuirks *quirks = realloc(table->atomQuirks, atomCapacity * sizeof(*quirks));
+        if (quirks) { table->atomQuirks = quirks; }
+        if (!offsets || !lengths || !quirks) { return SWWindowTableAtomNone; }
+        table->atomCapacity = atomCapacity;
+    }
+    if (table->stringsLength + length > table->stringsCapacity) {
+        size_t stringsCapacity = table->stringsCapacity * 2;
+        while (stringsCapacity < table->stringsLength + length) {
+            stringsCapacity *= 2;
+        }
+        char *strings = realloc(table->strings, stringsCapacity);
+        if (!strings) { return SWWindowTableAtomNone; }
+        table->strings = strings;
+        table->stringsCapacity = stringsCapacity;
+    }
+    if ((table->atomCount + 1) * 2 > table->atomSlotCount) {
+        if (!growAtomIndex(table)) { return SWWindowTableAtomNone; }
+        mask = table->atomSlotCount - 1;
+        for (slot = hash & mask; table->atomSlots[slot]; slot = (slot + 1) & mask);
+    }
+    
+    SWWindowTableAtom atom = (SWWindowTableAtom)table->atomCount++;
+    table->atomOffsets[atom] = table->stringsLength;
+    table->atomLengths[atom] = length;
+    table->atomQuirks[atom] = 0;
+    memcpy(table->strings + table->stringsLength, string, length);
+    table->stringsLength += length;
+    table->atomSlots[slot] = atom + 1;
+    return atom;
+}
+
+SWWindowTableQuirks SWWindowTableQuirkNamed(const char *name, size_t length)
+{
+    for (size_t i = 0; i < sizeof(quirkNames) / sizeof(*quirkNames); ++i) {
+        if (strlen(quirkNames[i].name) == length && memcmp(quirkNames[i].name, name, length) == 0) {
+            return quirkNames[i].quirk;
+        }
+    }
+    return 0;
+}
+
+bool SWWindowTableSetQuirks(SWWindowTable *table, const char *ownerName, size_t length, SWWindowTableQuirks quirks)
+{
+    // Forget every unpinned name, so that the owner's atom is pinned along with those before it.
+    SWWindowTableRemoveAll(table);
+    
+    SWWindowTableAtom atom = SWWindowTableIntern(table, ownerName, length);
+    if (atom == SWWindowTableAtomNone) {
+        return false;
+    }
+    
+    table->atomQuirks[atom] = quirks;
+    table->pinnedAtomCount = table->atomCount;
+    table->pinnedStringsLength = table->stringsLength;
+    return true;
+}
+
+size_t SWWindowTableAppend(SWWindowTable *table, uint32_t windowID, int32_t pid, int64_t layer, double alpha, SWWindowTableRect bounds, SWWindowTableAtom name, SWWindowTableAtom ownerName)
+{
+    if (table->count == table->capacity && !growColumns(table, table->capacity * 2)) {
+        return SIZE_MAX;
+    }
+    
+    size_t row = table->count++;
+    table->windowIDs[row] = windowID;
+    table->pids[row] = pid;
+    table->layers[row] = layer;
+    table->alphas[row] = alpha;
+    table->bounds[row] = bounds;
+    table->names[row] = name;
+    table->ownerNames[row] = ownerName;
+    table->flags[row] = 0;
+    table->screens[row] = kSWWindowTableNoScreen;
+    return row;
+}
+
+#pragma mark - Filtering
+
+size_t SWWindowTableFilter(const SWWindowTable *table, size_t *rows)
+{
+    size_t count = 0;
+    for (size_t row = 0; row < table->count; ++row) {
+        double alpha = table->alphas[row];
+        SWWindowTableAtom owner = table->ownerNames[row];
+        
+        // Non-normal windows are filtered out as the accuracy of their ordering in the window list cannot be guaranteed.
+        bool normalWindow = table->layers[row] == kSWWindowTableNormalLayer;
+        bool transparentWindow = alpha == 0.0;
+        SWWindowTableQuirks quirks = table->atomQuirks[owner];
+        bool paletteWindow = (quirks & SWWindowTableQuirkHideWindowsNamedAfterOwner) && table->names[row] == owner;
+        bool overlayWindow = (quirks & SWWindowTableQuirkHideTranslucentWindows) && alpha < 0.9;
+        
+        rows[count] = row;
+        count += normalWindow && !transparentWindow && !paletteWindow && !overlayWindow;
+    }
+    return count;
+}
+
+void SWWindowTableCompact(SWWindowTable *table, const size_t *rows, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        size_t row = rows[i];
+        if (row == i) { continue; }
+        table->windowIDs[i] = table->windowIDs[row];
+        table->pids[i] = table->pids[row];
+        table->layers[i] = table->layers[row];
+        table->alphas[i] = table->alphas[row];
+        table->bounds[i] = table->bounds[row];
+        table->names[i] = table->names[row];
+        table->ownerNames[i] = table->ownerNames[row];
+        table->flags[i] = table->flags[row];
+        table->screens[i] = table->screens[row];
+    }
+    table->count = count;
+}
+
+#pragma mark - Grouping
+
+static inline bool rectsIntersect(SWWindowTableRect a, SWWindowTableRect b)
+{
+    // Rects that only share an edge intersect, like CGRectIntersection's non-null result.
+    return fmax(a.x, b.x) <= fmin(a.x + a.width, b.x + b.width) && fmax(a.y, b.y) <= fmin(a.y + a.height, b.y + b.height);
+}
+
+static inline bool rectContainsRect(SWWindowTableRect outer, SWWindowTableRect inner)
+{
+    return inner.x >= outer.x && inner.y >= outer.y && inner.x + inner.width <= outer.x + outer.width && inner.y + inner.height <= outer.y + outer.height;
+}
+
+static bool decoratorIsRelatedToLowerWindow(const SWWindowTable *table, size_t upper, size_t lower)
+{
+    // Tweetbot, which *does* name its main window, has spurious decorator windows, but does not name its popup windows ಠ_ಠ
+    SWWindowTableRect upperBounds = table->bounds[upper];
+    SWWindowTableRect lowerBounds = table->bounds[lower];
+    bool enclosed = rectContainsRect(lowerBounds, upperBounds);
+    
+    /**
+     * Catch the table view section header window. It:
+     * • has no name.
+     * • floats over a window that has a name (in practice, the main window).
+     * • is fully enclosed by the window it decorates.
+     * • has a height of < 33 points (in practice, 30).
+     */
+    if (!table->names[upper] && upperBounds.height < 33.0 && enclosed) {
+        return true;
+    }
+    
+    /**
+     * Catch any shadowing windows. They:
+     * • have no name
+     * • shadow a window that has a name (in practice, the main window).
+     * • are positioned (nearly) centered underneath the shadowed window, within (20, 20) points center to center.
+     * • extend beyond the edges of the shadowed window on all sides
+     * • do not exceed the height or width of the shadowed window by more than 100 points (in practice, (90, 85)).
+     *
+     * These rules should be sufficient to reduce the likelihood of false positives to an acceptable level.
+     */
+    if (!table->names[lower]) {
+        // Windows have center origins that are within (20, 20) points of each other.
+        double centerOffsetX = (upperBounds.x + upperBounds.width / 2.0) - (lowerBounds.x + lowerBounds.width / 2.0);
+        double centerOffsetY = (upperBounds.y + upperBounds.height / 2.0) - (lowerBounds.y + lowerBounds.height / 2.0);
+        bool centered = fabs(centerOffsetX) < 20.0 && fabs(centerOffsetY) < 20.0;
+        
+        // Window to the rear has dimensions larger than the window it shadows, not exceeding (100, 100) points.
+        bool saneSize = lowerBounds.width - upperBounds.width < 100.0 && lowerBounds.height - upperBounds.height < 100.0;
+        
+        if (centered && enclosed && saneSize) {
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+bool SWWindowTableIsRelatedToLowerWindow(const SWWindowTable *table, size_t upper, size_t lower)
+{
+    // Powerbox (for example) names its windows, but cannot be activated.
+    if (!(table->flags[upper] & SWWindowTableFlagCanBeActivated)) {
+        return true;
+    }
+    
+    // Windows belonging to different applications are unrelated.
+    if (table->pids[upper] != table->pids[lower]) {
+        return false;
+    }
+    
+    // Named windows are (usually) main windows themselves
+    if (table->names[upper] && table->names[lower]) {
+        return false;
+    }
+    
+    // Windows on different screens are not equal, and windows that aren't on any screen aren't equal to anything
+    if (table->screens[upper] != table->screens[lower] || table->screens[upper] == kSWWindowTableNoScreen) {
+        return false;
+    }
+    
+    SWWindowTableRect upperBounds = table->bounds[upper];
+    SWWindowTableRect lowerBounds = table->bounds[lower];
+    
+    // This is a special case for catching the shadow opening for sheets
+    if (upperBounds.height < 20.0 && (float)table->alphas[upper] < 1.0f) {
+        return true;
+    }
+    
+    SWWindowTableQuirks quirks = SWWindowTableQuirksOfRow(table, upper);
+    if (quirks & SWWindowTableQuirkDecoratorWindows) {
+        return decoratorIsRelatedToLowerWindow(table, upper, lower);
+    } else if (quirks & SWWindowTableQuirkNoChildWindows) {
+        // MacVim isn't known to have any extraneous unnamed windows… yet?
+        return false;
+    }
+    
+    // This is intended to fix some window grouping issues around full-screen applications (such as Xcode).
+    if (
+        // higher window and lower window have the same origin.x, and
+        upperBounds.x == lowerBounds.x &&
+        // higher window and lower window have the same size.width, and
+        upperBounds.width == lowerBounds.width &&
+        // higer window and lower window intersect
+        rectsIntersect(upperBounds, lowerBounds)
+    ) {
+        return true;
+    }
+    
+    return rectContainsRect(lowerBounds, upperBounds);
+}
+
+// The bounds of a run of rows, as edges.
+typedef struct {
+    double minX;
+    double minY;
+    double maxX;
+    double maxY;
+} groupBounds;
+
+static inline groupBounds groupBoundsUnion(groupBounds a, groupBounds b)
+{
+    return (groupBounds){
+        .minX = a.minX < b.minX ? a.minX : b.minX,
+        .minY = a.minY < b.minY ? a.minY : b.minY,
+        .maxX = a.maxX > b.maxX ? a.maxX : b.maxX,
+        .maxY = a.maxY > b.maxY ? a.maxY : b.maxY,
+    };
+}
+
+static inline bool groupBoundsContains(groupBounds outer, groupBounds inner)
+{
+    return inner.minX >= outer.minX && inner.minY >= outer.minY && inner.maxX <= outer.maxX && inner.maxY <= outer.maxY;
+}
+
+// Whether a window marks the group it's in as a save dialog that belongs with the group below.
+static inline bool isSaveDialogWindow(const SWWindowTable *table, size_t row, size_t groupCount)
+{
+    if (table->alphas[row] < 1.0 && table->bounds[row].height < 12.0 && groupCount > 1) {
+        return true;
+    }
+    
+    /** XXX: in case of recursive calls, should check to make sure the window that the save dialog refers to is not already included in the group. Example:
+     
+     (lldb) po [windowGroupList[7] windows]
+     {(
+     0x6080002268c0 <48051 ((null))>,
+     0x608000225be0 <48050 ()>,
+     0x608000226900 <48045 (Save)>,
+     0x608000226500 <48046 (Save)>,
+     0x608000226520 <48043 (Untitled.txt)>
+     )}
+     
+     (lldb) po [((NSOrderedSet *)[windowGroupList[7] windows])[2] application]
+     0x6080002268e0 <82769 (com.apple.appkit.xpc.openAndSavePanelService)>
+     (lldb) p (CGRect)[((NSOrderedSet *)[windowGroupList[7] windows])[2] frame]
+     (CGRect) $8 = (x=222, y=69), (width=489, height=319)
+
+     (lldb) po [((NSOrderedSet *)[windowGroupList[7] windows])[3] application]
+     0x608000226560 <82763 (TextEdit)>
+     (lldb) p (CGRect)[((NSOrderedSet *)[windowGroupList[7] windows])[3] frame]
+     (CGRect) $7 = (x=222, y=69), (width=490, height=319)
+     
+     (lldb) p (CGRect)[((NSOrderedSet *)[windowGroupList[7] windows])[4] frame]
+     (CGRect) $9 = (x=147, y=47), (width=640, height=412)
+     
+     */
+    return SWWindowTableQuirksOfRow(table, row) & SWWindowTableQuirkSavePanelService;
+}
+
+static groupBounds boundsOfGroup(const SWWindowTable *table, const SWWindowTableGroup *group)
+{
+    groupBounds result = { INFINITY, INFINITY, -INFINITY, -INFINITY };
+    for (size_t row = group->start; row < group->start + group->count; ++row) {
+        SWWindowTableRect rect = table->bounds[row];
+        result = groupBoundsUnion(result, (groupBounds){ rect.x, rect.y, rect.x + rect.width, rect.y + rect.height });
+    }
+    return result;
+}
+
+// Bounds are only needed for groups of the same application, so the lower group's are computed when first needed and kept while it grows.
+static bool groupIsRelatedToLowerGroup(const SWWindowTable *table, const SWWindowTableGroup *upper, groupBounds *upperBounds, const SWWindowTableGroup *lower, groupBounds *lowerBounds, bool *lowerBoundsValid)
+{
+    // Ensure that both windows belong to the same application, as a fast fail.
+    if (table->pids[upper->mainWindow] != table->pids[lower->mainWindow]) {
+        return false;
+    }
+    
+    // Ensure concentricity of groups, as a fast fail.
+    *upperBounds = boundsOfGroup(table, upper);
+    if (!*lowerBoundsValid) {
+        *lowerBounds = boundsOfGroup(table, lower);
+        *lowerBoundsValid = true;
+    }
+    if (!groupBoundsContains(*lowerBounds, *upperBounds)) {
+        return false;
+    }
+    
+    for (size_t row = upper->start; row < upper->start + upper->count; ++row) {
+        if (isSaveDialogWindow(table, row, upper->count)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Writes a group, or merges it into the group below. Returns the new number of groups.
+static size_t addGroup(const SWWindowTable *table, SWWindowTableGroup *groups, size_t groupCount, SWWindowTableGroup group, groupBounds *lowerBounds, bool *lowerBoundsValid)
+{
+    groupBounds bounds;
+    if (groupCount && groupIsRelatedToLowerGroup(table, &group, &bounds, &groups[groupCount - 1], lowerBounds, lowerBoundsValid)) {
+        // Save dialogs join the group below, which keeps its main window.
+        groups[groupCount - 1].start = group.start;
+        groups[groupCount - 1].count += group.count;
+        *lowerBounds = groupBoundsUnion(*lowerBounds, bounds);
+        return groupCount;
+    }
+    
+    groups[groupCount] = group;
+    *lowerBoundsValid = false;
+    return groupCount + 1;
+}
+
+size_t SWWindowTableGroupWindows(const SWWindowTable *table, SWWindowTableGroup *groups)
+{
+    size_t groupCount = 0;
+    if (!table->count) {
+        return 0;
+    }
+    
+    groupBounds lowerBounds;
+    bool lowerBoundsValid = false;
+    size_t groupEnd = table->count;
+    size_t mainWindow = SIZE_MAX;
+    
+    // Walk from the back, growing the current group forward until a window is found that is unrelated to its main window.
+    for (size_t row = table->count; row-- > 0;) {
+        if (mainWindow != SIZE_MAX && !SWWindowTableIsRelatedToLowerWindow(table, row, mainWindow)) {
+            groupCount = addGroup(table, groups, groupCount, (SWWindowTableGroup){ .start = row + 1, .count = groupEnd - (row + 1), .mainWindow = mainWindow }, &lowerBounds, &lowerBoundsValid);
+            groupEnd = row + 1;
+            mainWindow = SIZE_MAX;
+        }
+        
+        if (table->flags[row] & SWWindowTableFlagCanBeActivated) {
+            // Some applications don't name their windows, some people juggle geese. Make sure there's always a main window for the group.
+            if (mainWindow == SIZE_MAX) {
+                mainWindow = row;
+            } else
+            // Named windows always supercede unnamed siblings in the same window group.
+            if (table->names[row] && !table->names[mainWindow]) {
+                mainWindow = row;
+            }
+        }
+    }
+    if (mainWindow != SIZE_MAX) {
+        groupCount = addGroup(table, groups, groupCount, (SWWindowTableGroup){ .start = 0, .count = groupEnd, .mainWindow = mainWindow }, &lowerBounds, &lowerBoundsValid);
+    }
+    
+    return groupCount;
+}
@@ -0,0 +1,161 @@
+//
+//  windowTable.h
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef _WINDOWTABLE_H_
+#define _WINDOWTABLE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A flat, column-oriented table of windows for the filtering and grouping passes.
+ *
+ * Window descriptions are decoded into the table once per window list update, after which every filtering and grouping test reads plain arrays instead of looking up and unboxing dictionary values. Owner and window names are interned, so name tests compare integers.
+ *
+ * Applications that need special handling have quirks, which are kept per owner name atom. Looking up a window's quirks is a single index into an array once its owner name has been interned, and no rule compares strings. The table starts with the quirks of the applications Switch knows about, and more can be set (or those replaced) before it is filled.
+ *
+ * Bounds are kept in the window list's own coordinate space, with the origin at the top left of the main display. None of the geometric tests made while grouping windows change when the y axis is flipped, so the total screen height is never needed.
+ *
+ * This file has no Cocoa dependencies so it can be built and benchmarked on any platform.
+ */
+
+typedef struct {
+    double x;
+    double y;
+    double width;
+    double height;
+} SWWindowTableRect;
+
+typedef uint32_t SWWindowTableAtom;
+
+enum {
+    // Missing and empty names.
+    SWWindowTableAtomNone = 0,
+};
+
+typedef uint32_t SWWindowTableQuirks;
+
+// Ways an application's windows differ from the rules every other application's windows are held to. Each has a name, used by rules that are set at runtime.
+enum {
+    // "hideWindowsNamedAfterOwner": windows with the same name as their application are palettes, not documents (Microsoft Word).
+    SWWindowTableQuirkHideWindowsNamedAfterOwner = 1 << 0,
+    // "hideTranslucentWindows": windows less than 90% opaque are overlays, not documents (Isolator).
+    SWWindowTableQuirkHideTranslucentWindows = 1 << 1,
+    // "decoratorWindows": unnamed windows only join the window below them if they are its section header or its shadow (Tweetbot).
+    SWWindowTableQuirkDecoratorWindows = 1 << 2,
+    // "noChildWindows": unnamed windows never join the window below them (MacVim).
+    SWWindowTableQuirkNoChildWindows = 1 << 3,
+    // "savePanelService": the application shows open and save panels for other applications, so a group containing its windows joins the group below it (Powerbox).
+    SWWindowTableQuirkSavePanelService = 1 << 4,
+    // "hideLoneUnnamedWindowsWhenInactive": a group of one unnamed window is hidden unless the application is active (Finder's Quick Look). Not applied by the table itself.
+    SWWindowTableQuirkHideLoneUnnamedWindowsWhenInactive = 1 << 5,
+};
+
+enum {
+    // The window's application is a regular or accessory application. Windows of other applications are never main windows.
+    SWWindowTableFlagCanBeActivated = 1 << 0,
+};
+
+// kCGNormalWindowLevel.
+#define kSWWindowTableNormalLayer 0
+#define kSWWindowTableNoScreen UINT32_MAX
+
+typedef struct {
+    size_t count;
+    size_t capacity;
+    
+    // Decoded from the window list.
+    uint32_t *windowIDs;
+    int32_t *pids;
+    int64_t *layers;
+    double *alphas;
+    SWWindowTableRect *bounds;
+    SWWindowTableAtom *names;
+    SWWindowTableAtom *ownerNames;
+    
+    // Not part of the window list; filled in by the caller before grouping. Rows are appended with no flags and kSWWindowTableNoScreen.
+    uint8_t *flags;
+    // Any identifier that is equal for windows on the same screen, or kSWWindowTableNoScreen for windows that aren't on a screen. Only read for windows that can be activated.
+    uint32_t *screens;
+    
+    // Interned strings, as one buffer indexed by atom, and an open-addressed index of atom + 1 by hash.
+    char *strings;
+    size_t stringsLength;
+    size_t stringsCapacity;
+    size_t *atomOffsets;
+    size_t *atomLengths;
+    size_t atomCount;
+    size_t atomCapacity;
+    SWWindowTableAtom *atomSlots;
+    size_t atomSlotCount;
+    
+    // The quirks of the application with each atom as its owner name, indexed by atom. The atoms of applications with quirks come first and are kept when the table is emptied.
+    SWWindowTableQuirks *atomQuirks;
+    size_t pinnedAtomCount;
+    size_t pinnedStringsLength;
+} SWWindowTable;
+
+// A run of rows that belong together, front to back.
+typedef struct {
+    size_t start;
+    size_t count;
+    size_t mainWindow;
+} SWWindowTableGroup;
+
+bool SWWindowTableInit(SWWindowTable *table, size_t capacity);
+void SWWindowTableDestroy(SWWindowTable *table);
+
+// Removes every row, and forgets every interned name other than the owner names of applications with quirks.
+void SWWindowTableRemoveAll(SWWindowTable *table);
+
+// Returns the atom for a UTF-8 string, interning it if necessary. Empty strings are SWWindowTableAtomNone.
+SWWindowTableAtom SWWindowTableIntern(SWWindowTable *table, const char *string, size_t length);
+
+// Returns the quirk with the given name, or 0 if there is no such quirk.
+SWWindowTableQuirks SWWindowTableQuirkNamed(const char *name, size_t length);
+
+// Sets the quirks of the application with the given owner name, replacing any it already had. Removes every row, so quirks should be set before the table is filled. Returns false if the name is empty or could not be interned.
+bool SWWindowTableSetQuirks(SWWindowTable *table, const char *ownerName, size_t length, SWWindowTableQuirks quirks);
+
+static inline SWWindowTableQuirks SWWindowTableQuirksOfRow(const SWWindowTable *table, size_t row)
+{
+    return table->atomQuirks[table->ownerNames[row]];
+}
+
+// Appends a row for a window, in front-to-back order. Returns the row's index, or SIZE_MAX if the table could not grow.
+size_t SWWindowTableAppend(SWWindowTable *table, uint32_t windowID, int32_t pid, int64_t layer, double alpha, SWWindowTableRect bounds, SWWindowTableAtom name, SWWindowTableAtom ownerName);
+
+// Writes the indexes of the rows that belong in the interface to rows, in order, and returns how many were written. rows must have room for table->count indexes.
+size_t SWWindowTableFilter(const SWWindowTable *table, size_t *rows);
+
+// Keeps only the given rows, which must be in ascending order.
+void SWWindowTableCompact(SWWindowTable *table, const size_t *rows, size_t count);
+
+// Whether the window in the upper row belongs to the same group as the window below it in the lower row. The lower window must be able to be activated.
+bool SWWindowTableIsRelatedToLowerWindow(const SWWindowTable *table, size_t upper, size_t lower);
+
+// Writes the table's window groups to groups, back to front, and returns how many were written. groups must have room for table->count groups. Every group has a main window that can be activated, so if no window can be activated there are no groups.
+// The table is scanned once: each window is only compared to the main window of the group below it, and each group to the group below it, whose bounds are kept as it grows. The work is linear in the number of windows.
+size_t SWWindowTableGroupWindows(const SWWindowTable *table, SWWindowTableGroup *groups);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _WINDOWTABLE_H_
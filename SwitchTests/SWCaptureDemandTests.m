@@ -0,0 +1,208 @@
+//
+//  SWCaptureDemandTests.m
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "SWWindow.h"
+#import "SWWindowFilteringTests.h"
+#import "SWWindowWorker.h"
+
+
+static const NSUInteger kWindowCount = 200;
+static const NSTimeInterval kSimulationDuration = 10.0;
+
+
+// A worker whose window is drawn instead of captured. Busy windows change with every capture; the rest never change.
+@interface SWSimulatedWindowWorker : SWWindowWorker
+
+@property (atomic, assign) NSUInteger captures;
+@property (nonatomic, assign) BOOL busy;
+// Captures with 16 bits per component, which the resampler can't read.
+@property (nonatomic, assign) BOOL unreadable;
+@property (nonatomic, copy) dispatch_block_t onCapture;
+
+@end
+
+
+@implementation SWSimulatedWindowWorker
+
+- (CGImageRef)copyWindowImage;
+{
+    NSUInteger capture = ++self.captures;
+    if (self.onCapture) {
+        self.onCapture();
+    }
+    
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateWithName(kCGColorSpaceSRGB);
+    CGContextRef context;
+    if (self.unreadable) {
+        context = CGBitmapContextCreate(NULL, 160, 100, 16, 0, colorSpace, (CGBitmapInfo)kCGImageAlphaPremultipliedLast);
+    } else {
+        context = CGBitmapContextCreate(NULL, 160, 100, 8, 0, colorSpace, kCGBitmapByteOrder32Host | (CGBitmapInfo)kCGImageAlphaPremultipliedFirst);
+    }
+    CGColorSpaceRelease(colorSpace);
+    CGFloat shade = self.busy ? (capture % 256) / 255.0 : 0.5;
+    CGContextSetRGBFillColor(context, shade, 0.25, 0.75, 1.0);
+    CGContextFillRect(context, CGRectMake(0.0, 0.0, 160.0, 100.0));
+    CGImageRef image = CGBitmapContextCreateImage(context);
+    CGContextRelease(context);
+    return image;
+}
+
+- (void)postNotification:(NSDictionary *)userInfo;
+{
+    // Nobody is listening, and the simulation runs off the main thread, which notifications are posted on.
+}
+
+@end
+
+
+@interface SWCaptureDemandTests : XCTestCase
+
+@property (nonatomic, strong) NNPollingScheduler *scheduler;
+@property (nonatomic, strong) NSArray *workers;
+
+@end
+
+
+@implementation SWCaptureDemandTests
+
+- (void)setUp
+{
+    [super setUp];
+    
+    self.scheduler = [[NNPollingScheduler alloc] initWithVirtualClock];
+    NSMutableArray *workers = [NSMutableArray new];
+    for (NSUInteger i = 0; i < kWindowCount; ++i) {
+        SWWindow *window = [SWWindow windowWithDescription:@{
+            NNWindowAlpha : @1,
+            NNWindowBounds : DICT_FROM_RECT(CGRectMake(i, 22 + i, 800, 500)),
+            NNWindowIsOnscreen : @1,
+            NNWindowLayer : @0,
+            NNWindowMemoryUsage : @1024,
+            NNWindowName : [NSString stringWithFormat:@"Window %lu", (unsigned long)i],
+            NNWindowNumber : @(1000 + i),
+            NNWindowOwnerName : @"Simulator",
+            NNWindowOwnerPID : @(100 + i / 4),
+            NNWindowSharingState : @1,
+            NNWindowStoreType : @2
+        }];
+        SWSimulatedWindowWorker *worker = [[SWSimulatedWindowWorker alloc] initWithModelObject:window scheduler:self.scheduler];
+        // A quarter of the windows are playing video, or the like.
+        worker.busy = (i % 4 == 0);
+        [workers addObject:worker];
+    }
+    self.workers = workers;
+}
+
+- (void)tearDown
+{
+    self.workers = nil;
+    self.scheduler = nil;
+    
+    [super tearDown];
+}
+
+- (NSUInteger)captures;
+{
+    NSUInteger result = 0;
+    for (SWSimulatedWindowWorker *worker in self.workers) {
+        result += worker.captures;
+    }
+    return result;
+}
+
+// Workers check that they aren't polled on the main thread.
+- (void)advanceClockBy:(NSTimeInterval)interval;
+{
+    dispatch_sync(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        [self.scheduler advanceClockBy:interval];
+    });
+}
+
+// Sets each worker's demand, lets the workers settle into it, then simulates a while and returns the captures per second.
+- (double)capturesPerSecondWithDemand:(SWWindowWorkerDemand (^)(NSUInteger index))demand;
+{
+    [self.workers enumerateObjectsUsingBlock:^(SWSimulatedWindowWorker *worker, NSUInteger index, BOOL *stop) {
+        worker.demand = demand(index);
+    }];
+    [self advanceClockBy:2.0];
+    
+    NSUInteger start = self.captures;
+    [self advanceClockBy:kSimulationDuration];
+    return (self.captures - start) / kSimulationDuration;
+}
+
+- (void)testCapturesPerSecond
+{
+    // Every window captured as often as its content changes, as all were before capture followed the interface.
+    double unthrottled = [self capturesPerSecondWithDemand:^(NSUInteger index) { return SWWindowWorkerDemandSelected; }];
+    // The interface is showing every window, with the first selected.
+    double shown = [self capturesPerSecondWithDemand:^(NSUInteger index) { return index == 0 ? SWWindowWorkerDemandSelected : SWWindowWorkerDemandVisible; }];
+    // The interface is hidden.
+    double hidden = [self capturesPerSecondWithDemand:^(NSUInteger index) { return SWWindowWorkerDemandNone; }];
+    
+    NSLog(@"%lu windows: %.1f captures/s unthrottled, %.1f captures/s shown, %.1f captures/s hidden", (unsigned long)kWindowCount, unthrottled, shown, hidden);
+    XCTAssertLessThan(shown, unthrottled / 2.0);
+    XCTAssertEqual(hidden, 0.0);
+}
+
+- (void)testSuspendedWorkersResumeWhenShown
+{
+    [self capturesPerSecondWithDemand:^(NSUInteger index) { return SWWindowWorkerDemandNone; }];
+    
+    SWSimulatedWindowWorker *worker = self.workers.firstObject;
+    NSUInteger captures = worker.captures;
+    XCTAssertGreaterThan(captures, (NSUInteger)0, @"Every worker should keep a frame while suspended");
+    
+    worker.demand = SWWindowWorkerDemandSelected;
+    [self advanceClockBy:0.0];
+    XCTAssertEqual(worker.captures, captures + 1);
+    [self advanceClockBy:1.0];
+    XCTAssertGreaterThan(worker.captures, captures + 10);
+}
+
+- (void)testUnreadableCapturesBackOff
+{
+    SWSimulatedWindowWorker *readable = self.workers[1];
+    SWSimulatedWindowWorker *unreadable = self.workers[2];
+    unreadable.unreadable = YES;
+    readable.demand = SWWindowWorkerDemandVisible;
+    unreadable.demand = SWWindowWorkerDemandVisible;
+    
+    // Neither window changes, so a capture the resampler can't read must back off just like one it can.
+    [self advanceClockBy:30.0];
+    XCTAssertGreaterThan(readable.captures, (NSUInteger)1);
+    XCTAssertEqual(unreadable.captures, readable.captures);
+}
+
+- (void)testDemandArrivingDuringCaptureIsKept
+{
+    SWSimulatedWindowWorker *worker = self.workers.firstObject;
+    __weak SWSimulatedWindowWorker *weakWorker = worker;
+    worker.onCapture = ^{
+        // The window is shown while its first capture is running, before the worker decides whether to suspend itself.
+        weakWorker.demand = SWWindowWorkerDemandVisible;
+    };
+    
+    [self advanceClockBy:0.0];
+    worker.onCapture = nil;
+    XCTAssertFalse(worker.suspended);
+    
+    NSUInteger captures = worker.captures;
+    [self advanceClockBy:2.0];
+    XCTAssertGreaterThan(worker.captures, captures);
+}
+
+@end
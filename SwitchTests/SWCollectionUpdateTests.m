@@ -0,0 +1,115 @@
+//
+//  SWCollectionUpdateTests.m
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "collectionUpdate.h"
+
+
+#define countof(array) (sizeof(array) / sizeof(*(array)))
+
+
+@interface SWCollectionUpdateTests : XCTestCase
+
+@end
+
+
+@implementation SWCollectionUpdateTests
+
+- (void)testUnchangedListKeepsEverything {
+    SWWindowListEntry entries[] = { { 1, 10 }, { 2, 20 }, { 3, 30 } };
+    SWCollectionUpdateCell cells[countof(entries)];
+    size_t discarded[countof(entries)];
+    
+    XCTAssertEqual(SWCollectionUpdatePlan(entries, countof(entries), entries, countof(entries), cells, discarded), 0);
+    for (size_t i = 0; i < countof(entries); ++i) {
+        XCTAssertEqual(cells[i].oldIndex, i);
+    }
+}
+
+- (void)testInsertionKeepsExistingCells {
+    SWWindowListEntry oldEntries[] = { { 1, 10 }, { 2, 20 }, { 3, 30 } };
+    SWWindowListEntry newEntries[] = { { 1, 10 }, { 4, 40 }, { 2, 20 }, { 3, 30 } };
+    SWCollectionUpdateCell cells[countof(newEntries)];
+    size_t discarded[countof(oldEntries)];
+    
+    XCTAssertEqual(SWCollectionUpdatePlan(oldEntries, countof(oldEntries), newEntries, countof(newEntries), cells, discarded), 0);
+    XCTAssertEqual(cells[0].oldIndex, 0);
+    XCTAssertEqual(cells[1].oldIndex, SIZE_MAX);
+    XCTAssertEqual(cells[2].oldIndex, 1);
+    XCTAssertEqual(cells[3].oldIndex, 2);
+}
+
+- (void)testRemovingTheLastCellDiscardsIt {
+    SWWindowListEntry oldEntries[] = { { 1, 10 }, { 2, 20 }, { 3, 30 } };
+    SWWindowListEntry newEntries[] = { { 1, 10 }, { 2, 20 } };
+    SWCollectionUpdateCell cells[countof(newEntries)];
+    size_t discarded[countof(oldEntries)];
+    
+    XCTAssertEqual(SWCollectionUpdatePlan(oldEntries, countof(oldEntries), newEntries, countof(newEntries), cells, discarded), 1);
+    XCTAssertEqual(discarded[0], 2);
+    XCTAssertEqual(cells[0].oldIndex, 0);
+    XCTAssertEqual(cells[1].oldIndex, 1);
+}
+
+- (void)testUpdatedCellsAreReplaced {
+    SWWindowListEntry oldEntries[] = { { 1, 10 }, { 2, 20 }, { 3, 30 } };
+    SWWindowListEntry newEntries[] = { { 1, 10 }, { 2, 21 }, { 3, 30 } };
+    SWCollectionUpdateCell cells[countof(newEntries)];
+    size_t discarded[countof(oldEntries)];
+    
+    XCTAssertEqual(SWCollectionUpdatePlan(oldEntries, countof(oldEntries), newEntries, countof(newEntries), cells, discarded), 1);
+    XCTAssertEqual(discarded[0], 1);
+    XCTAssertEqual(cells[1].oldIndex, SIZE_MAX);
+    XCTAssertEqual(cells[2].oldIndex, 2);
+}
+
+- (void)testMovedCellsAreKept {
+    SWWindowListEntry oldEntries[] = { { 1, 10 }, { 2, 20 }, { 3, 30 }, { 4, 40 } };
+    SWWindowListEntry newEntries[] = { { 3, 30 }, { 1, 10 }, { 2, 20 }, { 4, 40 } };
+    SWCollectionUpdateCell cells[countof(newEntries)];
+    size_t discarded[countof(oldEntries)];
+    
+    XCTAssertEqual(SWCollectionUpdatePlan(oldEntries, countof(oldEntries), newEntries, countof(newEntries), cells, discarded), 0);
+    XCTAssertEqual(cells[0].oldIndex, 2);
+    XCTAssertEqual(cells[1].oldIndex, 0);
+    XCTAssertEqual(cells[2].oldIndex, 1);
+    XCTAssertEqual(cells[3].oldIndex, 3);
+}
+
+- (void)testPlanPerformance {
+    const size_t count = 1000;
+    SWWindowListEntry *oldEntries = calloc(count, sizeof(*oldEntries));
+    SWWindowListEntry *newEntries = calloc(count, sizeof(*newEntries));
+    SWCollectionUpdateCell *cells = calloc(count, sizeof(*cells));
+    size_t *discarded = calloc(count, sizeof(*discarded));
+    for (size_t i = 0; i < count; ++i) {
+        oldEntries[i] = (SWWindowListEntry){ (uint32_t)(i * 7919 + 13), i };
+        // Every tenth window goes away and is replaced by a new one; the rest are unchanged.
+        newEntries[i] = i % 10 ? oldEntries[i] : (SWWindowListEntry){ (uint32_t)(i * 7919 + 14), i };
+    }
+    
+    [self measureBlock:^{
+        for (unsigned i = 0; i < 100; ++i) {
+            (void)SWCollectionUpdatePlan(oldEntries, count, newEntries, count, cells, discarded);
+        }
+    }];
+    
+    free(discarded);
+    free(cells);
+    free(newEntries);
+    free(oldEntries);
+}
+
+@end
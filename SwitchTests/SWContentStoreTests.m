@@ -0,0 +1,178 @@
+//
+//  SWContentStoreTests.m
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#import <Cocoa/Cocoa.h>
+#import <XCTest/XCTest.h>
+#import <mach/mach_time.h>
+
+#import "contentStore.h"
+
+
+static const size_t kWindowCount = 200;
+static const size_t kReaderCount = 4;
+static const NSTimeInterval kStressDuration = 2.0;
+
+static const void *retainObject(const void *value) { return CFRetain(value); }
+static void releaseObject(const void *value) { CFRelease(value); }
+
+static double nanosecondsFromAbsolute(uint64_t absolute) {
+    static mach_timebase_info_data_t timebase;
+    if (!timebase.denom) {
+        mach_timebase_info(&timebase);
+    }
+    return (double)absolute * timebase.numer / timebase.denom;
+}
+
+
+@interface SWContentStoreTests : XCTestCase {
+    SWContentStore *store;
+}
+
+@end
+
+
+@implementation SWContentStoreTests
+
+- (void)setUp {
+    [super setUp];
+    
+    self->store = SWContentStoreCreate((SWContentStoreCallbacks){ .retain = retainObject, .release = releaseObject });
+}
+
+- (void)tearDown {
+    SWContentStoreDestroy(self->store);
+    
+    [super tearDown];
+}
+
+- (BOOL)publishObjects:(NSArray *)objects withWindowIDs:(const uint32_t *)windowIDs {
+    const void **values = calloc(MAX(objects.count, (NSUInteger)1), sizeof(*values));
+    for (NSUInteger i = 0; i < objects.count; ++i) {
+        values[i] = (__bridge const void *)objects[i];
+    }
+    BOOL result = SWContentStorePublish(self->store, windowIDs, values, objects.count);
+    free(values);
+    return result;
+}
+
+// Every window's content, labelled with the window and the update that produced it.
+- (NSArray *)contentForUpdate:(NSUInteger)update windowIDs:(uint32_t *)windowIDs {
+    NSMutableArray *result = [NSMutableArray new];
+    for (size_t i = 0; i < kWindowCount; ++i) {
+        windowIDs[i] = (uint32_t)(1000 + i);
+        [result addObject:[NSString stringWithFormat:@"%u:%lu", windowIDs[i], (unsigned long)update]];
+    }
+    return result;
+}
+
+#pragma mark - Correctness
+
+- (void)testLookup {
+    XCTAssertTrue(SWContentStoreCopyValue(self->store, 1) == NULL);
+    
+    uint32_t windowIDs[] = { 1, 2, 3 };
+    XCTAssertTrue([self publishObjects:@[@"one", @"two", @"three"] withWindowIDs:windowIDs]);
+    XCTAssertEqualObjects(CFBridgingRelease(SWContentStoreCopyValue(self->store, 2)), @"two");
+    XCTAssertTrue(SWContentStoreCopyValue(self->store, 4) == NULL);
+    XCTAssertTrue(SWContentStoreCopyValue(self->store, 0) == NULL);
+    XCTAssertEqual(SWContentStoreGeneration(self->store), (uint64_t)1);
+    
+    XCTAssertTrue([self publishObjects:@[@"three again"] withWindowIDs:windowIDs + 2]);
+    XCTAssertTrue(SWContentStoreCopyValue(self->store, 2) == NULL);
+    XCTAssertEqualObjects(CFBridgingRelease(SWContentStoreCopyValue(self->store, 3)), @"three again");
+}
+
+- (void)testReplacedValuesAreReleased {
+    __weak NSObject *weakValue;
+    @autoreleasepool {
+        NSObject *value = [NSObject new];
+        weakValue = value;
+        uint32_t windowID = 7;
+        XCTAssertTrue([self publishObjects:@[value] withWindowIDs:&windowID]);
+    }
+    XCTAssertNotNil(weakValue);
+    
+    XCTAssertTrue([self publishObjects:@[] withWindowIDs:NULL]);
+    XCTAssertNil(weakValue);
+}
+
+#pragma mark - Benchmarks
+
+// Reads every window's content from several threads while a writer publishes a new snapshot of every window as fast as it can, then logs the readers' latency percentiles.
+- (void)testReadLatencyDuringUpdates {
+    uint32_t *windowIDs = calloc(kWindowCount, sizeof(*windowIDs));
+    XCTAssertTrue([self publishObjects:[self contentForUpdate:0 windowIDs:windowIDs] withWindowIDs:windowIDs]);
+    
+    __block volatile BOOL running = YES;
+    __block NSUInteger mismatches = 0;
+    const size_t samplesPerReader = 1 << 20;
+    uint64_t *samples = calloc(kReaderCount * samplesPerReader, sizeof(*samples));
+    size_t *sampleCounts = calloc(kReaderCount, sizeof(*sampleCounts));
+    
+    dispatch_group_t readers = dispatch_group_create();
+    for (size_t reader = 0; reader < kReaderCount; ++reader) {
+        dispatch_group_async(readers, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_HIGH, 0), ^{
+            uint64_t *readerSamples = samples + reader * samplesPerReader;
+            size_t count = 0;
+            for (size_t i = 0; running && count < samplesPerReader; ++i) {
+                uint32_t windowID = windowIDs[i % kWindowCount];
+                uint64_t start = mach_absolute_time();
+                NSString *content = CFBridgingRelease(SWContentStoreCopyValue(self->store, windowID));
+                readerSamples[count++] = mach_absolute_time() - start;
+                if (![content hasPrefix:[NSString stringWithFormat:@"%u:", windowID]]) {
+                    @synchronized(self) { mismatches++; }
+                }
+            }
+            sampleCounts[reader] = count;
+        });
+    }
+    
+    // The capture stream: publishes are batched on one serial queue, as SWWindowContentsService does.
+    dispatch_queue_t writerQueue = dispatch_queue_create("SWContentStoreTests writer", DISPATCH_QUEUE_SERIAL);
+    __block NSUInteger updates = 0;
+    NSDate *start = [NSDate date];
+    while (-[start timeIntervalSinceNow] < kStressDuration) {
+        dispatch_sync(writerQueue, ^{
+            uint32_t *updateWindowIDs = calloc(kWindowCount, sizeof(*updateWindowIDs));
+            NSArray *content = [self contentForUpdate:++updates windowIDs:updateWindowIDs];
+            XCTAssertTrue([self publishObjects:content withWindowIDs:updateWindowIDs]);
+            free(updateWindowIDs);
+        });
+    }
+    running = NO;
+    dispatch_group_wait(readers, DISPATCH_TIME_FOREVER);
+    
+    NSMutableData *all = [NSMutableData new];
+    for (size_t reader = 0; reader < kReaderCount; ++reader) {
+        [all appendBytes:samples + reader * samplesPerReader length:sampleCounts[reader] * sizeof(*samples)];
+    }
+    uint64_t *sorted = all.mutableBytes;
+    size_t count = all.length / sizeof(*sorted);
+    qsort_b(sorted, count, sizeof(*sorted), ^int(const void *a, const void *b) {
+        uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+        return x < y ? -1 : x > y;
+    });
+    
+    XCTAssertEqual(mismatches, (NSUInteger)0);
+    XCTAssertGreaterThan(count, (size_t)0);
+    if (count) {
+        NSLog(@"%zu reads during %lu publishes of %zu windows: p50 %.0fns, p99 %.0fns, p99.9 %.0fns, max %.0fns", count, (unsigned long)updates, kWindowCount, nanosecondsFromAbsolute(sorted[count / 2]), nanosecondsFromAbsolute(sorted[count * 99 / 100]), nanosecondsFromAbsolute(sorted[count * 999 / 1000]), nanosecondsFromAbsolute(sorted[count - 1]));
+    }
+    
+    free(sampleCounts);
+    free(samples);
+    free(windowIDs);
+}
+
+@end
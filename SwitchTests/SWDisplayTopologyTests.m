@@ -0,0 +1,147 @@
+//
+//  SWDisplayTopologyTests.m
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "displayTopology.h"
+
+
+static SWWindowTableRect rect(double x, double y, double width, double height) {
+    return (SWWindowTableRect){ .x = x, .y = y, .width = width, .height = height };
+}
+
+
+@interface SWDisplayTopologyTests : XCTestCase {
+    SWDisplayTopology _topology;
+}
+
+@end
+
+
+@implementation SWDisplayTopologyTests
+
+- (void)setUp
+{
+    [super setUp];
+    XCTAssertTrue(SWDisplayTopologyInit(&self->_topology, 0));
+}
+
+- (void)tearDown
+{
+    SWDisplayTopologyDestroy(&self->_topology);
+    [super tearDown];
+}
+
+// A laptop with an external display to its right, main, and a portrait display to its left that sits higher.
+- (void)addThreeDisplayLayout;
+{
+    SWDisplayTopologyAddDisplay(&self->_topology, 1, rect(0, 0, 1440, 900), false);
+    SWDisplayTopologyAddDisplay(&self->_topology, 2, rect(1440, 0, 1920, 1080), true);
+    SWDisplayTopologyAddDisplay(&self->_topology, 3, rect(-1080, -600, 1080, 1920), false);
+}
+
+#pragma mark - Single windows
+
+- (void)testNoDisplays
+{
+    XCTAssertEqual(SWDisplayTopologyDisplayForRect(&self->_topology, rect(0, 0, 100, 100)), SIZE_MAX);
+}
+
+- (void)testWindowsBelongToTheDisplayTheyOverlapMost
+{
+    [self addThreeDisplayLayout];
+    XCTAssertEqual(SWDisplayTopologyDisplayForRect(&self->_topology, rect(100, 100, 800, 600)), (size_t)0);
+    XCTAssertEqual(SWDisplayTopologyDisplayForRect(&self->_topology, rect(1300, 100, 800, 600)), (size_t)1);
+    XCTAssertEqual(SWDisplayTopologyDisplayForRect(&self->_topology, rect(-700, -500, 800, 600)), (size_t)2);
+}
+
+- (void)testTiesGoToTheMainDisplay
+{
+    [self addThreeDisplayLayout];
+    // Straddles the first two displays evenly.
+    XCTAssertEqual(SWDisplayTopologyDisplayForRect(&self->_topology, rect(1340, 100, 200, 100)), (size_t)1);
+    // Offscreen.
+    XCTAssertEqual(SWDisplayTopologyDisplayForRect(&self->_topology, rect(9000, 9000, 100, 100)), (size_t)1);
+}
+
+- (void)testTiesWithoutTheMainDisplayGoToTheFirstDisplay
+{
+    [self addThreeDisplayLayout];
+    // Straddles the laptop and the portrait display evenly.
+    XCTAssertEqual(SWDisplayTopologyDisplayForRect(&self->_topology, rect(-100, 100, 200, 100)), (size_t)0);
+}
+
+- (void)testWithoutAMainDisplayOnlyOverlapCounts
+{
+    SWDisplayTopologyAddDisplay(&self->_topology, 1, rect(0, 0, 1440, 900), false);
+    XCTAssertEqual(SWDisplayTopologyDisplayForRect(&self->_topology, rect(9000, 9000, 100, 100)), SIZE_MAX);
+    XCTAssertEqual(SWDisplayTopologyDisplayForRect(&self->_topology, rect(10, 10, 100, 100)), (size_t)0);
+}
+
+#pragma mark - Tables
+
+- (void)fillTable:(SWWindowTable *)table withCount:(NSUInteger)count;
+{
+    for (NSUInteger i = 0; i < count; ++i) {
+        SWWindowTableAppend(table, (uint32_t)i, 100, 0, 1.0, rect((double)((i * 37) % 4000) - 1500.0, (double)((i * 17) % 1800) - 700.0, 300 + i % 400, 200 + i % 300), SWWindowTableAtomNone, SWWindowTableAtomNone);
+    }
+}
+
+- (void)testTableAssignmentMatchesSingleWindows
+{
+    [self addThreeDisplayLayout];
+    SWWindowTable table;
+    XCTAssertTrue(SWWindowTableInit(&table, 0));
+    // More than one block's worth of windows.
+    [self fillTable:&table withCount:1000];
+    
+    SWDisplayTopologyAssignScreens(&self->_topology, &table);
+    for (size_t row = 0; row < table.count; ++row) {
+        XCTAssertEqual((size_t)table.screens[row], SWDisplayTopologyDisplayForRect(&self->_topology, table.bounds[row]));
+    }
+    
+    SWWindowTableDestroy(&table);
+}
+
+- (void)testTableAssignmentWithoutDisplays
+{
+    SWWindowTable table;
+    XCTAssertTrue(SWWindowTableInit(&table, 0));
+    [self fillTable:&table withCount:10];
+    
+    SWDisplayTopologyAssignScreens(&self->_topology, &table);
+    for (size_t row = 0; row < table.count; ++row) {
+        XCTAssertEqual(table.screens[row], (uint32_t)kSWWindowTableNoScreen);
+    }
+    
+    SWWindowTableDestroy(&table);
+}
+
+- (void)testTableAssignmentPerformance
+{
+    [self addThreeDisplayLayout];
+    SWWindowTable table;
+    XCTAssertTrue(SWWindowTableInit(&table, 0));
+    [self fillTable:&table withCount:1000];
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 1000; ++i) {
+            SWDisplayTopologyAssignScreens(&self->_topology, &table);
+        }
+    }];
+    
+    SWWindowTableDestroy(&table);
+}
+
+@end
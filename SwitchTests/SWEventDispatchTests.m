@@ -0,0 +1,128 @@
+//
+//  SWEventDispatchTests.m
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "eventDispatch.h"
+#import "SWHotKey.h"
+
+
+static const NSUInteger kEventCount = 1000000;
+
+static NSUInteger releaseCount;
+static void countRelease(const void *handler) { releaseCount++; }
+
+
+@interface SWEventDispatchTests : XCTestCase {
+    SWEventDispatcher *dispatcher;
+}
+
+@end
+
+
+@implementation SWEventDispatchTests
+
+- (void)setUp {
+    [super setUp];
+    
+    releaseCount = 0;
+    self->dispatcher = SWEventDispatcherCreate();
+}
+
+- (void)tearDown {
+    SWEventDispatcherDestroy(self->dispatcher);
+    
+    [super tearDown];
+}
+
+// The bindings SWCoreWindowService makes, plus the interface's mouse and scroll callbacks.
+- (SWEventDispatchTable *)switchBindings {
+    SWEventDispatchEntry entries[] = {
+        { SWEventDispatchKindHotKey, SWEventDispatchHotKey(kVK_Tab, SWHotKeyModifierOption), 1, (void *)1 },
+        { SWEventDispatchKindHotKey, SWEventDispatchHotKey(kVK_RightArrow, SWHotKeyModifierOption), 1, (void *)2 },
+        { SWEventDispatchKindHotKey, SWEventDispatchHotKey(kVK_Tab, SWHotKeyModifierOption | SWHotKeyModifierShift), 1, (void *)3 },
+        { SWEventDispatchKindHotKey, SWEventDispatchHotKey(kVK_LeftArrow, SWHotKeyModifierOption), 1, (void *)4 },
+        { SWEventDispatchKindHotKey, SWEventDispatchHotKey(kVK_ANSI_W, SWHotKeyModifierOption), 1, (void *)5 },
+        { SWEventDispatchKindHotKey, SWEventDispatchHotKey(kVK_ANSI_Comma, SWHotKeyModifierOption), 1, (void *)6 },
+        { SWEventDispatchKindHotKey, SWEventDispatchHotKey(kVK_Escape, SWHotKeyModifierOption), 1, (void *)7 },
+        { SWEventDispatchKindModifier, SWHotKeyModifierOption, 1, (void *)8 },
+        { SWEventDispatchKindEventType, kCGEventScrollWheel, 1, (void *)9 },
+        { SWEventDispatchKindEventType, kCGEventMouseMoved, 3, (void *)10 },
+        { SWEventDispatchKindEventType, kCGEventMouseMoved, 2, (void *)11 },
+    };
+    return SWEventDispatchTableCreate(entries, sizeof(entries) / sizeof(*entries), countRelease);
+}
+
+- (void)testLookupsFindEveryRegistrantInOwnerOrder {
+    SWEventDispatchTable *table = [self switchBindings];
+    const SWEventDispatchEntry *entries;
+    
+    XCTAssertEqual(SWEventDispatchTableFind(table, SWEventDispatchKindHotKey, SWEventDispatchHotKey(kVK_Tab, SWHotKeyModifierOption | SWHotKeyModifierShift), &entries), (size_t)1);
+    XCTAssertEqual(entries[0].handler, (void *)3);
+    XCTAssertEqual(SWEventDispatchTableFind(table, SWEventDispatchKindHotKey, SWEventDispatchHotKey(kVK_Tab, 0), &entries), (size_t)0);
+    XCTAssertEqual(SWEventDispatchTableFind(table, SWEventDispatchKindEventType, kCGEventMouseMoved, &entries), (size_t)2);
+    XCTAssertEqual(entries[0].owner, (uintptr_t)2);
+    XCTAssertEqual(entries[1].owner, (uintptr_t)3);
+    XCTAssertEqual(SWEventDispatchTableEntries(table, SWEventDispatchKindModifier, &entries), (size_t)1);
+    XCTAssertEqual(entries[0].key, (uint32_t)SWHotKeyModifierOption);
+    
+    SWEventDispatchTableDestroy(table);
+    XCTAssertEqual(releaseCount, (NSUInteger)11);
+}
+
+- (void)testReplacedTablesOutliveTheirReader {
+    SWEventDispatcherPublish(self->dispatcher, [self switchBindings]);
+    
+    const SWEventDispatchTable *table = SWEventDispatcherBeginRead(self->dispatcher);
+    SWEventDispatcherPublish(self->dispatcher, SWEventDispatchTableCreate(NULL, 0, countRelease));
+    XCTAssertEqual(releaseCount, (NSUInteger)0);
+    const SWEventDispatchEntry *entries;
+    XCTAssertEqual(SWEventDispatchTableFind(table, SWEventDispatchKindModifier, SWHotKeyModifierOption, &entries), (size_t)1);
+    SWEventDispatcherEndRead(self->dispatcher);
+    
+    table = SWEventDispatcherBeginRead(self->dispatcher);
+    XCTAssertEqual(SWEventDispatchTableFind(table, SWEventDispatchKindModifier, SWHotKeyModifierOption, &entries), (size_t)0);
+    SWEventDispatcherEndRead(self->dispatcher);
+    
+    SWEventDispatcherPublish(self->dispatcher, SWEventDispatchTableCreate(NULL, 0, countRelease));
+    XCTAssertEqual(releaseCount, (NSUInteger)11);
+}
+
+- (void)testDispatchThroughput {
+    SWEventDispatcherPublish(self->dispatcher, [self switchBindings]);
+    
+    // A synthetic session: mostly typing and mouse movement, with the occasional binding.
+    uint32_t *keys = calloc(kEventCount, sizeof(*keys));
+    for (NSUInteger i = 0; i < kEventCount; ++i) {
+        keys[i] = SWEventDispatchHotKey((uint16_t)(arc4random_uniform(0x60)), (uint16_t)(arc4random_uniform(8) ? 0 : SWHotKeyModifierOption));
+    }
+    
+    __block uintptr_t handlers = 0;
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < kEventCount; ++i) {
+            const SWEventDispatchTable *table = SWEventDispatcherBeginRead(self->dispatcher);
+            const SWEventDispatchEntry *entries;
+            size_t count = SWEventDispatchTableFind(table, i % 4 ? SWEventDispatchKindHotKey : SWEventDispatchKindEventType, i % 4 ? keys[i] : kCGEventMouseMoved, &entries);
+            for (size_t j = 0; j < count; ++j) {
+                handlers += (uintptr_t)entries[j].handler;
+            }
+            SWEventDispatcherEndRead(self->dispatcher);
+        }
+    }];
+    XCTAssertGreaterThan(handlers, (uintptr_t)0);
+    
+    free(keys);
+}
+
+@end
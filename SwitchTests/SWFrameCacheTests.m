@@ -0,0 +1,184 @@
+//
+//  SWFrameCacheTests.m
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#import <Cocoa/Cocoa.h>
+#import <XCTest/XCTest.h>
+
+#import "frameCache.h"
+
+
+static const size_t kWindowCount = 200;
+static const size_t kFrameWidth = 128;
+static const size_t kFrameHeight = 80;
+
+
+// Draws something like a window: a title bar, a flat background, and a few lines of text.
+static void drawWindow(uint32_t *pixels, size_t width, size_t height, size_t bytesPerRow, uint32_t seed) {
+    for (size_t y = 0; y < height; ++y) {
+        uint32_t *row = (uint32_t *)((uint8_t *)pixels + y * bytesPerRow);
+        for (size_t x = 0; x < width; ++x) {
+            if (y < 8) {
+                row[x] = 0xFFD0D0D0;
+            } else if (y % 6 == 0 && x > 4 && x < width - 4 && ((x * 7 + y * 13 + seed) % 11) > 2) {
+                row[x] = 0xFF202020 + (seed & 0xFF);
+            } else {
+                row[x] = 0xFFFFFFFF;
+            }
+        }
+    }
+}
+
+
+@interface SWFrameCacheTests : XCTestCase {
+    SWFrameCache cache;
+}
+
+@end
+
+
+@implementation SWFrameCacheTests
+
+- (void)setUp {
+    [super setUp];
+    
+    XCTAssertTrue(SWFrameCacheInit(&self->cache, 1024 * 1024));
+}
+
+- (void)tearDown {
+    SWFrameCacheDestroy(&self->cache);
+    
+    [super tearDown];
+}
+
+- (void)testFramesAreKeptToFourBitsPerChannel {
+    uint8_t pixels[kFrameWidth * kFrameHeight * 4];
+    for (size_t i = 0; i < sizeof(pixels); ++i) {
+        pixels[i] = (uint8_t)(i * 31 + i / 7);
+    }
+    XCTAssertTrue(SWFrameCacheStore(&self->cache, 42, 7, pixels, kFrameWidth, kFrameHeight, kFrameWidth * 4));
+    
+    const SWFrameCacheEntry *frame = SWFrameCacheLookup(&self->cache, 42);
+    XCTAssertTrue(frame != NULL);
+    XCTAssertEqual(frame->format, (uint32_t)7);
+    XCTAssertEqual(frame->width, (uint32_t)kFrameWidth);
+    XCTAssertEqual(frame->height, (uint32_t)kFrameHeight);
+    
+    uint8_t decoded[sizeof(pixels)];
+    SWFrameCacheDecode(frame, decoded, kFrameWidth * 4);
+    for (size_t i = 0; i < sizeof(pixels); ++i) {
+        XCTAssertEqual(decoded[i] >> 4, pixels[i] >> 4);
+        XCTAssertEqual(decoded[i] & 0xF, decoded[i] >> 4);
+    }
+}
+
+- (void)testFlatContentIsSmall {
+    uint32_t pixels[kFrameWidth * kFrameHeight];
+    drawWindow(pixels, kFrameWidth, kFrameHeight, kFrameWidth * 4, 0);
+    XCTAssertTrue(SWFrameCacheStore(&self->cache, 1, 0, pixels, kFrameWidth, kFrameHeight, kFrameWidth * 4));
+    
+    XCTAssertLessThan(self->cache.byteCount, sizeof(pixels) / 4);
+}
+
+- (void)testLeastRecentlyUsedFramesAreEvicted {
+    uint32_t pixels[kFrameWidth * kFrameHeight];
+    drawWindow(pixels, kFrameWidth, kFrameHeight, kFrameWidth * 4, 0);
+    XCTAssertTrue(SWFrameCacheStore(&self->cache, 1, 0, pixels, kFrameWidth, kFrameHeight, kFrameWidth * 4));
+    size_t frameSize = self->cache.byteCount;
+    SWFrameCacheSetByteLimit(&self->cache, frameSize * 3);
+    
+    XCTAssertTrue(SWFrameCacheStore(&self->cache, 2, 0, pixels, kFrameWidth, kFrameHeight, kFrameWidth * 4));
+    XCTAssertTrue(SWFrameCacheStore(&self->cache, 3, 0, pixels, kFrameWidth, kFrameHeight, kFrameWidth * 4));
+    XCTAssertTrue(SWFrameCacheLookup(&self->cache, 1) != NULL);
+    XCTAssertTrue(SWFrameCacheStore(&self->cache, 4, 0, pixels, kFrameWidth, kFrameHeight, kFrameWidth * 4));
+    
+    XCTAssertEqual(self->cache.count, (size_t)3);
+    XCTAssertLessThanOrEqual(self->cache.byteCount, self->cache.byteLimit);
+    XCTAssertTrue(SWFrameCacheLookup(&self->cache, 1) != NULL);
+    XCTAssertTrue(SWFrameCacheLookup(&self->cache, 2) == NULL);
+    XCTAssertTrue(SWFrameCacheLookup(&self->cache, 3) != NULL);
+    XCTAssertTrue(SWFrameCacheLookup(&self->cache, 4) != NULL);
+    
+    SWFrameCacheSetByteLimit(&self->cache, frameSize);
+    XCTAssertEqual(self->cache.count, (size_t)1);
+    XCTAssertTrue(SWFrameCacheLookup(&self->cache, 4) != NULL);
+}
+
+- (void)testFramesLargerThanTheLimitAreNotKept {
+    uint32_t pixels[kFrameWidth * kFrameHeight];
+    drawWindow(pixels, kFrameWidth, kFrameHeight, kFrameWidth * 4, 0);
+    XCTAssertTrue(SWFrameCacheStore(&self->cache, 1, 0, pixels, kFrameWidth, kFrameHeight, kFrameWidth * 4));
+    SWFrameCacheSetByteLimit(&self->cache, self->cache.byteCount - 1);
+    
+    XCTAssertEqual(self->cache.count, (size_t)0);
+    XCTAssertFalse(SWFrameCacheStore(&self->cache, 1, 0, pixels, kFrameWidth, kFrameHeight, kFrameWidth * 4));
+    XCTAssertTrue(SWFrameCacheLookup(&self->cache, 1) == NULL);
+}
+
+// Every thumbnail in the interface can be filled from the frames kept from last time, without waiting for the window server.
+- (void)testEveryWindowIsFilledFromCache {
+    size_t bytesPerRow = kFrameWidth * 4;
+    size_t framePixels = kFrameWidth * kFrameHeight;
+    uint32_t *frames = calloc(kWindowCount, framePixels * 4);
+    uint32_t *decoded = calloc(kWindowCount, framePixels * 4);
+    
+    for (size_t i = 0; i < kWindowCount; ++i) {
+        drawWindow(frames + i * framePixels, kFrameWidth, kFrameHeight, bytesPerRow, (uint32_t)i);
+        XCTAssertTrue(SWFrameCacheStore(&self->cache, (uint32_t)i + 1, 0, frames + i * framePixels, kFrameWidth, kFrameHeight, bytesPerRow));
+    }
+    
+    for (size_t i = 0; i < kWindowCount; ++i) {
+        const SWFrameCacheEntry *frame = SWFrameCacheLookup(&self->cache, (uint32_t)i + 1);
+        XCTAssertTrue(frame != NULL, @"Frame for window %zu was not kept", i);
+        if (!frame) {
+            continue;
+        }
+        SWFrameCacheDecode(frame, decoded + i * framePixels, bytesPerRow);
+    }
+    
+    // Each window's frame comes back as it was drawn, to four bits per channel.
+    const uint8_t *original = (const uint8_t *)frames;
+    const uint8_t *result = (const uint8_t *)decoded;
+    size_t mismatches = 0;
+    for (size_t i = 0; i < kWindowCount * framePixels * 4; ++i) {
+        if (result[i] >> 4 != original[i] >> 4) {
+            mismatches++;
+        }
+    }
+    XCTAssertEqual(mismatches, (size_t)0);
+    
+    free(decoded);
+    free(frames);
+}
+
+- (void)testDecodePerformance {
+    size_t bytesPerRow = kFrameWidth * 4;
+    size_t framePixels = kFrameWidth * kFrameHeight;
+    uint32_t *frames = calloc(kWindowCount, framePixels * 4);
+    
+    for (size_t i = 0; i < kWindowCount; ++i) {
+        drawWindow(frames + i * framePixels, kFrameWidth, kFrameHeight, bytesPerRow, (uint32_t)i);
+        XCTAssertTrue(SWFrameCacheStore(&self->cache, (uint32_t)i + 1, 0, frames + i * framePixels, kFrameWidth, kFrameHeight, bytesPerRow));
+    }
+    
+    NSLog(@"%zu windows kept in %zu bytes", kWindowCount, self->cache.byteCount);
+    [self measureBlock:^{
+        for (size_t i = 0; i < kWindowCount; ++i) {
+            SWFrameCacheDecode(SWFrameCacheLookup(&self->cache, (uint32_t)i + 1), frames + i * framePixels, bytesPerRow);
+        }
+    }];
+    
+    free(frames);
+}
+
+@end
@@ -0,0 +1,217 @@
+//
+//  SWGridLayoutTests.m
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "gridLayout.h"
+
+
+static const SWGridMetrics kMetrics = { .maxCellSize = 128.0, .cellPadding = 19.0, .boundsInset = 16.0 };
+static const SWGridRect kBounds = { 0.0, 0.0, 1440.0, 900.0 };
+static const size_t kMaxCells = 500;
+static const size_t kHitTestQueries = 100000;
+
+
+// How cells were found before the grid could answer directly: test each cell's frame in turn.
+static size_t cellAtPointByScanning(const SWGridLayout *layout, double x, double y) {
+    double localX = x - layout->hudFrame.x;
+    double localY = y - layout->hudFrame.y;
+    for (size_t i = 0; i < layout->count; ++i) {
+        SWGridRect frame = layout->cellFrames[i];
+        if (localX >= frame.x && localX < frame.x + frame.width && localY >= frame.y && localY < frame.y + frame.height) {
+            return i;
+        }
+    }
+    return SIZE_MAX;
+}
+
+
+@interface SWGridLayoutTests : XCTestCase {
+    SWGridRect *cellFrames;
+}
+
+@end
+
+
+@implementation SWGridLayoutTests
+
+- (void)setUp {
+    [super setUp];
+    
+    self->cellFrames = calloc(kMaxCells, sizeof(*self->cellFrames));
+}
+
+- (void)tearDown {
+    free(self->cellFrames);
+    
+    [super tearDown];
+}
+
+- (void)assertRect:(SWGridRect)rect equals:(SWGridRect)expected {
+    XCTAssertEqual(rect.x, expected.x);
+    XCTAssertEqual(rect.y, expected.y);
+    XCTAssertEqual(rect.width, expected.width);
+    XCTAssertEqual(rect.height, expected.height);
+}
+
+#pragma mark - Golden layouts
+
+- (void)testEmptyLayoutIsTheSizeOfOneCell {
+    SWGridLayout layout = SWGridLayoutMake(kMetrics, kBounds, 0, self->cellFrames);
+    
+    XCTAssertEqual(layout.rows, 0);
+    XCTAssertEqual(layout.columns, 0);
+    [self assertRect:layout.hudFrame equals:(SWGridRect){ 637, 367, 166, 166 }];
+}
+
+- (void)testFewCellsFitInOneRow {
+    SWGridLayout layout = SWGridLayoutMake(kMetrics, kBounds, 3, self->cellFrames);
+    
+    XCTAssertEqual(layout.rows, 1);
+    XCTAssertEqual(layout.columns, 3);
+    XCTAssertEqual(layout.cellSize, 128);
+    [self assertRect:layout.hudFrame equals:(SWGridRect){ 490, 367, 460, 166 }];
+    [self assertRect:layout.cellFrames[0] equals:(SWGridRect){ 19, 19, 128, 128 }];
+    [self assertRect:layout.cellFrames[1] equals:(SWGridRect){ 166, 19, 128, 128 }];
+    [self assertRect:layout.cellFrames[2] equals:(SWGridRect){ 313, 19, 128, 128 }];
+}
+
+- (void)testRowsAreAddedBeforeCellsShrink {
+    SWGridLayout layout = SWGridLayoutMake(kMetrics, kBounds, 12, self->cellFrames);
+    
+    XCTAssertEqual(layout.rows, 2);
+    XCTAssertEqual(layout.columns, 6);
+    XCTAssertEqual(layout.cellSize, 128);
+    [self assertRect:layout.hudFrame equals:(SWGridRect){ 269, 293, 901, 313 }];
+    // Rows fill from the top.
+    [self assertRect:layout.cellFrames[0] equals:(SWGridRect){ 19, 166, 128, 128 }];
+    [self assertRect:layout.cellFrames[5] equals:(SWGridRect){ 754, 166, 128, 128 }];
+    [self assertRect:layout.cellFrames[6] equals:(SWGridRect){ 19, 19, 128, 128 }];
+    [self assertRect:layout.cellFrames[11] equals:(SWGridRect){ 754, 19, 128, 128 }];
+}
+
+- (void)testCellsShrinkWhenTheyDoNotFit {
+    SWGridLayout layout = SWGridLayoutMake(kMetrics, kBounds, 100, self->cellFrames);
+    
+    XCTAssertEqual(layout.rows, 8);
+    XCTAssertEqual(layout.columns, 13);
+    XCTAssertEqual(layout.cellSize, 87);
+    [self assertRect:layout.hudFrame equals:(SWGridRect){ 21, 16, 1397, 867 }];
+    [self assertRect:layout.cellFrames[0] equals:(SWGridRect){ 19, 761, 87, 87 }];
+    [self assertRect:layout.cellFrames[99] equals:(SWGridRect){ 867, 19, 87, 87 }];
+}
+
+- (void)testLargestLayout {
+    SWGridLayout layout = SWGridLayoutMake(kMetrics, kBounds, kMaxCells, self->cellFrames);
+    
+    XCTAssertEqual(layout.rows, 18);
+    XCTAssertEqual(layout.columns, 28);
+    XCTAssertEqual(layout.cellSize, 28);
+    [self assertRect:layout.hudFrame equals:(SWGridRect){ 52, 17, 1335, 865 }];
+    [self assertRect:layout.cellFrames[0] equals:(SWGridRect){ 19, 818, 28, 28 }];
+    [self assertRect:layout.cellFrames[kMaxCells - 1] equals:(SWGridRect){ 1100, 19, 28, 28 }];
+}
+
+- (void)testHUDStaysInsideTheBounds {
+    for (size_t count = 1; count <= kMaxCells; ++count) {
+        SWGridLayout layout = SWGridLayoutMake(kMetrics, kBounds, count, self->cellFrames);
+        
+        XCTAssertGreaterThanOrEqual(layout.hudFrame.x, kMetrics.boundsInset);
+        XCTAssertGreaterThanOrEqual(layout.hudFrame.y, kMetrics.boundsInset);
+        XCTAssertLessThanOrEqual(layout.hudFrame.x + layout.hudFrame.width, kBounds.width - kMetrics.boundsInset);
+        XCTAssertLessThanOrEqual(layout.hudFrame.y + layout.hudFrame.height, kBounds.height - kMetrics.boundsInset);
+        XCTAssertGreaterThanOrEqual(layout.columns * layout.rows, count);
+    }
+}
+
+#pragma mark - Hit testing
+
+- (void)testHitTestingMatchesCellFrames {
+    size_t counts[] = { 0, 1, 3, 12, 41, 100, kMaxCells };
+    for (size_t i = 0; i < sizeof(counts) / sizeof(*counts); ++i) {
+        SWGridLayout layout = SWGridLayoutMake(kMetrics, kBounds, counts[i], self->cellFrames);
+        
+        // Every half point, which includes every cell edge.
+        for (double y = 0.0; y <= kBounds.height; y += 0.5) {
+            for (double x = 0.0; x <= kBounds.width; x += 0.5) {
+                if (SWGridLayoutCellAtPoint(&layout, x, y) != cellAtPointByScanning(&layout, x, y)) {
+                    XCTFail(@"%zu cells: hit test at (%g, %g) found %zu instead of %zu", counts[i], x, y, SWGridLayoutCellAtPoint(&layout, x, y), cellAtPointByScanning(&layout, x, y));
+                    return;
+                }
+            }
+        }
+    }
+}
+
+- (void)testPaddingIsNotInAnyCell {
+    SWGridLayout layout = SWGridLayoutMake(kMetrics, kBounds, 3, self->cellFrames);
+    
+    XCTAssertEqual(SWGridLayoutCellAtPoint(&layout, 490 + 19, 367 + 19), 0);
+    XCTAssertEqual(SWGridLayoutCellAtPoint(&layout, 490 + 19 + 128, 367 + 19), SIZE_MAX);
+    XCTAssertEqual(SWGridLayoutCellAtPoint(&layout, 490 + 166, 367 + 19), 1);
+    XCTAssertEqual(SWGridLayoutCellAtPoint(&layout, 490 + 19, 367 + 18), SIZE_MAX);
+    XCTAssertEqual(SWGridLayoutCellAtPoint(&layout, 490 + 19, 367 + 19 + 128), SIZE_MAX);
+}
+
+#pragma mark - Cache
+
+- (void)testCacheReturnsTheSameLayoutForTheSameKey {
+    SWGridLayoutCache *cache = SWGridLayoutCacheCreate(kMetrics);
+    
+    const SWGridLayout *layout = SWGridLayoutCacheGet(cache, kBounds, 12);
+    XCTAssertEqual(layout->columns, 6);
+    XCTAssertEqual(SWGridLayoutCacheGet(cache, kBounds, 3)->columns, 3);
+    XCTAssertEqual(SWGridLayoutCacheGet(cache, kBounds, 12), layout);
+    
+    SWGridRect otherBounds = { 0.0, 0.0, 1920.0, 1080.0 };
+    XCTAssertNotEqual(SWGridLayoutCacheGet(cache, otherBounds, 12)->hudFrame.x, layout->hudFrame.x);
+    
+    SWGridLayoutCacheDestroy(cache);
+}
+
+#pragma mark - Performance
+
+- (void)testLayoutPerformance {
+    [self measureBlock:^{
+        for (size_t count = 1; count <= kMaxCells; ++count) {
+            (void)SWGridLayoutMake(kMetrics, kBounds, count, self->cellFrames);
+        }
+    }];
+}
+
+- (void)testScanningHitTestPerformance {
+    SWGridLayout layout = SWGridLayoutMake(kMetrics, kBounds, kMaxCells, self->cellFrames);
+    
+    [self measureBlock:^{
+        size_t hits = 0;
+        for (size_t i = 0; i < kHitTestQueries; ++i) {
+            hits += cellAtPointByScanning(&layout, (double)(i * 7 % 1440), (double)(i * 13 % 900)) != SIZE_MAX;
+        }
+        XCTAssertGreaterThan(hits, 0);
+    }];
+}
+
+- (void)testGridHitTestPerformance {
+    SWGridLayout layout = SWGridLayoutMake(kMetrics, kBounds, kMaxCells, self->cellFrames);
+    
+    [self measureBlock:^{
+        size_t hits = 0;
+        for (size_t i = 0; i < kHitTestQueries; ++i) {
+            hits += SWGridLayoutCellAtPoint(&layout, (double)(i * 7 % 1440), (double)(i * 13 % 900)) != SIZE_MAX;
+        }
+        XCTAssertGreaterThan(hits, 0);
+    }];
+}
+
+@end
@@ -88,4 +88,115 @@
     }];
 }
 
+- (void)testTileHashComparisonDifferent {
+    [self measureBlock:^{
+        XCTAssertTrue(imagesDifferByTileHashComparison(self->cgImageA, self->cgImageB));
+    }];
+}
+
+- (void)testTileHashComparisonSame {
+    [self measureBlock:^{
+        XCTAssertFalse(imagesDifferByTileHashComparison(self->cgImageA, self->cgImageAA));
+    }];
+}
+
+- (void)testTileHashImplementationsAgree {
+    NSData *pixels = CFBridgingRelease(CGDataProviderCopyData(CGImageGetDataProvider(self->cgImageA)));
+    size_t width = CGImageGetWidth(self->cgImageA);
+    size_t height = CGImageGetHeight(self->cgImageA);
+    size_t bytesPerRow = CGImageGetBytesPerRow(self->cgImageA);
+    size_t tileCount = ((width + 31) / 32) * ((height + 31) / 32);
+
+    NSMutableData *expected = [NSMutableData dataWithLength:tileCount * sizeof(uint64_t)];
+    SWTileHashCompute(pixels.bytes, width, height, bytesPerRow, 32, SWTileHashImplementationScalar, expected.mutableBytes);
+
+    for (SWTileHashImplementation implementation = SWTileHashImplementationSSE2; implementation <= SWTileHashImplementationNEON; ++implementation) {
+        if (!SWTileHashImplementationAvailable(implementation)) {
+            continue;
+        }
+        NSMutableData *actual = [NSMutableData dataWithLength:tileCount * sizeof(uint64_t)];
+        SWTileHashCompute(pixels.bytes, width, height, bytesPerRow, 32, implementation, actual.mutableBytes);
+        XCTAssertEqualObjects(expected, actual, @"Implementation %d disagrees with scalar implementation", implementation);
+    }
+}
+
+static void addToWord(NSMutableData *pixels, size_t index, uint64_t delta)
+{
+    uint64_t word;
+    memcpy(&word, (uint8_t *)pixels.mutableBytes + index * sizeof(word), sizeof(word));
+    word += delta;
+    memcpy((uint8_t *)pixels.mutableBytes + index * sizeof(word), &word, sizeof(word));
+}
+
+static uint64_t hashOfTile(NSData *pixels, SWTileHashImplementation implementation)
+{
+    uint64_t hash = 0;
+    SWTileHashCompute(pixels.bytes, 32, 32, 32 * 4, 32, implementation, &hash);
+    return hash;
+}
+
+- (void)testTileHashStructuredEditsChangeHash {
+    // A single 32×32 tile. Words 4 apart (32 bytes) are accumulated by the same lane, so these edits cancel out in a hash that only sums words.
+    NSMutableData *original = [NSMutableData dataWithLength:32 * 32 * 4];
+    for (size_t i = 0; i < original.length; ++i) {
+        ((uint8_t *)original.mutableBytes)[i] = (uint8_t)(i * 37 + i / 7);
+    }
+
+    // +d, -2d, +d on consecutive words of one lane leaves both its sum and its sum of sums unchanged.
+    NSMutableData *secondDifference = [original mutableCopy];
+    addToWord(secondDifference, 0, 0x0101);
+    addToWord(secondDifference, 4, -2 * 0x0101);
+    addToWord(secondDifference, 8, 0x0101);
+
+    // Swapping two words of a lane and compensating with the words that follow each of them does the same.
+    NSMutableData *compensatedSwap = [original mutableCopy];
+    uint64_t a, b;
+    memcpy(&a, (uint8_t *)original.bytes + 16 * sizeof(uint64_t), sizeof(a));
+    memcpy(&b, (uint8_t *)original.bytes + 24 * sizeof(uint64_t), sizeof(b));
+    addToWord(compensatedSwap, 16, b - a);
+    addToWord(compensatedSwap, 24, a - b);
+    addToWord(compensatedSwap, 20, a - b);
+    addToWord(compensatedSwap, 28, b - a);
+    XCTAssertNotEqualObjects(original, compensatedSwap);
+
+    for (SWTileHashImplementation implementation = SWTileHashImplementationScalar; implementation <= SWTileHashImplementationNEON; ++implementation) {
+        if (!SWTileHashImplementationAvailable(implementation)) {
+            continue;
+        }
+        uint64_t expected = hashOfTile(original, implementation);
+        XCTAssertNotEqual(expected, hashOfTile(secondDifference, implementation), @"Implementation %d", implementation);
+        XCTAssertNotEqual(expected, hashOfTile(compensatedSwap, implementation), @"Implementation %d", implementation);
+    }
+}
+
+- (void)testTileHashDirtyTiles {
+    NSMutableData *pixels = [CFBridgingRelease(CGDataProviderCopyData(CGImageGetDataProvider(self->cgImageA))) mutableCopy];
+    size_t width = CGImageGetWidth(self->cgImageA);
+    size_t height = CGImageGetHeight(self->cgImageA);
+    size_t bytesPerRow = CGImageGetBytesPerRow(self->cgImageA);
+    XCTAssertGreaterThan(width, (size_t)40);
+    XCTAssertGreaterThan(height, (size_t)70);
+
+    SWTileHash tileHash;
+    SWTileHashInit(&tileHash, 32);
+
+    XCTAssertTrue(SWTileHashUpdate(&tileHash, pixels.bytes, width, height, bytesPerRow));
+    XCTAssertEqual(SWTileHashDirtyCount(&tileHash), tileHash.columns * tileHash.rows);
+
+    XCTAssertFalse(SWTileHashUpdate(&tileHash, pixels.bytes, width, height, bytesPerRow));
+    XCTAssertEqual(SWTileHashDirtyCount(&tileHash), (size_t)0);
+
+    // Flip one bit of the pixel at (40, 70).
+    ((uint8_t *)pixels.mutableBytes)[70 * bytesPerRow + 40 * 4] ^= 1;
+    XCTAssertTrue(SWTileHashUpdate(&tileHash, pixels.bytes, width, height, bytesPerRow));
+    XCTAssertEqual(SWTileHashDirtyCount(&tileHash), (size_t)1);
+    XCTAssertTrue(SWTileHashTileIsDirty(&tileHash, 1, 2));
+
+    // Changing the dimensions dirties everything.
+    XCTAssertTrue(SWTileHashUpdate(&tileHash, pixels.bytes, width - 1, height, bytesPerRow));
+    XCTAssertEqual(SWTileHashDirtyCount(&tileHash), tileHash.columns * tileHash.rows);
+
+    SWTileHashDestroy(&tileHash);
+}
+
 @end
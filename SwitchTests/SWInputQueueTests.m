@@ -0,0 +1,143 @@
+//
+//  SWInputQueueTests.m
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "inputQueue.h"
+
+
+static const size_t kCapacity = 256;
+static const uint64_t kInputCount = 1000000;
+
+
+@interface SWInputQueueTests : XCTestCase {
+    SWInputQueue *queue;
+}
+
+@end
+
+
+@implementation SWInputQueueTests
+
+- (void)setUp {
+    [super setUp];
+    
+    self->queue = SWInputQueueCreate(kCapacity);
+}
+
+- (void)tearDown {
+    SWInputQueueDestroy(self->queue);
+    
+    [super tearDown];
+}
+
+- (void)testInputsArriveInOrder {
+    SWInput input = { .kind = SWInputKindIncrement, .flags = SWInputFlagInvoke | SWInputFlagRepeating };
+    for (uint64_t i = 0; i < 3; ++i) {
+        input.timestamp = i;
+        XCTAssertTrue(SWInputQueuePush(self->queue, &input));
+    }
+    
+    for (uint64_t i = 0; i < 3; ++i) {
+        XCTAssertTrue(SWInputQueuePop(self->queue, &input));
+        XCTAssertEqual(input.kind, SWInputKindIncrement);
+        XCTAssertEqual(input.flags, (uint32_t)(SWInputFlagInvoke | SWInputFlagRepeating));
+        XCTAssertEqual(input.timestamp, i);
+    }
+    XCTAssertFalse(SWInputQueuePop(self->queue, &input));
+}
+
+- (void)testFullQueueRejectsInputs {
+    SWInputQueue *small = SWInputQueueCreate(3);
+    SWInput input = { .kind = SWInputKindCancel };
+    
+    // Capacity is rounded up to 4.
+    for (uint64_t i = 0; i < 4; ++i) {
+        input.timestamp = i;
+        XCTAssertTrue(SWInputQueuePush(small, &input));
+    }
+    XCTAssertFalse(SWInputQueuePush(small, &input));
+    
+    // Wrapping around.
+    XCTAssertTrue(SWInputQueuePop(small, &input));
+    XCTAssertEqual(input.timestamp, (uint64_t)0);
+    input.timestamp = 4;
+    XCTAssertTrue(SWInputQueuePush(small, &input));
+    for (uint64_t i = 1; i <= 4; ++i) {
+        XCTAssertTrue(SWInputQueuePop(small, &input));
+        XCTAssertEqual(input.timestamp, i);
+    }
+    XCTAssertFalse(SWInputQueuePop(small, &input));
+    
+    SWInputQueueDestroy(small);
+}
+
+- (void)testRepeatsAreCoalesced {
+    uint32_t repeating = SWInputFlagInvoke | SWInputFlagRepeating;
+    SWInput inputs[] = {
+        { .kind = SWInputKindIncrement, .flags = SWInputFlagInvoke, .timestamp = 1 },
+        { .kind = SWInputKindIncrement, .flags = repeating, .timestamp = 2 },
+        { .kind = SWInputKindIncrement, .flags = repeating, .timestamp = 3 },
+        { .kind = SWInputKindIncrement, .flags = repeating, .timestamp = 4 },
+        { .kind = SWInputKindIncrement, .flags = repeating | SWInputFlagDecreasing, .timestamp = 5 },
+        { .kind = SWInputKindEnd, .timestamp = 6 },
+        { .kind = SWInputKindEnd, .timestamp = 7 },
+    };
+    for (size_t i = 0; i < sizeof(inputs) / sizeof(*inputs); ++i) {
+        XCTAssertTrue(SWInputQueuePush(self->queue, &inputs[i]));
+    }
+    
+    SWInput input;
+    XCTAssertEqual(SWInputQueuePopCoalesced(self->queue, &input), (size_t)1);
+    XCTAssertEqual(input.timestamp, (uint64_t)1);
+    XCTAssertEqual(SWInputQueuePopCoalesced(self->queue, &input), (size_t)3);
+    XCTAssertEqual(input.timestamp, (uint64_t)2);
+    XCTAssertEqual(SWInputQueuePopCoalesced(self->queue, &input), (size_t)1);
+    XCTAssertEqual(input.flags, repeating | SWInputFlagDecreasing);
+    // Only increments are coalesced.
+    XCTAssertEqual(SWInputQueuePopCoalesced(self->queue, &input), (size_t)1);
+    XCTAssertEqual(SWInputQueuePopCoalesced(self->queue, &input), (size_t)1);
+    XCTAssertEqual(input.timestamp, (uint64_t)7);
+    XCTAssertEqual(SWInputQueuePopCoalesced(self->queue, &input), (size_t)0);
+}
+
+- (void)testHandoffBetweenThreads {
+    SWInputQueue *queue = self->queue;
+    
+    [self measureBlock:^{
+        dispatch_semaphore_t produced = dispatch_semaphore_create(0);
+        dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^{
+            for (uint64_t i = 0; i < kInputCount;) {
+                SWInput input = { .kind = SWInputKindIncrement, .timestamp = i };
+                if (SWInputQueuePush(queue, &input)) {
+                    ++i;
+                }
+            }
+            dispatch_semaphore_signal(produced);
+        });
+        
+        uint64_t misordered = 0;
+        for (uint64_t i = 0; i < kInputCount;) {
+            SWInput input;
+            if (SWInputQueuePop(queue, &input)) {
+                misordered += input.timestamp != i;
+                ++i;
+            }
+        }
+        dispatch_semaphore_wait(produced, DISPATCH_TIME_FOREVER);
+        XCTAssertEqual(misordered, (uint64_t)0);
+    }];
+}
+
+@end
@@ -0,0 +1,186 @@
+//
+//  SWResampleTests.m
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#import <Cocoa/Cocoa.h>
+#import <XCTest/XCTest.h>
+#import <mach/mach.h>
+
+#import "resample.h"
+
+
+// A 5K display's worth of window.
+static const size_t kCaptureWidth = 5120;
+static const size_t kCaptureHeight = 2880;
+static const size_t kThumbnailMaxEdge = 256;
+
+
+static int64_t residentBytes() {
+    struct mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return (int64_t)info.resident_size;
+}
+
+
+@interface SWResampleTests : XCTestCase {
+    NSMutableData *capture;
+}
+
+@end
+
+
+@implementation SWResampleTests
+
+- (void)setUp {
+    [super setUp];
+
+    self->capture = [NSMutableData dataWithLength:kCaptureWidth * kCaptureHeight * 4];
+    uint8_t *pixels = self->capture.mutableBytes;
+    for (size_t y = 0; y < kCaptureHeight; ++y) {
+        for (size_t x = 0; x < kCaptureWidth; ++x) {
+            uint8_t *pixel = pixels + (y * kCaptureWidth + x) * 4;
+            pixel[0] = (uint8_t)(x ^ y);
+            pixel[1] = (uint8_t)(x * 3 + y);
+            pixel[2] = (uint8_t)(y * 5);
+            pixel[3] = 0xFF;
+        }
+    }
+}
+
+#pragma mark - Correctness
+
+- (void)testFitSize {
+    size_t width, height;
+
+    SWResampleFitSize(kCaptureWidth, kCaptureHeight, kThumbnailMaxEdge, SIZE_MAX, &width, &height);
+    XCTAssertEqual(width, (size_t)256);
+    XCTAssertEqual(height, (size_t)144);
+
+    // The pixel budget wins when it is tighter than the edge limit.
+    SWResampleFitSize(kCaptureWidth, kCaptureHeight, kThumbnailMaxEdge, 64 * 36, &width, &height);
+    XCTAssertEqual(width, (size_t)64);
+    XCTAssertEqual(height, (size_t)36);
+
+    // Small windows are never scaled up.
+    SWResampleFitSize(100, 20, kThumbnailMaxEdge, SIZE_MAX, &width, &height);
+    XCTAssertEqual(width, (size_t)100);
+    XCTAssertEqual(height, (size_t)20);
+}
+
+- (void)testSolidColorIsPreserved {
+    uint8_t *pixels = self->capture.mutableBytes;
+    for (size_t i = 0; i < self->capture.length; i += 4) {
+        pixels[i + 0] = 10;
+        pixels[i + 1] = 200;
+        pixels[i + 2] = 255;
+        pixels[i + 3] = 255;
+    }
+
+    size_t width = 333, height = 187;
+    NSMutableData *thumbnail = [NSMutableData dataWithLength:width * height * 4];
+    XCTAssertTrue(SWResampleBox(pixels, kCaptureWidth, kCaptureHeight, kCaptureWidth * 4, thumbnail.mutableBytes, width, height, width * 4, NULL));
+
+    const uint8_t *result = thumbnail.bytes;
+    for (size_t i = 0; i < thumbnail.length; i += 4) {
+        XCTAssertEqual(result[i + 0], (uint8_t)10);
+        XCTAssertEqual(result[i + 1], (uint8_t)200);
+        XCTAssertEqual(result[i + 2], (uint8_t)255);
+        XCTAssertEqual(result[i + 3], (uint8_t)255);
+    }
+}
+
+- (void)testCheckerboardAverages {
+    const uint8_t checkerboard[16] = {
+        0x00, 0x00, 0x00, 0x00,   0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF,   0x00, 0x00, 0x00, 0x00,
+    };
+    uint8_t pixel[4];
+    XCTAssertTrue(SWResampleBox(checkerboard, 2, 2, 8, pixel, 1, 1, 4, NULL));
+    for (size_t c = 0; c < 4; ++c) {
+        XCTAssertEqualWithAccuracy(pixel[c], 0x80, 1);
+    }
+}
+
+- (void)testRegionMatchesFullResample {
+    size_t width, height;
+    SWResampleFitSize(kCaptureWidth, kCaptureHeight, kThumbnailMaxEdge, SIZE_MAX, &width, &height);
+
+    NSMutableData *full = [NSMutableData dataWithLength:width * height * 4];
+    NSMutableData *partial = [NSMutableData dataWithLength:width * height * 4];
+    SWResampleBox(self->capture.bytes, kCaptureWidth, kCaptureHeight, kCaptureWidth * 4, full.mutableBytes, width, height, width * 4, NULL);
+
+    // A blinking cursor's worth of change in the capture.
+    SWTileRect changed = { .x = 1000, .y = 700, .width = 2, .height = 36 };
+    SWTileRect region = SWResampleScaleRect(changed, kCaptureWidth, kCaptureHeight, width, height);
+    XCTAssertTrue(region.width >= 1 && region.height >= 1);
+    XCTAssertTrue(region.width * region.height <= 4);
+    XCTAssertTrue(SWResampleBox(self->capture.bytes, kCaptureWidth, kCaptureHeight, kCaptureWidth * 4, partial.mutableBytes, width, height, width * 4, &region));
+
+    const uint8_t *a = full.bytes, *b = partial.bytes;
+    for (size_t y = region.y; y < region.y + region.height; ++y) {
+        XCTAssertEqual(memcmp(a + (y * width + region.x) * 4, b + (y * width + region.x) * 4, region.width * 4), 0);
+    }
+}
+
+#pragma mark - Benchmarks
+
+- (void)testDownsampleThroughput {
+    size_t width, height;
+    SWResampleFitSize(kCaptureWidth, kCaptureHeight, kThumbnailMaxEdge, SIZE_MAX, &width, &height);
+    NSMutableData *thumbnail = [NSMutableData dataWithLength:width * height * 4];
+
+    [self measureBlock:^{
+        const size_t iterations = 10;
+        NSDate *start = [NSDate date];
+        for (size_t i = 0; i < iterations; ++i) {
+            SWResampleBox(self->capture.bytes, kCaptureWidth, kCaptureHeight, kCaptureWidth * 4, thumbnail.mutableBytes, width, height, width * 4, NULL);
+        }
+        NSTimeInterval elapsed = -[start timeIntervalSinceNow] / iterations;
+        NSLog(@"%zux%zu -> %zux%zu: %.2fms per capture, %.0f megapixels/s", kCaptureWidth, kCaptureHeight, width, height, elapsed * 1000.0, kCaptureWidth * kCaptureHeight / elapsed / 1e6);
+    }];
+}
+
+// Compares the memory held per window when keeping full-size captures (as the worker used to) with keeping downsampled thumbnails.
+- (void)testResidentMemoryPerWindow {
+    const size_t windows = 16;
+    size_t width, height;
+    SWResampleFitSize(kCaptureWidth, kCaptureHeight, kThumbnailMaxEdge, SIZE_MAX, &width, &height);
+
+    // Resident size can shrink between samples as the allocator returns pages, so deltas are signed.
+    int64_t baseline = residentBytes();
+    NSMutableArray *captures = [NSMutableArray new];
+    for (size_t i = 0; i < windows; ++i) {
+        [captures addObject:[self->capture mutableCopy]];
+    }
+    int64_t fullSize = residentBytes() - baseline;
+    [captures removeAllObjects];
+
+    baseline = residentBytes();
+    NSMutableArray *thumbnails = [NSMutableArray new];
+    for (size_t i = 0; i < windows; ++i) {
+        NSMutableData *thumbnail = [NSMutableData dataWithLength:width * height * 4];
+        SWResampleBox(self->capture.bytes, kCaptureWidth, kCaptureHeight, kCaptureWidth * 4, thumbnail.mutableBytes, width, height, width * 4, NULL);
+        [thumbnails addObject:thumbnail];
+    }
+    int64_t downsampled = residentBytes() - baseline;
+
+    NSLog(@"%zu windows: %.1fMiB resident with full-size captures, %.1fMiB with %zux%zu thumbnails", windows, fullSize / 1048576.0, downsampled / 1048576.0, width, height);
+    // Copying the captures touches every page, so they are resident; the thumbnails should cost a small fraction of that.
+    XCTAssertGreaterThan(fullSize, (int64_t)(kCaptureWidth * kCaptureHeight * 4 * windows / 2));
+    XCTAssertLessThan(downsampled, fullSize / 10);
+}
+
+@end
@@ -0,0 +1,134 @@
+//
+//  SWSelectionTests.m
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "selection.h"
+
+
+static const size_t kWindowCount = 10000;
+
+
+@interface SWSelectionTests : XCTestCase {
+    uint32_t *windowIDs;
+}
+
+@end
+
+
+@implementation SWSelectionTests
+
+- (void)setUp {
+    [super setUp];
+    
+    self->windowIDs = calloc(kWindowCount, sizeof(*self->windowIDs));
+    for (size_t i = 0; i < kWindowCount; ++i) {
+        self->windowIDs[i] = (uint32_t)(i * 7919 + 13);
+    }
+}
+
+- (void)tearDown {
+    free(self->windowIDs);
+    
+    [super tearDown];
+}
+
+- (void)testMapFindsFirstWindowWithID {
+    uint32_t ids[] = { 40, 7, 12, 7, 99 };
+    SWSelectionMap *map = SWSelectionMapCreate(ids, sizeof(ids) / sizeof(*ids));
+    
+    XCTAssertEqual(SWSelectionMapFind(map, 40), 0);
+    XCTAssertEqual(SWSelectionMapFind(map, 7), 1);
+    XCTAssertEqual(SWSelectionMapFind(map, 99), 4);
+    XCTAssertEqual(SWSelectionMapFind(map, 8), SWSelectionNone);
+    
+    SWSelectionMapDestroy(map);
+}
+
+- (void)testSelectionFollowsItsWindow {
+    SWSelection selection = SWSelectionMake(true, 5, 3);
+    
+    // The selected window moved to the front.
+    SWSelectionUpdate(&selection, true, 5, 0);
+    XCTAssertEqual(selection.index, 0);
+}
+
+- (void)testSelectionKeepsItsPositionWhenItsWindowIsGone {
+    SWSelection selection = SWSelectionMake(true, 5, 2);
+    
+    SWSelectionUpdate(&selection, true, 4, SWSelectionNone);
+    XCTAssertEqual(selection.index, 2);
+    
+    // Past the end of a shorter list, the last window is selected.
+    selection = SWSelectionMake(true, 5, 4);
+    SWSelectionUpdate(&selection, true, 3, SWSelectionNone);
+    XCTAssertEqual(selection.index, 2);
+    
+    SWSelectionUpdate(&selection, true, 0, SWSelectionNone);
+    XCTAssertEqual(selection.index, SWSelectionNone);
+}
+
+- (void)testSelectionWithoutListKeepsItsIndex {
+    SWSelection selection = SWSelectionMake(false, 0, 0);
+    SWSelectionMove(&selection, 6, false);
+    XCTAssertEqual(selection.index, 6);
+    
+    // Wrapped into the first list.
+    SWSelectionUpdate(&selection, true, 4, SWSelectionNone);
+    XCTAssertEqual(selection.index, 2);
+}
+
+- (void)testMovesStopAtOrWrapAroundTheEnds {
+    SWSelection selection = SWSelectionMake(true, 4, 2);
+    SWSelectionMove(&selection, 5, false);
+    XCTAssertEqual(selection.index, 3);
+    SWSelectionMove(&selection, 2, true);
+    XCTAssertEqual(selection.index, 1);
+    SWSelectionMove(&selection, -9, false);
+    XCTAssertEqual(selection.index, 0);
+    
+    XCTAssertFalse(SWSelectionSelect(&selection, 4));
+    XCTAssertEqual(selection.index, 0);
+    XCTAssertTrue(SWSelectionSelect(&selection, SWSelectionNone));
+    SWSelectionMove(&selection, -1, false);
+    XCTAssertEqual(selection.index, 3);
+}
+
+- (void)testUpdatePerformance {
+    // Ten thousand windows, reversed on every update so that the selected window is always somewhere else.
+    uint32_t *reversedIDs = calloc(kWindowCount, sizeof(*reversedIDs));
+    for (size_t i = 0; i < kWindowCount; ++i) {
+        reversedIDs[i] = self->windowIDs[kWindowCount - 1 - i];
+    }
+    
+    [self measureBlock:^{
+        SWSelection selection = SWSelectionMake(true, kWindowCount, 0);
+        const uint32_t *currentIDs = self->windowIDs;
+        for (unsigned update = 0; update < 100; ++update) {
+            const uint32_t *nextIDs = update % 2 ? self->windowIDs : reversedIDs;
+            SWSelectionMap *map = SWSelectionMapCreate(nextIDs, kWindowCount);
+            for (unsigned move = 0; move < 100; ++move) {
+                SWSelectionMove(&selection, move % 3 ? 1 : -1, move % 2);
+            }
+            SWSelectionUpdate(&selection, true, kWindowCount, SWSelectionMapFind(map, currentIDs[selection.index]));
+            SWSelectionMapDestroy(map);
+            currentIDs = nextIDs;
+        }
+        XCTAssertNotEqual(selection.index, SWSelectionNone);
+    }];
+    
+    free(reversedIDs);
+}
+
+@end
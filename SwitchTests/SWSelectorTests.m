@@ -373,6 +373,93 @@
     XCTAssertEqual(selector.selectedIndex, NSNotFound);
 }
 
+- (void)testMoveByMatchesRepeatedSteps;
+{
+    for (id listOrNull in @[[NSNull null], [NSOrderedSet orderedSet], self.list0, self.list321, self.list0123]) {
+        NSOrderedSet *list = [listOrNull isEqual:[NSNull null]] ? nil : listOrNull;
+        for (NSNumber *start in @[@(NSNotFound), @0, @1, @2]) {
+            SWSelector *initial = [SWSelector new];
+            if (list) {
+                initial = [initial updateWithWindowList:list];
+            }
+            if (start.integerValue == NSNotFound) {
+                initial = [initial selectIndex:NSNotFound];
+            } else if (list.count) {
+                initial = [initial selectIndex:MIN(start.integerValue, (NSInteger)list.count - 1)];
+            }
+            
+            for (NSInteger steps = -9; steps <= 9; ++steps) {
+                for (int wrapping = 0; wrapping < 2; ++wrapping) {
+                    SWSelector *stepped = initial;
+                    for (NSInteger i = 0; i < ABS(steps); ++i) {
+                        if (steps > 0) {
+                            stepped = wrapping ? [stepped increment] : [stepped incrementWithoutWrapping];
+                        } else {
+                            stepped = wrapping ? [stepped decrement] : [stepped decrementWithoutWrapping];
+                        }
+                    }
+                    
+                    SWSelector *moved = [initial moveBy:steps wrapping:wrapping];
+                    XCTAssertEqual(moved.selectedIndex, stepped.selectedIndex, @"list: %@ start: %@ steps: %ld wrapping: %d", list, start, (long)steps, wrapping);
+                    XCTAssertEqualObjects(moved.selectedWindow, stepped.selectedWindow);
+                }
+            }
+        }
+    }
+}
+
+- (void)testMutableSelectorUpdatesInPlace;
+{
+    SWMutableSelector *selector = [SWMutableSelector new];
+    [selector setWindowList:self.list0123];
+    [selector move:2 wrapping:false];
+    XCTAssertEqualObjects(selector.selectedWindow, @(2));
+    
+    // The selected window is followed into the new list.
+    [selector setWindowList:self.list321];
+    XCTAssertEqual(selector.selectedIndex, 1);
+    XCTAssertEqualObjects(selector.selectedWindow, @(2));
+    
+    [selector setSelectedIndex:0];
+    XCTAssertEqualObjects(selector.selectedWindow, @(3));
+    XCTAssertThrows([selector setSelectedIndex:4]);
+}
+
+- (void)testSelectIndexPastEndClamps;
+{
+    SWSelector *selector = [[SWSelector new] updateWithWindowList:self.list0123];
+    
+    // One past the end selects the last window, as it always has.
+    selector = [selector selectIndex:4];
+    XCTAssertEqual(selector.selectedIndex, 3);
+    XCTAssertEqualObjects(selector.selectedWindow, @(3));
+    
+    SWMutableSelector *mutableSelector = [SWMutableSelector new];
+    [mutableSelector setWindowList:self.list321];
+    [mutableSelector setSelectedIndex:3];
+    XCTAssertEqual(mutableSelector.selectedIndex, 2);
+    XCTAssertEqualObjects(mutableSelector.selectedWindow, @(1));
+}
+
+- (void)testLargeWindowListUpdatePerformance;
+{
+    NSMutableArray *windows = [NSMutableArray new];
+    for (NSUInteger i = 0; i < 10000; ++i) {
+        [windows addObject:@(i)];
+    }
+    NSOrderedSet *forward = [NSOrderedSet orderedSetWithArray:windows];
+    NSOrderedSet *reversed = [NSOrderedSet orderedSetWithArray:windows.reverseObjectEnumerator.allObjects];
+    
+    [self measureBlock:^{
+        SWMutableSelector *selector = [SWMutableSelector new];
+        for (NSUInteger i = 0; i < 100; ++i) {
+            [selector setWindowList:i % 2 ? forward : reversed];
+            [selector move:1 wrapping:true];
+        }
+        XCTAssertNotNil(selector.selectedWindow);
+    }];
+}
+
 - (void)testSelectInvalidIndex;
 {
     SWSelector *selector = [SWSelector new];
@@ -385,6 +472,7 @@
     selector = [selector updateWithWindowList:self.list0123];
     XCTAssertThrows([selector selectIndex:-1]);
     XCTAssertThrows([selector selectIndex:50]);
+    XCTAssertThrows([selector selectIndex:5]);
     selector = [selector selectIndex:NSNotFound];
     XCTAssertEqual(selector.selectedIndex, NSNotFound);
 }
@@ -15,6 +15,7 @@
 #import <XCTest/XCTest.h>
 #import <OCMock/OCMock.h>
 
+#import "inputQueue.h"
 #import "SWStateMachine.h"
 #import "SWWindowFilteringTests.h"
 #import "SWWindow.h"
@@ -1614,6 +1615,60 @@ static SWWindow *(^rwg)() = ^{
     [self testInvokeWindowListKeyReleasedSuccessfulRaiseWithMonkey];
 }
 
+- (SWStateMachine *)replayStateMachineCountingRedraws:(NSUInteger *)redraws;
+{
+    SWStateMachine *stateMachine = [SWStateMachine stateMachineWithDelegate:OCMProtocolMock(@protocol(SWStateMachineDelegate))];
+    [stateMachine incrementWithInvoke:true direction:SWIncrementDirectionIncreasing isRepeating:false];
+    [stateMachine updateWindowList:[SWStateMachineTests windowList]];
+    [stateMachine displayTimerCompleted];
+    XCTAssertTrue(stateMachine.interfaceVisible);
+
+    // Each change to the selected window is a selection update in the interface.
+    [[RACObserve(stateMachine, selectedWindow) skip:1] subscribeNext:^(id x) {
+        ++*redraws;
+    }];
+    return stateMachine;
+}
+
+- (void)testCoalescedKeyRepeatReplay;
+{
+    // Ten seconds of option-tab held down at 60 frames per second, with keyboard repeat at 30Hz, shift toggling every 40 frames, and the main thread stalling for 14 frames out of every 45.
+    unsigned const frameCount = 600;
+    NSUInteger coalescedRedraws = 0, individualRedraws = 0;
+    SWStateMachine *coalesced = [self replayStateMachineCountingRedraws:&coalescedRedraws];
+    SWStateMachine *individual = [self replayStateMachineCountingRedraws:&individualRedraws];
+    SWInputQueue *queue = SWInputQueueCreate(256);
+
+    for (unsigned frame = 0; frame < frameCount; ++frame) {
+        if (frame % 2 == 0) {
+            uint32_t flags = SWInputFlagInvoke | SWInputFlagRepeating | ((frame / 40) % 2 ? SWInputFlagDecreasing : 0);
+            XCTAssertTrue(SWInputQueuePush(queue, &(SWInput){ .kind = SWInputKindIncrement, .flags = flags, .timestamp = frame }));
+        }
+
+        if (frame % 45 >= 31) {
+            continue;
+        }
+
+        NSUInteger before = coalescedRedraws;
+        SWInput input;
+        size_t count;
+        while ((count = SWInputQueuePopCoalesced(queue, &input))) {
+            SWIncrementDirection direction = (input.flags & SWInputFlagDecreasing) ? SWIncrementDirectionDecreasing : SWIncrementDirectionIncreasing;
+            [coalesced incrementWithInvoke:true direction:direction isRepeating:true count:count];
+            // What dispatching each event to the main queue individually did.
+            for (size_t i = 0; i < count; ++i) {
+                [individual incrementWithInvoke:true direction:direction isRepeating:true];
+            }
+        }
+        XCTAssertLessThanOrEqual(coalescedRedraws - before, (NSUInteger)2, @"A frame's inputs changed direction at most once");
+        XCTAssertEqualObjects(coalesced.selectedWindow, individual.selectedWindow);
+    }
+
+    NSLog(@"Replayed %u frames: %lu redraws coalesced, %lu individually", frameCount, (unsigned long)coalescedRedraws, (unsigned long)individualRedraws);
+    XCTAssertLessThan(coalescedRedraws, individualRedraws);
+    SWInputQueueDestroy(queue);
+}
+
 - (void)testAllAPIAtRandom;
 {
     self.niceMock = true;
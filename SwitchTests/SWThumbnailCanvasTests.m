@@ -0,0 +1,209 @@
+//
+//  SWThumbnailCanvasTests.m
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#import <Cocoa/Cocoa.h>
+#import <XCTest/XCTest.h>
+
+#import "SWThumbnailCanvas.h"
+#import "tileHash.h"
+
+
+static const size_t kFrameWidth = 1440;
+static const size_t kFrameHeight = 900;
+
+
+@interface SWThumbnailCanvasTests : XCTestCase {
+    CGContextRef frameContext;
+    SWTileHash tileHash;
+}
+
+@end
+
+
+@implementation SWThumbnailCanvasTests
+
+- (void)setUp {
+    [super setUp];
+
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateWithName(kCGColorSpaceSRGB);
+    self->frameContext = CGBitmapContextCreate(NULL, kFrameWidth, kFrameHeight, 8, 0, colorSpace, kCGBitmapByteOrder32Host | (CGBitmapInfo)kCGImageAlphaPremultipliedFirst);
+    CGColorSpaceRelease(colorSpace);
+
+    // Something vaguely document-shaped: a white page with grey lines of "text".
+    CGContextSetRGBFillColor(self->frameContext, 1.0, 1.0, 1.0, 1.0);
+    CGContextFillRect(self->frameContext, CGRectMake(0, 0, kFrameWidth, kFrameHeight));
+    CGContextSetRGBFillColor(self->frameContext, 0.3, 0.3, 0.3, 1.0);
+    for (size_t line = 0; line < kFrameHeight / 24; ++line) {
+        CGContextFillRect(self->frameContext, CGRectMake(40, 20 + line * 24, 200 + (line * 97) % 1100, 14));
+    }
+
+    SWTileHashInit(&self->tileHash, kSWTileHashDefaultTileSize);
+}
+
+- (void)tearDown {
+    SWTileHashDestroy(&self->tileHash);
+    CGContextRelease(self->frameContext);
+
+    [super tearDown];
+}
+
+#pragma mark - Helpers
+
+// Hashes the current frame the same way SWWindowWorker does, returning the frame and its dirty rects (nil if the whole frame changed).
+- (CGImageRef)captureFrameWithDirtyRects:(NSArray **)dirtyRects CF_RETURNS_RETAINED {
+    CGImageRef frame = CGBitmapContextCreateImage(self->frameContext);
+    NSData *pixels = CFBridgingRelease(CGDataProviderCopyData(CGImageGetDataProvider(frame)));
+
+    *dirtyRects = nil;
+    if (SWTileHashUpdate(&self->tileHash, pixels.bytes, CGImageGetWidth(frame), CGImageGetHeight(frame), CGImageGetBytesPerRow(frame))) {
+        size_t tileCount = self->tileHash.columns * self->tileHash.rows;
+        if (SWTileHashDirtyCount(&self->tileHash) < tileCount) {
+            NSMutableData *rectBuffer = [NSMutableData dataWithLength:tileCount * sizeof(SWTileRect)];
+            SWTileRect *rects = rectBuffer.mutableBytes;
+            size_t rectCount = SWTileHashCopyDirtyRects(&self->tileHash, rects);
+
+            NSMutableArray *result = [NSMutableArray new];
+            for (size_t i = 0; i < rectCount; ++i) {
+                [result addObject:[NSValue valueWithRect:NSMakeRect(rects[i].x, rects[i].y, rects[i].width, rects[i].height)]];
+            }
+            *dirtyRects = result;
+        }
+    } else {
+        *dirtyRects = @[];
+    }
+
+    return frame;
+}
+
+// The bytes a layer would upload for the update: every tile whose image is not the one it had before.
+- (size_t)bytesOfTilesOfCanvas:(SWThumbnailCanvas *)canvas changedFrom:(NSMutableArray *)previousTiles {
+    size_t result = 0;
+    for (NSUInteger i = 0; i < canvas.tileCount; ++i) {
+        // The previous images are kept alive so that a new image can't reuse an old one's address.
+        id tile = (__bridge id)[canvas imageForTileAtIndex:i];
+        if (i >= previousTiles.count || previousTiles[i] != tile) {
+            result += CGImageGetBytesPerRow((__bridge CGImageRef)tile) * CGImageGetHeight((__bridge CGImageRef)tile);
+        }
+        if (i < previousTiles.count) {
+            previousTiles[i] = tile;
+        } else {
+            [previousTiles addObject:tile];
+        }
+    }
+    return result;
+}
+
+- (NSData *)pixelsOfCanvas:(SWThumbnailCanvas *)canvas {
+    return CFBridgingRelease(CGDataProviderCopyData(CGImageGetDataProvider(canvas.image)));
+}
+
+#pragma mark - Tests
+
+- (void)testCursorBlinkReplay {
+    SWThumbnailCanvas *canvas = [[SWThumbnailCanvas alloc] initWithMaximumPixelSize:256.0];
+    size_t bytesBefore = 0;
+    size_t bytesAfter = 0;
+    size_t wholeCanvasBytes = 0;
+    NSMutableArray *previousTiles = [NSMutableArray new];
+
+    for (NSUInteger generation = 1; generation <= 48; ++generation) {
+        // A blinking cursor, with a word typed every eighth frame.
+        BOOL cursorVisible = generation % 2;
+        CGFloat cursorX = 300.0 + 40.0 * (generation / 8);
+        if (generation % 8 == 0) {
+            CGContextSetRGBFillColor(self->frameContext, 0.3, 0.3, 0.3, 1.0);
+            CGContextFillRect(self->frameContext, CGRectMake(cursorX - 40.0, 500, 36, 14));
+        }
+        CGContextSetRGBFillColor(self->frameContext, cursorVisible ? 0.0 : 1.0, cursorVisible ? 0.0 : 1.0, cursorVisible ? 0.0 : 1.0, 1.0);
+        CGContextFillRect(self->frameContext, CGRectMake(cursorX, 498, 2, 18));
+
+        NSArray *dirtyRects;
+        CGImageRef frame = [self captureFrameWithDirtyRects:&dirtyRects];
+        if (dirtyRects && !dirtyRects.count) {
+            CGImageRelease(frame);
+            continue;
+        }
+
+        // Before: every update replaced the layer's contents with the full-resolution capture.
+        size_t fullBytes = CGImageGetBytesPerRow(frame) * CGImageGetHeight(frame);
+        size_t canvasBytes = [canvas updateWithImage:frame dirtyRects:dirtyRects generation:generation];
+        size_t uploadedBytes = [self bytesOfTilesOfCanvas:canvas changedFrom:previousTiles];
+        XCTAssertEqual(canvasBytes, uploadedBytes);
+        bytesBefore += fullBytes;
+        bytesAfter += uploadedBytes;
+        // What publishing the whole canvas as one image would copy on the next write.
+        wholeCanvasBytes += (size_t)(canvas.pixelSize.width * canvas.pixelSize.height) * 4;
+        NSLog(@"update %lu: %lu dirty rects, %zu bytes before, %zu bytes after", (unsigned long)generation, (unsigned long)dirtyRects.count, fullBytes, canvasBytes);
+
+        CGImageRelease(frame);
+    }
+
+    NSLog(@"total: %zu bytes before, %zu bytes after, %zu bytes for whole-canvas images", bytesBefore, bytesAfter, wholeCanvasBytes);
+    XCTAssertGreaterThan(bytesBefore, bytesAfter * 50);
+    XCTAssertGreaterThan(wholeCanvasBytes, bytesAfter * 3);
+
+    // The incrementally updated canvas must match one drawn from scratch.
+    CGImageRef finalFrame = CGBitmapContextCreateImage(self->frameContext);
+    SWThumbnailCanvas *reference = [[SWThumbnailCanvas alloc] initWithMaximumPixelSize:256.0];
+    [reference updateWithImage:finalFrame dirtyRects:nil generation:0];
+    CGImageRelease(finalFrame);
+
+    NSData *actual = [self pixelsOfCanvas:canvas];
+    NSData *expected = [self pixelsOfCanvas:reference];
+    XCTAssertEqual(actual.length, expected.length);
+    const uint8_t *actualBytes = actual.bytes;
+    const uint8_t *expectedBytes = expected.bytes;
+    NSUInteger mismatches = 0;
+    for (NSUInteger i = 0; i < MIN(actual.length, expected.length); ++i) {
+        if (abs((int)actualBytes[i] - (int)expectedBytes[i]) > 1) {
+            ++mismatches;
+        }
+    }
+    XCTAssertEqual(mismatches, (NSUInteger)0);
+}
+
+- (void)testGenerationGapRedrawsEverything {
+    SWThumbnailCanvas *canvas = [[SWThumbnailCanvas alloc] initWithMaximumPixelSize:256.0];
+    NSArray *dirtyRects;
+
+    CGImageRef frame = [self captureFrameWithDirtyRects:&dirtyRects];
+    XCTAssertNil(dirtyRects);
+    size_t fullBytes = [canvas updateWithImage:frame dirtyRects:dirtyRects generation:1];
+    CGImageRelease(frame);
+    XCTAssertEqual(fullBytes, (size_t)(256 * 160 * 4));
+
+    CGContextFillRect(self->frameContext, CGRectMake(10, 10, 4, 4));
+    frame = [self captureFrameWithDirtyRects:&dirtyRects];
+    XCTAssertEqual(dirtyRects.count, (NSUInteger)1);
+
+    // Generation 2 was missed, so generation 3's dirty rects cannot be trusted.
+    XCTAssertEqual([canvas updateWithImage:frame dirtyRects:dirtyRects generation:3], fullBytes);
+    CGImageRelease(frame);
+}
+
+- (void)testStaleGenerationIsDropped {
+    SWThumbnailCanvas *canvas = [[SWThumbnailCanvas alloc] initWithMaximumPixelSize:256.0];
+    NSArray *dirtyRects;
+
+    CGImageRef frame = [self captureFrameWithDirtyRects:&dirtyRects];
+    XCTAssertEqual([canvas updateWithImage:frame dirtyRects:dirtyRects generation:3], (size_t)(256 * 160 * 4));
+
+    // An older generation must not replace the newer content, or be mistaken for a gap that needs a full redraw.
+    XCTAssertEqual([canvas updateWithImage:frame dirtyRects:nil generation:2], (size_t)0);
+    XCTAssertEqual([canvas updateWithImage:frame dirtyRects:nil generation:3], (size_t)0);
+    XCTAssertEqual(canvas.generation, (NSUInteger)3);
+    CGImageRelease(frame);
+}
+
+@end
@@ -0,0 +1,156 @@
+//
+//  SWTraceTests.m
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "trace.h"
+
+
+static const size_t kEventCapacity = 4 * SWTraceBufferCapacity;
+static const NSUInteger kOverheadIterations = 1000000;
+
+
+@interface SWTraceTests : XCTestCase {
+    SWTraceEvent *events;
+    uint64_t start;
+}
+
+@end
+
+
+@implementation SWTraceTests
+
+- (void)setUp {
+    [super setUp];
+    
+    self->events = calloc(kEventCapacity, sizeof(*self->events));
+    self->start = SWTraceNow();
+}
+
+- (void)tearDown {
+    free(self->events);
+    
+    [super tearDown];
+}
+
+- (size_t)copyEventsNamed:(const char *)name {
+    size_t count = SWTraceCopyEvents(self->events, kEventCapacity, self->start);
+    size_t matching = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (!strcmp(self->events[i].name, name)) {
+            self->events[matching++] = self->events[i];
+        }
+    }
+    return matching;
+}
+
+- (void)testScopesRecordSpans {
+    for (int i = 0; i < 3; ++i) {
+        SWTraceScope("testScopesRecordSpans");
+        usleep(1000);
+    }
+    
+    XCTAssertEqual([self copyEventsNamed:"testScopesRecordSpans"], (size_t)3);
+    for (size_t i = 0; i < 3; ++i) {
+        XCTAssertGreaterThanOrEqual(SWTraceNanoseconds(self->events[i].duration), (uint64_t)1000000);
+        XCTAssertGreaterThanOrEqual(self->events[i].start, self->start);
+    }
+}
+
+- (void)testIntervalsEndOnce {
+    SWTraceInterval interval = { 0 };
+    SWTraceIntervalEnd(&interval, "testIntervalsEndOnce");
+    SWTraceIntervalBegin(&interval, SWTraceNow());
+    SWTraceIntervalEnd(&interval, "testIntervalsEndOnce");
+    SWTraceIntervalEnd(&interval, "testIntervalsEndOnce");
+    
+    XCTAssertEqual([self copyEventsNamed:"testIntervalsEndOnce"], (size_t)1);
+}
+
+- (void)testFullBuffersKeepTheNewestSpans {
+    for (uint64_t i = 0; i < 3 * SWTraceBufferCapacity; ++i) {
+        SWTraceRecord("testFullBuffersKeepTheNewestSpans", self->start + i, self->start + i + 1);
+    }
+    
+    size_t count = [self copyEventsNamed:"testFullBuffersKeepTheNewestSpans"];
+    XCTAssertEqual(count, (size_t)SWTraceBufferCapacity - 1);
+    XCTAssertEqual(self->events[count - 1].start, self->start + 3 * SWTraceBufferCapacity - 1);
+    for (size_t i = 1; i < count; ++i) {
+        XCTAssertEqual(self->events[i].start, self->events[i - 1].start + 1);
+    }
+}
+
+- (void)testHistogramPercentiles {
+    SWTraceHistogram histogram;
+    SWTraceHistogramInit(&histogram);
+    XCTAssertEqual(SWTraceHistogramPercentile(&histogram, 50.0), (uint64_t)0);
+    
+    for (uint64_t value = 1; value <= 100000; ++value) {
+        SWTraceHistogramRecord(&histogram, value);
+    }
+    
+    double percentiles[] = { 50.0, 99.0, 99.9 };
+    for (size_t i = 0; i < sizeof(percentiles) / sizeof(*percentiles); ++i) {
+        double expected = percentiles[i] * 1000.0;
+        double actual = SWTraceHistogramPercentile(&histogram, percentiles[i]);
+        XCTAssertEqualWithAccuracy(actual, expected, expected / 32.0);
+    }
+    XCTAssertEqual(SWTraceHistogramPercentile(&histogram, 100.0), (uint64_t)100000);
+    XCTAssertEqual(SWTraceHistogramPercentile(&histogram, 0.0), (uint64_t)1);
+}
+
+- (void)testSummariesAreByName {
+    SWTraceEvent summarized[] = {
+        { "a", 0, 10, 1 },
+        { "b", 0, 20, 1 },
+        { "a", 0, 30, 2 },
+    };
+    SWTraceSummary summaries[1];
+    
+    XCTAssertEqual(SWTraceSummarize(summarized, 3, summaries, 1), (size_t)1);
+    XCTAssertEqual(strcmp(summaries[0].name, "a"), 0);
+    XCTAssertEqual(summaries[0].durations.count, (uint64_t)2);
+}
+
+- (void)testChromeTraceExport {
+    SWTraceEvent exported[] = {
+        { "first", 1000, 500, 1 },
+        { "\"quoted\"", 1200, 100, 2 },
+    };
+    char *buffer = NULL;
+    size_t length = 0;
+    FILE *file = open_memstream(&buffer, &length);
+    XCTAssertTrue(SWTraceWriteChromeJSON(exported, 2, file));
+    fclose(file);
+    
+    NSError *error = nil;
+    NSArray *trace = [NSJSONSerialization JSONObjectWithData:[NSData dataWithBytesNoCopy:buffer length:length freeWhenDone:YES] options:0 error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqual(trace.count, (NSUInteger)2);
+    XCTAssertEqualObjects(trace[0][@"ph"], @"X");
+    XCTAssertEqualObjects(trace[0][@"ts"], @0);
+    XCTAssertEqualObjects(trace[1][@"name"], @"\"quoted\"");
+    XCTAssertEqualObjects(trace[1][@"tid"], @2);
+    XCTAssertEqualWithAccuracy([trace[1][@"ts"] doubleValue], SWTraceNanoseconds(200) / 1000.0, 0.001);
+}
+
+- (void)testSpanOverhead {
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < kOverheadIterations; ++i) {
+            SWTraceScope("testSpanOverhead");
+        }
+    }];
+}
+
+@end
@@ -0,0 +1,219 @@
+//
+//  SWWindowListDeltaTests.m
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#import "SWWindowListServiceTestSuperclass.h"
+
+#import "SWWindowListDelta.h"
+
+
+@interface SWWindowListService (DeltaInternal)
+
+- (void)private_updateWindowList:(NSArray *)windowInfoList delta:(SWWindowListDelta *)delta;
+
+@end
+
+
+static NSDictionary *windowDescriptionByChanging(NSDictionary *description, NSString *key, id value) {
+    NSMutableDictionary *result = [description mutableCopy];
+    result[key] = value;
+    return result;
+}
+
+
+@interface SWWindowListDeltaTests : SWWindowListServiceTestSuperclass
+
+@end
+
+
+@implementation SWWindowListDeltaTests
+
+// Window descriptions in the style of the filtering fixtures, with distinct window numbers.
+- (NSArray *)baseWindowListWithCount:(NSUInteger)count;
+{
+    NSArray *owners = @[@"Google Chrome", @"Safari", @"Xcode", @"Finder", @"Tweetbot", @"MacVim", @"Dash"];
+    NSMutableArray *result = [NSMutableArray new];
+    for (NSUInteger i = 0; i < count; ++i) {
+        NSString *owner = owners[i % owners.count];
+        CGRect bounds = { .origin.x = (i * 37) % 800, .origin.y = 22 + (i * 19) % 400, .size.width = 600 + (i * 13) % 700, .size.height = 400 + (i * 7) % 300 };
+        [result addObject:windowDescriptionWithAttributes(1000 + i * 3, owner, (pid_t)(100 + i % owners.count), [NSString stringWithFormat:@"%@ window %lu", owner, (unsigned long)i], bounds, 0, 1.0, 5000 + i)];
+    }
+    return result;
+}
+
+- (SWWindowListDelta *)deltaFromList:(NSArray *)oldList toList:(NSArray *)newList;
+{
+    return [SWWindowListDelta deltaFromEntries:oldList ? [SWWindowListDelta entriesForWindowInfoList:oldList] : nil toEntries:[SWWindowListDelta entriesForWindowInfoList:newList]];
+}
+
+#pragma mark - Deltas
+
+- (void)testFirstListInsertsEverything
+{
+    NSArray *list = [self baseWindowListWithCount:5];
+    SWWindowListDelta *delta = [self deltaFromList:nil toList:list];
+    XCTAssertEqual(delta.insertedWindowIDs.count, (NSUInteger)5);
+    XCTAssertFalse(delta.empty);
+}
+
+- (void)testIdenticalListsAreEmpty
+{
+    NSArray *list = [self baseWindowListWithCount:5];
+    XCTAssertTrue([self deltaFromList:list toList:[list copy]].empty);
+}
+
+- (void)testMemoryUsageIsIgnored
+{
+    NSArray *list = [self baseWindowListWithCount:5];
+    NSMutableArray *churned = [list mutableCopy];
+    churned[2] = windowDescriptionByChanging(list[2], NNWindowMemoryUsage, @123456);
+    XCTAssertTrue([self deltaFromList:list toList:churned].empty);
+}
+
+- (void)testInsertRemoveMoveUpdate
+{
+    NSArray *list = [self baseWindowListWithCount:5];
+    NSDictionary *newWindow = windowDescriptionWithAttributes(42, @"Safari", 101, @"New window", CGRectMake(0, 22, 800, 600), 0, 1.0, 1);
+    NSDictionary *retitled = windowDescriptionByChanging(list[1], NNWindowName, @"Renamed");
+    // Window 3 is brought to the front, window 1 is retitled, window 4 closes, a new window opens at the back.
+    NSArray *next = @[list[3], list[0], retitled, list[2], newWindow];
+    
+    SWWindowListDelta *delta = [self deltaFromList:list toList:next];
+    XCTAssertEqualObjects(delta.insertedWindowIDs, [NSIndexSet indexSetWithIndex:42]);
+    XCTAssertEqualObjects(delta.removedWindowIDs, [NSIndexSet indexSetWithIndex:[list[4][NNWindowNumber] unsignedIntegerValue]]);
+    XCTAssertEqualObjects(delta.movedWindowIDs, [NSIndexSet indexSetWithIndex:[list[3][NNWindowNumber] unsignedIntegerValue]]);
+    XCTAssertEqualObjects(delta.updatedWindowIDs, [NSIndexSet indexSetWithIndex:[list[1][NNWindowNumber] unsignedIntegerValue]]);
+}
+
+- (void)testShiftedWindowsAreNotMoved
+{
+    NSArray *list = [self baseWindowListWithCount:5];
+    NSArray *next = [@[windowDescriptionWithAttributes(42, @"Safari", 101, @"New window", CGRectMake(0, 22, 800, 600), 0, 1.0, 1)] arrayByAddingObjectsFromArray:list];
+    
+    SWWindowListDelta *delta = [self deltaFromList:list toList:next];
+    XCTAssertEqual(delta.insertedWindowIDs.count, (NSUInteger)1);
+    XCTAssertEqual(delta.movedWindowIDs.count, (NSUInteger)0);
+}
+
+- (void)testChangesInLongTitlesAreDetected
+{
+    NSString *title = [@"" stringByPaddingToLength:200 withString:@"document " startingAtIndex:0];
+    NSString *changedTitle = [title stringByReplacingCharactersInRange:NSMakeRange(100, 1) withString:@"!"];
+    NSDictionary *window = windowDescriptionWithAttributes(7, @"Xcode", 102, title, CGRectMake(0, 22, 800, 600), 0, 1.0, 1);
+    
+    SWWindowListDelta *delta = [self deltaFromList:@[window] toList:@[windowDescriptionByChanging(window, NNWindowName, changedTitle)]];
+    XCTAssertEqualObjects(delta.updatedWindowIDs, [NSIndexSet indexSetWithIndex:7]);
+}
+
+- (void)testBoundsChangesAreDetected
+{
+    NSDictionary *window = windowDescriptionWithAttributes(7, @"Xcode", 102, @"main.m", CGRectMake(0, 22, 800, 600), 0, 1.0, 1);
+    NSDictionary *moved = windowDescriptionByChanging(window, NNWindowBounds, DICT_FROM_RECT(CGRectMake(1, 22, 800, 600)));
+    XCTAssertEqualObjects([self deltaFromList:@[window] toList:@[moved]].updatedWindowIDs, [NSIndexSet indexSetWithIndex:7]);
+}
+
+#pragma mark - Replay
+
+// A deterministic sequence of window lists like the ones the worker sees: memory usage churning constantly, with occasional title changes, focus changes, and windows opening and closing.
+- (NSArray *)replayTicksWithWindowCount:(NSUInteger)windowCount tickCount:(NSUInteger)tickCount;
+{
+    NSMutableArray *ticks = [NSMutableArray new];
+    NSMutableArray *list = [[self baseWindowListWithCount:windowCount] mutableCopy];
+    NSUInteger nextWindowNumber = 100000;
+    
+    for (NSUInteger tick = 0; tick < tickCount; ++tick) {
+        NSUInteger index = (tick * 7) % list.count;
+        list[index] = windowDescriptionByChanging(list[index], NNWindowMemoryUsage, @(tick));
+        
+        if (tick % 10 == 0) {
+            list[0] = windowDescriptionByChanging(list[0], NNWindowName, [NSString stringWithFormat:@"Edited %lu", (unsigned long)tick]);
+        }
+        if (tick % 50 == 25) {
+            NSDictionary *focused = list[index];
+            [list removeObjectAtIndex:index];
+            [list insertObject:focused atIndex:0];
+        }
+        if (tick % 100 == 50) {
+            [list insertObject:windowDescriptionWithAttributes(nextWindowNumber++, @"Safari", 101, @"Popup", CGRectMake(100, 100, 400, 300), 0, 1.0, 1) atIndex:0];
+            [list removeLastObject];
+        }
+        
+        [ticks addObject:[list copy]];
+    }
+    return ticks;
+}
+
+// Reused windows keep the memory usage they were created with, so compare everything else.
+- (NSArray *)summaryOfWindowGroups:(NSOrderedSet *)windowGroups;
+{
+    NSMutableArray *result = [NSMutableArray new];
+    for (SWWindowGroup *group in windowGroups) {
+        NSMutableArray *windows = [NSMutableArray new];
+        for (SWWindow *window in group.windows) {
+            [windows addObject:@[@(window.windowID), window.name, [NSValue valueWithRect:window.flippedFrame]]];
+        }
+        [result addObject:@[@(group.mainWindow.windowID), windows]];
+    }
+    return result;
+}
+
+- (void)testReplayMatchesFullRebuild
+{
+    SWWindowListService *fullService = [SWWindowListService new];
+    NSArray *previous = nil;
+    
+    for (NSArray *tick in [self replayTicksWithWindowCount:30 tickCount:200]) {
+        SWWindowListDelta *delta = [self deltaFromList:previous toList:tick];
+        previous = tick;
+        if (delta.empty) {
+            continue;
+        }
+        
+        [self.listService private_updateWindowList:tick delta:delta];
+        [fullService private_updateWindowList:tick delta:nil];
+        XCTAssertEqualObjects([self summaryOfWindowGroups:self.listService.windows], [self summaryOfWindowGroups:fullService.windows]);
+    }
+}
+
+- (void)testReplayTickCost
+{
+    const NSUInteger windowCount = 60;
+    const NSUInteger tickCount = 600;
+    NSArray *ticks = [self replayTicksWithWindowCount:windowCount tickCount:tickCount];
+    
+    NSUInteger wholeListChanges = 0;
+    NSDate *wholeListStart = [NSDate date];
+    for (NSUInteger i = 1; i < ticks.count; ++i) {
+        if (![ticks[i - 1] isEqualToArray:ticks[i]]) {
+            wholeListChanges++;
+        }
+    }
+    NSTimeInterval wholeListElapsed = -[wholeListStart timeIntervalSinceNow];
+    
+    [self measureBlock:^{
+        NSUInteger deltas = 0;
+        NSData *previous = nil;
+        NSDate *start = [NSDate date];
+        for (NSArray *tick in ticks) {
+            NSData *entries = [SWWindowListDelta entriesForWindowInfoList:tick];
+            if (![SWWindowListDelta deltaFromEntries:previous toEntries:entries].empty) {
+                deltas++;
+            }
+            previous = entries;
+        }
+        NSTimeInterval elapsed = -[start timeIntervalSinceNow];
+        NSLog(@"%lu windows, %lu ticks: isEqualToArray %.1fus/tick with %lu changes, keyed diff %.1fus/tick with %lu changes", (unsigned long)windowCount, (unsigned long)tickCount, wholeListElapsed * 1e6 / tickCount, (unsigned long)wholeListChanges, elapsed * 1e6 / tickCount, (unsigned long)deltas);
+    }];
+}
+
+@end
@@ -20,6 +20,11 @@
 #import "SWWindow.h"
 
 
+// Window descriptions in the form CGWindowListCopyWindowInfo returns them. Unless given, windows are on layer 0, opaque, and use 1024 bytes.
+NSDictionary *windowDescription(NSUInteger number, NSString *owner, pid_t pid, NSString *name, CGRect bounds);
+NSDictionary *windowDescriptionWithAttributes(NSUInteger number, NSString *owner, pid_t pid, NSString *name, CGRect bounds, NSInteger layer, double alpha, NSUInteger memoryUsage);
+
+
 @interface SWWindowListServiceTestSuperclass : XCTestCase
 
 @property (nonatomic, strong, readonly) SWWindowListService *listService;
@@ -15,6 +15,27 @@
 #import "SWWindowListServiceTestSuperclass.h"
 
 
+NSDictionary *windowDescription(NSUInteger number, NSString *owner, pid_t pid, NSString *name, CGRect bounds) {
+    return windowDescriptionWithAttributes(number, owner, pid, name, bounds, 0, 1.0, 1024);
+}
+
+NSDictionary *windowDescriptionWithAttributes(NSUInteger number, NSString *owner, pid_t pid, NSString *name, CGRect bounds, NSInteger layer, double alpha, NSUInteger memoryUsage) {
+    return @{
+        NNWindowAlpha : @(alpha),
+        NNWindowBounds : DICT_FROM_RECT(bounds),
+        NNWindowIsOnscreen : @1,
+        NNWindowLayer : @(layer),
+        NNWindowMemoryUsage : @(memoryUsage),
+        NNWindowName : name,
+        NNWindowNumber : @(number),
+        NNWindowOwnerName : owner,
+        NNWindowOwnerPID : @(pid),
+        NNWindowSharingState : @1,
+        NNWindowStoreType : @2
+    };
+}
+
+
 @interface SWWindowListService (Internal)
 
 - (void)private_updateWindowList:(NSArray *)windowInfoList;
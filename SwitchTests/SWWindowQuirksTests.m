@@ -0,0 +1,108 @@
+//
+//  SWWindowQuirksTests.m
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#import "SWWindowListServiceTestSuperclass.h"
+
+#import "SWPreferencesService.h"
+#import "windowTable.h"
+
+
+@interface SWWindowListService (Internal)
+
+- (void)private_updateWindowList:(NSArray *)windowInfoList;
+
+@end
+
+
+@interface SWWindowQuirksTests : SWWindowListServiceTestSuperclass
+
+@end
+
+
+@implementation SWWindowQuirksTests
+
+- (void)tearDown
+{
+    [SWPreferencesService sharedService].windowQuirks = nil;
+    
+    [super tearDown];
+}
+
+// User quirks are read when the list service is created, so each replay gets a new one.
+- (NSOrderedSet *)windowGroupsFromInfoList:(NSArray *)infoList withQuirks:(NSDictionary *)quirks;
+{
+    [SWPreferencesService sharedService].windowQuirks = quirks;
+    SWWindowListService *listService = [SWWindowListService new];
+    [listService private_updateWindowList:infoList];
+    return listService.windows;
+}
+
+- (void)testQuirkNames
+{
+    NSDictionary *quirksByName = @{
+        @"hideWindowsNamedAfterOwner" : @(SWWindowTableQuirkHideWindowsNamedAfterOwner),
+        @"hideTranslucentWindows" : @(SWWindowTableQuirkHideTranslucentWindows),
+        @"decoratorWindows" : @(SWWindowTableQuirkDecoratorWindows),
+        @"noChildWindows" : @(SWWindowTableQuirkNoChildWindows),
+        @"savePanelService" : @(SWWindowTableQuirkSavePanelService),
+        @"hideLoneUnnamedWindowsWhenInactive" : @(SWWindowTableQuirkHideLoneUnnamedWindowsWhenInactive),
+    };
+    [quirksByName enumerateKeysAndObjectsUsingBlock:^(NSString *name, NSNumber *quirk, BOOL *stop) {
+        XCTAssertEqual(SWWindowTableQuirkNamed(name.UTF8String, name.length), quirk.unsignedIntValue, @"%@", name);
+    }];
+    XCTAssertEqual(SWWindowTableQuirkNamed("hideWindows", strlen("hideWindows")), (SWWindowTableQuirks)0);
+}
+
+- (void)testUserQuirksApplyToOtherApplications
+{
+    NSArray *infoList = @[
+        windowDescription(2, @"Paletted", 200, @"Paletted", CGRectMake(900, 100, 200, 400)),
+        windowDescription(1, @"Paletted", 200, @"Drawing.pal", CGRectMake(100, 100, 700, 500)),
+    ];
+    
+    XCTAssertEqual([self windowGroupsFromInfoList:infoList withQuirks:nil].count, (NSUInteger)2);
+    
+    NSOrderedSet *windowGroups = [self windowGroupsFromInfoList:infoList withQuirks:@{ @"Paletted" : @[@"hideWindowsNamedAfterOwner"] }];
+    XCTAssertEqual(windowGroups.count, (NSUInteger)1);
+    XCTAssertEqualObjects(((SWWindowGroup *)windowGroups.firstObject).mainWindow.name, @"Drawing.pal");
+}
+
+- (void)testUserQuirksReplaceBuiltInQuirks
+{
+    NSArray *infoList = @[
+        windowDescription(2, @"Microsoft Word", 300, @"Microsoft Word", CGRectMake(0, 22, 1280, 80)),
+        windowDescription(1, @"Microsoft Word", 300, @"Document1", CGRectMake(100, 120, 900, 700)),
+    ];
+    
+    XCTAssertEqual([self windowGroupsFromInfoList:infoList withQuirks:nil].count, (NSUInteger)1);
+    XCTAssertEqual([self windowGroupsFromInfoList:infoList withQuirks:@{ @"Microsoft Word" : @[] }].count, (NSUInteger)2);
+}
+
+- (void)testMalformedUserQuirksAreIgnored
+{
+    NSArray *infoList = @[
+        windowDescriptionWithAttributes(2, @"Isolator", 400, @"", CGRectMake(0, 0, 1440, 900), 0, 0.5, 1024),
+        windowDescription(1, @"Safari", 401, @"Apple", CGRectMake(100, 120, 900, 700)),
+    ];
+    NSDictionary *quirks = @{
+        @"Isolator" : @"hideTranslucentWindows",
+        @"Safari" : @[@"noSuchQuirk", @3],
+    };
+    
+    NSOrderedSet *windowGroups = [self windowGroupsFromInfoList:infoList withQuirks:quirks];
+    XCTAssertEqual(windowGroups.count, (NSUInteger)1);
+    XCTAssertEqualObjects(((SWWindowGroup *)windowGroups.firstObject).mainWindow.name, @"Apple");
+}
+
+@end
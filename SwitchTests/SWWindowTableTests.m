@@ -0,0 +1,269 @@
+//
+//  SWWindowTableTests.m
+//  Switch
+//
+//  Created by Scott Perry on 10/17/26.
+//  Copyright © 2026 Scott Perry.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#import "SWWindowListServiceTestSuperclass.h"
+
+#import "windowTable.h"
+
+
+static SWWindowTableAtom intern(SWWindowTable *table, const char *string) {
+    return SWWindowTableIntern(table, string, strlen(string));
+}
+
+
+@interface SWWindowTableTests : SWWindowListServiceTestSuperclass
+
+@end
+
+
+@implementation SWWindowTableTests
+
+// A window list like a busy desktop's: main windows with unnamed children, menu bar and dock windows, and the occasional invisible window.
+- (NSArray *)syntheticWindowListWithCount:(NSUInteger)count;
+{
+    NSArray *owners = @[@"Google Chrome", @"Safari", @"Xcode", @"Finder", @"Tweetbot", @"MacVim", @"Dash", @"Microsoft Word"];
+    NSMutableArray *result = [NSMutableArray new];
+    for (NSUInteger i = 0; i < count; ++i) {
+        NSString *owner = owners[(i / 3) % owners.count];
+        pid_t pid = (pid_t)(100 + (i / 3) % owners.count);
+        CGRect bounds = { .origin.x = (i * 37) % 800, .origin.y = 22 + (i * 19) % 400, .size.width = 600 + (i * 13) % 700, .size.height = 400 + (i * 7) % 300 };
+        NSString *name = [NSString stringWithFormat:@"%@ window %lu", owner, (unsigned long)i];
+        NSInteger layer = 0;
+        double alpha = 1.0;
+        
+        switch (i % 6) {
+            case 1:
+                // A sheet, attached to the window behind it.
+                bounds = CGRectInset(bounds, 50.0, 50.0);
+                name = @"";
+                break;
+            case 3:
+                layer = 25;
+                break;
+            case 5:
+                alpha = 0.0;
+                break;
+        }
+        
+        [result addObject:windowDescriptionWithAttributes(1000 + i, owner, pid, name, bounds, layer, alpha, 1024)];
+    }
+    return result;
+}
+
+#pragma mark - Table
+
+- (void)testOwnerNamesWithQuirksOutliveRemoveAll
+{
+    SWWindowTable table;
+    XCTAssertTrue(SWWindowTableInit(&table, 0));
+    
+    XCTAssertEqual(intern(&table, ""), (SWWindowTableAtom)SWWindowTableAtomNone);
+    SWWindowTableAtom tweetbot = intern(&table, "Tweetbot");
+    XCTAssertEqual(table.atomQuirks[tweetbot], (SWWindowTableQuirks)SWWindowTableQuirkDecoratorWindows);
+    SWWindowTableAtom safari = intern(&table, "Safari");
+    XCTAssertEqual(intern(&table, "Safari"), safari);
+    XCTAssertNotEqual(intern(&table, "Safari 2"), safari);
+    XCTAssertEqual(table.atomQuirks[safari], (SWWindowTableQuirks)0);
+    
+    SWWindowTableRemoveAll(&table);
+    XCTAssertEqual(table.count, (size_t)0);
+    XCTAssertEqual(table.atomCount, table.pinnedAtomCount);
+    XCTAssertEqual(intern(&table, "Tweetbot"), tweetbot);
+    
+    SWWindowTableDestroy(&table);
+}
+
+- (void)testDecodedWindowsMatchDescriptions
+{
+    NSArray *list = [self syntheticWindowListWithCount:12];
+    SWWindowTable table;
+    XCTAssertTrue(SWWindowTableInit(&table, 0));
+    
+    for (NSDictionary *description in list) {
+        size_t row = [SWWindow appendDescription:description toWindowTable:&table];
+        SWWindow *fromTable = [SWWindow windowWithDescription:description windowTable:&table row:row];
+        SWWindow *fromDescription = [SWWindow windowWithDescription:description];
+        
+        XCTAssertEqualObjects(fromTable, fromDescription);
+        XCTAssertEqual(fromTable.windowID, fromDescription.windowID);
+        XCTAssertEqualObjects(fromTable.name, fromDescription.name);
+        XCTAssertEqual(fromTable.alpha, fromDescription.alpha);
+        XCTAssertTrue(CGRectEqualToRect(fromTable.flippedFrame, fromDescription.flippedFrame));
+    }
+    
+    SWWindowTableDestroy(&table);
+}
+
+- (void)testFilterRules
+{
+    CGRect bounds = CGRectMake(0, 22, 800, 600);
+    NSArray *list = @[
+        windowDescription(1, @"Safari", 101, @"Kept", bounds),
+        windowDescriptionWithAttributes(2, @"SystemUIServer", 102, @"", bounds, 25, 1.0, 1024),
+        windowDescriptionWithAttributes(3, @"Safari", 101, @"Transparent", bounds, 0, 0.0, 1024),
+        windowDescription(4, @"Microsoft Word", 103, @"Microsoft Word", bounds),
+        windowDescription(5, @"Microsoft Word", 103, @"Document1", bounds),
+        windowDescriptionWithAttributes(6, @"Isolator", 104, @"", bounds, 0, 0.5, 1024),
+        windowDescriptionWithAttributes(7, @"Isolator", 104, @"", bounds, 0, 0.95, 1024),
+    ];
+    
+    NSOrderedSet *windows = [SWWindowListService filterInfoDictionariesToWindowObjects:list];
+    NSArray *windowIDs = [windows.array valueForKey:@"windowID"];
+    XCTAssertEqualObjects(windowIDs, (@[@1, @5, @7]));
+}
+
+- (void)testTweetbotShadowsJoinTheWindowTheyShadow
+{
+    SWWindowTable table;
+    XCTAssertTrue(SWWindowTableInit(&table, 0));
+    
+    SWWindowTableAtom name = intern(&table, "Timeline");
+    SWWindowTableAtom tweetbot = intern(&table, "Tweetbot");
+    // Front to back: the main window, its shadow, and an unrelated window of the same size and position.
+    SWWindowTableAppend(&table, 1, 100, 0, 1.0, (SWWindowTableRect){ 100, 100, 400, 600 }, name, tweetbot);
+    SWWindowTableAppend(&table, 2, 100, 0, 1.0, (SWWindowTableRect){ 55, 60, 490, 685 }, SWWindowTableAtomNone, tweetbot);
+    SWWindowTableAppend(&table, 3, 100, 0, 1.0, (SWWindowTableRect){ 100, 100, 400, 600 }, name, tweetbot);
+    for (size_t row = 0; row < table.count; ++row) {
+        table.flags[row] = SWWindowTableFlagCanBeActivated;
+        table.screens[row] = 0;
+    }
+    
+    SWWindowTableGroup groups[3];
+    XCTAssertEqual(SWWindowTableGroupWindows(&table, groups), (size_t)2);
+    XCTAssertEqual(groups[0].start, (size_t)2);
+    XCTAssertEqual(groups[1].start, (size_t)0);
+    XCTAssertEqual(groups[1].count, (size_t)2);
+    XCTAssertEqual(groups[1].mainWindow, (size_t)0);
+    
+    SWWindowTableDestroy(&table);
+}
+
+- (void)testSaveDialogsJoinTheDocumentTheyBelongTo
+{
+    SWWindowTable table;
+    XCTAssertTrue(SWWindowTableInit(&table, 0));
+    
+    SWWindowTableAtom save = intern(&table, "Save");
+    SWWindowTableAtom document = intern(&table, "Untitled.txt");
+    SWWindowTableAtom textEdit = intern(&table, "TextEdit");
+    SWWindowTableAtom savePanel = intern(&table, "com.apple.appkit.xpc.openAndSav");
+    // Front to back: two stacked save panels, the document they belong to, and another document of the same size and position.
+    SWWindowTableAppend(&table, 1, 100, 0, 1.0, (SWWindowTableRect){ 150, 150, 400, 300 }, save, savePanel);
+    SWWindowTableAppend(&table, 2, 100, 0, 1.0, (SWWindowTableRect){ 150, 150, 400, 300 }, save, savePanel);
+    SWWindowTableAppend(&table, 3, 100, 0, 1.0, (SWWindowTableRect){ 100, 100, 600, 400 }, document, textEdit);
+    SWWindowTableAppend(&table, 4, 100, 0, 1.0, (SWWindowTableRect){ 100, 100, 600, 400 }, document, textEdit);
+    for (size_t row = 0; row < table.count; ++row) {
+        table.flags[row] = SWWindowTableFlagCanBeActivated;
+        table.screens[row] = 0;
+    }
+    
+    SWWindowTableGroup groups[4];
+    XCTAssertEqual(SWWindowTableGroupWindows(&table, groups), (size_t)2);
+    XCTAssertEqual(groups[0].start, (size_t)3);
+    XCTAssertEqual(groups[0].count, (size_t)1);
+    XCTAssertEqual(groups[1].start, (size_t)0);
+    XCTAssertEqual(groups[1].count, (size_t)3);
+    XCTAssertEqual(groups[1].mainWindow, (size_t)2);
+    
+    SWWindowTableDestroy(&table);
+}
+
+#pragma mark - Performance
+
+- (void)measureFilteringAndGroupingWithCount:(NSUInteger)count;
+{
+    NSArray *list = [self syntheticWindowListWithCount:count];
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 1000 / count + 10; ++i) {
+            NSOrderedSet *windows = [SWWindowListService filterInfoDictionariesToWindowObjects:list];
+            [SWWindowListService filterWindowObjectsToWindowGroups:windows];
+        }
+    }];
+}
+
+- (void)measureTableWithCount:(NSUInteger)count;
+{
+    NSArray *list = [self syntheticWindowListWithCount:count];
+    SWWindowTable table;
+    XCTAssertTrue(SWWindowTableInit(&table, count));
+    size_t *rows = calloc(count, sizeof(*rows));
+    SWWindowTableGroup *groups = calloc(count, sizeof(*groups));
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 100000 / count; ++i) {
+            SWWindowTableRemoveAll(&table);
+            for (NSDictionary *description in list) {
+                [SWWindow appendDescription:description toWindowTable:&table];
+            }
+            SWWindowTableCompact(&table, rows, SWWindowTableFilter(&table, rows));
+            for (size_t row = 0; row < table.count; ++row) {
+                table.flags[row] = SWWindowTableFlagCanBeActivated;
+                table.screens[row] = 0;
+            }
+            SWWindowTableGroupWindows(&table, groups);
+        }
+    }];
+    
+    free(groups);
+    free(rows);
+    SWWindowTableDestroy(&table);
+}
+
+// Every window after the first is a save panel stacked on the one below, so the whole list merges into a single group.
+- (void)testSaveDialogChainPerformance
+{
+    NSMutableArray *list = [NSMutableArray new];
+    for (NSUInteger i = 0; i < 1000; ++i) {
+        CGRect bounds = CGRectInset(CGRectMake(0, 22, 1600, 1200), i * 0.5, i * 0.5);
+        [list insertObject:windowDescriptionWithAttributes(1000 + i, @"TextEdit", 100, @"Save", bounds, 0, i ? 0.99 : 1.0, 1024) atIndex:0];
+        [list insertObject:windowDescriptionWithAttributes(3000 + i, @"TextEdit", 100, @"", CGRectMake(bounds.origin.x, bounds.origin.y, bounds.size.width, 10.0), 0, 0.5, 1024) atIndex:0];
+    }
+    NSOrderedSet *windows = [SWWindowListService filterInfoDictionariesToWindowObjects:list];
+    
+    [self measureBlock:^{
+        [SWWindowListService filterWindowObjectsToWindowGroups:windows];
+    }];
+}
+
+- (void)testFilteringAndGroupingPerformance10
+{
+    [self measureFilteringAndGroupingWithCount:10];
+}
+
+- (void)testFilteringAndGroupingPerformance100
+{
+    [self measureFilteringAndGroupingWithCount:100];
+}
+
+- (void)testFilteringAndGroupingPerformance1000
+{
+    [self measureFilteringAndGroupingWithCount:1000];
+}
+
+- (void)testTablePerformance10
+{
+    [self measureTableWithCount:10];
+}
+
+- (void)testTablePerformance100
+{
+    [self measureTableWithCount:100];
+}
+
+- (void)testTablePerformance1000
+{
+    [self measureTableWithCount:1000];
+}
+
+@end